@@ -0,0 +1,62 @@
+#ifndef DUELSCRIPT_ALLOCATIONSTATS_H
+#define DUELSCRIPT_ALLOCATIONSTATS_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+
+// --- عداد الـ Allocations ---
+// العدادات متاحة من أي ملف. الـ operator new/delete البديلة تُعرّف مرة واحدة
+// فقط: في الملف الذي يعرّف DUELSCRIPT_ALLOCATION_HOOKS قبل الـ include (main.cpp).
+namespace alloc_stats {
+
+inline std::atomic<std::size_t> allocationCount{0};
+inline std::atomic<std::size_t> allocatedBytes{0};
+
+struct Snapshot {
+    std::size_t count;
+    std::size_t bytes;
+
+    Snapshot operator-(const Snapshot& other) const {
+        return {count - other.count, bytes - other.bytes};
+    }
+};
+
+inline Snapshot snapshot() {
+    return {allocationCount.load(std::memory_order_relaxed),
+            allocatedBytes.load(std::memory_order_relaxed)};
+}
+
+} // namespace alloc_stats
+
+#ifdef DUELSCRIPT_ALLOCATION_HOOKS
+
+// (GCC يعطي تحذيراً خاطئاً عند دمج malloc/free مع new/delete بعد الـ inlining)
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+#endif
+
+void* operator new(std::size_t size) {
+    alloc_stats::allocationCount.fetch_add(1, std::memory_order_relaxed);
+    alloc_stats::allocatedBytes.fetch_add(size, std::memory_order_relaxed);
+    if (void* p = std::malloc(size ? size : 1)) return p;
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept {
+    std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept {
+    std::free(p);
+}
+
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic pop
+#endif
+
+#endif // DUELSCRIPT_ALLOCATION_HOOKS
+
+#endif // DUELSCRIPT_ALLOCATIONSTATS_H
@@ -0,0 +1,143 @@
+#ifndef DUELSCRIPT_ASTARENA_H
+#define DUELSCRIPT_ASTARENA_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// --- NodePtr ---
+// مالك الـ node داخل الشجرة (move-only مثل unique_ptr)، لكن بدون destructor:
+// الذاكرة والهدم كلاهما مسؤولية الـ AstArena. لذلك هدم شجرة عميقة (سلسلة
+// 'a + b + c + ...' بمليون عنصر) لا يستدعي أي destructor متداخل ولا يستهلك الـ stack.
+template<typename T>
+class NodePtr {
+public:
+    NodePtr() = default;
+    NodePtr(std::nullptr_t) {}
+    explicit NodePtr(T* node) : node(node) {}
+
+    NodePtr(NodePtr&& other) noexcept : node(other.release()) {}
+    template<typename U, typename = std::enable_if_t<std::is_convertible_v<U*, T*>>>
+    NodePtr(NodePtr<U>&& other) noexcept : node(other.release()) {}
+
+    NodePtr& operator=(NodePtr&& other) noexcept {
+        node = other.release();
+        return *this;
+    }
+    NodePtr(const NodePtr&) = delete;
+    NodePtr& operator=(const NodePtr&) = delete;
+
+    T* get() const { return node; }
+    T* operator->() const { return node; }
+    T& operator*() const { return *node; }
+    explicit operator bool() const { return node != nullptr; }
+
+    T* release() {
+        T* released = node;
+        node = nullptr;
+        return released;
+    }
+
+    friend bool operator==(const NodePtr& pointer, std::nullptr_t) { return pointer.node == nullptr; }
+    friend bool operator!=(const NodePtr& pointer, std::nullptr_t) { return pointer.node != nullptr; }
+
+private:
+    T* node = nullptr;
+};
+
+// --- AstArena ---
+// Bump allocator لكل compilation unit: كل الـ nodes تُحجز في chunks كبيرة
+// متتالية، وتُحرر كلها مرة واحدة عند موت الـ arena.
+// الهدم بالجملة: معظم الـ nodes trivially destructible (NodePtr و Token و Value)
+// فلا يُستدعى لها شيء؛ فقط الـ nodes التي تملك vector تُسجَّل في قائمة وتُهدم
+// في حلقة واحدة مسطحة (stack ثابت مهما كان عمق الشجرة).
+// (أي NodePtr يبقى بعد الـ arena يصبح معلقاً، لكن تدميره نفسه لا يفعل شيئاً)
+class AstArena {
+public:
+    // PER_NODE_HEAP = الطريقة القديمة (new/delete لكل node كما كانت مع unique_ptr)،
+    // موجودة فقط كـ baseline لـ astarena و parsealloc في Benchmarks.h
+    enum class Strategy { BUMP, PER_NODE_HEAP };
+
+    explicit AstArena(Strategy strategy = Strategy::BUMP) : strategy(strategy) {}
+    AstArena(const AstArena&) = delete;
+    AstArena& operator=(const AstArena&) = delete;
+
+    ~AstArena() {
+        for (auto it = finalizers.rbegin(); it != finalizers.rend(); ++it) it->destroy(it->node);
+    }
+
+    template<typename T, typename... Args>
+    NodePtr<T> make(Args&&... args) {
+        nodes++;
+        if (strategy == Strategy::PER_NODE_HEAP) {
+            T* node = new (::operator new(sizeof(T))) T(std::forward<Args>(args)...);
+            finalizers.push_back({node, [](void* object) {
+                static_cast<T*>(object)->~T();
+                ::operator delete(object);
+            }});
+            return NodePtr<T>(node);
+        }
+        void* memory = allocate(sizeof(T), alignof(T));
+        T* node = new (memory) T(std::forward<Args>(args)...);
+        if constexpr (!std::is_trivially_destructible_v<T>) {
+            finalizers.push_back({node, [](void* object) { static_cast<T*>(object)->~T(); }});
+        }
+        return NodePtr<T>(node);
+    }
+
+    // ينقل ملكية chunks arena أخرى إلى هذه (الـ nodes لا تتحرك من مكانها).
+    // (الـ Parsing المتوازي: كل thread تبني في arena خاصة ثم تُدمج في arena الملف)
+    void adopt(AstArena& other) {
+        for (auto& chunk : other.chunks) chunks.push_back(std::move(chunk));
+        finalizers.insert(finalizers.end(), other.finalizers.begin(), other.finalizers.end());
+        other.finalizers.clear();
+        nodes += other.nodes;
+        reserved += other.reserved;
+        other.chunks.clear();
+        other.cursor = other.limit = nullptr;
+        other.nodes = other.reserved = 0;
+    }
+
+    size_t nodeCount() const { return nodes; }
+    size_t finalizerCount() const { return finalizers.size(); }
+    size_t chunkCount() const { return chunks.size(); }
+    size_t bytesReserved() const { return reserved; }
+
+private:
+    static constexpr size_t CHUNK_SIZE = 64 * 1024;
+
+    void* allocate(size_t size, size_t align) {
+        size_t padding = (align - reinterpret_cast<uintptr_t>(cursor) % align) % align;
+        if (cursor == nullptr || padding + size > static_cast<size_t>(limit - cursor)) {
+            size_t chunkSize = size + align > CHUNK_SIZE ? size + align : CHUNK_SIZE;
+            chunks.push_back(std::unique_ptr<char[]>(new char[chunkSize])); // (بدون تصفير)
+            reserved += chunkSize;
+            cursor = chunks.back().get();
+            limit = cursor + chunkSize;
+            padding = (align - reinterpret_cast<uintptr_t>(cursor) % align) % align;
+        }
+        char* result = cursor + padding;
+        cursor = result + size;
+        return result;
+    }
+
+    // (node يملك ذاكرة خارج الـ arena + الدالة التي تهدمه)
+    struct Finalizer {
+        void* node;
+        void (*destroy)(void*);
+    };
+
+    Strategy strategy;
+    std::vector<std::unique_ptr<char[]>> chunks;
+    std::vector<Finalizer> finalizers;
+    char* cursor = nullptr;
+    char* limit = nullptr;
+    size_t nodes = 0;
+    size_t reserved = 0;
+};
+
+#endif // DUELSCRIPT_ASTARENA_H
@@ -0,0 +1,424 @@
+#ifndef DUELSCRIPT_ASTCACHE_H
+#define DUELSCRIPT_ASTCACHE_H
+
+#include "FlatAst.h"
+#include "SourceBuffer.h"
+#include "TokenBuffer.h"
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <optional>
+#include <string>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+// --- AstCache ---
+// ملف ثنائي لكل source (الاسم = hash المحتوى): مصفوفات الـ TokenBuffer والـ FlatAst
+// كما هي في الذاكرة، فالتحميل = mmap + memcpy لكل مصفوفة بدلاً من Scanner + Parser.
+//
+// الملف لا يحتوي أي pointer ولا أي رقم خاص بالـ process:
+//   - الـ lexemes مجرد offsets داخل الـ source (الذي نقرأه أصلاً لحساب الـ hash)
+//   - الـ Symbols تُحفظ كأرقام محلية + جدول أسماء، وتُسجَّل من جديد عند التحميل
+// أي ملف تالف (checksum، أحجام، handles خارج الحدود أو غير شجرية) يُرفض كـ CORRUPT،
+// وأي ملف من نسخة/layout أخرى أو لـ source مختلف يُرفض كـ STALE؛ وفي الحالتين يعود
+// المستدعي إلى الـ Scanner والـ Parser ويكتب الملف من جديد.
+class AstCache {
+public:
+    static constexpr uint32_t FORMAT_VERSION = 1;
+
+    enum class Status { HIT, MISS, STALE, CORRUPT };
+
+    explicit AstCache(std::string directory) : directory(std::move(directory)) {}
+
+    static const char* statusName(Status status) {
+        switch (status) {
+            case Status::HIT: return "hit";
+            case Status::MISS: return "miss";
+            case Status::STALE: return "stale";
+            case Status::CORRUPT: return "corrupt";
+        }
+        return "?";
+    }
+
+    // 64-bit hash سريع (8 bytes في كل خطوة)؛ مفتاح الملف و checksum محتواه.
+    // (كل خطوة قابلة للعكس، لذلك تغيير أي 8 bytes يغيّر النتيجة دائماً)
+    static uint64_t hash(std::string_view data) {
+        const uint64_t K = 0x9E3779B97F4A7C15ull;
+        uint64_t h = data.size() * K;
+        size_t i = 0;
+        for (; i + 8 <= data.size(); i += 8) {
+            uint64_t word;
+            std::memcpy(&word, data.data() + i, 8);
+            h = (h ^ word) * K;
+            h ^= h >> 32;
+        }
+        uint64_t tail = 0;
+        if (i < data.size()) std::memcpy(&tail, data.data() + i, data.size() - i);
+        h = (h ^ tail) * K;
+        h ^= h >> 33;
+        h *= 0xff51afd7ed558ccdull;
+        h ^= h >> 33;
+        h *= 0xc4ceb9fe1a85ec53ull;
+        h ^= h >> 33;
+        return h;
+    }
+
+    std::string pathFor(uint64_t key) const {
+        char name[32];
+        std::snprintf(name, sizeof(name), "%016llx.dsast", static_cast<unsigned long long>(key));
+        return (std::filesystem::path(directory) / name).string();
+    }
+
+    // key = hash(source). عند HIT فقط: tokens تُملأ (views داخل source) و ast يشير إليها.
+    Status load(uint64_t key, std::string_view source, std::optional<TokenBuffer>& tokens,
+                flat::FlatAst& ast) const {
+        std::optional<SourceBuffer> file = SourceBuffer::fromFile(pathFor(key));
+        if (!file) return Status::MISS;
+        std::string_view bytes = file->text();
+
+        Header header;
+        if (bytes.size() < sizeof(Header)) return Status::CORRUPT;
+        std::memcpy(&header, bytes.data(), sizeof(Header));
+        if (header.magic != MAGIC) return Status::CORRUPT;
+
+        TokenBuffer restored(source);
+        NameTable names;
+        flat::FlatAst loaded;
+        if (header.version != FORMAT_VERSION || header.byteOrder != ENDIAN_MARK ||
+            header.layout != layoutOf(restored, names, loaded)) {
+            return Status::STALE;
+        }
+        if (header.sourceHash != key || header.sourceSize != source.size()) return Status::STALE;
+
+        std::string_view payload = bytes.substr(sizeof(Header));
+        if (payload.size() != header.payloadSize || hash(payload) != header.payloadHash) return Status::CORRUPT;
+        if (header.sectionCount != sectionCount(restored, names, loaded) ||
+            payload.size() < header.sectionCount * sizeof(Section)) {
+            return Status::CORRUPT;
+        }
+
+        // --- كل مصفوفة: memcpy من الـ mapping بعد التأكد من حدودها ---
+        bool ok = true;
+        size_t next = 0;
+        forEachSection(restored, names, loaded, [&](auto& array) {
+            using Element = typename std::decay_t<decltype(array)>::value_type;
+            Section section;
+            std::memcpy(&section, payload.data() + next++ * sizeof(Section), sizeof(Section));
+            if (!ok || section.offset > payload.size() ||
+                section.count > (payload.size() - section.offset) / sizeof(Element)) {
+                ok = false;
+                return;
+            }
+            array.resize(section.count);
+            // (مصفوفة فارغة: data() قد يكون nullptr، و memcpy لا يقبله حتى مع حجم 0)
+            if (section.count > 0) {
+                std::memcpy(array.data(), payload.data() + section.offset, section.count * sizeof(Element));
+            }
+        });
+        loaded.roots = {header.rootsFirst, header.rootsCount};
+        if (!ok || !validateTokens(restored, names, source.size()) ||
+            !Validator(loaded, static_cast<uint32_t>(restored.size())).run()) {
+            return Status::CORRUPT;
+        }
+
+        // --- الأرقام المحلية -> Symbols هذا الـ process (كل اسم يُسجَّل مرة واحدة) ---
+        std::vector<Symbol> symbols(names.offsets.size() - 1);
+        for (size_t i = 0; i < symbols.size(); ++i) {
+            symbols[i] = SymbolTable::global().intern(std::string_view(
+                    names.bytes.data() + names.offsets[i], names.offsets[i + 1] - names.offsets[i]));
+        }
+        restored.symbols.resize(names.symbols.size());
+        for (size_t i = 0; i < names.symbols.size(); ++i) restored.symbols[i] = symbols[names.symbols[i]];
+
+        tokens.emplace(std::move(restored));
+        ast = std::move(loaded);
+        ast.tokens = &*tokens;
+        return Status::HIT;
+    }
+
+    // يكتب الملف (إلى ملف مؤقت ثم rename، فلا يرى أحد ملفاً نصف مكتوب).
+    // يعيد عدد الـ bytes، أو 0 إذا فشلت الكتابة.
+    size_t store(uint64_t key, std::string_view source, const TokenBuffer& tokens, const flat::FlatAst& ast) const {
+        NameTable names = NameTable::build(tokens.symbols);
+        uint32_t sections = sectionCount(tokens, names, ast);
+
+        std::string payload(sections * sizeof(Section), '\0');
+        size_t next = 0;
+        forEachSection(tokens, names, ast, [&](const auto& array) {
+            using Element = typename std::decay_t<decltype(array)>::value_type;
+            payload.resize((payload.size() + 7) & ~size_t(7)); // (كل مصفوفة على حدود 8 bytes)
+            Section section{payload.size(), array.size()};
+            std::memcpy(&payload[next++ * sizeof(Section)], &section, sizeof(Section));
+            payload.append(reinterpret_cast<const char*>(array.data()), array.size() * sizeof(Element));
+        });
+
+        Header header{};
+        header.magic = MAGIC;
+        header.version = FORMAT_VERSION;
+        header.byteOrder = ENDIAN_MARK;
+        header.layout = layoutOf(tokens, names, ast);
+        header.sourceHash = key;
+        header.sourceSize = source.size();
+        header.payloadHash = hash(payload);
+        header.payloadSize = payload.size();
+        header.sectionCount = sections;
+        header.rootsFirst = ast.roots.first;
+        header.rootsCount = ast.roots.count;
+
+        std::error_code error;
+        std::filesystem::create_directories(directory, error);
+        std::string path = pathFor(key);
+        std::string temporary = path + ".tmp";
+        {
+            std::ofstream out(temporary, std::ios::binary | std::ios::trunc);
+            if (!out) return 0;
+            out.write(reinterpret_cast<const char*>(&header), sizeof(Header));
+            out.write(payload.data(), static_cast<std::streamsize>(payload.size()));
+            if (!out) return 0;
+        }
+        std::filesystem::rename(temporary, path, error);
+        return error ? 0 : sizeof(Header) + payload.size();
+    }
+
+    // يعيد حساب الـ checksum لملف معدَّل يدوياً (الـ benchmark يستعمله ليختبر أن
+    // الـ Validator وحده يرفض المحتوى التالف حتى لو كان الـ checksum صحيحاً)
+    static bool reseal(std::string& file) {
+        if (file.size() < sizeof(Header)) return false;
+        Header header;
+        std::memcpy(&header, file.data(), sizeof(Header));
+        header.payloadHash = hash(std::string_view(file).substr(sizeof(Header)));
+        std::memcpy(&file[0], &header, sizeof(Header));
+        return true;
+    }
+
+private:
+    static constexpr uint64_t MAGIC = 0x3145484341435344ull; // ("DSCACHE1" كـ bytes)
+    static constexpr uint32_t ENDIAN_MARK = 0x01020304;
+
+    struct Header {
+        uint64_t magic;
+        uint32_t version;
+        uint32_t byteOrder;
+        uint64_t layout;      // (أحجام عناصر كل المصفوفات: أي تغيير في الـ structs = STALE)
+        uint64_t sourceHash;
+        uint64_t sourceSize;
+        uint64_t payloadHash; // (checksum كل ما بعد الـ header)
+        uint64_t payloadSize;
+        uint32_t sectionCount;
+        uint32_t rootsFirst;
+        uint32_t rootsCount;
+        uint32_t reserved;
+    };
+
+    // (مكان كل مصفوفة داخل الـ payload؛ الجدول في أول الـ payload)
+    struct Section {
+        uint64_t offset;
+        uint64_t count;
+    };
+
+    // أسماء الـ Symbols المستخدمة في الملف: symbols[token] = رقم محلي داخل الجدول
+    struct NameTable {
+        std::vector<uint32_t> symbols;
+        std::vector<uint32_t> offsets; // (الاسم i = bytes[offsets[i], offsets[i + 1]))
+        std::vector<char> bytes;
+
+        static NameTable build(const std::vector<Symbol>& tokenSymbols) {
+            NameTable table;
+            std::unordered_map<Symbol, uint32_t> local;
+            table.offsets.push_back(0);
+            table.symbols.reserve(tokenSymbols.size());
+            for (Symbol symbol : tokenSymbols) {
+                auto [found, added] = local.emplace(symbol, static_cast<uint32_t>(local.size()));
+                if (added) {
+                    std::string_view name = SymbolTable::global().name(symbol);
+                    table.bytes.insert(table.bytes.end(), name.begin(), name.end());
+                    table.offsets.push_back(static_cast<uint32_t>(table.bytes.size()));
+                }
+                table.symbols.push_back(found->second);
+            }
+            return table;
+        }
+    };
+
+    // (نفس الترتيب للكتابة والقراءة والـ layout)
+    template<typename Tokens, typename Names, typename Ast, typename F>
+    static void forEachSection(Tokens& tokens, Names& names, Ast& ast, F&& f) {
+        f(tokens.types);
+        f(tokens.offsets);
+        f(tokens.lengths);
+        f(tokens.newlines);
+        f(names.symbols);
+        f(names.offsets);
+        f(names.bytes);
+        ast.forEachArray(f);
+    }
+
+    template<typename Tokens, typename Names, typename Ast>
+    static uint32_t sectionCount(Tokens& tokens, Names& names, Ast& ast) {
+        uint32_t count = 0;
+        forEachSection(tokens, names, ast, [&](const auto&) { count++; });
+        return count;
+    }
+
+    template<typename Tokens, typename Names, typename Ast>
+    static uint64_t layoutOf(Tokens& tokens, Names& names, Ast& ast) {
+        std::string sizes;
+        forEachSection(tokens, names, ast, [&](const auto& array) {
+            sizes += static_cast<char>(sizeof(typename std::decay_t<decltype(array)>::value_type));
+        });
+        return hash(sizes);
+    }
+
+    static bool validateTokens(const TokenBuffer& tokens, const NameTable& names, size_t sourceSize) {
+        size_t count = tokens.types.size();
+        if (count == 0 || tokens.offsets.size() != count || tokens.lengths.size() != count ||
+            names.symbols.size() != count || names.offsets.empty() || names.offsets[0] != 0 ||
+            names.offsets.back() != names.bytes.size() ||
+            tokens.type(count - 1) != TokenType::TOKEN_EOF) {
+            return false;
+        }
+        for (size_t i = 0; i < count; ++i) {
+            if (tokens.types[i] > static_cast<uint8_t>(TokenType::TOKEN_EOF) ||
+                uint64_t(tokens.offsets[i]) + tokens.lengths[i] > sourceSize ||
+                (i > 0 && tokens.offsets[i] < tokens.offsets[i - 1]) ||
+                names.symbols[i] >= names.offsets.size() - 1) {
+                return false;
+            }
+        }
+        for (size_t i = 1; i < names.offsets.size(); ++i) {
+            if (names.offsets[i] < names.offsets[i - 1]) return false;
+        }
+        for (uint32_t newline : tokens.newlines) {
+            if (newline >= sourceSize) return false;
+        }
+        return true;
+    }
+
+    // --- Validator ---
+    // كل handle داخل حدود مصفوفته ومن النوع الذي يتوقعه الـ Expander، وكل node
+    // يُشار إليه مرة واحدة على الأكثر (فالبنية من الـ roots شجرة، بدون دوائر).
+    class Validator {
+    public:
+        Validator(const flat::FlatAst& ast, uint32_t tokenCount) : ast(ast), tokenCount(tokenCount) {
+            exprSeen[size_t(flat::ExprKind::Binary)].resize(ast.binaries.size());
+            exprSeen[size_t(flat::ExprKind::Grouping)].resize(ast.groupings.size());
+            exprSeen[size_t(flat::ExprKind::Literal)].resize(ast.literals.size());
+            exprSeen[size_t(flat::ExprKind::Unary)].resize(ast.unaries.size());
+            exprSeen[size_t(flat::ExprKind::Variable)].resize(ast.variables.size());
+            exprSeen[size_t(flat::ExprKind::Assign)].resize(ast.assigns.size());
+            exprSeen[size_t(flat::ExprKind::Call)].resize(ast.calls.size());
+            exprSeen[size_t(flat::ExprKind::Get)].resize(ast.gets.size());
+            exprSeen[size_t(flat::ExprKind::Set)].resize(ast.sets.size());
+            stmtSeen[size_t(flat::StmtKind::Expression)].resize(ast.expressions.size());
+            stmtSeen[size_t(flat::StmtKind::Summon)].resize(ast.summons.size());
+            stmtSeen[size_t(flat::StmtKind::Draw)].resize(ast.draws.size());
+            stmtSeen[size_t(flat::StmtKind::VarDecl)].resize(ast.varDecls.size());
+            stmtSeen[size_t(flat::StmtKind::Block)].resize(ast.blocks.size());
+            stmtSeen[size_t(flat::StmtKind::If)].resize(ast.ifs.size());
+            stmtSeen[size_t(flat::StmtKind::While)].resize(ast.whiles.size());
+            stmtSeen[size_t(flat::StmtKind::Function)].resize(ast.functions.size());
+            stmtSeen[size_t(flat::StmtKind::Return)].resize(ast.returns.size());
+            stmtSeen[size_t(flat::StmtKind::Class)].resize(ast.classes.size());
+            stmtSeen[size_t(flat::StmtKind::Struct)].resize(ast.structs.size());
+            stmtSeen[size_t(flat::StmtKind::Include)].resize(ast.includes.size());
+            stmtSeen[size_t(flat::StmtKind::Using)].resize(ast.usings.size());
+        }
+
+        bool run() {
+            using flat::StmtKind;
+            bool ok = stmtRange(ast.roots);
+            for (const auto& n : ast.binaries) ok = ok && expr(n.left) && token(n.op) && expr(n.right);
+            for (const auto& n : ast.groupings) ok = ok && expr(n.expression);
+            for (const auto& n : ast.literals) ok = ok && token(n.token);
+            for (const auto& n : ast.unaries) ok = ok && token(n.op) && expr(n.right);
+            for (const auto& n : ast.variables) ok = ok && token(n.name);
+            for (const auto& n : ast.assigns) ok = ok && token(n.name) && expr(n.value);
+            for (const auto& n : ast.calls) ok = ok && expr(n.callee) && token(n.paren) && exprRange(n.arguments);
+            for (const auto& n : ast.gets) ok = ok && expr(n.object) && token(n.name);
+            for (const auto& n : ast.sets) ok = ok && expr(n.object) && token(n.name) && expr(n.value);
+
+            for (const auto& n : ast.expressions) ok = ok && expr(n.expression);
+            for (const auto& n : ast.summons) ok = ok && expr(n.expression);
+            for (const auto& n : ast.draws) ok = ok && token(n.name);
+            for (const auto& n : ast.varDecls) ok = ok && token(n.type) && token(n.name) && expr(n.initializer, true);
+            for (const auto& n : ast.blocks) ok = ok && stmtRange(n.statements);
+            for (const auto& n : ast.ifs) {
+                ok = ok && expr(n.condition) && stmt(n.thenBranch) && stmt(n.elseBranch, true);
+            }
+            for (const auto& n : ast.whiles) ok = ok && expr(n.condition) && stmt(n.body);
+            for (const auto& n : ast.functions) {
+                ok = ok && token(n.name) && paramRange(n.params) && stmt(n.body, false, StmtKind::Block);
+            }
+            for (const auto& n : ast.returns) ok = ok && token(n.keyword) && expr(n.value, true);
+            for (const auto& n : ast.classes) {
+                ok = ok && token(n.name) && stmtRange(n.fields, StmtKind::VarDecl) &&
+                     stmtRange(n.methods, StmtKind::Function);
+            }
+            for (const auto& n : ast.structs) ok = ok && token(n.name) && stmtRange(n.fields, StmtKind::VarDecl);
+            for (const auto& n : ast.includes) ok = ok && token(n.path);
+            for (const auto& n : ast.usings) ok = ok && token(n.keyword) && token(n.name);
+            return ok;
+        }
+
+    private:
+        static constexpr size_t EXPR_KINDS = size_t(flat::ExprKind::Set) + 1;
+        static constexpr size_t STMT_KINDS = size_t(flat::StmtKind::Using) + 1;
+
+        const flat::FlatAst& ast;
+        uint32_t tokenCount;
+        std::vector<uint8_t> exprSeen[EXPR_KINDS];
+        std::vector<uint8_t> stmtSeen[STMT_KINDS];
+
+        bool token(flat::TokenRef ref) const { return ref == flat::NO_TOKEN || ref < tokenCount; }
+
+        static bool claim(std::vector<uint8_t>& seen, uint32_t index) {
+            if (index >= seen.size() || seen[index]) return false;
+            seen[index] = 1;
+            return true;
+        }
+
+        bool expr(flat::ExprRef ref, bool optional = false) {
+            if (!ref.valid()) return optional;
+            size_t kind = size_t(ref.kind());
+            return kind < EXPR_KINDS && claim(exprSeen[kind], ref.index());
+        }
+
+        bool stmt(flat::StmtRef ref, bool optional = false, std::optional<flat::StmtKind> only = std::nullopt) {
+            if (!ref.valid()) return optional;
+            size_t kind = size_t(ref.kind());
+            if (only && ref.kind() != *only) return false;
+            return kind < STMT_KINDS && claim(stmtSeen[kind], ref.index());
+        }
+
+        bool exprRange(flat::Range range) {
+            if (uint64_t(range.first) + range.count > ast.exprLists.size()) return false;
+            for (uint32_t i = 0; i < range.count; ++i) {
+                if (!expr(ast.exprLists[range.first + i])) return false;
+            }
+            return true;
+        }
+
+        bool stmtRange(flat::Range range, std::optional<flat::StmtKind> only = std::nullopt) {
+            if (uint64_t(range.first) + range.count > ast.stmtLists.size()) return false;
+            for (uint32_t i = 0; i < range.count; ++i) {
+                if (!stmt(ast.stmtLists[range.first + i], false, only)) return false;
+            }
+            return true;
+        }
+
+        bool paramRange(flat::Range range) const {
+            if (uint64_t(range.first) + range.count > ast.params.size()) return false;
+            for (uint32_t i = 0; i < range.count; ++i) {
+                const flat::Parameter& param = ast.params[range.first + i];
+                if (!token(param.type) || !token(param.name)) return false;
+            }
+            return true;
+        }
+    };
+
+    std::string directory;
+};
+
+#endif // DUELSCRIPT_ASTCACHE_H
@@ -2,9 +2,11 @@
 #define DUELSCRIPT_ASTNODES_H
 
 #include "DuelScriptScanner.h"
+#include "AstArena.h"
+#include "Value.h"
 #include <memory>
+#include <type_traits>
 #include <vector>
-#include <any>
 
 // --- Forward Declarations ---
 struct BinaryExpr;
@@ -17,9 +19,58 @@ struct CallExpr;
 struct GetExpr;
 struct SetExpr;
 
+// --- Node kinds ---
+// كل node يحمل نوعه كرقم، لذلك يمكن الـ dispatch بـ switch بدون أي virtual call
+// (انظر StaticVisitor في الأسفل). نفس الترتيب يستخدمه الـ FlatAst في الـ handles.
+enum class ExprKind : uint8_t { Binary, Grouping, Literal, Unary, Variable, Assign, Call, Get, Set };
+
+enum class StmtKind : uint8_t {
+    Expression, Summon, Draw, VarDecl, Block, If, While, Function, Return, Class, Struct, Include, Using,
+};
+
+// --- StaticType ---
+// نوع قيمة التعبير كما يثبته الـ TypeChecker (انظر TypeChecker.h): كل تنفيذ يعطي هذا النوع بالضبط،
+// فالـ VM يستطيع استخدام عمليات INT / DOUBLE / BOOL بدون فحص النوع وقت التنفيذ.
+// (UNKNOWN = لم يُفحص، أو Ritual لا يعود أبداً؛ NIL = Ritual بدون Tribute بقيمة)
+enum class StaticType : uint8_t { UNKNOWN, NIL, INT, DOUBLE, BOOL, STRING, OBJECT };
+
+// --- ExprDispatcher ---
+// الـ accept الـ virtual في Expr لا يعرف نوع النتيجة، لذلك يمر عبر هذه الواجهة (void)
+// والـ ExprVisitor<R> يحفظ النتيجة في مكانها الحقيقي بدون std::any.
+class ExprDispatcher {
+public:
+    virtual void dispatch(const BinaryExpr& expr) = 0;
+    virtual void dispatch(const GroupingExpr& expr) = 0;
+    virtual void dispatch(const LiteralExpr& expr) = 0;
+    virtual void dispatch(const UnaryExpr& expr) = 0;
+    virtual void dispatch(const VariableExpr& expr) = 0;
+    virtual void dispatch(const AssignExpr& expr) = 0;
+    virtual void dispatch(const CallExpr& expr) = 0;
+    virtual void dispatch(const GetExpr& expr) = 0;
+    virtual void dispatch(const SetExpr& expr) = 0;
+    virtual ~ExprDispatcher() = default;
+};
+
+// --- Base Expr ---
+// (بدون virtual destructor: الـ nodes لا تُحذف أبداً عبر pointer للـ base،
+// الـ AstArena تهدم كل node بنوعه الحقيقي، والمعظم لا يحتاج هدماً أصلاً)
+class Expr {
+public:
+    explicit Expr(ExprKind kind) : kind(kind) {}
+    virtual void accept(ExprDispatcher& dispatcher) const = 0;
+
+    const ExprKind kind;
+    mutable StaticType type = StaticType::UNKNOWN; // (يكتبه الـ TypeChecker، في الـ padding بعد kind)
+
+protected:
+    ~Expr() = default;
+};
+
 // --- ExprVisitor ---
+// R = نوع النتيجة الحقيقي (std::string للطباعة، Value للتنفيذ، ...).
+// الاستدعاء: visit(expr) بدلاً من expr.accept(visitor).
 template<typename R>
-class ExprVisitor {
+class ExprVisitor : public ExprDispatcher {
 public:
     virtual R visitBinaryExpr(const BinaryExpr& expr) = 0;
     virtual R visitGroupingExpr(const GroupingExpr& expr) = 0;
@@ -30,14 +81,25 @@ public:
     virtual R visitCallExpr(const CallExpr& expr) = 0;
     virtual R visitGetExpr(const GetExpr& expr) = 0;
     virtual R visitSetExpr(const SetExpr& expr) = 0;
-    virtual ~ExprVisitor() = default;
-};
 
-// --- Base Expr ---
-class Expr {
-public:
-    virtual ~Expr() = default;
-    virtual std::any accept(ExprVisitor<std::any>& visitor) const = 0;
+    R visit(const Expr& expr) {
+        expr.accept(*this);
+        return std::move(result);
+    }
+
+private:
+    void dispatch(const BinaryExpr& expr) final { result = visitBinaryExpr(expr); }
+    void dispatch(const GroupingExpr& expr) final { result = visitGroupingExpr(expr); }
+    void dispatch(const LiteralExpr& expr) final { result = visitLiteralExpr(expr); }
+    void dispatch(const UnaryExpr& expr) final { result = visitUnaryExpr(expr); }
+    void dispatch(const VariableExpr& expr) final { result = visitVariableExpr(expr); }
+    void dispatch(const AssignExpr& expr) final { result = visitAssignExpr(expr); }
+    void dispatch(const CallExpr& expr) final { result = visitCallExpr(expr); }
+    void dispatch(const GetExpr& expr) final { result = visitGetExpr(expr); }
+    void dispatch(const SetExpr& expr) final { result = visitSetExpr(expr); }
+
+    // (يُقرأ مباشرة بعد accept، لذلك الـ visits المتداخلة لا تتعارض)
+    R result{};
 };
 
 // --- Forward Declarations (Stmts) ---
@@ -78,156 +140,207 @@ public:
 // --- Base Stmt ---
 class Stmt {
 public:
-    virtual ~Stmt() = default;
+    explicit Stmt(StmtKind kind) : kind(kind) {}
     virtual void accept(StmtVisitor<void>& visitor) const = 0;
+
+    const StmtKind kind;
+
+protected:
+    ~Stmt() = default;
+};
+
+// --- نتائج الـ Resolver ---
+// الـ Resolver يكتبها مرة واحدة بعد الـ parsing (لذلك mutable: الـ visitors يرون nodes ثابتة)،
+// والـ Interpreter يقرأها بدلاً من البحث بالأسماء وقت التنفيذ.
+
+// مكان متغير: depth = كم مستوى نخرج من الـ Ritual الحالي، slot = الـ index داخل ذلك المستوى
+// (toDouble = المتغير BlueEyesWhiteDragon: الـ DarkMagician يتحول إلى double عند تخزينه فيه)
+struct VarSlot {
+    static constexpr uint16_t LOCAL = 0;  // frame الـ Ritual الحالي (البارامترات أولاً)
+    static constexpr uint16_t FIELD = 1;  // حقول الـ object الحالي (داخل method)
+    static constexpr uint16_t GLOBAL = 2; // المتغيرات العليا
+    static constexpr uint16_t UNRESOLVED = UINT16_MAX;
+
+    uint16_t depth = UNRESOLVED;
+    bool toDouble = false; // (في الـ padding قبل slot)
+    uint32_t slot = 0;
+};
+
+// حقل أو method معروف مسبقاً: صالح فقط إذا كان الـ object فعلاً من نوع layout
+// (وإلا يبحث الـ Interpreter بالاسم، مثل inline cache لا يفشل أبداً)
+struct MemberSlot {
+    static constexpr uint32_t NONE = UINT32_MAX;
+
+    uint32_t layout = NONE;
+    uint32_t index = 0;
+};
+
+// هدف الـ CallExpr
+struct CallTarget {
+    enum Kind : uint8_t {
+        UNRESOLVED,
+        FUNCTION,    // Ritual عام: index = رقمه في الـ program
+        SELF_METHOD, // method من نفس الـ LordOfD بدون "obj.": index = رقمه في الـ program
+        METHOD,      // obj.Method(...): member في الـ GetExpr
+    };
+
+    Kind kind = UNRESOLVED;
+    uint32_t index = 0;
 };
 
 // --- Expression Node Definitions ---
 
 struct BinaryExpr : public Expr {
-    BinaryExpr(std::unique_ptr<Expr> left, Token op, std::unique_ptr<Expr> right)
-            : left(std::move(left)), op(op), right(std::move(right)) {}
+    BinaryExpr(NodePtr<Expr> left, Token op, NodePtr<Expr> right)
+            : Expr(ExprKind::Binary), left(std::move(left)), op(op), right(std::move(right)) {}
 
-    std::any accept(ExprVisitor<std::any>& visitor) const override {
-        return visitor.visitBinaryExpr(*this);
+    void accept(ExprDispatcher& dispatcher) const override {
+        dispatcher.dispatch(*this);
     }
 
-    std::unique_ptr<Expr> left;
+    NodePtr<Expr> left;
     Token op;
-    std::unique_ptr<Expr> right;
+    NodePtr<Expr> right;
 };
 
 struct GroupingExpr : public Expr {
-    GroupingExpr(std::unique_ptr<Expr> expression)
-            : expression(std::move(expression)) {}
+    GroupingExpr(NodePtr<Expr> expression)
+            : Expr(ExprKind::Grouping), expression(std::move(expression)) {}
 
-    std::any accept(ExprVisitor<std::any>& visitor) const override {
-        return visitor.visitGroupingExpr(*this);
+    void accept(ExprDispatcher& dispatcher) const override {
+        dispatcher.dispatch(*this);
     }
 
-    std::unique_ptr<Expr> expression;
+    NodePtr<Expr> expression;
 };
 
 struct LiteralExpr : public Expr {
-    LiteralExpr(std::any value) : value(std::move(value)) {}
+    LiteralExpr(Value value, Token token = Token()) : Expr(ExprKind::Literal), value(value), token(token) {}
 
-    std::any accept(ExprVisitor<std::any>& visitor) const override {
-        return visitor.visitLiteralExpr(*this);
+    void accept(ExprDispatcher& dispatcher) const override {
+        dispatcher.dispatch(*this);
     }
 
-    std::any value;
+    Value value;
+    Token token; // (الـ Token الذي جاءت منه القيمة)
 };
 
 struct UnaryExpr : public Expr {
-    UnaryExpr(Token op, std::unique_ptr<Expr> right)
-            : op(op), right(std::move(right)) {}
+    UnaryExpr(Token op, NodePtr<Expr> right)
+            : Expr(ExprKind::Unary), op(op), right(std::move(right)) {}
 
-    std::any accept(ExprVisitor<std::any>& visitor) const override {
-        return visitor.visitUnaryExpr(*this);
+    void accept(ExprDispatcher& dispatcher) const override {
+        dispatcher.dispatch(*this);
     }
 
     Token op;
-    std::unique_ptr<Expr> right;
+    NodePtr<Expr> right;
 };
 
 struct VariableExpr : public Expr {
-    VariableExpr(Token name) : name(name) {}
+    VariableExpr(Token name) : Expr(ExprKind::Variable), name(name) {}
 
-    std::any accept(ExprVisitor<std::any>& visitor) const override {
-        return visitor.visitVariableExpr(*this);
+    void accept(ExprDispatcher& dispatcher) const override {
+        dispatcher.dispatch(*this);
     }
 
     Token name;
+    mutable VarSlot slot;
 };
 
 struct AssignExpr : public Expr {
-    AssignExpr(Token name, std::unique_ptr<Expr> value)
-            : name(name), value(std::move(value)) {}
+    AssignExpr(Token name, NodePtr<Expr> value)
+            : Expr(ExprKind::Assign), name(name), value(std::move(value)) {}
 
-    std::any accept(ExprVisitor<std::any>& visitor) const override {
-        return visitor.visitAssignExpr(*this);
+    void accept(ExprDispatcher& dispatcher) const override {
+        dispatcher.dispatch(*this);
     }
 
     Token name;
-    std::unique_ptr<Expr> value;
+    NodePtr<Expr> value;
+    mutable VarSlot slot;
 };
 
 struct CallExpr : public Expr {
-    CallExpr(std::unique_ptr<Expr> callee, Token paren, std::vector<std::unique_ptr<Expr>> arguments)
-            : callee(std::move(callee)), paren(paren), arguments(std::move(arguments)) {}
+    CallExpr(NodePtr<Expr> callee, Token paren, std::vector<NodePtr<Expr>> arguments)
+            : Expr(ExprKind::Call), callee(std::move(callee)), paren(paren), arguments(std::move(arguments)) {}
 
-    std::any accept(ExprVisitor<std::any>& visitor) const override {
-        return visitor.visitCallExpr(*this);
+    void accept(ExprDispatcher& dispatcher) const override {
+        dispatcher.dispatch(*this);
     }
 
-    std::unique_ptr<Expr> callee;
+    NodePtr<Expr> callee;
     Token paren;
-    std::vector<std::unique_ptr<Expr>> arguments;
+    std::vector<NodePtr<Expr>> arguments;
+    mutable CallTarget target;
 };
 
 struct GetExpr : public Expr {
-    GetExpr(std::unique_ptr<Expr> object, Token name)
-            : object(std::move(object)), name(name) {}
+    GetExpr(NodePtr<Expr> object, Token name)
+            : Expr(ExprKind::Get), object(std::move(object)), name(name) {}
 
-    std::any accept(ExprVisitor<std::any>& visitor) const override {
-        return visitor.visitGetExpr(*this);
+    void accept(ExprDispatcher& dispatcher) const override {
+        dispatcher.dispatch(*this);
     }
 
-    std::unique_ptr<Expr> object;
+    NodePtr<Expr> object;
     Token name;
+    mutable MemberSlot member;
 };
 
 struct SetExpr : public Expr {
-    SetExpr(std::unique_ptr<Expr> object, Token name, std::unique_ptr<Expr> value)
-            : object(std::move(object)), name(name), value(std::move(value)) {}
+    SetExpr(NodePtr<Expr> object, Token name, NodePtr<Expr> value)
+            : Expr(ExprKind::Set), object(std::move(object)), name(name), value(std::move(value)) {}
 
-    std::any accept(ExprVisitor<std::any>& visitor) const override {
-        return visitor.visitSetExpr(*this);
+    void accept(ExprDispatcher& dispatcher) const override {
+        dispatcher.dispatch(*this);
     }
 
-    std::unique_ptr<Expr> object;
+    NodePtr<Expr> object;
     Token name;
-    std::unique_ptr<Expr> value;
+    NodePtr<Expr> value;
+    mutable MemberSlot member;
 };
 
 
 // --- Statement Node Definitions ---
 
 struct ExpressionStmt : public Stmt {
-    ExpressionStmt(std::unique_ptr<Expr> expression)
-            : expression(std::move(expression)) {}
+    ExpressionStmt(NodePtr<Expr> expression)
+            : Stmt(StmtKind::Expression), expression(std::move(expression)) {}
 
     void accept(StmtVisitor<void>& visitor) const override {
         visitor.visitExpressionStmt(*this);
     }
 
-    std::unique_ptr<Expr> expression;
+    NodePtr<Expr> expression;
 };
 
 struct SummonStmt : public Stmt {
-    SummonStmt(std::unique_ptr<Expr> expression)
-            : expression(std::move(expression)) {}
+    SummonStmt(NodePtr<Expr> expression)
+            : Stmt(StmtKind::Summon), expression(std::move(expression)) {}
 
     void accept(StmtVisitor<void>& visitor) const override {
         visitor.visitSummonStmt(*this);
     }
 
-    std::unique_ptr<Expr> expression;
+    NodePtr<Expr> expression;
 };
 
 struct DrawStmt : public Stmt {
-    DrawStmt(Token name) : name(name) {}
+    DrawStmt(Token name) : Stmt(StmtKind::Draw), name(name) {}
 
     void accept(StmtVisitor<void>& visitor) const override {
         visitor.visitDrawStmt(*this);
     }
 
     Token name;
+    mutable VarSlot slot;
 };
 
 struct VarDeclStmt : public Stmt {
-    VarDeclStmt(Token type, Token name, std::unique_ptr<Expr> initializer)
-            : type(type), name(name), initializer(std::move(initializer)) {}
+    VarDeclStmt(Token type, Token name, NodePtr<Expr> initializer)
+            : Stmt(StmtKind::VarDecl), type(type), name(name), initializer(std::move(initializer)) {}
 
     void accept(StmtVisitor<void>& visitor) const override {
         visitor.visitVarDeclStmt(*this);
@@ -235,43 +348,45 @@ struct VarDeclStmt : public Stmt {
 
     Token type;
     Token name;
-    std::unique_ptr<Expr> initializer;
+    NodePtr<Expr> initializer;
+    mutable VarSlot slot;
+    mutable uint32_t layout = MemberSlot::NONE; // (نوع LordOfD / ToonWorld: يُنشأ object جديد)
 };
 
 struct BlockStmt : public Stmt {
-    BlockStmt(std::vector<std::unique_ptr<Stmt>> statements)
-            : statements(std::move(statements)) {}
+    BlockStmt(std::vector<NodePtr<Stmt>> statements)
+            : Stmt(StmtKind::Block), statements(std::move(statements)) {}
 
     void accept(StmtVisitor<void>& visitor) const override {
         visitor.visitBlockStmt(*this);
     }
 
-    std::vector<std::unique_ptr<Stmt>> statements;
+    std::vector<NodePtr<Stmt>> statements;
 };
 
 struct IfStmt : public Stmt {
-    IfStmt(std::unique_ptr<Expr> condition, std::unique_ptr<Stmt> thenBranch, std::unique_ptr<Stmt> elseBranch)
-            : condition(std::move(condition)), thenBranch(std::move(thenBranch)), elseBranch(std::move(elseBranch)) {}
+    IfStmt(NodePtr<Expr> condition, NodePtr<Stmt> thenBranch, NodePtr<Stmt> elseBranch)
+            : Stmt(StmtKind::If), condition(std::move(condition)), thenBranch(std::move(thenBranch)), elseBranch(std::move(elseBranch)) {}
 
     void accept(StmtVisitor<void>& visitor) const override {
         visitor.visitIfStmt(*this);
     }
 
-    std::unique_ptr<Expr> condition;
-    std::unique_ptr<Stmt> thenBranch;
-    std::unique_ptr<Stmt> elseBranch;
+    NodePtr<Expr> condition;
+    NodePtr<Stmt> thenBranch;
+    NodePtr<Stmt> elseBranch;
 };
 
 struct WhileStmt : public Stmt {
-    WhileStmt(std::unique_ptr<Expr> condition, std::unique_ptr<Stmt> body)
-            : condition(std::move(condition)), body(std::move(body)) {}
+    WhileStmt(NodePtr<Expr> condition, NodePtr<Stmt> body)
+            : Stmt(StmtKind::While), condition(std::move(condition)), body(std::move(body)) {}
 
     void accept(StmtVisitor<void>& visitor) const override {
         visitor.visitWhileStmt(*this);
     }
 
-    std::unique_ptr<Expr> condition;
-    std::unique_ptr<Stmt> body;
+    NodePtr<Expr> condition;
+    NodePtr<Stmt> body;
 };
 
 // --- بنية البارامتر (جديدة) ---
@@ -281,8 +396,8 @@ struct FunctionParameter {
 };
 
 struct FunctionStmt : public Stmt {
-    FunctionStmt(Token name, std::vector<FunctionParameter> params, std::unique_ptr<BlockStmt> body)
-            : name(name), params(std::move(params)), body(std::move(body)) {}
+    FunctionStmt(Token name, std::vector<FunctionParameter> params, NodePtr<BlockStmt> body)
+            : Stmt(StmtKind::Function), name(name), params(std::move(params)), body(std::move(body)) {}
 
     void accept(StmtVisitor<void>& visitor) const override {
         visitor.visitFunctionStmt(*this);
@@ -290,51 +405,51 @@ struct FunctionStmt : public Stmt {
 
     Token name;
     std::vector<FunctionParameter> params;
-    std::unique_ptr<BlockStmt> body;
+    NodePtr<BlockStmt> body;
 };
 
 struct ReturnStmt : public Stmt {
-    ReturnStmt(Token keyword, std::unique_ptr<Expr> value)
-            : keyword(keyword), value(std::move(value)) {}
+    ReturnStmt(Token keyword, NodePtr<Expr> value)
+            : Stmt(StmtKind::Return), keyword(keyword), value(std::move(value)) {}
 
     void accept(StmtVisitor<void>& visitor) const override {
         visitor.visitReturnStmt(*this);
     }
 
     Token keyword;
-    std::unique_ptr<Expr> value;
+    NodePtr<Expr> value;
 };
 
 struct ClassStmt : public Stmt {
     // الكلاس يحتوي على حقول ودوال
     ClassStmt(Token name,
-              std::vector<std::unique_ptr<VarDeclStmt>> fields,
-              std::vector<std::unique_ptr<FunctionStmt>> methods)
-            : name(name), fields(std::move(fields)), methods(std::move(methods)) {}
+              std::vector<NodePtr<VarDeclStmt>> fields,
+              std::vector<NodePtr<FunctionStmt>> methods)
+            : Stmt(StmtKind::Class), name(name), fields(std::move(fields)), methods(std::move(methods)) {}
 
     void accept(StmtVisitor<void>& visitor) const override {
         visitor.visitClassStmt(*this);
     }
 
     Token name;
-    std::vector<std::unique_ptr<VarDeclStmt>> fields;
-    std::vector<std::unique_ptr<FunctionStmt>> methods;
+    std::vector<NodePtr<VarDeclStmt>> fields;
+    std::vector<NodePtr<FunctionStmt>> methods;
 };
 
 struct StructStmt : public Stmt {
-    StructStmt(Token name, std::vector<std::unique_ptr<VarDeclStmt>> fields)
-            : name(name), fields(std::move(fields)) {}
+    StructStmt(Token name, std::vector<NodePtr<VarDeclStmt>> fields)
+            : Stmt(StmtKind::Struct), name(name), fields(std::move(fields)) {}
 
     void accept(StmtVisitor<void>& visitor) const override {
         visitor.visitStructStmt(*this);
     }
 
     Token name;
-    std::vector<std::unique_ptr<VarDeclStmt>> fields;
+    std::vector<NodePtr<VarDeclStmt>> fields;
 };
 
 struct IncludeStmt : public Stmt {
-    IncludeStmt(Token path) : path(path) {}
+    IncludeStmt(Token path) : Stmt(StmtKind::Include), path(path) {}
 
     void accept(StmtVisitor<void>& visitor) const override {
         visitor.visitIncludeStmt(*this);
@@ -345,7 +460,7 @@ struct IncludeStmt : public Stmt {
 
 // "using Kaiba Joey;"
 struct UsingStmt : public Stmt {
-    UsingStmt(Token keyword, Token name) : keyword(keyword), name(name) {}
+    UsingStmt(Token keyword, Token name) : Stmt(StmtKind::Using), keyword(keyword), name(name) {}
 
     void accept(StmtVisitor<void>& visitor) const override {
         visitor.visitUsingStmt(*this);
@@ -355,6 +470,67 @@ struct UsingStmt : public Stmt {
     Token name;    // Joey
 };
 
+// قيمة الـ Token الثابت كما يضعها الـ Parser في LiteralExpr (NUMBER / STRING / true / false)
+// (الـ Scanner سجّل نص الـ STRING كما هو، بين علامتي التنصيص، في الـ SymbolTable)
+inline Value literalValue(const Token& token) {
+    switch (token.type) {
+        case TokenType::KEYWORD_TRUE: return Value::boolean(true);
+        case TokenType::KEYWORD_FALSE: return Value::boolean(false);
+        case TokenType::NUMBER: return numberValue(token.lexeme);
+        case TokenType::STRING: return Value::interned(token.symbol);
+        default: return Value();
+    }
+}
+
+// (سلاسل الـ operators والـ blocks المتداخلة لا تحتاج أي destructor عند الهدم)
+static_assert(std::is_trivially_destructible_v<BinaryExpr> && std::is_trivially_destructible_v<UnaryExpr> &&
+              std::is_trivially_destructible_v<GroupingExpr> && std::is_trivially_destructible_v<LiteralExpr> &&
+              std::is_trivially_destructible_v<IfStmt> && std::is_trivially_destructible_v<WhileStmt>,
+              "leaf and chain nodes must stay trivially destructible (see AstArena)");
+
+// --- StaticVisitor (CRTP) ---
+// بديل للـ visitors الـ virtual: switch على الـ kind ثم استدعاء مباشر لدالة الـ
+// Derived (بدون virtual calls، والـ compiler يستطيع عمل inline).
+// الـ Derived يعرّف نفس دوال visitXxx (بدون override) ويستدعي visit(node) للأبناء.
+template<typename Derived, typename ExprR, typename StmtR = void>
+class StaticVisitor {
+public:
+    ExprR visit(const Expr& expr) {
+        Derived& self = static_cast<Derived&>(*this);
+        switch (expr.kind) {
+            case ExprKind::Binary: return self.visitBinaryExpr(static_cast<const BinaryExpr&>(expr));
+            case ExprKind::Grouping: return self.visitGroupingExpr(static_cast<const GroupingExpr&>(expr));
+            case ExprKind::Literal: return self.visitLiteralExpr(static_cast<const LiteralExpr&>(expr));
+            case ExprKind::Unary: return self.visitUnaryExpr(static_cast<const UnaryExpr&>(expr));
+            case ExprKind::Variable: return self.visitVariableExpr(static_cast<const VariableExpr&>(expr));
+            case ExprKind::Assign: return self.visitAssignExpr(static_cast<const AssignExpr&>(expr));
+            case ExprKind::Call: return self.visitCallExpr(static_cast<const CallExpr&>(expr));
+            case ExprKind::Get: return self.visitGetExpr(static_cast<const GetExpr&>(expr));
+            case ExprKind::Set: return self.visitSetExpr(static_cast<const SetExpr&>(expr));
+        }
+        return ExprR();
+    }
+
+    StmtR visit(const Stmt& stmt) {
+        Derived& self = static_cast<Derived&>(*this);
+        switch (stmt.kind) {
+            case StmtKind::Expression: return self.visitExpressionStmt(static_cast<const ExpressionStmt&>(stmt));
+            case StmtKind::Summon: return self.visitSummonStmt(static_cast<const SummonStmt&>(stmt));
+            case StmtKind::Draw: return self.visitDrawStmt(static_cast<const DrawStmt&>(stmt));
+            case StmtKind::VarDecl: return self.visitVarDeclStmt(static_cast<const VarDeclStmt&>(stmt));
+            case StmtKind::Block: return self.visitBlockStmt(static_cast<const BlockStmt&>(stmt));
+            case StmtKind::If: return self.visitIfStmt(static_cast<const IfStmt&>(stmt));
+            case StmtKind::While: return self.visitWhileStmt(static_cast<const WhileStmt&>(stmt));
+            case StmtKind::Function: return self.visitFunctionStmt(static_cast<const FunctionStmt&>(stmt));
+            case StmtKind::Return: return self.visitReturnStmt(static_cast<const ReturnStmt&>(stmt));
+            case StmtKind::Class: return self.visitClassStmt(static_cast<const ClassStmt&>(stmt));
+            case StmtKind::Struct: return self.visitStructStmt(static_cast<const StructStmt&>(stmt));
+            case StmtKind::Include: return self.visitIncludeStmt(static_cast<const IncludeStmt&>(stmt));
+            case StmtKind::Using: return self.visitUsingStmt(static_cast<const UsingStmt&>(stmt));
+        }
+        return StmtR();
+    }
+};
 
 #endif // DUELSCRIPT_ASTNODES_H
 
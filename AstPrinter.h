@@ -2,79 +2,94 @@
 #define DUELSCRIPT_ASTPRINTER_H
 
 #include "AstNodes.h"
+#include "FlatAst.h"
 #include <iostream>
 #include <string>
 
 // كلاس لطباعة شجرة الـ AST (للاختبار)
-class AstPrinter : public ExprVisitor<std::any>, public StmtVisitor<void> {
+// (dispatch ثابت عبر StaticVisitor: switch على الـ kind بدون virtual calls)
+class AstPrinter : public StaticVisitor<AstPrinter, std::string> {
 public:
-    void print(const std::vector<std::unique_ptr<Stmt>>& statements) {
+    void print(const std::vector<NodePtr<Stmt>>& statements) {
         std::cout << "(Program" << std::endl;
         indent = "  "; // (إضافة مسافة بادئة للبرنامج)
         for (const auto& stmt : statements) {
             if (stmt) {
-                stmt->accept(*this);
+                visit(*stmt);
             }
         }
         indent = "";
         std::cout << ")" << std::endl;
     }
 
+    // نفس المخرجات تماماً، لكن من الـ FlatAst (انظر printFlat / flatExpr)
+    void print(const flat::FlatAst& ast) {
+        flatAst = &ast;
+        std::cout << "(Program" << std::endl;
+        indent = "  ";
+        for (uint32_t i = 0; i < ast.roots.count; ++i) {
+            printFlat(ast.stmtLists[ast.roots.first + i]);
+        }
+        indent = "";
+        std::cout << ")" << std::endl;
+        flatAst = nullptr;
+    }
+
     // --- زيارة الجمل (Statements) ---
 
-    void visitExpressionStmt(const ExpressionStmt& stmt) override {
+    void visitExpressionStmt(const ExpressionStmt& stmt) {
         // --- (الإصلاح) ---
         // (إضافة std::cout لطباعة الناتج)
         std::cout << indent << parenthesize("ExpressionStmt", std::vector<Expr*>{stmt.expression.get()}) << std::endl;
     }
 
-    void visitSummonStmt(const SummonStmt& stmt) override {
+    void visitSummonStmt(const SummonStmt& stmt) {
         // --- (الإصلاح) ---
         // (إضافة std::cout لطباعة الناتج)
         std::cout << indent << parenthesize("Summon", std::vector<Expr*>{stmt.expression.get()}) << std::endl;
     }
 
-    void visitDrawStmt(const DrawStmt& stmt) override {
+    void visitDrawStmt(const DrawStmt& stmt) {
         parenthesize("Draw", std::vector<Token*>{const_cast<Token*>(&stmt.name)});
     }
 
-    void visitVarDeclStmt(const VarDeclStmt& stmt) override {
+    void visitVarDeclStmt(const VarDeclStmt& stmt) {
         std::cout << indent << "(VarDecl " << tokenTypeToString(stmt.type.type) << " " << stmt.name.lexeme;
         if (stmt.initializer) {
             std::cout << " = ";
-            std::cout << std::any_cast<std::string>(stmt.initializer->accept(*this));
+            std::cout << visit(*stmt.initializer);
         }
         std::cout << ")" << std::endl;
     }
 
-    void visitBlockStmt(const BlockStmt& stmt) override {
+    void visitBlockStmt(const BlockStmt& stmt) {
         std::cout << indent << "(Block" << std::endl;
         std::string oldIndent = indent;
         indent += "  ";
         for (const auto& statement : stmt.statements) {
-            statement->accept(*this);
+            visit(*statement);
         }
         indent = oldIndent;
         std::cout << indent << ")" << std::endl;
     }
 
-    void visitIfStmt(const IfStmt& stmt) override {
+    void visitIfStmt(const IfStmt& stmt) {
         std::cout << indent << "(If ";
-        std::cout << std::any_cast<std::string>(stmt.condition->accept(*this));
+        std::cout << visit(*stmt.condition);
         std::cout << std::endl;
 
         std::string oldIndent = indent;
         indent += "  ";
         std::cout << indent << "(Then" << std::endl;
         indent += "  ";
-        stmt.thenBranch->accept(*this);
+        visit(*stmt.thenBranch);
         indent = oldIndent + "  ";
         std::cout << indent << ")" << std::endl;
 
         if (stmt.elseBranch) {
             std::cout << indent << "(Else" << std::endl;
             indent += "  ";
-            stmt.elseBranch->accept(*this);
+            visit(*stmt.elseBranch);
             indent = oldIndent + "  ";
             std::cout << indent << ")" << std::endl;
         }
@@ -82,11 +97,16 @@ public:
         std::cout << indent << ")" << std::endl;
     }
 
-    void visitWhileStmt(const WhileStmt& stmt) override {
-        // ... (لم يُنفذ بعد)
+    void visitWhileStmt(const WhileStmt& stmt) {
+        std::cout << indent << "(While " << visit(*stmt.condition) << std::endl;
+        std::string oldIndent = indent;
+        indent += "  ";
+        visit(*stmt.body);
+        indent = oldIndent;
+        std::cout << indent << ")" << std::endl;
     }
 
-    void visitFunctionStmt(const FunctionStmt& stmt) override {
+    void visitFunctionStmt(const FunctionStmt& stmt) {
         std::cout << indent << "(Function " << stmt.name.lexeme << " (";
         for (size_t i = 0; i < stmt.params.size(); ++i) {
             std::cout << tokenTypeToString(stmt.params[i].type.type) << " " << stmt.params[i].name.lexeme;
@@ -96,12 +116,12 @@ public:
 
         std::string oldIndent = indent;
         indent += "  ";
-        stmt.body->accept(*this);
+        visit(*stmt.body);
         indent = oldIndent;
         std::cout << indent << ")" << std::endl;
     }
 
-    void visitReturnStmt(const ReturnStmt& stmt) override {
+    void visitReturnStmt(const ReturnStmt& stmt) {
         if (stmt.value) {
             // --- (الإصلاح) ---
             // (إضافة std::cout لطباعة الناتج)
@@ -113,7 +133,7 @@ public:
         }
     }
 
-    void visitClassStmt(const ClassStmt& stmt) override {
+    void visitClassStmt(const ClassStmt& stmt) {
         std::cout << indent << "(Class " << stmt.name.lexeme << std::endl;
         std::string oldIndent = indent;
         indent += "  ";
@@ -122,7 +142,7 @@ public:
             std::cout << indent << "(Fields" << std::endl;
             indent += "  ";
             for (const auto& field : stmt.fields) {
-                field->accept(*this);
+                visit(*field);
             }
             indent = oldIndent + "  ";
             std::cout << indent << ")" << std::endl;
@@ -132,7 +152,7 @@ public:
             std::cout << indent << "(Methods" << std::endl;
             indent += "  ";
             for (const auto& method : stmt.methods) {
-                method->accept(*this);
+                visit(*method);
             }
             indent = oldIndent + "  ";
             std::cout << indent << ")" << std::endl;
@@ -142,92 +162,305 @@ public:
         std::cout << indent << ")" << std::endl;
     }
 
-    void visitStructStmt(const StructStmt& stmt) override {
+    void visitStructStmt(const StructStmt& stmt) {
         std::cout << indent << "(Struct " << stmt.name.lexeme << std::endl;
         std::string oldIndent = indent;
         indent += "  ";
         for (const auto& field : stmt.fields) {
-            field->accept(*this);
+            visit(*field);
         }
         indent = oldIndent;
         std::cout << indent << ")" << std::endl;
     }
 
-    void visitIncludeStmt(const IncludeStmt& stmt) override {
+    void visitIncludeStmt(const IncludeStmt& stmt) {
         std::cout << indent << "($SetField \"" << stmt.path.lexeme << "\")" << std::endl;
     }
 
-    void visitUsingStmt(const UsingStmt& stmt) override {
+    void visitUsingStmt(const UsingStmt& stmt) {
         std::cout << indent << "(Using " << stmt.keyword.lexeme << " " << stmt.name.lexeme << ")" << std::endl;
     }
 
 
     // --- زيارة التعبيرات (Expressions) ---
 
-    std::any visitBinaryExpr(const BinaryExpr& expr) override {
-        return parenthesize(expr.op.lexeme, std::vector<Expr*>{expr.left.get(), expr.right.get()});
+    std::string visitBinaryExpr(const BinaryExpr& expr) {
+        return parenthesize(std::string(expr.op.lexeme), std::vector<Expr*>{expr.left.get(), expr.right.get()});
     }
 
-    std::any visitGroupingExpr(const GroupingExpr& expr) override {
+    std::string visitGroupingExpr(const GroupingExpr& expr) {
         return parenthesize("group", std::vector<Expr*>{expr.expression.get()});
     }
 
-    std::any visitLiteralExpr(const LiteralExpr& expr) override {
-        if (expr.value.type() == typeid(std::string)) {
-            return "\"" + std::any_cast<std::string>(expr.value) + "\"";
-        }
-        if (expr.value.type() == typeid(double)) {
-            std::string num = std::to_string(std::any_cast<double>(expr.value));
-            num.erase(num.find_last_not_of('0') + 1, std::string::npos);
-            if(num.back() == '.') num.pop_back();
-            return num;
-        }
-        if (expr.value.type() == typeid(bool)) {
-            return std::string(std::any_cast<bool>(expr.value) ? "true" : "false");
-        }
-        return std::string("nil");
+    std::string visitLiteralExpr(const LiteralExpr& expr) {
+        return formatValue(expr.value);
     }
 
-    std::any visitUnaryExpr(const UnaryExpr& expr) override {
-        return parenthesize(expr.op.lexeme, std::vector<Expr*>{expr.right.get()});
+    std::string visitUnaryExpr(const UnaryExpr& expr) {
+        return parenthesize(std::string(expr.op.lexeme), std::vector<Expr*>{expr.right.get()});
     }
 
-    std::any visitVariableExpr(const VariableExpr& expr) override {
-        return expr.name.lexeme;
+    std::string visitVariableExpr(const VariableExpr& expr) {
+        return std::string(expr.name.lexeme);
     }
 
-    std::any visitAssignExpr(const AssignExpr& expr) override {
-        return parenthesize("= " + expr.name.lexeme, std::vector<Expr*>{expr.value.get()});
+    std::string visitAssignExpr(const AssignExpr& expr) {
+        return parenthesize("= " + std::string(expr.name.lexeme), std::vector<Expr*>{expr.value.get()});
     }
 
-    std::any visitCallExpr(const CallExpr& expr) override {
+    std::string visitCallExpr(const CallExpr& expr) {
         std::vector<Expr*> args;
         for(const auto& arg : expr.arguments) {
             args.push_back(arg.get());
         }
-        return parenthesize("call " + std::any_cast<std::string>(expr.callee->accept(*this)), args);
+        return parenthesize("call " + visit(*expr.callee), args);
     }
 
-    std::any visitGetExpr(const GetExpr& expr) override {
+    std::string visitGetExpr(const GetExpr& expr) {
         // --- (الإصلاح) ---
         // (تحديد نوع الـ vector لإزالة الغموض)
-        return parenthesize("." + expr.name.lexeme, std::vector<Expr*>{expr.object.get()});
+        return parenthesize("." + std::string(expr.name.lexeme), std::vector<Expr*>{expr.object.get()});
     }
 
-    std::any visitSetExpr(const SetExpr& expr) override {
+    std::string visitSetExpr(const SetExpr& expr) {
         // --- (الإصلاح) ---
         // (تحديد نوع الـ vector لإزالة الغموض)
-        return parenthesize("set ." + expr.name.lexeme, std::vector<Expr*>{expr.object.get(), expr.value.get()});
+        return parenthesize("set ." + std::string(expr.name.lexeme), std::vector<Expr*>{expr.object.get(), expr.value.get()});
     }
 
 private:
     std::string indent = "";
+    const flat::FlatAst* flatAst = nullptr;
+
+    static std::string formatValue(const Value& value) {
+        switch (value.type) {
+            case Value::Type::STRING: return "\"" + std::string(value.stringValue()) + "\"";
+            case Value::Type::INT: return std::to_string(value.asInt);
+            case Value::Type::DOUBLE: return formatNumber(value.asDouble);
+            case Value::Type::BOOL: return value.asBool ? "true" : "false";
+            case Value::Type::OBJECT: return "<object>";
+            case Value::Type::NIL: break;
+        }
+        return "nil";
+    }
+
+    static std::string formatNumber(double value) {
+        std::string num = std::to_string(value);
+        num.erase(num.find_last_not_of('0') + 1, std::string::npos);
+        if(num.back() == '.') num.pop_back();
+        return num;
+    }
+
+    // --- الـ FlatAst ---
+
+    std::string_view lexeme(flat::TokenRef token) const {
+        return token == flat::NO_TOKEN ? std::string_view() : flatAst->tokens->lexeme(token);
+    }
+
+    void printFlatList(flat::Range range) {
+        for (uint32_t i = 0; i < range.count; ++i) {
+            printFlat(flatAst->stmtLists[range.first + i]);
+        }
+    }
+
+    void printFlat(flat::StmtRef ref) {
+        const flat::FlatAst& ast = *flatAst;
+        uint32_t i = ref.index();
+        switch (ref.kind()) {
+            case flat::StmtKind::Expression:
+                std::cout << indent << "(ExpressionStmt " << flatExpr(ast.expressions[i].expression) << ")" << std::endl;
+                break;
+
+            case flat::StmtKind::Summon:
+                std::cout << indent << "(Summon " << flatExpr(ast.summons[i].expression) << ")" << std::endl;
+                break;
+
+            case flat::StmtKind::Draw:
+                std::cout << indent << "(Draw " << lexeme(ast.draws[i].name) << ")" << std::endl;
+                break;
+
+            case flat::StmtKind::VarDecl: {
+                const flat::VarDecl& decl = ast.varDecls[i];
+                std::cout << indent << "(VarDecl " << tokenTypeToString(ast.tokens->type(decl.type)) << " "
+                          << lexeme(decl.name);
+                if (decl.initializer.valid()) {
+                    std::cout << " = " << flatExpr(decl.initializer);
+                }
+                std::cout << ")" << std::endl;
+                break;
+            }
+
+            case flat::StmtKind::Block: {
+                std::cout << indent << "(Block" << std::endl;
+                std::string oldIndent = indent;
+                indent += "  ";
+                printFlatList(ast.blocks[i].statements);
+                indent = oldIndent;
+                std::cout << indent << ")" << std::endl;
+                break;
+            }
+
+            case flat::StmtKind::If: {
+                const flat::If& stmt = ast.ifs[i];
+                std::cout << indent << "(If " << flatExpr(stmt.condition) << std::endl;
+                std::string oldIndent = indent;
+                indent += "  ";
+                std::cout << indent << "(Then" << std::endl;
+                indent += "  ";
+                printFlat(stmt.thenBranch);
+                indent = oldIndent + "  ";
+                std::cout << indent << ")" << std::endl;
+                if (stmt.elseBranch.valid()) {
+                    std::cout << indent << "(Else" << std::endl;
+                    indent += "  ";
+                    printFlat(stmt.elseBranch);
+                    indent = oldIndent + "  ";
+                    std::cout << indent << ")" << std::endl;
+                }
+                indent = oldIndent;
+                std::cout << indent << ")" << std::endl;
+                break;
+            }
+
+            case flat::StmtKind::While: {
+                const flat::While& stmt = ast.whiles[i];
+                std::cout << indent << "(While " << flatExpr(stmt.condition) << std::endl;
+                std::string oldIndent = indent;
+                indent += "  ";
+                printFlat(stmt.body);
+                indent = oldIndent;
+                std::cout << indent << ")" << std::endl;
+                break;
+            }
+
+            case flat::StmtKind::Function: {
+                const flat::Function& function = ast.functions[i];
+                std::cout << indent << "(Function " << lexeme(function.name) << " (";
+                for (uint32_t p = 0; p < function.params.count; ++p) {
+                    const flat::Parameter& param = ast.params[function.params.first + p];
+                    std::cout << tokenTypeToString(ast.tokens->type(param.type)) << " " << lexeme(param.name);
+                    if (p + 1 < function.params.count) std::cout << ", ";
+                }
+                std::cout << ")" << std::endl;
+                std::string oldIndent = indent;
+                indent += "  ";
+                printFlat(function.body);
+                indent = oldIndent;
+                std::cout << indent << ")" << std::endl;
+                break;
+            }
+
+            case flat::StmtKind::Return: {
+                std::cout << indent << "(Tribute (Return)";
+                if (ast.returns[i].value.valid()) std::cout << " " << flatExpr(ast.returns[i].value);
+                std::cout << ")" << std::endl;
+                break;
+            }
+
+            case flat::StmtKind::Class: {
+                const flat::Class& stmt = ast.classes[i];
+                std::cout << indent << "(Class " << lexeme(stmt.name) << std::endl;
+                std::string oldIndent = indent;
+                indent += "  ";
+                if (stmt.fields.count > 0) {
+                    std::cout << indent << "(Fields" << std::endl;
+                    indent += "  ";
+                    printFlatList(stmt.fields);
+                    indent = oldIndent + "  ";
+                    std::cout << indent << ")" << std::endl;
+                }
+                if (stmt.methods.count > 0) {
+                    std::cout << indent << "(Methods" << std::endl;
+                    indent += "  ";
+                    printFlatList(stmt.methods);
+                    indent = oldIndent + "  ";
+                    std::cout << indent << ")" << std::endl;
+                }
+                indent = oldIndent;
+                std::cout << indent << ")" << std::endl;
+                break;
+            }
+
+            case flat::StmtKind::Struct: {
+                std::cout << indent << "(Struct " << lexeme(ast.structs[i].name) << std::endl;
+                std::string oldIndent = indent;
+                indent += "  ";
+                printFlatList(ast.structs[i].fields);
+                indent = oldIndent;
+                std::cout << indent << ")" << std::endl;
+                break;
+            }
+
+            case flat::StmtKind::Include:
+                std::cout << indent << "($SetField \"" << lexeme(ast.includes[i].path) << "\")" << std::endl;
+                break;
+
+            case flat::StmtKind::Using:
+                std::cout << indent << "(Using " << lexeme(ast.usings[i].keyword) << " "
+                          << lexeme(ast.usings[i].name) << ")" << std::endl;
+                break;
+        }
+    }
+
+    std::string flatExpr(flat::ExprRef ref) {
+        const flat::FlatAst& ast = *flatAst;
+        uint32_t i = ref.index();
+        switch (ref.kind()) {
+            case flat::ExprKind::Binary: {
+                const flat::Binary& expr = ast.binaries[i];
+                return "(" + std::string(lexeme(expr.op)) + " " + flatExpr(expr.left) + " " + flatExpr(expr.right) + ")";
+            }
+            case flat::ExprKind::Grouping:
+                return "(group " + flatExpr(ast.groupings[i].expression) + ")";
+
+            case flat::ExprKind::Literal: {
+                flat::TokenRef token = ast.literals[i].token;
+                if (token == flat::NO_TOKEN) return "nil";
+                std::string_view text = lexeme(token);
+                switch (ast.tokens->type(token)) {
+                    case TokenType::STRING: return "\"" + std::string(text) + "\"";
+                    case TokenType::NUMBER: return formatValue(numberValue(text));
+                    case TokenType::KEYWORD_TRUE: return "true";
+                    case TokenType::KEYWORD_FALSE: return "false";
+                    default: return "nil";
+                }
+            }
+            case flat::ExprKind::Unary: {
+                const flat::Unary& expr = ast.unaries[i];
+                return "(" + std::string(lexeme(expr.op)) + " " + flatExpr(expr.right) + ")";
+            }
+            case flat::ExprKind::Variable:
+                return std::string(lexeme(ast.variables[i].name));
+
+            case flat::ExprKind::Assign:
+                return "(= " + std::string(lexeme(ast.assigns[i].name)) + " " + flatExpr(ast.assigns[i].value) + ")";
+
+            case flat::ExprKind::Call: {
+                const flat::Call& expr = ast.calls[i];
+                std::string result = "(call " + flatExpr(expr.callee);
+                for (uint32_t a = 0; a < expr.arguments.count; ++a) {
+                    result += " " + flatExpr(ast.exprLists[expr.arguments.first + a]);
+                }
+                return result + ")";
+            }
+            case flat::ExprKind::Get: {
+                const flat::Get& expr = ast.gets[i];
+                return "(." + std::string(lexeme(expr.name)) + " " + flatExpr(expr.object) + ")";
+            }
+            case flat::ExprKind::Set: {
+                const flat::Set& expr = ast.sets[i];
+                return "(set ." + std::string(lexeme(expr.name)) + " " + flatExpr(expr.object) + " " +
+                       flatExpr(expr.value) + ")";
+            }
+        }
+        return "nil";
+    }
 
     std::string parenthesize(std::string name, const std::vector<Expr*>& exprs) {
         std::string result = "(" + name;
         for (const auto& expr : exprs) {
             result += " ";
-            result += std::any_cast<std::string>(expr->accept(*this));
+            result += visit(*expr);
         }
         result += ")";
         return result;
@@ -0,0 +1,2258 @@
+#ifndef DUELSCRIPT_BENCHMARKS_H
+#define DUELSCRIPT_BENCHMARKS_H
+
+#include "AllocationStats.h"
+#include "CompilationUnit.h"
+#include "Parser.h"
+#include "DuelScriptScanner.h"
+#include "ScanKernels.h"
+#include "SourceBuffer.h"
+#include "ThreadPool.h"
+#include "AstPrinter.h"
+#include "FlatAst.h"
+#include "AstCache.h"
+#include "ModuleLoader.h"
+#include "Resolver.h"
+#include "TypeChecker.h"
+#include "Optimizer.h"
+#include "Interpreter.h"
+#include "BytecodeCompiler.h"
+#include "VM.h"
+#include "CppEmitter.h"
+#include <algorithm>
+#include <any>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <optional>
+#include <random>
+#include <set>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#ifdef DUELSCRIPT_HAVE_MMAP
+#include <sys/resource.h>
+#include <sys/wait.h>
+#endif
+
+// --- Benchmarks ---
+// تُشغّل عبر: DuelScript --bench <name>
+// كل benchmark يطبع نتائجه ويعيد exit code (غير صفري = فشل/تراجع).
+namespace bench {
+
+using Clock = std::chrono::steady_clock;
+
+inline double secondsSince(Clock::time_point start) {
+    return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+// (يمنع الـ compiler من حذف نتيجة الحلقة)
+template<typename T>
+inline void keep(const T& value) {
+    asm volatile("" : : "g"(&value) : "memory");
+}
+
+// --- مولدات الـ corpus ---
+
+// ملف "مولّد" نموذجي: أغلبه تعليقات ومسافات بادئة حول كود قليل
+inline std::string commentHeavyCorpus(int rituals) {
+    std::string out;
+    for (int i = 0; i < rituals; ++i) {
+        std::string n = std::to_string(i);
+        out += "MillenniumEye: generated ritual #" + n + " -- this line only documents the generator state\n";
+        out += "ShadowRealm{\n"
+               "    Auto-generated by the duel simulator. The following ritual applies\n"
+               "    a fixed amount of damage and announces the result to both duelists.\n"
+               "    Do not edit by hand; regenerate from the deck description instead.\n"
+               "}\n";
+        out += "Ritual Generated" + n + "(DarkMagician damage) {\n"
+               "        MillenniumEye: apply the damage\n"
+               "        DarkMagician lifePoints = 4000 - damage;\n"
+               "        Summon << \"ritual " + n + " leaves \" << lifePoints;\n"
+               "        Tribute lifePoints;\n"
+               "}\n\n";
+    }
+    return out;
+}
+
+// كود كثيف بالـ nodes: تعبيرات، استدعاءات، blocks متداخلة
+inline std::string nodeHeavyCorpus(int rituals) {
+    std::string out;
+    for (int i = 0; i < rituals; ++i) {
+        std::string n = std::to_string(i);
+        out += "Ritual Duel" + n + "(DarkMagician attack, DarkMagician defense) {\n"
+               "    DarkMagician damage = (attack - defense) * 2 + " + n + " / 3 - -1;\n"
+               "    JudgmentOfAnubis (damage > 1500 == !false) {\n"
+               "        player.lifePoints = player.lifePoints - damage;\n"
+               "        Summon << player.name << \" takes \" << damage << \" damage\";\n"
+               "    } SolemnJudgment {\n"
+               "        { log(damage, attack + defense, Duel" + n + "(1, 2)); }\n"
+               "    }\n"
+               "    Tribute damage * attack + defense;\n"
+               "}\n";
+    }
+    return out;
+}
+
+// كود كثيف بالتعبيرات: كل statement تقريباً operators و operands بسيطة
+inline std::string expressionDenseCorpus(int rituals) {
+    std::string out;
+    for (int i = 0; i < rituals; ++i) {
+        std::string n = std::to_string(i);
+        out += "Ritual Calc" + n + "(DarkMagician a, DarkMagician b) {\n"
+               "    DarkMagician x = a * b + " + n + " - a / 2 * (b - 1) + -a;\n"
+               "    x = x * 2 + a * 3 - b * 4 + 5 / a - 6 / b;\n"
+               "    x = a > b == b < a != !(x >= 1) == x <= 2;\n"
+               "    board.slot.atk = board.slot.atk - a * b.def + f(a, b + 1, -x).y;\n"
+               "    Tribute a + b + x + 1 + 2 + 3 + a * b * x / 4;\n"
+               "}\n";
+    }
+    return out;
+}
+
+// مخرجات مولّد مكسور: كل ritual فيها عدة أخطاء (';' ناقصة، أقواس زائدة،
+// تعبيرات مبتورة، حروف غير معروفة) حتى يعمل الـ error recovery باستمرار
+inline std::string brokenCorpus(int rituals) {
+    std::string out;
+    for (int i = 0; i < rituals; ++i) {
+        std::string n = std::to_string(i);
+        out += "Ritual Broken" + n + "(DarkMagician attack DarkMagician defense) {\n"
+               "    DarkMagician damage = (attack - ) * 2 + " + n + "\n"
+               "    JudgmentOfAnubis damage > 1500) {\n"
+               "        player.lifePoints = player. - damage;\n"
+               "        Summon player.name << ;\n"
+               "    } SolemnJudgment { @ $ ; }\n"
+               "    Tribute damage * * attack;\n"
+               "}\n"
+               "LordOfD Board" + n + " { 5; DarkMagician slot = ; };\n";
+    }
+    return out;
+}
+
+inline size_t scanTokenCount(std::string_view source, int& lastLine) {
+    Scanner scanner(source);
+    std::vector<Token> tokens = scanner.scanTokens();
+    lastLine = tokens.back().line;
+    return tokens.size();
+}
+
+// --- scanner: الـ SIMD kernels مقابل المسار الـ scalar على corpus مليء بالتعليقات ---
+// الـ kernel يُختار وقت الترجمة، فالمقارنة تمر على الـ corpus بنفس تقسيم الـ Scanner لكن بالـ kernels
+// فقط (scalar:: ثم simd:: مباشرة)، ثم الـ Scanner الكامل: الفرق بينهما هو ما لا يلمسه الـ SIMD
+// (تسجيل الأسماء في الـ SymbolTable، بناء الـ Tokens، الـ dispatch على كل حرف).
+template <typename Kernels>
+inline size_t kernelWalk(std::string_view source, int& newlines) {
+    const char* p = source.data();
+    const char* end = p + source.size();
+    auto startsWith = [&](std::string_view prefix) {
+        return static_cast<size_t>(end - p) >= prefix.size() && std::string_view(p, prefix.size()) == prefix;
+    };
+    size_t runs = 0;
+    newlines = 0;
+    while (p < end) {
+        char c = *p;
+        runs++;
+        if (scan_kernels::scalar::isWhitespace(c)) {
+            p = Kernels::skipWhitespace(p, end, newlines);
+        } else if (c == 'M' && startsWith("MillenniumEye:")) {
+            p = Kernels::findByte(p, end, '\n');
+        } else if ((c == 'S' && startsWith("ShadowRealm{")) || c == '"') {
+            const char* close = Kernels::findByte(p + 1, end, c == '"' ? '"' : '}');
+            newlines += Kernels::countNewlines(p, close);
+            p = close + (close < end);
+        } else if (c >= '0' && c <= '9') {
+            p = Kernels::skipDigits(p, end);
+        } else if (scan_kernels::scalar::isIdentifierChar(c)) {
+            p = Kernels::skipIdentifier(p, end);
+        } else {
+            p++;
+        }
+    }
+    return runs;
+}
+
+struct ScalarKernels {
+    static constexpr auto skipWhitespace = &scan_kernels::scalar::skipWhitespace;
+    static constexpr auto skipIdentifier = &scan_kernels::scalar::skipIdentifier;
+    static constexpr auto skipDigits = &scan_kernels::scalar::skipDigits;
+    static constexpr auto findByte = &scan_kernels::scalar::findByte;
+    static constexpr auto countNewlines = &scan_kernels::scalar::countNewlines;
+};
+
+#ifdef DUELSCRIPT_SIMD_SCANNER
+struct SimdKernels {
+    static constexpr auto skipWhitespace = &scan_kernels::simd::skipWhitespace;
+    static constexpr auto skipIdentifier = &scan_kernels::simd::skipIdentifier;
+    static constexpr auto skipDigits = &scan_kernels::simd::skipDigits;
+    static constexpr auto findByte = &scan_kernels::simd::findByte;
+    static constexpr auto countNewlines = &scan_kernels::simd::countNewlines;
+};
+#else
+using SimdKernels = ScalarKernels;
+#endif
+
+inline int scannerThroughput() {
+    std::string source = commentHeavyCorpus(40000);
+    const int rounds = 5;
+
+    auto timed = [&](auto&& body) {
+        auto start = Clock::now();
+        for (int r = 0; r < rounds; ++r) body();
+        return secondsSince(start) / rounds;
+    };
+
+    size_t scalarRuns = 0, simdRuns = 0, tokens = 0;
+    int scalarLines = 0, simdLines = 0, lastLine = 0;
+    double scalarTime = timed([&] { scalarRuns = kernelWalk<ScalarKernels>(source, scalarLines); });
+    double simdTime = timed([&] { simdRuns = kernelWalk<SimdKernels>(source, simdLines); });
+    double scanTime = timed([&] { tokens = scanTokenCount(source, lastLine); });
+
+    double mb = source.size() / (1024.0 * 1024.0);
+    std::cout << "scanner: " << mb << " MB comment-heavy corpus, " << tokens << " tokens" << std::endl;
+#ifdef DUELSCRIPT_SIMD_SCANNER
+    std::cout << "  kernels       : " << scan_kernels::simd::WIDTH * 8 << "-bit SIMD" << std::endl;
+#else
+    std::cout << "  kernels       : scalar only (no SSE2/AVX2 at build time)" << std::endl;
+#endif
+    std::cout << "  kernels scalar: " << mb / scalarTime << " MB/s" << std::endl;
+    std::cout << "  kernels simd  : " << mb / simdTime << " MB/s (" << scalarTime / simdTime << "x)" << std::endl;
+    std::cout << "  full Scanner  : " << tokens / scanTime / 1e6 << " M tokens/s, " << mb / scanTime << " MB/s ("
+              << simdTime / scanTime * 100 << "% in the kernels, the rest is per-token work)" << std::endl;
+
+    if (scalarRuns != simdRuns || scalarLines != simdLines || simdLines + 1 != lastLine) {
+        std::cout << "  MISMATCH between scalar, SIMD and Scanner line counts" << std::endl;
+        return 1;
+    }
+    return 0;
+}
+
+// --- scanalloc: حد أقصى ثابت للـ bytes المحجوزة لكل byte من الـ source ---
+// (تراجع يفشل الـ benchmark: مثلاً عودة substr لكل حرف داخل ShadowRealm)
+inline int scannerAllocations() {
+    const double MAX_BYTES_PER_SOURCE_BYTE = 4.0;
+
+    std::string shadowRealms;
+    for (int i = 0; i < 20000; ++i) {
+        shadowRealms += "ShadowRealm{\n  generated block " + std::to_string(i) +
+                        ": nothing in here should cost an allocation\n}\n";
+    }
+    std::string lineComments;
+    for (int i = 0; i < 20000; ++i) {
+        lineComments += "MillenniumEye: generated comment " + std::to_string(i) + "\n";
+    }
+
+    struct Case {
+        const char* name;
+        std::string source;
+    };
+    const Case cases[] = {
+        {"comment-heavy", commentHeavyCorpus(20000)},
+        {"ShadowRealm-only", shadowRealms},
+        {"MillenniumEye-only", lineComments},
+    };
+
+    int status = 0;
+    std::cout << "scanalloc: bound " << MAX_BYTES_PER_SOURCE_BYTE << " bytes allocated per source byte" << std::endl;
+    for (const Case& c : cases) {
+        int lastLine = 0;
+        alloc_stats::Snapshot before = alloc_stats::snapshot();
+        size_t tokens = scanTokenCount(c.source, lastLine);
+        alloc_stats::Snapshot delta = alloc_stats::snapshot() - before;
+
+        double ratio = double(delta.bytes) / c.source.size();
+        bool ok = ratio <= MAX_BYTES_PER_SOURCE_BYTE;
+        std::cout << "  " << c.name << ": " << c.source.size() << " bytes, " << tokens << " tokens, "
+                  << delta.count << " allocations, " << ratio << " bytes/source byte"
+                  << (ok ? "" : "  <-- FAIL") << std::endl;
+        if (!ok) status = 1;
+    }
+    return status;
+}
+
+// --- bigfile: تحميل ملف كبير عبر mmap مقابل ifstream -> stringstream -> string ---
+// كل طريقة تعمل في process منفصلة حتى يكون الـ peak RSS خاصاً بها.
+#ifdef DUELSCRIPT_HAVE_MMAP
+inline long peakRssKb() {
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_maxrss;
+}
+
+enum class LoadMode { Stream, Mmap, MmapStreaming };
+
+inline void largeFileChild(const std::string& path, LoadMode mode) {
+    bool useMmap = mode != LoadMode::Stream;
+    auto start = Clock::now();
+    std::string copied;
+    SourceBuffer mapped;
+    std::string_view text;
+    if (useMmap) {
+        mapped = std::move(*SourceBuffer::fromFile(path));
+        text = mapped.text();
+    } else {
+        // (المسار القديم في main.cpp: نسختان قبل الـ Scanner ثم نسخة ثالثة داخله)
+        std::ifstream file(path);
+        std::stringstream buffer;
+        buffer << file.rdbuf();
+        std::string source = buffer.str();
+        copied = source;
+        text = copied;
+    }
+    double loaded = secondsSince(start);
+    long loadRss = peakRssKb();
+
+    Scanner scanner(text);
+    Token token = scanner.nextToken();
+    double firstToken = secondsSince(start);
+
+    size_t tokens = 1;
+    if (mode == LoadMode::MmapStreaming) {
+        // (بدون vector: ذاكرة ثابتة مهما كبر الملف)
+        while (token.type != TokenType::TOKEN_EOF) {
+            token = scanner.nextToken();
+            tokens++;
+        }
+    } else {
+        tokens += scanner.scanTokens().size();
+    }
+    double total = secondsSince(start);
+
+    std::printf("  %-14s: load %.1f ms (peak RSS %.1f MB), first token %.1f ms, "
+                "all %zu tokens %.1f ms (peak RSS %.1f MB)\n",
+                mode == LoadMode::Stream ? "ifstream" : mode == LoadMode::Mmap ? "mmap" : "mmap+nextToken",
+                loaded * 1e3, loadRss / 1024.0, firstToken * 1e3,
+                tokens, total * 1e3, peakRssKb() / 1024.0);
+}
+
+inline int largeFileLoading() {
+    const std::string path = "/tmp/duelscript-bigfile.duelscript";
+    const int rituals = 400000;
+
+    // (الملف يُولّد في process ابن حتى لا يرتفع الـ RSS عند الأب)
+    pid_t writer = fork();
+    if (writer == 0) {
+        std::ofstream(path) << commentHeavyCorpus(rituals);
+        _exit(0);
+    }
+    waitpid(writer, nullptr, 0);
+
+    std::cout << "bigfile: " << path << " (" << rituals << " generated rituals)" << std::endl;
+    std::cout.flush();
+    for (LoadMode mode : {LoadMode::Stream, LoadMode::Mmap, LoadMode::MmapStreaming}) {
+        pid_t child = fork();
+        if (child == 0) {
+            largeFileChild(path, mode);
+            std::fflush(stdout);
+            _exit(0);
+        }
+        waitpid(child, nullptr, 0);
+    }
+    std::remove(path.c_str());
+    return 0;
+}
+#endif
+
+// --- astarena: سرعة بناء الـ AST (nodes/sec) وزمن هدمه، الـ arena مقابل new/delete لكل node ---
+struct ArenaRun {
+    double parseTime = 0, teardownTime = 0;
+    size_t nodes = 0, chunks = 0, allocations = 0;
+};
+
+inline ArenaRun arenaRun(const std::string& source, AstArena::Strategy strategy, int rounds) {
+    ArenaRun result;
+    for (int r = 0; r < rounds; ++r) {
+        CompilationUnit unit("<bench>", source);
+        TokenBuffer tokens = scanPacked(unit.text());
+        auto arena = std::make_unique<AstArena>(strategy);
+
+        auto start = Clock::now();
+        alloc_stats::Snapshot before = alloc_stats::snapshot();
+        Parser parser(tokens, *arena);
+        std::vector<NodePtr<Stmt>> statements = parser.parse();
+        result.allocations = (alloc_stats::snapshot() - before).count;
+        result.parseTime += secondsSince(start);
+        result.nodes = arena->nodeCount();
+        result.chunks = arena->chunkCount();
+
+        start = Clock::now();
+        statements.clear();
+        arena.reset();
+        result.teardownTime += secondsSince(start);
+    }
+    result.parseTime /= rounds;
+    result.teardownTime /= rounds;
+    return result;
+}
+
+inline int astArena() {
+    std::string source = nodeHeavyCorpus(20000);
+    const int rounds = 5;
+    ArenaRun heap = arenaRun(source, AstArena::Strategy::PER_NODE_HEAP, rounds);
+    ArenaRun arena = arenaRun(source, AstArena::Strategy::BUMP, rounds);
+
+    std::cout << "astarena: " << arena.nodes << " nodes in " << arena.chunks << " arena chunks" << std::endl;
+    auto row = [](const char* name, const ArenaRun& run) {
+        std::cout << "  " << name << ": parse " << run.parseTime * 1e3 << " ms, " << run.nodes / run.parseTime / 1e6
+                  << " M nodes/s, " << run.allocations << " heap allocations, teardown " << run.teardownTime * 1e3
+                  << " ms" << std::endl;
+    };
+    row("new per node (old)", heap);
+    row("arena             ", arena);
+    std::cout << "  speedup            : parse " << heap.parseTime / arena.parseTime << "x, teardown "
+              << heap.teardownTime / arena.teardownTime << "x" << std::endl;
+    return heap.nodes == arena.nodes ? 0 : 1;
+}
+
+// --- teardown: هدم أشجار عميقة جداً (سلاسل بمليون عنصر) ---
+// الـ Pratt loop يبني السلسلة بدون recursion؛ هنا نتأكد أن الهدم أيضاً بدون
+// recursion (الـ destructors المتداخلة القديمة كانت تستهلك الـ stack حتى الـ crash).
+inline int deepTeardown() {
+    const int terms = 1000000;
+    const int depth = 10000; // (الـ Parser نفسه recursive في الـ blocks)
+
+    struct Case {
+        const char* name;
+        std::string source;
+    };
+    std::vector<Case> cases;
+
+    std::string summon = "Ritual Yugi() {\n    Summon << a";
+    for (int i = 1; i < terms; ++i) summon += " << a";
+    cases.push_back({"summon chain", summon + ";\n}\n"});
+
+    std::string sum = "Ritual Yugi() {\n    DarkMagician x = 1";
+    for (int i = 1; i < terms; ++i) sum += " + 1";
+    cases.push_back({"'+' chain", sum + ";\n}\n"});
+
+    std::string nested = "Ritual Yugi() {\n";
+    for (int i = 0; i < depth; ++i) nested += "JudgmentOfAnubis (true) { { ";
+    nested += "Summon << 1;";
+    for (int i = 0; i < depth; ++i) nested += " } }";
+    cases.push_back({"nested if/blocks", nested + "\n}\n"});
+
+    std::cout << "teardown: " << terms << "-term chains, " << depth << "-deep nesting" << std::endl;
+    for (Case& c : cases) {
+        auto unit = std::make_unique<CompilationUnit>("<bench>", std::move(c.source));
+        TokenBuffer tokens = scanPacked(unit->text());
+
+        auto start = Clock::now();
+        Parser parser(tokens, unit->getArena());
+        std::vector<NodePtr<Stmt>> statements = parser.parse();
+        double parseTime = secondsSince(start);
+        size_t nodes = unit->getArena().nodeCount();
+        size_t finalizers = unit->getArena().finalizerCount();
+        if (parser.hadError) {
+            std::cout << "  " << c.name << ": parse failed" << std::endl;
+            return 1;
+        }
+
+        start = Clock::now();
+        statements.clear();
+        unit.reset();
+        double teardownTime = secondsSince(start);
+
+        std::cout << "  " << c.name << ": " << nodes << " nodes, parse " << parseTime * 1e3 << " ms, teardown "
+                  << teardownTime * 1e3 << " ms (" << finalizers << " destructors run)" << std::endl;
+    }
+    return 0;
+}
+
+// --- parsealloc: عدد الـ heap allocations داخل الـ Parser لكل node ---
+// الـ nodes نفسها في الـ arena؛ الباقي هو فقط ما تملكه الـ nodes (vectors للـ
+// arguments/statements، قيم الـ literals). أي نسخ Token أو vector مؤقت في
+// advance/match/consume يرفع الرقم فوق الحد ويفشل الـ benchmark.
+// (العمود "old" = نفس الـ Parser مع new لكل node، أي الطريقة قبل الـ arena)
+inline int parserAllocations() {
+    const double MAX_ALLOCATIONS_PER_NODE = 1.0;
+
+    struct Case {
+        std::string name;
+        std::string source;
+    };
+    std::vector<Case> cases;
+    if (std::optional<SourceBuffer> file = SourceBuffer::fromFile("test.duelscript")) {
+        cases.push_back({"test.duelscript", std::string(file->text())});
+    }
+    cases.push_back({"node-heavy", nodeHeavyCorpus(20000)});
+
+    auto measure = [](const TokenBuffer& tokens, AstArena::Strategy strategy, size_t& nodes, bool& hadError) {
+        AstArena arena(strategy);
+        alloc_stats::Snapshot before = alloc_stats::snapshot();
+        Parser parser(tokens, arena);
+        std::vector<NodePtr<Stmt>> statements = parser.parse();
+        alloc_stats::Snapshot delta = alloc_stats::snapshot() - before;
+        nodes = arena.nodeCount();
+        hadError = parser.hadError;
+        return delta.count;
+    };
+
+    int status = 0;
+    std::cout << "parsealloc: bound " << MAX_ALLOCATIONS_PER_NODE << " heap allocations per AST node" << std::endl;
+    for (const Case& c : cases) {
+        CompilationUnit unit("<bench>", c.source);
+        TokenBuffer tokens = scanPacked(unit.text());
+
+        size_t nodes = 0;
+        bool hadError = false;
+        size_t old = measure(tokens, AstArena::Strategy::PER_NODE_HEAP, nodes, hadError);
+        size_t current = measure(tokens, AstArena::Strategy::BUMP, nodes, hadError);
+
+        double ratio = nodes ? double(current) / nodes : 0.0;
+        double oldRatio = nodes ? double(old) / nodes : 0.0;
+        bool ok = ratio <= MAX_ALLOCATIONS_PER_NODE;
+        std::cout << "  " << c.name << ": " << tokens.size() << " tokens, " << nodes << " nodes, "
+                  << current << " allocations, " << ratio << " allocations/node (old: " << old << ", "
+                  << oldRatio << "/node)" << (hadError ? " (with parse errors)" : "") << (ok ? "" : "  <-- FAIL")
+                  << std::endl;
+        if (!ok) status = 1;
+    }
+    return status;
+}
+
+// --- exprparse: الـ Parser على كود كثيف بالتعبيرات (precedence climbing) ---
+inline int expressionParsing() {
+    std::string source = expressionDenseCorpus(20000);
+    const int rounds = 5;
+    double parseTime = 0;
+    size_t nodes = 0, tokenCount = 0;
+
+    for (int r = 0; r < rounds; ++r) {
+        CompilationUnit unit("<bench>", source);
+        TokenBuffer tokens = scanPacked(unit.text());
+        tokenCount = tokens.size();
+
+        auto start = Clock::now();
+        Parser parser(tokens, unit.getArena());
+        std::vector<NodePtr<Stmt>> statements = parser.parse();
+        parseTime += secondsSince(start);
+        nodes = unit.getArena().nodeCount();
+        if (parser.hadError) {
+            std::cout << "exprparse: unexpected parse error" << std::endl;
+            return 1;
+        }
+    }
+    parseTime /= rounds;
+
+    std::cout << "exprparse: " << tokenCount << " tokens, " << nodes << " nodes (expression-dense corpus)" << std::endl;
+    std::cout << "  parse : " << parseTime * 1e3 << " ms, " << nodes / parseTime / 1e6 << " M nodes/s, "
+              << parseTime * 1e9 / tokenCount << " ns/token" << std::endl;
+    return 0;
+}
+
+// --- parallel: parse() مقابل parseParallel() على ملف بآلاف الـ Rituals ---
+// (يتحقق أيضاً أن الـ AST المطبوع مطابق تماماً للـ parse التسلسلي)
+inline std::string printedAst(const std::vector<NodePtr<Stmt>>& statements) {
+    std::ostringstream out;
+    std::streambuf* previous = std::cout.rdbuf(out.rdbuf());
+    AstPrinter printer;
+    printer.print(statements);
+    std::cout.rdbuf(previous);
+    return out.str();
+}
+
+inline int parallelParsing() {
+    std::string source = nodeHeavyCorpus(40000);
+    CompilationUnit unit("<bench>", source);
+    TokenBuffer tokens = scanPacked(unit.text());
+    const int rounds = 3;
+
+    auto measure = [&](ThreadPool* pool, std::string* printed) {
+        double total = 0;
+        for (int r = 0; r < rounds; ++r) {
+            AstArena arena;
+            auto start = Clock::now();
+            Parser parser(tokens, arena);
+            std::vector<NodePtr<Stmt>> statements = pool ? parser.parseParallel(*pool) : parser.parse();
+            total += secondsSince(start);
+            if (printed && r == 0) *printed = printedAst(statements);
+        }
+        return total / rounds;
+    };
+
+    std::string expected;
+    double sequential = measure(nullptr, &expected);
+    std::cout << "parallel: " << tokens.size() << " tokens, 40000 rituals, "
+              << std::thread::hardware_concurrency() << " hardware threads" << std::endl;
+    std::cout << "  sequential  : " << sequential * 1e3 << " ms" << std::endl;
+
+    int status = 0;
+    std::vector<unsigned> counts = {1, 2, 4, 8};
+    unsigned hardware = std::max(1u, std::thread::hardware_concurrency());
+    if (hardware > 8) counts.push_back(hardware);
+    for (unsigned threads : counts) {
+        ThreadPool pool(threads);
+        std::string printed;
+        double time = measure(&pool, &printed);
+        bool same = printed == expected;
+        std::printf("  %2u threads  : %.1f ms, speedup %.2fx%s\n", threads, time * 1e3,
+                    sequential / time, same ? "" : "  <-- AST MISMATCH");
+        if (!same) status = 1;
+    }
+    return status;
+}
+
+// (الأخطاء كأسطر مرتبة بعد emit، بالـ TokenBuffer أو بالـ TokenStream كما في --stream؛
+//  الترتيب وحده يختلف: في الـ streaming تظهر أخطاء الـ Scanner عند الوصول إليها)
+inline std::vector<std::string> brokenDiagnostics(const std::string& source, bool streaming) {
+    CompilationUnit unit("<bench>", source);
+    Diagnostics diagnostics(SIZE_MAX);
+    if (streaming) {
+        Scanner scanner(unit.text(), &diagnostics);
+        Parser parser(scanner, unit.getArena(), &diagnostics);
+        parser.parse();
+    } else {
+        TokenBuffer tokens = scanPacked(unit.text(), &diagnostics);
+        Parser parser(tokens, unit.getArena(), &diagnostics);
+        parser.parse();
+    }
+    std::ostringstream text;
+    diagnostics.emit(text);
+    std::istringstream in(text.str());
+    std::vector<std::string> lines;
+    for (std::string line; std::getline(in, line);) lines.push_back(line);
+    std::sort(lines.begin(), lines.end());
+    return lines;
+}
+
+// --- broken: الـ Scanner + Parser على مدخلات مكسورة جداً ---
+// التسجيل (بدون تنسيق) مفصول عن الطباعة: emit يُقاس وحده إلى stream فارغ.
+// ثم نفس المدخلات في الـ streaming mode: الـ TokenStream يرى 4 Tokens فقط، فكل خطأ
+// يُسجل بعد parsing ما بعده (a = <تعبير طويل>) يجب أن يحفظ الـ Token نفسه.
+inline int brokenInput() {
+    std::string source = brokenCorpus(20000);
+    const int rounds = 3;
+    double parseTime = 0, emitTime = 0;
+    size_t reported = 0, tokenCount = 0;
+
+    for (int r = 0; r < rounds; ++r) {
+        CompilationUnit unit("<bench>", source);
+        Diagnostics diagnostics(SIZE_MAX);
+
+        auto start = Clock::now();
+        TokenBuffer tokens = scanPacked(unit.text(), &diagnostics);
+        Parser parser(tokens, unit.getArena(), &diagnostics);
+        std::vector<NodePtr<Stmt>> statements = parser.parse();
+        parseTime += secondsSince(start);
+        reported = diagnostics.count();
+        tokenCount = tokens.size();
+
+        std::ostringstream sink;
+        start = Clock::now();
+        diagnostics.emit(sink);
+        emitTime += secondsSince(start);
+    }
+    parseTime /= rounds;
+    emitTime /= rounds;
+
+    // (مع الحد الافتراضي: الـ Parser يتوقف مبكراً)
+    CompilationUnit unit("<bench>", source);
+    Diagnostics capped;
+    auto start = Clock::now();
+    TokenBuffer tokens = scanPacked(unit.text(), &capped);
+    Parser parser(tokens, unit.getArena(), &capped);
+    std::vector<NodePtr<Stmt>> statements = parser.parse();
+    double cappedTime = secondsSince(start);
+
+    std::cout << "broken: " << tokenCount << " tokens, " << reported << " diagnostics" << std::endl;
+    std::cout << "  scan+parse (no cap) : " << parseTime * 1e3 << " ms, "
+              << parseTime * 1e9 / reported << " ns/diagnostic" << std::endl;
+    std::cout << "  emit (formatting)   : " << emitTime * 1e3 << " ms" << std::endl;
+    std::cout << "  scan+parse (cap " << capped.getLimit() << ") : " << cappedTime * 1e3 << " ms" << std::endl;
+
+    const std::string streamCases[] = {
+        "Ritual Yugi() { DarkMagician a = 1; (a) = 1 + 2 + 3 + 4; }\n",
+        brokenCorpus(50),
+    };
+    int status = 0;
+    for (const std::string& input : streamCases) {
+        if (brokenDiagnostics(input, true) != brokenDiagnostics(input, false)) {
+            std::cout << "  --stream MISMATCH on:\n" << input.substr(0, 200) << std::endl;
+            status = 1;
+        }
+    }
+    if (status == 0) std::cout << "  --stream            : same diagnostics as the TokenBuffer" << std::endl;
+    return status;
+}
+
+// --- flatast: الـ AST العادي مقابل الـ Flat AST (ذاكرة، traversal، نسخ) ---
+
+// (يزور كل node في الشجرة العادية ويعدّها)
+class NodeCounter : public ExprVisitor<size_t>, public StmtVisitor<void> {
+public:
+    size_t nodes = 0;
+
+    void count(const std::vector<NodePtr<Stmt>>& statements) { for (const auto& s : statements) stmt(s); }
+
+    // (كل expression يُرجع عدد الـ nodes في الشجرة الفرعية)
+    size_t visitBinaryExpr(const BinaryExpr& e) override { return 1 + sub(e.left) + sub(e.right); }
+    size_t visitGroupingExpr(const GroupingExpr& e) override { return 1 + sub(e.expression); }
+    size_t visitLiteralExpr(const LiteralExpr&) override { return 1; }
+    size_t visitUnaryExpr(const UnaryExpr& e) override { return 1 + sub(e.right); }
+    size_t visitVariableExpr(const VariableExpr&) override { return 1; }
+    size_t visitAssignExpr(const AssignExpr& e) override { return 1 + sub(e.value); }
+    size_t visitCallExpr(const CallExpr& e) override {
+        size_t total = 1 + sub(e.callee);
+        for (const auto& argument : e.arguments) total += sub(argument);
+        return total;
+    }
+    size_t visitGetExpr(const GetExpr& e) override { return 1 + sub(e.object); }
+    size_t visitSetExpr(const SetExpr& e) override { return 1 + sub(e.object) + sub(e.value); }
+
+    void visitExpressionStmt(const ExpressionStmt& s) override { nodes++; expr(s.expression); }
+    void visitSummonStmt(const SummonStmt& s) override { nodes++; expr(s.expression); }
+    void visitDrawStmt(const DrawStmt&) override { nodes++; }
+    void visitVarDeclStmt(const VarDeclStmt& s) override { nodes++; expr(s.initializer); }
+    void visitBlockStmt(const BlockStmt& s) override { nodes++; count(s.statements); }
+    void visitIfStmt(const IfStmt& s) override { nodes++; expr(s.condition); stmt(s.thenBranch); stmt(s.elseBranch); }
+    void visitWhileStmt(const WhileStmt& s) override { nodes++; expr(s.condition); stmt(s.body); }
+    void visitFunctionStmt(const FunctionStmt& s) override { nodes++; stmt(s.body); }
+    void visitReturnStmt(const ReturnStmt& s) override { nodes++; expr(s.value); }
+    void visitClassStmt(const ClassStmt& s) override {
+        nodes++;
+        for (const auto& field : s.fields) stmt(field);
+        for (const auto& method : s.methods) stmt(method);
+    }
+    void visitStructStmt(const StructStmt& s) override { nodes++; for (const auto& field : s.fields) stmt(field); }
+    void visitIncludeStmt(const IncludeStmt&) override { nodes++; }
+    void visitUsingStmt(const UsingStmt&) override { nodes++; }
+
+private:
+    size_t sub(const NodePtr<Expr>& e) { return e ? visit(*e) : 0; }
+    void expr(const NodePtr<Expr>& e) { nodes += sub(e); }
+    template<typename T>
+    void stmt(const NodePtr<T>& s) { if (s) s->accept(*this); }
+};
+
+// (نفس العدّ عبر StaticVisitor: switch على الـ kind بدلاً من accept + visitXxx)
+class StaticNodeCounter : public StaticVisitor<StaticNodeCounter, size_t> {
+public:
+    size_t nodes = 0;
+
+    void count(const std::vector<NodePtr<Stmt>>& statements) { for (const auto& s : statements) stmt(s); }
+
+    size_t visitBinaryExpr(const BinaryExpr& e) { return 1 + sub(e.left) + sub(e.right); }
+    size_t visitGroupingExpr(const GroupingExpr& e) { return 1 + sub(e.expression); }
+    size_t visitLiteralExpr(const LiteralExpr&) { return 1; }
+    size_t visitUnaryExpr(const UnaryExpr& e) { return 1 + sub(e.right); }
+    size_t visitVariableExpr(const VariableExpr&) { return 1; }
+    size_t visitAssignExpr(const AssignExpr& e) { return 1 + sub(e.value); }
+    size_t visitCallExpr(const CallExpr& e) {
+        size_t total = 1 + sub(e.callee);
+        for (const auto& argument : e.arguments) total += sub(argument);
+        return total;
+    }
+    size_t visitGetExpr(const GetExpr& e) { return 1 + sub(e.object); }
+    size_t visitSetExpr(const SetExpr& e) { return 1 + sub(e.object) + sub(e.value); }
+
+    void visitExpressionStmt(const ExpressionStmt& s) { nodes++; expr(s.expression); }
+    void visitSummonStmt(const SummonStmt& s) { nodes++; expr(s.expression); }
+    void visitDrawStmt(const DrawStmt&) { nodes++; }
+    void visitVarDeclStmt(const VarDeclStmt& s) { nodes++; expr(s.initializer); }
+    void visitBlockStmt(const BlockStmt& s) { nodes++; count(s.statements); }
+    void visitIfStmt(const IfStmt& s) { nodes++; expr(s.condition); stmt(s.thenBranch); stmt(s.elseBranch); }
+    void visitWhileStmt(const WhileStmt& s) { nodes++; expr(s.condition); stmt(s.body); }
+    void visitFunctionStmt(const FunctionStmt& s) { nodes++; stmt(s.body); }
+    void visitReturnStmt(const ReturnStmt& s) { nodes++; expr(s.value); }
+    void visitClassStmt(const ClassStmt& s) {
+        nodes++;
+        for (const auto& field : s.fields) stmt(field);
+        for (const auto& method : s.methods) stmt(method);
+    }
+    void visitStructStmt(const StructStmt& s) { nodes++; for (const auto& field : s.fields) stmt(field); }
+    void visitIncludeStmt(const IncludeStmt&) { nodes++; }
+    void visitUsingStmt(const UsingStmt&) { nodes++; }
+
+private:
+    size_t sub(const NodePtr<Expr>& e) { return e ? visit(*e) : 0; }
+    void expr(const NodePtr<Expr>& e) { nodes += sub(e); }
+    template<typename T>
+    void stmt(const NodePtr<T>& s) { if (s) visit(static_cast<const Stmt&>(*s)); }
+};
+
+// (نفس العدّ على الـ Flat AST: switch على نوع الـ handle بدلاً من virtual call)
+struct FlatCounter {
+    const flat::FlatAst& ast;
+    size_t nodes = 0;
+
+    void list(flat::Range range) {
+        for (uint32_t i = 0; i < range.count; ++i) stmt(ast.stmtLists[range.first + i]);
+    }
+
+    void expr(flat::ExprRef ref) {
+        if (!ref.valid()) return;
+        nodes++;
+        uint32_t i = ref.index();
+        switch (ref.kind()) {
+            case flat::ExprKind::Binary: expr(ast.binaries[i].left); expr(ast.binaries[i].right); break;
+            case flat::ExprKind::Grouping: expr(ast.groupings[i].expression); break;
+            case flat::ExprKind::Unary: expr(ast.unaries[i].right); break;
+            case flat::ExprKind::Assign: expr(ast.assigns[i].value); break;
+            case flat::ExprKind::Call: {
+                expr(ast.calls[i].callee);
+                flat::Range arguments = ast.calls[i].arguments;
+                for (uint32_t a = 0; a < arguments.count; ++a) expr(ast.exprLists[arguments.first + a]);
+                break;
+            }
+            case flat::ExprKind::Get: expr(ast.gets[i].object); break;
+            case flat::ExprKind::Set: expr(ast.sets[i].object); expr(ast.sets[i].value); break;
+            case flat::ExprKind::Literal:
+            case flat::ExprKind::Variable: break;
+        }
+    }
+
+    void stmt(flat::StmtRef ref) {
+        if (!ref.valid()) return;
+        nodes++;
+        uint32_t i = ref.index();
+        switch (ref.kind()) {
+            case flat::StmtKind::Expression: expr(ast.expressions[i].expression); break;
+            case flat::StmtKind::Summon: expr(ast.summons[i].expression); break;
+            case flat::StmtKind::VarDecl: expr(ast.varDecls[i].initializer); break;
+            case flat::StmtKind::Block: list(ast.blocks[i].statements); break;
+            case flat::StmtKind::If:
+                expr(ast.ifs[i].condition); stmt(ast.ifs[i].thenBranch); stmt(ast.ifs[i].elseBranch);
+                break;
+            case flat::StmtKind::While: expr(ast.whiles[i].condition); stmt(ast.whiles[i].body); break;
+            case flat::StmtKind::Function: stmt(ast.functions[i].body); break;
+            case flat::StmtKind::Return: expr(ast.returns[i].value); break;
+            case flat::StmtKind::Class: list(ast.classes[i].fields); list(ast.classes[i].methods); break;
+            case flat::StmtKind::Struct: list(ast.structs[i].fields); break;
+            case flat::StmtKind::Draw:
+            case flat::StmtKind::Include:
+            case flat::StmtKind::Using: break;
+        }
+    }
+};
+
+inline int flatAst() {
+    std::string source = nodeHeavyCorpus(20000);
+    CompilationUnit unit("<bench>", source);
+    TokenBuffer tokens = scanPacked(unit.text());
+
+    alloc_stats::Snapshot before = alloc_stats::snapshot();
+    Parser parser(tokens, unit.getArena());
+    std::vector<NodePtr<Stmt>> statements = parser.parse();
+    size_t treeBytes = (alloc_stats::snapshot() - before).bytes;
+
+    auto start = Clock::now();
+    flat::FlatAst ast = flat::flatten(statements, tokens);
+    double flattenTime = secondsSince(start);
+
+    const int rounds = 10;
+    NodeCounter treeCounter;
+    start = Clock::now();
+    for (int r = 0; r < rounds; ++r) treeCounter.count(statements);
+    double treeWalk = secondsSince(start) / rounds;
+    // (عدد الـ nodes الحية؛ الـ arena تعدّ أيضاً الـ GetExpr الذي يتحول إلى SetExpr عند الـ assignment)
+    size_t treeNodes = treeCounter.nodes / rounds;
+
+    FlatCounter flatCounter{ast};
+    start = Clock::now();
+    for (int r = 0; r < rounds; ++r) flatCounter.list(ast.roots);
+    double flatWalk = secondsSince(start) / rounds;
+
+    start = Clock::now();
+    flat::FlatAst copy = ast;
+    double cloneTime = secondsSince(start);
+    keep(copy);
+
+    std::cout << "flatast: " << treeNodes << " nodes (node-heavy corpus)" << std::endl;
+    std::cout << "  tree : " << treeBytes << " bytes (" << double(treeBytes) / treeNodes << " B/node), walk "
+              << treeWalk * 1e3 << " ms" << std::endl;
+    std::cout << "  flat : " << ast.bytes() << " bytes (" << double(ast.bytes()) / ast.nodeCount() << " B/node), walk "
+              << flatWalk * 1e3 << " ms, flatten " << flattenTime * 1e3 << " ms, clone " << cloneTime * 1e3 << " ms"
+              << std::endl;
+    std::cout << "  memory " << double(treeBytes) / ast.bytes() << "x smaller, walk " << treeWalk / flatWalk
+              << "x faster" << std::endl;
+
+    if (ast.nodeCount() != treeNodes || treeCounter.nodes != flatCounter.nodes) {
+        std::cout << "  MISMATCH: " << treeNodes << " tree nodes, " << ast.nodeCount() << " flat nodes" << std::endl;
+        return 1;
+    }
+    return 0;
+}
+
+// --- visitor: سرعة الـ visitors على شجرة كثيفة بالتعبيرات ---
+// (الطباعة تبني نتيجة std::string لكل expression، والعدّ نتيجة رقمية فقط)
+
+// (كل الـ expressions الجذرية في البرنامج، لتمريرها على الـ visitors التالية)
+class ExprRoots : public StmtVisitor<void> {
+public:
+    std::vector<const Expr*> roots;
+
+    void collect(const std::vector<NodePtr<Stmt>>& statements) { for (const auto& s : statements) stmt(s); }
+
+    void visitExpressionStmt(const ExpressionStmt& s) override { expr(s.expression); }
+    void visitSummonStmt(const SummonStmt& s) override { expr(s.expression); }
+    void visitDrawStmt(const DrawStmt&) override {}
+    void visitVarDeclStmt(const VarDeclStmt& s) override { expr(s.initializer); }
+    void visitBlockStmt(const BlockStmt& s) override { collect(s.statements); }
+    void visitIfStmt(const IfStmt& s) override { expr(s.condition); stmt(s.thenBranch); stmt(s.elseBranch); }
+    void visitWhileStmt(const WhileStmt& s) override { expr(s.condition); stmt(s.body); }
+    void visitFunctionStmt(const FunctionStmt& s) override { stmt(s.body); }
+    void visitReturnStmt(const ReturnStmt& s) override { expr(s.value); }
+    void visitClassStmt(const ClassStmt& s) override {
+        for (const auto& field : s.fields) stmt(field);
+        for (const auto& method : s.methods) stmt(method);
+    }
+    void visitStructStmt(const StructStmt& s) override { for (const auto& field : s.fields) stmt(field); }
+    void visitIncludeStmt(const IncludeStmt&) override {}
+    void visitUsingStmt(const UsingStmt&) override {}
+
+private:
+    void expr(const NodePtr<Expr>& e) { if (e) roots.push_back(e.get()); }
+    template<typename T>
+    void stmt(const NodePtr<T>& s) { if (s) s->accept(*this); }
+};
+
+// نفس الـ visitor مرتين: R = std::any هو المسار القديم (كل نتيجة تُغلَّف ثم any_cast،
+// والـ literal قيمة std::any تُفحص بـ type())؛ R = النوع الحقيقي هو المسار الحالي.
+template<typename R, typename T>
+inline T unwrap(R&& result) {
+    if constexpr (std::is_same_v<std::decay_t<R>, std::any>) return std::any_cast<T>(std::move(result));
+    else return std::move(result);
+}
+
+template<typename R>
+class ExprCounter : public ExprVisitor<R> {
+public:
+    size_t count(const Expr& e) { return unwrap<R, size_t>(this->visit(e)); }
+
+    R visitBinaryExpr(const BinaryExpr& e) override { return 1 + sub(e.left) + sub(e.right); }
+    R visitGroupingExpr(const GroupingExpr& e) override { return 1 + sub(e.expression); }
+    R visitLiteralExpr(const LiteralExpr&) override { return size_t(1); }
+    R visitUnaryExpr(const UnaryExpr& e) override { return 1 + sub(e.right); }
+    R visitVariableExpr(const VariableExpr&) override { return size_t(1); }
+    R visitAssignExpr(const AssignExpr& e) override { return 1 + sub(e.value); }
+    R visitCallExpr(const CallExpr& e) override {
+        size_t total = 1 + sub(e.callee);
+        for (const auto& argument : e.arguments) total += sub(argument);
+        return total;
+    }
+    R visitGetExpr(const GetExpr& e) override { return 1 + sub(e.object); }
+    R visitSetExpr(const SetExpr& e) override { return 1 + sub(e.object) + sub(e.value); }
+
+private:
+    size_t sub(const NodePtr<Expr>& e) { return e ? count(*e) : 0; }
+};
+
+template<typename R>
+class ExprText : public ExprVisitor<R> {
+public:
+    std::string text(const Expr& e) { return unwrap<R, std::string>(this->visit(e)); }
+
+    R visitBinaryExpr(const BinaryExpr& e) override { return wrap(e.op.lexeme, {e.left.get(), e.right.get()}); }
+    R visitGroupingExpr(const GroupingExpr& e) override { return wrap("group", {e.expression.get()}); }
+    R visitLiteralExpr(const LiteralExpr& e) override {
+        if constexpr (std::is_same_v<R, std::any>) return literal(boxed(e.value));
+        else return literal(e.value);
+    }
+    R visitUnaryExpr(const UnaryExpr& e) override { return wrap(e.op.lexeme, {e.right.get()}); }
+    R visitVariableExpr(const VariableExpr& e) override { return std::string(e.name.lexeme); }
+    R visitAssignExpr(const AssignExpr& e) override { return wrap("= " + std::string(e.name.lexeme), {e.value.get()}); }
+    R visitCallExpr(const CallExpr& e) override {
+        std::vector<const Expr*> parts;
+        for (const auto& argument : e.arguments) parts.push_back(argument.get());
+        return wrap("call " + text(*e.callee), parts);
+    }
+    R visitGetExpr(const GetExpr& e) override { return wrap("." + std::string(e.name.lexeme), {e.object.get()}); }
+    R visitSetExpr(const SetExpr& e) override {
+        return wrap("set ." + std::string(e.name.lexeme), {e.object.get(), e.value.get()});
+    }
+
+private:
+    std::string wrap(std::string_view name, const std::vector<const Expr*>& parts) {
+        std::string out = "(" + std::string(name);
+        for (const Expr* part : parts) out += " " + text(*part);
+        return out + ")";
+    }
+
+    // (الـ LiteralExpr القديم كان يخزن std::any: double أو std::string أو bool أو لا شيء)
+    static std::any boxed(const Value& value) {
+        switch (value.type) {
+            case Value::Type::INT: return double(value.asInt);
+            case Value::Type::DOUBLE: return value.asDouble;
+            case Value::Type::STRING: return std::string(value.stringValue());
+            case Value::Type::BOOL: return value.asBool;
+            default: return {};
+        }
+    }
+    static std::string literal(const std::any& value) {
+        if (value.type() == typeid(std::string)) return "\"" + std::any_cast<const std::string&>(value) + "\"";
+        if (value.type() == typeid(double)) return number(std::any_cast<double>(value));
+        if (value.type() == typeid(bool)) return std::any_cast<bool>(value) ? "true" : "false";
+        return "nil";
+    }
+    static std::string literal(const Value& value) {
+        switch (value.type) {
+            case Value::Type::INT: return number(double(value.asInt));
+            case Value::Type::DOUBLE: return number(value.asDouble);
+            case Value::Type::STRING: return "\"" + std::string(value.stringValue()) + "\"";
+            case Value::Type::BOOL: return value.asBool ? "true" : "false";
+            default: return "nil";
+        }
+    }
+    static std::string number(double value) {
+        std::string text = std::to_string(value);
+        text.erase(text.find_last_not_of('0') + 1, std::string::npos);
+        if (text.back() == '.') text.pop_back();
+        return text;
+    }
+};
+
+inline int visitorThroughput() {
+    std::string source = expressionDenseCorpus(20000);
+    CompilationUnit unit("<bench>", source);
+    TokenBuffer tokens = scanPacked(unit.text());
+    Parser parser(tokens, unit.getArena());
+    std::vector<NodePtr<Stmt>> statements = parser.parse();
+    const int rounds = 5;
+
+    NodeCounter counter;
+    auto start = Clock::now();
+    for (int r = 0; r < rounds; ++r) counter.count(statements);
+    double countTime = secondsSince(start) / rounds;
+    size_t nodes = counter.nodes / rounds;
+
+    // (المخرجات إلى stream بدون buffer حتى نقيس الـ visitor وليس الـ terminal)
+    std::ostringstream sink;
+    std::streambuf* console = std::cout.rdbuf(sink.rdbuf());
+    start = Clock::now();
+    for (int r = 0; r < rounds; ++r) {
+        AstPrinter().print(statements);
+        sink.str({});
+    }
+    double printTime = secondsSince(start) / rounds;
+    std::cout.rdbuf(console);
+
+    std::cout << "visitor: " << nodes << " nodes (expression-dense corpus)" << std::endl;
+    std::cout << "  count : " << countTime * 1e3 << " ms (" << nodes / countTime / 1e6 << " M nodes/s)" << std::endl;
+    std::cout << "  print : " << printTime * 1e3 << " ms (" << nodes / printTime / 1e6 << " M nodes/s)" << std::endl;
+
+    // --- baseline: نفس الـ expressions عبر ExprVisitor<std::any> مقابل ExprVisitor<نتيجة حقيقية> ---
+    ExprRoots roots;
+    roots.collect(statements);
+    size_t exprNodes = 0, anyNodes = 0, textSize = 0, anyTextSize = 0;
+    bool sameText = true;
+
+    auto timed = [&](auto&& body) {
+        auto begin = Clock::now();
+        for (int r = 0; r < rounds; ++r) body();
+        return secondsSince(begin) / rounds;
+    };
+    double anyCount = timed([&] {
+        ExprCounter<std::any> visitor;
+        anyNodes = 0;
+        for (const Expr* e : roots.roots) anyNodes += visitor.count(*e);
+    });
+    double typedCount = timed([&] {
+        ExprCounter<size_t> visitor;
+        exprNodes = 0;
+        for (const Expr* e : roots.roots) exprNodes += visitor.count(*e);
+    });
+    std::vector<std::string> anyTexts(roots.roots.size()), texts(roots.roots.size());
+    double anyPrint = timed([&] {
+        ExprText<std::any> visitor;
+        for (size_t i = 0; i < roots.roots.size(); ++i) anyTexts[i] = visitor.text(*roots.roots[i]);
+    });
+    double typedPrint = timed([&] {
+        ExprText<std::string> visitor;
+        for (size_t i = 0; i < roots.roots.size(); ++i) texts[i] = visitor.text(*roots.roots[i]);
+    });
+    for (size_t i = 0; i < texts.size(); ++i) {
+        textSize += texts[i].size();
+        anyTextSize += anyTexts[i].size();
+        sameText = sameText && texts[i] == anyTexts[i];
+    }
+
+    std::cout << "  expressions only (" << exprNodes << " nodes, same virtual dispatch, result type differs):" << std::endl;
+    std::cout << "    count std::any (old): " << anyCount * 1e3 << " ms, typed: " << typedCount * 1e3 << " ms ("
+              << anyCount / typedCount << "x)" << std::endl;
+    std::cout << "    print std::any (old): " << anyPrint * 1e3 << " ms, typed: " << typedPrint * 1e3 << " ms ("
+              << anyPrint / typedPrint << "x)" << std::endl;
+    if (anyNodes != exprNodes || !sameText || textSize != anyTextSize) {
+        std::cout << "  std::any and typed visitors disagree" << std::endl;
+        return 1;
+    }
+    return 0;
+}
+
+// --- dispatch: accept + visitXxx (virtual) مقابل StaticVisitor (switch) مقابل الـ Flat AST ---
+// شجرة صغيرة تبقى في الـ cache حتى نقيس الـ dispatch نفسه وليس الذاكرة؛
+// أفضل زمن من عدة محاولات لتقليل الضجيج.
+inline int dispatchCost() {
+    std::string source = expressionDenseCorpus(200);
+    CompilationUnit unit("<bench>", source);
+    TokenBuffer tokens = scanPacked(unit.text());
+    Parser parser(tokens, unit.getArena());
+    std::vector<NodePtr<Stmt>> statements = parser.parse();
+    flat::FlatAst ast = flat::flatten(statements, tokens);
+    const int trials = 7, rounds = 200;
+
+    auto best = [&](auto walk) {
+        double fastest = 1e30;
+        for (int t = 0; t < trials; ++t) {
+            auto start = Clock::now();
+            for (int r = 0; r < rounds; ++r) walk();
+            fastest = std::min(fastest, secondsSince(start) / rounds);
+        }
+        return fastest;
+    };
+
+    NodeCounter virtualCounter;
+    StaticNodeCounter staticCounter;
+    FlatCounter flatCounter{ast};
+    double virtualTime = best([&] { virtualCounter.count(statements); });
+    double staticTime = best([&] { staticCounter.count(statements); });
+    double flatTime = best([&] { flatCounter.list(ast.roots); });
+
+    size_t walks = size_t(trials) * rounds;
+    size_t nodes = virtualCounter.nodes / walks;
+    auto line = [&](const char* name, double time) {
+        std::cout << "  " << name << time * 1e6 << " us/walk (" << time * 1e9 / nodes << " ns/node, "
+                  << virtualTime / time << "x)" << std::endl;
+    };
+    std::cout << "dispatch: " << nodes << " nodes, best of " << trials << " x " << rounds << " walks" << std::endl;
+    line("virtual (accept + visit) : ", virtualTime);
+    line("static (kind switch)     : ", staticTime);
+    line("flat (handle switch)     : ", flatTime);
+
+    if (staticCounter.nodes / walks != nodes || flatCounter.nodes / walks != nodes) {
+        std::cout << "  MISMATCH: " << nodes << " / " << staticCounter.nodes / walks << " / "
+                  << flatCounter.nodes / walks << " nodes" << std::endl;
+        return 1;
+    }
+    return 0;
+}
+
+// --- astcache: compile بارد (Scanner + Parser + كتابة) مقابل دافئ (mmap + تحميل) ---
+// ثم نتأكد أن كل ملف تالف أو قديم يُكتشف: bytes عشوائية، ملف مقطوع، نسخة أخرى،
+// ملف source آخر، ومئات التعديلات العشوائية مع checksum صحيح (الـ Validator وحده).
+inline int astCache() {
+    const std::string path = "/tmp/duelscript-astcache.duelscript";
+    const std::string directory = "/tmp/duelscript-astcache";
+    {
+        std::ofstream out(path, std::ios::binary);
+        out << nodeHeavyCorpus(20000);
+    }
+    std::filesystem::remove_all(directory);
+    AstCache cache(directory);
+    const int rounds = 5;
+
+    double coldTime = 0, warmTime = 0, loadTime = 0;
+    size_t nodes = 0, bytes = 0;
+    std::string cachePath;
+    for (int r = 0; r < rounds; ++r) {
+        std::filesystem::remove_all(directory);
+        {
+            auto start = Clock::now();
+            CompilationUnit unit(path, *SourceBuffer::fromFile(path));
+            uint64_t key = AstCache::hash(unit.text());
+            TokenBuffer tokens = scanPacked(unit.text());
+            Parser parser(tokens, unit.getArena());
+            std::vector<NodePtr<Stmt>> statements = parser.parse();
+            bytes = cache.store(key, unit.text(), tokens, flat::flatten(statements, tokens));
+            coldTime += secondsSince(start);
+            cachePath = cache.pathFor(key);
+        }
+        {
+            auto start = Clock::now();
+            CompilationUnit unit(path, *SourceBuffer::fromFile(path));
+            uint64_t key = AstCache::hash(unit.text());
+            std::optional<TokenBuffer> tokens;
+            flat::FlatAst ast;
+            if (cache.load(key, unit.text(), tokens, ast) != AstCache::Status::HIT) {
+                std::cout << "astcache: warm load missed" << std::endl;
+                return 1;
+            }
+            loadTime += secondsSince(start);
+            std::vector<NodePtr<Stmt>> statements = flat::expand(ast, unit.getArena());
+            warmTime += secondsSince(start);
+            nodes = unit.getArena().nodeCount();
+        }
+    }
+    coldTime /= rounds;
+    warmTime /= rounds;
+    loadTime /= rounds;
+
+    std::cout << "astcache: " << nodes << " nodes, cache file " << bytes << " bytes" << std::endl;
+    std::cout << "  cold (scan + parse + store)  : " << coldTime * 1e3 << " ms" << std::endl;
+    std::cout << "  warm (load, flat AST only)   : " << loadTime * 1e3 << " ms (" << coldTime / loadTime << "x)"
+              << std::endl;
+    std::cout << "  warm (load + expand to tree) : " << warmTime * 1e3 << " ms (" << coldTime / warmTime << "x)"
+              << std::endl;
+
+    // --- الملفات التالفة / القديمة ---
+    std::string original;
+    {
+        std::ifstream in(cachePath, std::ios::binary);
+        original.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+    }
+    CompilationUnit unit(path, *SourceBuffer::fromFile(path));
+    uint64_t key = AstCache::hash(unit.text());
+    auto loadWith = [&](const std::string& contents) {
+        {
+            std::ofstream out(cachePath, std::ios::binary | std::ios::trunc);
+            out << contents;
+        }
+        std::optional<TokenBuffer> tokens;
+        flat::FlatAst ast;
+        AstCache::Status status = cache.load(key, unit.text(), tokens, ast);
+        if (status == AstCache::Status::HIT) {
+            // (ملف معدَّل لكنه سليم بنيوياً: يجب أن يُبنى ويُطبع بدون أي crash)
+            AstArena arena;
+            std::vector<NodePtr<Stmt>> statements = flat::expand(ast, arena);
+            std::ostringstream sink;
+            std::streambuf* console = std::cout.rdbuf(sink.rdbuf());
+            AstPrinter().print(statements);
+            std::cout.rdbuf(console);
+        }
+        return status;
+    };
+
+    bool ok = true;
+    auto expect = [&](const char* name, AstCache::Status got, AstCache::Status wanted) {
+        std::cout << "  " << name << AstCache::statusName(got) << std::endl;
+        ok = ok && got == wanted;
+    };
+
+    std::string flipped = original;
+    flipped[flipped.size() / 2] ^= 0x40;
+    expect("flipped byte      : ", loadWith(flipped), AstCache::Status::CORRUPT);
+    expect("truncated file    : ", loadWith(original.substr(0, original.size() - 100)), AstCache::Status::CORRUPT);
+    std::string versioned = original;
+    versioned[8] ^= 0x7f; // (أول حقل بعد الـ magic: FORMAT_VERSION)
+    expect("other version     : ", loadWith(versioned), AstCache::Status::STALE);
+    {
+        // (ملف cache لـ source آخر منسوخ تحت هذا الاسم)
+        CompilationUnit other("<other>", nodeHeavyCorpus(10));
+        TokenBuffer tokens = scanPacked(other.text());
+        Parser parser(tokens, other.getArena());
+        AstCache otherCache(directory + "-other");
+        uint64_t otherKey = AstCache::hash(other.text());
+        otherCache.store(otherKey, other.text(), tokens, flat::flatten(parser.parse(), tokens));
+        std::ifstream in(otherCache.pathFor(otherKey), std::ios::binary);
+        std::string otherFile((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+        expect("other source      : ", loadWith(otherFile), AstCache::Status::STALE);
+        std::filesystem::remove_all(directory + "-other");
+    }
+    expect("original          : ", loadWith(original), AstCache::Status::HIT);
+
+    std::mt19937 random(18);
+    int corrupt = 0, survived = 0;
+    const int mutations = 300;
+    for (int m = 0; m < mutations; ++m) {
+        std::string mutated = original;
+        for (int b = 0; b < 4; ++b) mutated[128 + random() % (mutated.size() - 128)] = char(random());
+        AstCache::reseal(mutated);
+        (loadWith(mutated) == AstCache::Status::CORRUPT ? corrupt : survived)++;
+    }
+    std::cout << "  resealed mutations: " << corrupt << " rejected by the validator, " << survived
+              << " structurally valid (loaded and printed safely)" << std::endl;
+
+    std::filesystem::remove_all(directory);
+    std::remove(path.c_str());
+    return ok ? 0 : 1;
+}
+
+// --- modules: تحميل #SetField بالتوازي مع منع التكرار ---
+// root -> 32 feature modules -> 16 shared modules (diamonds) -> core واحد يطلبه الجميع
+inline int moduleLoading() {
+    const std::string directory = "/tmp/duelscript-modules";
+    const int features = 32, shared = 16, rituals = 300;
+    std::filesystem::remove_all(directory);
+    std::filesystem::create_directories(directory + "/lib");
+    auto write = [&](const std::string& name, const std::string& includes) {
+        std::ofstream out(directory + "/" + name + ".duelscript", std::ios::binary);
+        out << includes << nodeHeavyCorpus(rituals);
+    };
+
+    std::string rootIncludes;
+    for (int f = 0; f < features; ++f) {
+        std::string includes = "#SetField \"core\";\n";
+        for (int k = 0; k < 4; ++k) includes += "#SetField \"shared" + std::to_string((f * 3 + k) % shared) + "\";\n";
+        write("lib/feature" + std::to_string(f), includes);
+        rootIncludes += "#SetField \"feature" + std::to_string(f) + "\";\n";
+    }
+    for (int s = 0; s < shared; ++s) write("lib/shared" + std::to_string(s), "#SetField \"core\";\n");
+    write("lib/core", "#SetField \"../main\";\n"); // (cycle يعود إلى الـ root)
+    write("main", rootIncludes);
+
+    const std::string rootPath = directory + "/main.duelscript";
+    CompilationUnit unit(rootPath, *SourceBuffer::fromFile(rootPath));
+    TokenBuffer tokens = scanPacked(unit.text());
+    Parser parser(tokens, unit.getArena());
+    std::vector<NodePtr<Stmt>> statements = parser.parse();
+    const int rounds = 3;
+    std::vector<std::string> expected;
+
+    auto measure = [&](ThreadPool& pool, std::vector<std::string>* printed) {
+        double total = 0;
+        for (int r = 0; r < rounds; ++r) {
+            Diagnostics diagnostics;
+            ModuleLoader loader({directory + "/lib"}, pool);
+            auto start = Clock::now();
+            bool ok = loader.load(rootPath, statements, diagnostics);
+            total += secondsSince(start);
+            if (!ok) return -1.0;
+            if (printed && r == 0) {
+                for (const auto& module : loader.getModules()) printed->push_back(printedAst(module->statements));
+                std::set<std::string> paths;
+                for (const auto& module : loader.getModules()) paths.insert(module->path);
+                if (printed == &expected) std::cout << "modules: " << loader.moduleCount() << " modules (" << paths.size() << " unique files), "
+                          << loader.edgeCount() << " includes, " << rituals << " rituals each" << std::endl;
+                if (paths.size() != loader.moduleCount() || loader.moduleCount() != size_t(2 + features + shared)) {
+                    return -1.0;
+                }
+            }
+        }
+        return total / rounds;
+    };
+
+    int status = 0;
+    ThreadPool single(1);
+    measure(single, nullptr); // (warm-up: الملفات في الـ page cache قبل القياس)
+    double sequential = measure(single, &expected);
+    if (sequential < 0) {
+        std::cout << "modules: loading failed or a module was loaded twice" << std::endl;
+        return 1;
+    }
+    std::cout << "  1 thread    : " << sequential * 1e3 << " ms" << std::endl;
+
+    std::vector<std::string> printed;
+    double parallel = measure(ThreadPool::shared(), &printed);
+    bool same = parallel >= 0 && printed == expected;
+    std::printf("  %2u threads  : %.1f ms, speedup %.2fx%s\n", ThreadPool::shared().size(), parallel * 1e3,
+                sequential / parallel, same ? "" : "  <-- AST MISMATCH");
+    if (!same) status = 1;
+
+    // ترتيب التنفيذ: root يطلب a ثم b، و b يطلب a ويستخدم قيمته في initializer
+    // (الاثنان في نفس مستوى الـ BFS، فـ a يجب أن يأتي قبل b من الـ includes وليس من الـ ids)
+    std::filesystem::create_directories(directory + "/order");
+    std::ofstream(directory + "/order/a.duelscript", std::ios::binary)
+            << "DarkMagician base = 10;\nRitual Twice(DarkMagician n) { Tribute n * 2; }\n";
+    std::ofstream(directory + "/order/b.duelscript", std::ios::binary)
+            << "#SetField \"a\";\nDarkMagician derived = Twice(base) + 1;\n";
+    const std::string orderRoot = directory + "/order/root.duelscript";
+    std::ofstream(orderRoot, std::ios::binary)
+            << "#SetField \"a\";\n#SetField \"b\";\nRitual Yugi() { Summon << derived; }\n";
+    {
+        CompilationUnit rootUnit(orderRoot, *SourceBuffer::fromFile(orderRoot));
+        TokenBuffer rootTokens = scanPacked(rootUnit.text());
+        Diagnostics diagnostics;
+        Parser rootParser(rootTokens, rootUnit.getArena(), &diagnostics);
+        std::vector<NodePtr<Stmt>> rootStatements = rootParser.parse();
+        ModuleLoader loader({}, ThreadPool::shared());
+        std::string interpreted = "<not run>", compiled = "<not run>";
+        if (loader.load(orderRoot, rootStatements, diagnostics)) {
+            std::vector<Resolver::Unit> units;
+            for (size_t id : loader.initializationOrder()) {
+                units.push_back({&loader.getModules()[id]->statements, &loader.getModules()[id]->diagnostics});
+            }
+            units.push_back({&rootStatements, &diagnostics});
+            ResolvedProgram program;
+            BytecodeProgram bytecode;
+            if (Resolver().resolve(units, program) && BytecodeCompiler(diagnostics).compile(program, bytecode)) {
+                std::ostringstream viaInterpreter, viaVm;
+                Interpreter(program, diagnostics, viaInterpreter).run();
+                VM(bytecode, diagnostics, viaVm).run();
+                interpreted = viaInterpreter.str();
+                compiled = viaVm.str();
+            }
+        }
+        bool ordered = interpreted == "21" && compiled == "21";
+        std::cout << "  include order : derived = " << interpreted << " (interp), " << compiled << " (vm)"
+                  << (ordered ? "" : "  <-- expected 21: a must initialize before b") << std::endl;
+        if (!ordered) status = 1;
+    }
+
+    std::filesystem::remove_all(directory);
+    return status;
+}
+
+// --- interp: الـ Interpreter على scripts كثيفة الاستدعاءات والحلقات ---
+// كل script يطبع نتيجة معروفة مسبقاً، فالـ benchmark يتحقق من صحة التنفيذ أيضاً.
+struct ScriptCase {
+    const char* name;
+    const char* unit; // (ماذا نعدّ: calls / iterations)
+    double work;
+    std::string source;
+    std::string expected;
+};
+
+inline std::vector<ScriptCase> interpreterScripts() {
+    return {
+        {"calls (Fib 25)", "calls", 242785,
+         "Ritual Fib(DarkMagician n) {\n"
+         "    JudgmentOfAnubis (n < 2) Tribute n;\n"
+         "    Tribute Fib(n - 1) + Fib(n - 2);\n"
+         "}\n"
+         "Ritual Yugi() { Summon << Fib(25); }\n",
+         "75025"},
+        {"loops (1000 x 1000)", "iterations", 1e6,
+         "Ritual Yugi() {\n"
+         "    DarkMagician total = 0;\n"
+         "    DarkMagician i = 0;\n"
+         "    FairyBox (i < 1000) {\n"
+         "        DarkMagician j = 0;\n"
+         "        FairyBox (j < 1000) { total = total + i * j - j; j = j + 1; }\n"
+         "        i = i + 1;\n"
+         "    }\n"
+         "    Summon << total;\n"
+         "}\n",
+         "249000750000"},
+        {"methods + fields", "calls", 200000,
+         "ToonWorld Stats { DarkMagician attack = 1200; };\n"
+         "LordOfD Duelist {\n"
+         "    DarkMagician lifePoints = 0;\n"
+         "    Stats stats;\n"
+         "    Ritual TakeDamage(DarkMagician damage) { lifePoints = lifePoints - damage + stats.attack / 600; }\n"
+         "};\n"
+         "Ritual Yugi() {\n"
+         "    Duelist player;\n"
+         "    DarkMagician turn = 0;\n"
+         "    FairyBox (turn < 200000) {\n"
+         "        JudgmentOfAnubis (player.stats.attack > 1000) player.TakeDamage(3);\n"
+         "        turn = turn + 1;\n"
+         "    }\n"
+         "    Summon << player.lifePoints;\n"
+         "}\n",
+         "-200000"},
+    };
+}
+
+inline int interpreterThroughput() {
+    int status = 0;
+    const int rounds = 3;
+    for (const ScriptCase& script : interpreterScripts()) {
+        CompilationUnit unit("<bench>", script.source);
+        TokenBuffer tokens = scanPacked(unit.text());
+        Diagnostics diagnostics;
+        Parser parser(tokens, unit.getArena(), &diagnostics);
+        std::vector<NodePtr<Stmt>> statements = parser.parse();
+        ResolvedProgram program;
+        Resolver resolver;
+        if (parser.hadError || !resolver.resolve({{&statements, &diagnostics}}, program)) {
+            diagnostics.emit(std::cerr);
+            return 1;
+        }
+
+        double best = 1e9;
+        std::string printed;
+        for (int r = 0; r < rounds; ++r) {
+            std::ostringstream out;
+            Interpreter interpreter(program, diagnostics, out);
+            auto start = Clock::now();
+            bool ok = interpreter.run();
+            best = std::min(best, secondsSince(start));
+            printed = ok ? out.str() : "<runtime error>";
+        }
+        bool same = printed == script.expected;
+        std::printf("interp %-20s: %8.2f ms, %6.1f M %s/s%s\n", script.name, best * 1e3,
+                    script.work / best / 1e6, script.unit, same ? "" : "  <-- WRONG OUTPUT");
+        if (!same) {
+            std::cout << "  got: " << printed << ", expected: " << script.expected << std::endl;
+            status = 1;
+        }
+    }
+    return status;
+}
+
+// --- vm: نفس البرامج على الـ Interpreter وعلى الـ Bytecode VM، جنباً إلى جنب ---
+// (الـ scripts الخاصة بالـ interp مع حلقة حسابية مختلطة وحلقة كلها تفرعات)
+inline std::vector<ScriptCase> vmScripts() {
+    std::vector<ScriptCase> scripts = interpreterScripts();
+    scripts.push_back({"arithmetic (mixed)", "iterations", 1e6,
+                       "Ritual Yugi() {\n"
+                       "    BlueEyesWhiteDragon x = 0.5;\n"
+                       "    DarkMagician acc = 7;\n"
+                       "    DarkMagician i = 0;\n"
+                       "    FairyBox (i < 1000000) {\n"
+                       "        x = x * 0.999 + i / 1000000.0;\n"
+                       "        acc = (acc * 3 + i) / 4 - acc / 5;\n"
+                       "        i = i + 1;\n"
+                       "    }\n"
+                       "    Summon << x << \" \" << acc;\n"
+                       "}\n",
+                       "999 555555"});
+    scripts.push_back({"branching", "iterations", 1e6,
+                       "Ritual Yugi() {\n"
+                       "    DarkMagician i = 0;\n"
+                       "    DarkMagician a = 0;\n"
+                       "    DarkMagician b = 0;\n"
+                       "    DarkMagician c = 0;\n"
+                       "    FairyBox (i < 1000000) {\n"
+                       "        DarkMagician m = i - i / 3 * 3;\n"
+                       "        JudgmentOfAnubis (m == 0) a = a + 1;\n"
+                       "        SolemnJudgment JudgmentOfAnubis (m == 1) b = b + 1;\n"
+                       "        SolemnJudgment c = c + 1;\n"
+                       "        i = i + 1;\n"
+                       "    }\n"
+                       "    Summon << a << \" \" << b << \" \" << c;\n"
+                       "}\n",
+                       "333334 333333 333333"});
+    return scripts;
+}
+
+inline int vmThroughput() {
+    int status = 0;
+    const int rounds = 3;
+    for (const ScriptCase& script : vmScripts()) {
+        CompilationUnit unit("<bench>", script.source);
+        TokenBuffer tokens = scanPacked(unit.text());
+        Diagnostics diagnostics;
+        Parser parser(tokens, unit.getArena(), &diagnostics);
+        std::vector<NodePtr<Stmt>> statements = parser.parse();
+        ResolvedProgram program;
+        Resolver resolver;
+        BytecodeProgram bytecode;
+        BytecodeCompiler compiler(diagnostics);
+        if (parser.hadError || !resolver.resolve({{&statements, &diagnostics}}, program) ||
+            !compiler.compile(program, bytecode)) {
+            diagnostics.emit(std::cerr);
+            return 1;
+        }
+
+        double interpBest = 1e9, vmBest = 1e9;
+        std::string interpPrinted, vmPrinted;
+        for (int r = 0; r < rounds; ++r) {
+            std::ostringstream out;
+            Interpreter interpreter(program, diagnostics, out);
+            auto start = Clock::now();
+            bool ok = interpreter.run();
+            interpBest = std::min(interpBest, secondsSince(start));
+            interpPrinted = ok ? out.str() : "<runtime error>";
+        }
+        for (int r = 0; r < rounds; ++r) {
+            std::ostringstream out;
+            VM vm(bytecode, diagnostics, out); // (الـ stack يُحجز هنا، خارج القياس)
+            auto start = Clock::now();
+            bool ok = vm.run();
+            vmBest = std::min(vmBest, secondsSince(start));
+            vmPrinted = ok ? out.str() : "<runtime error>";
+        }
+        bool same = interpPrinted == script.expected && vmPrinted == script.expected;
+        std::printf("%-20s: interp %8.2f ms, vm %8.2f ms (%5.2fx), %6.1f M %s/s%s\n", script.name,
+                    interpBest * 1e3, vmBest * 1e3, interpBest / vmBest, script.work / vmBest / 1e6, script.unit,
+                    same ? "" : "  <-- WRONG OUTPUT");
+        if (!same) {
+            std::cout << "  interp: " << interpPrinted << ", vm: " << vmPrinted << ", expected: " << script.expected
+                      << std::endl;
+            status = 1;
+        }
+    }
+    return status;
+}
+
+// --- vmdispatch: switch مقابل computed goto، مع وبدون superinstructions ---
+// (نفس الـ bytecode يُشغّل بالطرق الأربع، والمخرجات تُقارن بمخرجات الـ Interpreter)
+inline std::vector<ScriptCase> dispatchScripts() {
+    return {
+        {"compare loop", "iterations", 2e6,
+         "Ritual Yugi() {\n"
+         "    DarkMagician i = 0;\n"
+         "    DarkMagician odd = 0;\n"
+         "    FairyBox (i < 2000000) {\n"
+         "        JudgmentOfAnubis (i - i / 2 * 2 == 1) odd = odd + 1;\n"
+         "        i = i + 1;\n"
+         "    }\n"
+         "    Summon << odd;\n"
+         "}\n",
+         ""},
+        {"field branch", "iterations", 1e6,
+         "LordOfD Monster { DarkMagician attack = 0; };\n"
+         "Ritual Yugi() {\n"
+         "    Monster x;\n"
+         "    DarkMagician strong = 0;\n"
+         "    DarkMagician i = 0;\n"
+         "    FairyBox (i < 1000000) {\n"
+         "        x.attack = i - i / 3000 * 3000;\n"
+         "        JudgmentOfAnubis (x.attack > 1500) strong = strong + 1;\n"
+         "        i = i + 1;\n"
+         "    }\n"
+         "    Summon << strong;\n"
+         "}\n",
+         ""},
+        {"summon chain", "lines", 2e5,
+         "Ritual Yugi() {\n"
+         "    DarkMagician i = 0;\n"
+         "    BlueEyesWhiteDragon half = 0.5;\n"
+         "    FairyBox (i < 200000) {\n"
+         "        Summon << \"turn \" << i << \": \" << half << \" \" << true << \"\\n\";\n"
+         "        i = i + 1;\n"
+         "    }\n"
+         "}\n",
+         ""},
+        {"calls (Fib 25)", "calls", 242785,
+         "Ritual Fib(DarkMagician n) {\n"
+         "    JudgmentOfAnubis (n < 2) Tribute n;\n"
+         "    Tribute Fib(n - 1) + Fib(n - 2);\n"
+         "}\n"
+         "Ritual Yugi() { Summon << Fib(25); }\n",
+         ""},
+    };
+}
+
+inline int vmDispatch() {
+    int status = 0;
+    const int rounds = 3;
+    if (!VM::THREADED_AVAILABLE) {
+        std::cout << "vmdispatch: computed goto not available in this build, threaded = switch" << std::endl;
+    }
+    for (const ScriptCase& script : dispatchScripts()) {
+        CompilationUnit unit("<bench>", script.source);
+        TokenBuffer tokens = scanPacked(unit.text());
+        Diagnostics diagnostics;
+        Parser parser(tokens, unit.getArena(), &diagnostics);
+        std::vector<NodePtr<Stmt>> statements = parser.parse();
+        ResolvedProgram program;
+        Resolver resolver;
+        BytecodeProgram plain, fused;
+        BytecodeCompiler plainCompiler(diagnostics, false), fusedCompiler(diagnostics, true);
+        if (parser.hadError || !resolver.resolve({{&statements, &diagnostics}}, program) ||
+            !plainCompiler.compile(program, plain) || !fusedCompiler.compile(program, fused)) {
+            diagnostics.emit(std::cerr);
+            return 1;
+        }
+
+        std::ostringstream reference;
+        Interpreter interpreter(program, diagnostics, reference);
+        std::string expected = interpreter.run() ? reference.str() : "<runtime error>";
+
+        struct Config {
+            const char* name;
+            const BytecodeProgram* bytecode;
+            VM::Dispatch dispatch;
+        };
+        const Config configs[] = {
+            {"switch", &plain, VM::Dispatch::SWITCH},
+            {"goto", &plain, VM::Dispatch::THREADED},
+            {"switch+fused", &fused, VM::Dispatch::SWITCH},
+            {"goto+fused", &fused, VM::Dispatch::THREADED},
+        };
+        std::printf("%s (%zu -> %zu instructions)\n", script.name, plain.instructionCount(),
+                    fused.instructionCount());
+        double baseline = 0;
+        for (const Config& config : configs) {
+            double best = 1e9;
+            std::string printed;
+            for (int r = 0; r < rounds; ++r) {
+                std::ostringstream out;
+                VM vm(*config.bytecode, diagnostics, out);
+                auto start = Clock::now();
+                bool ok = vm.run(config.dispatch);
+                best = std::min(best, secondsSince(start));
+                printed = ok ? out.str() : "<runtime error>";
+            }
+            if (baseline == 0) baseline = best;
+            bool same = printed == expected;
+            std::printf("  %-14s: %8.2f ms (%5.2fx), %6.1f M %s/s%s\n", config.name, best * 1e3, baseline / best,
+                        script.work / best / 1e6, script.unit, same ? "" : "  <-- WRONG OUTPUT");
+            if (!same) status = 1;
+        }
+    }
+    return status;
+}
+
+// --- fold: script مولّد مليء بالثوابت، مع وبدون الـ Optimizer، على الـ Interpreter والـ VM ---
+inline int constantFolding() {
+    const std::string source =
+        "Ritual Bonus(DarkMagician level) {\n"
+        "    JudgmentOfAnubis (level > 4 * 2) Tribute 500 + 2 * 250;\n"
+        "    Tribute (100 - 50) * 2;\n"
+        "    Summon << \"unreachable\";\n"
+        "}\n"
+        "Ritual Yugi() {\n"
+        "    DarkMagician total = 0;\n"
+        "    DarkMagician i = 0;\n"
+        "    FairyBox (i < 300000) {\n"
+        "        JudgmentOfAnubis (true) total = total + (3000 * 2 - 500) / (2 + 3);\n"
+        "        SolemnJudgment total = total - 1;\n"
+        "        JudgmentOfAnubis (!false == (1 < 2)) total = total + -(-4 * 2);\n"
+        "        JudgmentOfAnubis (2.5 * 4 > 10) Summon << \"never\";\n"
+        "        total = total + Bonus(i - i / 16 * 16) - (60 + 40);\n"
+        "        i = i + 1;\n"
+        "    }\n"
+        "    Summon << total;\n"
+        "}\n";
+    const std::string expected = "450525000";
+    const int rounds = 3;
+
+    struct Result {
+        double interp = 1e9, vm = 1e9;
+        std::string interpPrinted, vmPrinted;
+        Optimizer::Stats stats;
+    };
+    auto measure = [&](bool optimize, Result& result) {
+        CompilationUnit unit("<bench>", source);
+        TokenBuffer tokens = scanPacked(unit.text());
+        Diagnostics diagnostics;
+        Parser parser(tokens, unit.getArena(), &diagnostics);
+        std::vector<NodePtr<Stmt>> statements = parser.parse();
+        ResolvedProgram program;
+        Resolver resolver;
+        if (parser.hadError || !resolver.resolve({{&statements, &diagnostics}}, program)) {
+            diagnostics.emit(std::cerr);
+            return false;
+        }
+        if (optimize) {
+            Optimizer optimizer;
+            optimizer.optimize(statements, unit.getArena());
+            result.stats = optimizer.getStats();
+        }
+        BytecodeProgram bytecode;
+        BytecodeCompiler compiler(diagnostics);
+        if (!compiler.compile(program, bytecode)) {
+            diagnostics.emit(std::cerr);
+            return false;
+        }
+        for (int r = 0; r < rounds; ++r) {
+            std::ostringstream out;
+            Interpreter interpreter(program, diagnostics, out);
+            auto start = Clock::now();
+            bool ok = interpreter.run();
+            result.interp = std::min(result.interp, secondsSince(start));
+            result.interpPrinted = ok ? out.str() : "<runtime error>";
+        }
+        for (int r = 0; r < rounds; ++r) {
+            std::ostringstream out;
+            VM vm(bytecode, diagnostics, out);
+            auto start = Clock::now();
+            bool ok = vm.run();
+            result.vm = std::min(result.vm, secondsSince(start));
+            result.vmPrinted = ok ? out.str() : "<runtime error>";
+        }
+        return true;
+    };
+
+    Result plain, folded;
+    if (!measure(false, plain) || !measure(true, folded)) return 1;
+    const Optimizer::Stats& stats = folded.stats;
+    std::cout << "fold: " << stats.removed << " nodes removed (" << stats.folded << " constants folded, "
+              << stats.branches << " constant branches, " << stats.unreachable << " unreachable statements)"
+              << std::endl;
+    std::printf("  interp : %8.2f ms -> %8.2f ms (%5.2fx)\n", plain.interp * 1e3, folded.interp * 1e3,
+                plain.interp / folded.interp);
+    std::printf("  vm     : %8.2f ms -> %8.2f ms (%5.2fx)\n", plain.vm * 1e3, folded.vm * 1e3, plain.vm / folded.vm);
+
+    int status = 0;
+    for (const std::string* printed : {&plain.interpPrinted, &plain.vmPrinted, &folded.interpPrinted, &folded.vmPrinted}) {
+        if (*printed == expected) continue;
+        std::cout << "  WRONG OUTPUT: " << *printed << ", expected: " << expected << std::endl;
+        status = 1;
+    }
+
+    // "..." + "...": يُطوى فقط إذا كان الناتج ضمن حد الـ StringHeap، وإلا يبقى لوقت التنفيذ
+    // (STRING_TOO_LONG هناك) ولا يدخل الـ SymbolTable. نص بهذا الطول لا يُكتب في ملف، فالطول
+    // مزيف في الـ literal نفسه: الـ Optimizer يرفض قبل أن يقرأ أي byte منه.
+    auto concatFolded = [](uint32_t leftLength, size_t& interned) {
+        CompilationUnit unit("<bench>", std::string("Summon << \"ab\" + \"cd\";\n"));
+        TokenBuffer tokens = scanPacked(unit.text());
+        Parser parser(tokens, unit.getArena());
+        std::vector<NodePtr<Stmt>> statements = parser.parse();
+        const Expr& concat = *static_cast<const SummonStmt&>(*statements[0]).expression;
+        if (leftLength) {
+            Value& left = static_cast<LiteralExpr&>(*static_cast<const BinaryExpr&>(concat).left).value;
+            left.length = leftLength;
+        }
+        size_t before = SymbolTable::global().size();
+        Optimizer optimizer;
+        optimizer.optimize(statements, unit.getArena());
+        interned = SymbolTable::global().size() - before;
+        return optimizer.getStats().folded;
+    };
+    size_t interned = 0, hugeInterned = 0;
+    size_t small = concatFolded(0, interned);
+    size_t huge = concatFolded(uint32_t(StringHeap::MAX_LENGTH - 1), hugeInterned);
+    std::cout << "  string concat: \"ab\" + \"cd\" folded " << small << ", past StringHeap::MAX_LENGTH folded "
+              << huge << " (" << hugeInterned << " new symbols)" << std::endl;
+    if (small != 1 || huge != 0 || hugeInterned != 0) {
+        std::cout << "  WRONG: only concatenations within StringHeap::MAX_LENGTH may be folded" << std::endl;
+        status = 1;
+    }
+    return status;
+}
+
+// --- typed: نفس الـ bytecode مع وبدون الـ TypeChecker (typed opcodes مقابل فحص النوع وقت التنفيذ) ---
+inline int typedOps() {
+    const std::string source =
+        "Ritual Fib(DarkMagician n) {\n"
+        "    JudgmentOfAnubis (n < 2) Tribute n;\n"
+        "    Tribute Fib(n - 1) + Fib(n - 2);\n"
+        "}\n"
+        "Ritual Yugi() {\n"
+        "    DarkMagician sum = 0;\n"
+        "    BlueEyesWhiteDragon energy = 1.0;\n"
+        "    TimeWizard charging = true;\n"
+        "    DarkMagician i = 0;\n"
+        "    FairyBox (i < 400000) {\n"
+        "        sum = sum + i * 3 - i / 7;\n"
+        "        energy = energy * 0.5 + 1.25;\n"
+        "        charging = sum > i;\n"
+        "        JudgmentOfAnubis (charging) sum = sum - 1;\n"
+        "        i = i + 1;\n"
+        "    }\n"
+        "    Summon << sum << \" \" << energy << \" \" << Fib(24);\n"
+        "}\n";
+    const int rounds = 3;
+
+    struct Result {
+        double seconds = 1e9;
+        std::string printed;
+        size_t typed = 0; // (عدد الـ typed opcodes في الـ bytecode)
+    };
+    auto measure = [&](bool typecheck, Result& result) {
+        // (parse جديد لكل حالة: الـ TypeChecker يكتب أنواعه في الـ AST نفسه)
+        CompilationUnit unit("<bench>", source);
+        TokenBuffer tokens = scanPacked(unit.text());
+        Diagnostics diagnostics;
+        Parser parser(tokens, unit.getArena(), &diagnostics);
+        std::vector<NodePtr<Stmt>> statements = parser.parse();
+        std::vector<Resolver::Unit> units = {{&statements, &diagnostics}};
+        ResolvedProgram program;
+        Resolver resolver;
+        TypeChecker checker;
+        if (parser.hadError || !resolver.resolve(units, program) || (typecheck && !checker.check(units, program))) {
+            diagnostics.emit(std::cerr);
+            return false;
+        }
+        BytecodeProgram bytecode;
+        BytecodeCompiler compiler(diagnostics);
+        if (!compiler.compile(program, bytecode)) {
+            diagnostics.emit(std::cerr);
+            return false;
+        }
+        for (const Chunk& chunk : bytecode.rituals) {
+            for (size_t pc = 0; pc < chunk.code.size(); pc += bytecode::width(chunk.code[pc])) {
+                if (bytecode::op(chunk.code[pc]) >= OpCode::ADDI) result.typed++;
+            }
+        }
+        for (int r = 0; r < rounds; ++r) {
+            std::ostringstream out;
+            VM vm(bytecode, diagnostics, out);
+            auto start = Clock::now();
+            bool ok = vm.run();
+            result.seconds = std::min(result.seconds, secondsSince(start));
+            result.printed = ok ? out.str() : "<runtime error>";
+        }
+        return true;
+    };
+
+    Result generic, typed;
+    if (!measure(false, generic) || !measure(true, typed)) return 1;
+    std::cout << "typed: " << typed.typed << " typed instructions after the TypeChecker" << std::endl;
+    std::printf("  vm     : %8.2f ms -> %8.2f ms (%5.2fx)\n", generic.seconds * 1e3, typed.seconds * 1e3,
+                generic.seconds / typed.seconds);
+    if (generic.printed != typed.printed) {
+        std::cout << "  WRONG OUTPUT: " << typed.printed << ", expected: " << generic.printed << std::endl;
+        return 1;
+    }
+    return 0;
+}
+
+// --- native: نفس الـ scripts على الـ Interpreter، الـ VM (typed)، و --emit-cpp + c++ -O2 ---
+// (الـ executable يُقاس كـ process كامل، أي مع زمن التشغيل نفسه؛ بدون compiler في النظام = skipped)
+inline int nativeCodegen() {
+#ifdef DUELSCRIPT_HAVE_MMAP
+    const std::string directory = "/tmp/duelscript-native";
+    std::filesystem::create_directories(directory);
+    const int rounds = 3;
+    int status = 0;
+    int index = 0;
+    for (const ScriptCase& script : vmScripts()) {
+        CompilationUnit unit("<bench>", script.source);
+        TokenBuffer tokens = scanPacked(unit.text());
+        Diagnostics diagnostics;
+        Parser parser(tokens, unit.getArena(), &diagnostics);
+        std::vector<NodePtr<Stmt>> statements = parser.parse();
+        std::vector<Resolver::Unit> units = {{&statements, &diagnostics}};
+        ResolvedProgram program;
+        Resolver resolver;
+        TypeChecker checker;
+        BytecodeProgram bytecode;
+        BytecodeCompiler compiler(diagnostics);
+        CppEmitter emitter;
+        std::string code;
+        if (parser.hadError || !resolver.resolve(units, program) || !checker.check(units, program) ||
+            !compiler.compile(program, bytecode) || !emitter.emit(program, checker, diagnostics, "<bench>", code)) {
+            diagnostics.emit(std::cerr);
+            return 1;
+        }
+
+        std::string base = directory + "/script" + std::to_string(index++);
+        {
+            std::ofstream out(base + ".cpp", std::ios::binary);
+            out << code;
+        }
+        auto buildStart = Clock::now();
+        if (buildNative(base + ".cpp", base, false) != 0) {
+            std::cout << "native: C++ compiler not available, skipped" << std::endl;
+            return 0;
+        }
+        double buildTime = secondsSince(buildStart);
+
+        double interpBest = 1e9, vmBest = 1e9, nativeBest = 1e9;
+        std::string interpPrinted, vmPrinted, nativePrinted;
+        for (int r = 0; r < rounds; ++r) {
+            std::ostringstream out;
+            Interpreter interpreter(program, diagnostics, out);
+            auto start = Clock::now();
+            bool ok = interpreter.run();
+            interpBest = std::min(interpBest, secondsSince(start));
+            interpPrinted = ok ? out.str() : "<runtime error>";
+        }
+        for (int r = 0; r < rounds; ++r) {
+            std::ostringstream out;
+            VM vm(bytecode, diagnostics, out);
+            auto start = Clock::now();
+            bool ok = vm.run();
+            vmBest = std::min(vmBest, secondsSince(start));
+            vmPrinted = ok ? out.str() : "<runtime error>";
+        }
+        for (int r = 0; r < rounds; ++r) {
+            auto start = Clock::now();
+            FILE* pipe = popen(base.c_str(), "r");
+            if (!pipe) return 1;
+            std::string printed;
+            char buffer[4096];
+            for (size_t n; (n = std::fread(buffer, 1, sizeof(buffer), pipe)) > 0;) printed.append(buffer, n);
+            bool ok = pclose(pipe) == 0;
+            nativeBest = std::min(nativeBest, secondsSince(start));
+            nativePrinted = ok ? printed : "<runtime error>";
+        }
+
+        bool same = interpPrinted == script.expected && vmPrinted == script.expected && nativePrinted == script.expected;
+        std::printf("%-20s: interp %8.2f ms, vm %8.2f ms, native %8.2f ms (%6.1fx interp, %5.1fx vm), c++ %5.2f s%s\n",
+                    script.name, interpBest * 1e3, vmBest * 1e3, nativeBest * 1e3, interpBest / nativeBest,
+                    vmBest / nativeBest, buildTime, same ? "" : "  <-- WRONG OUTPUT");
+        if (!same) {
+            std::cout << "  interp: " << interpPrinted << ", vm: " << vmPrinted << ", native: " << nativePrinted
+                      << ", expected: " << script.expected << std::endl;
+            status = 1;
+        }
+    }
+    return status;
+#else
+    std::cout << "native: needs popen, skipped" << std::endl;
+    return 0;
+#endif
+}
+
+// --- engines: نفس البرنامج على كل طرق التنفيذ، والنتيجة يجب أن تكون واحدة بالحرف ---
+// (interp، --vm، --typecheck --vm، --optimize، --native: المخرجات + رسائل الأخطاء + الـ exit code)
+struct EngineCase {
+    const char* name;
+    std::string source;
+    std::string expected; // (المخرجات، ثم "[exit N]" والأخطاء إن وُجدت)
+};
+
+inline std::vector<EngineCase> engineCases() {
+    std::vector<EngineCase> cases;
+    cases.push_back({"deep recursion",
+                     "Ritual Depth(DarkMagician n) {\n"
+                     "    JudgmentOfAnubis (n == 0) { Tribute 0; }\n"
+                     "    Tribute Depth(n - 1) + 1;\n"
+                     "}\n"
+                     "Ritual Wide(DarkMagician n) {\n"
+                     "    DarkMagician a = n; DarkMagician b = a + 1; DarkMagician c = b + 1; DarkMagician d = c + 1;\n"
+                     "    DarkMagician e = d + 1; DarkMagician f = e + 1; DarkMagician g = f + 1; DarkMagician h = g + 1;\n"
+                     "    DarkMagician i = h + 1; DarkMagician j = i + 1; DarkMagician k = j + 1; DarkMagician l = k + 1;\n"
+                     "    DarkMagician m = l + 1; DarkMagician o = m + 1; DarkMagician p = o + 1; DarkMagician q = p + 1;\n"
+                     "    DarkMagician r = q + 1; DarkMagician s = r + 1; DarkMagician t = s + 1; DarkMagician u = t + 1;\n"
+                     "    JudgmentOfAnubis (n == 0) { Tribute u; }\n"
+                     "    Tribute Wide(n - 1) + u - n - 19;\n"
+                     "}\n"
+                     "Ritual Yugi() {\n"
+                     "    Summon << Depth(998) << \" \" << Wide(900) << \"|\";\n"
+                     "}\n",
+                     "998 19|"});
+    cases.push_back({"stack overflow",
+                     "Ritual Depth(DarkMagician n) {\n"
+                     "    JudgmentOfAnubis (n == 0) { Tribute 0; }\n"
+                     "    Tribute Depth(n - 1) + 1;\n"
+                     "}\n"
+                     "Ritual Yugi() {\n"
+                     "    Summon << Depth(10) << \"|\";\n"
+                     "    Summon << Depth(999) << \"|\";\n"
+                     "}\n",
+                     "10|[exit 70]\n[Line 3] Error at ')': Stack overflow (Rituals nested too deeply).\n"});
+    cases.push_back({"string concat",
+                     "LordOfD Deck {\n"
+                     "    RedEyesBlackDragon cards = \"deck\";\n"
+                     "    Ritual add(RedEyesBlackDragon card) { cards = cards + \":\" + card; Tribute 0; }\n"
+                     "};\n"
+                     "Ritual Greet(RedEyesBlackDragon name) { Tribute \"Hi \" + name; }\n"
+                     "Ritual Yugi() {\n"
+                     "    RedEyesBlackDragon s = \"\";\n"
+                     "    RedEyesBlackDragon w = \"\";\n"
+                     "    DarkMagician i = 0;\n"
+                     "    FairyBox (i < 2000) { s = s + \"ab\"; w = \"ab\" + w; i = i + 1; }\n"
+                     "    RedEyesBlackDragon t = s;\n"
+                     "    t = t + \"!\";\n"
+                     "    Summon << (s == w) << \" \" << (s == t) << \" \" << (s + \"!\" == t) << \" \" << (\"\" + \"x\" == \"x\");\n"
+                     "    Summon << \" \" << Greet(\"Yugi\") << \" \" << Greet(Greet(\"\")) << \" \" << (s == \"\");\n"
+                     "    Deck deck;\n"
+                     "    deck.add(\"Kuriboh\");\n"
+                     "    deck.add(\"Jinzo\");\n"
+                     "    Summon << \" \" << deck.cards << \"|\";\n"
+                     "}\n",
+                     "true false true true Hi Yugi Hi Hi  false deck:Kuriboh:Jinzo|"});
+    cases.push_back({"runtime errors",
+                     "Ritual Yugi() {\n"
+                     "    DarkMagician big = 9223372036854775807;\n"
+                     "    BlueEyesWhiteDragon zero = 0.0;\n"
+                     "    Summon << big + 1 << \" \" << 1.0 / zero << \" \" << -7 / 2 << \"|\";\n"
+                     "    DarkMagician z = 0;\n"
+                     "    Summon << 10 / z;\n"
+                     "    Summon << \"unreachable\";\n"
+                     "}\n",
+                     "-9223372036854775808 inf -3|[exit 70]\n[Line 6] Error at '/': Division by zero.\n"});
+    cases.push_back({"objects and control flow",
+                     "ToonWorld Card { DarkMagician atk = 1000; TimeWizard faceUp; };\n"
+                     "LordOfD Duelist {\n"
+                     "    DarkMagician life = 4000;\n"
+                     "    Card ace;\n"
+                     "    Ritual hit(DarkMagician damage) { life = life - damage; Tribute life; }\n"
+                     "};\n"
+                     "Duelist kaiba;\n"
+                     "Ritual Yugi() {\n"
+                     "    kaiba.ace.atk = 3000;\n"
+                     "    DarkMagician turns = 0;\n"
+                     "    FairyBox (kaiba.hit(kaiba.ace.atk / 2) > 0) { turns = turns + 1; }\n"
+                     "    JudgmentOfAnubis (!kaiba.ace.faceUp) { Summon << \"down \"; } SolemnJudgment { Summon << \"up \"; }\n"
+                     "    BlueEyesWhiteDragon ratio = 0.1 * 3;\n"
+                     "    Summon << turns << \" \" << kaiba.life << \" \" << ratio << \" \" << 25000000000.0 << \"|\";\n"
+                     "}\n",
+                     "down 2 -500 0.3 2.5e+10|"});
+    // (DarkMagician يُخزن في BlueEyesWhiteDragon: متغير، عام، حقل، بارامتر، و self من method)
+    cases.push_back({"int into double",
+                     "ToonWorld Box { BlueEyesWhiteDragon w = 3; DarkMagician n = 7; };\n"
+                     "LordOfD Scale {\n"
+                     "    BlueEyesWhiteDragon last;\n"
+                     "    Ritual half(BlueEyesWhiteDragon v) { last = v; Tribute last / 2; }\n"
+                     "};\n"
+                     "Ritual Half(BlueEyesWhiteDragon v) { Tribute v / 2; }\n"
+                     "BlueEyesWhiteDragon g = 9;\n"
+                     "Ritual Yugi() {\n"
+                     "    BlueEyesWhiteDragon x = 5;\n"
+                     "    Summon << x / 2 << \" \" << Half(7) << \" \" << g / 2;\n"
+                     "    DarkMagician n = 11;\n"
+                     "    x = n;\n"
+                     "    g = n + 2;\n"
+                     "    Box b;\n"
+                     "    b.w = n;\n"
+                     "    Scale s;\n"
+                     "    Summon << \" \" << x / 2 << \" \" << g / 2 << \" \" << b.w / 2 << \" \" << b.n / 2 << \" \"\n"
+                     "           << (b.w = 1) / 2 << \" \" << (x = 3) / 2 << \" \" << s.half(n) << \" \" << s.last / 2 << \"|\";\n"
+                     "}\n",
+                     "2.5 3.5 4.5 5.5 6.5 5.5 3 0.5 1.5 5.5 5.5|"});
+    // (Yugi يُستدعى بدون قيم: بارامتر فيه كان بدون قيمة، و typed opcodes تقرأه كأنه DarkMagician)
+    cases.push_back({"entry with parameters",
+                     "Ritual Yugi(DarkMagician n) {\n"
+                     "    Summon << n + 1;\n"
+                     "}\n",
+                     "<rejected before running>\n"
+                     "[Line 1] Error at 'n': Yugi() is called with no arguments, so it cannot take parameters.\n"});
+    return cases;
+}
+
+enum class EngineMode { INTERP, VM, TYPED_VM, OPTIMIZED, NATIVE };
+
+// (false = البرنامج لم يصل إلى التنفيذ أصلاً، والسبب في result)
+inline bool runEngine(const std::string& source, EngineMode mode, const std::string& base, std::string& result) {
+    CompilationUnit unit("<engines>", source);
+    TokenBuffer tokens = scanPacked(unit.text());
+    Diagnostics diagnostics;
+    Parser parser(tokens, unit.getArena(), &diagnostics);
+    std::vector<NodePtr<Stmt>> statements = parser.parse();
+    std::vector<Resolver::Unit> units = {{&statements, &diagnostics}};
+    ResolvedProgram program;
+    Resolver resolver;
+    TypeChecker checker;
+    bool typed = mode == EngineMode::TYPED_VM || mode == EngineMode::NATIVE;
+    auto rejected = [&] {
+        std::ostringstream errors;
+        diagnostics.emit(errors);
+        result = "<rejected before running>\n" + errors.str();
+        return false;
+    };
+    if (parser.hadError || !resolver.resolve(units, program) || (typed && !checker.check(units, program))) {
+        return rejected();
+    }
+    if (mode == EngineMode::OPTIMIZED) Optimizer().optimize(statements, unit.getArena());
+
+    std::ostringstream printed;
+    bool ok = false;
+    if (mode == EngineMode::VM || mode == EngineMode::TYPED_VM) {
+        BytecodeProgram bytecode;
+        BytecodeCompiler compiler(diagnostics);
+        if (!compiler.compile(program, bytecode)) return rejected();
+        VM vm(bytecode, diagnostics, printed);
+        ok = vm.run();
+    } else if (mode == EngineMode::NATIVE) {
+        CppEmitter emitter;
+        std::string code;
+        if (!emitter.emit(program, checker, diagnostics, "<engines>", code)) return rejected();
+        std::ofstream(base + ".cpp", std::ios::binary) << code;
+        int built = buildNative(base + ".cpp", base, false);
+        if (built != 0) {
+            result = "<c++ exit " + std::to_string(built) + ">";
+            return false;
+        }
+        int status = runProcess({base}, (base + ".out").c_str(), (base + ".err").c_str());
+        auto slurp = [](const std::string& path) {
+            std::ifstream in(path, std::ios::binary);
+            return std::string(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+        };
+        result = slurp(base + ".out");
+        if (status != 0) result += "[exit " + std::to_string(status) + "]\n" + slurp(base + ".err");
+        return true;
+    } else {
+        Interpreter interpreter(program, diagnostics, printed);
+        ok = interpreter.run();
+    }
+    result = printed.str();
+    if (!ok) {
+        std::ostringstream errors;
+        diagnostics.emit(errors);
+        result += "[exit 70]\n" + errors.str();
+    }
+    return true;
+}
+
+inline int engineAgreement() {
+    struct Mode {
+        EngineMode mode;
+        const char* name;
+    };
+    const Mode modes[] = {{EngineMode::INTERP, "interp"},
+                          {EngineMode::VM, "--vm"},
+                          {EngineMode::TYPED_VM, "--typecheck --vm"},
+                          {EngineMode::OPTIMIZED, "--optimize"},
+                          {EngineMode::NATIVE, "--native"}};
+    const std::string directory = "/tmp/duelscript-engines";
+    std::filesystem::create_directories(directory);
+    int status = 0;
+    int index = 0;
+
+    std::cout << "engines: " << engineCases().size() << " programs x interp, --vm, --typecheck --vm, --optimize, --native" << std::endl;
+    // (مرة واحدة: هل يمكن تشغيل الـ compiler أصلاً؟ بعدها أي فشل في بناء الكود الناتج = MISMATCH،
+    //  لأنه خطأ في الـ CppEmitter وليس toolchain ناقصاً)
+    std::vector<std::string> probe = compilerCommand();
+    probe.push_back("--version");
+    bool nativeSkipped = runProcess(probe, "/dev/null", "/dev/null") == 127;
+    if (nativeSkipped) std::cout << "  (C++ compiler not available: --native skipped)" << std::endl;
+    for (const EngineCase& c : engineCases()) {
+        std::string base = directory + "/case" + std::to_string(index++);
+        std::vector<std::string> wrong;
+        for (const Mode& m : modes) {
+            if (m.mode == EngineMode::NATIVE && nativeSkipped) continue;
+            std::string result;
+            runEngine(c.source, m.mode, base, result);
+            if (result != c.expected) {
+                wrong.push_back(std::string(m.name) + ":\n" + result);
+            }
+        }
+        std::cout << "  " << c.name << ": " << (wrong.empty() ? "same output" : "MISMATCH") << std::endl;
+        if (!wrong.empty()) {
+            std::cout << "    expected:\n" << c.expected << std::endl;
+            for (const std::string& w : wrong) std::cout << "    " << w << std::endl;
+            status = 1;
+        }
+    }
+    return status;
+}
+
+// --- keywords: الـ perfect hash مقابل الـ std::map القديمة ---
+inline int keywordLookup() {
+    const std::vector<std::string> words = {
+        "Ritual", "Yugi", "player1", "name", "Summon", "lifePoints", "damage",
+        "DarkMagician", "JudgmentOfAnubis", "blueEyes", "attack", "true",
+        "SwordsOfRevealingLight", "x", "TakeDamage", "RedEyesBlackDragon",
+    };
+    std::string text;
+    std::vector<std::string_view> views;
+    for (const auto& word : words) text += word;
+    for (size_t offset = 0, i = 0; i < words.size(); offset += words[i].size(), ++i) {
+        views.push_back(std::string_view(text).substr(offset, words[i].size()));
+    }
+
+    const int files = 20000;
+    const int lookupsPerFile = 200;
+
+    // المسار القديم: map لكل Scanner + count() ثم operator[] على substr
+    auto mapStart = Clock::now();
+    size_t mapHits = 0;
+    for (int f = 0; f < files; ++f) {
+        std::map<std::string, TokenType> keywords;
+        for (const auto& entry : keyword_table::keywords) {
+            keywords[std::string(entry.text)] = entry.type;
+        }
+        for (int i = 0; i < lookupsPerFile; ++i) {
+            std::string word(views[i % views.size()]);
+            TokenType type = keywords.count(word) ? keywords[word] : TokenType::IDENTIFIER;
+            mapHits += type != TokenType::IDENTIFIER;
+        }
+    }
+    double mapTime = secondsSince(mapStart);
+
+    auto hashStart = Clock::now();
+    size_t hashHits = 0;
+    for (int f = 0; f < files; ++f) {
+        for (int i = 0; i < lookupsPerFile; ++i) {
+            hashHits += lookupKeyword(views[i % views.size()]) != TokenType::IDENTIFIER;
+        }
+        keep(hashHits);
+    }
+    double hashTime = secondsSince(hashStart);
+
+    double lookups = double(files) * lookupsPerFile;
+    std::cout << "keywords: " << files << " files x " << lookupsPerFile << " identifiers" << std::endl;
+    std::cout << "  std::map     : " << mapTime * 1e9 / lookups << " ns/identifier (incl. per-file setup)" << std::endl;
+    std::cout << "  perfect hash : " << hashTime * 1e9 / lookups << " ns/identifier" << std::endl;
+    std::cout << "  speedup      : " << mapTime / hashTime << "x" << std::endl;
+
+    if (mapHits != hashHits) {
+        std::cout << "  MISMATCH: map found " << mapHits << " keywords, hash found " << hashHits << std::endl;
+        return 1;
+    }
+    return 0;
+}
+
+inline int run(const std::string& name) {
+    if (name == "keywords") return keywordLookup();
+    if (name == "scanner") return scannerThroughput();
+    if (name == "scanalloc") return scannerAllocations();
+#ifdef DUELSCRIPT_HAVE_MMAP
+    if (name == "bigfile") return largeFileLoading();
+#endif
+    if (name == "astarena") return astArena();
+    if (name == "parsealloc") return parserAllocations();
+    if (name == "exprparse") return expressionParsing();
+    if (name == "parallel") return parallelParsing();
+    if (name == "broken") return brokenInput();
+    if (name == "flatast") return flatAst();
+    if (name == "visitor") return visitorThroughput();
+    if (name == "dispatch") return dispatchCost();
+    if (name == "teardown") return deepTeardown();
+    if (name == "astcache") return astCache();
+    if (name == "modules") return moduleLoading();
+    if (name == "interp") return interpreterThroughput();
+    if (name == "vm") return vmThroughput();
+    if (name == "vmdispatch") return vmDispatch();
+    if (name == "fold") return constantFolding();
+    if (name == "typed") return typedOps();
+    if (name == "native") return nativeCodegen();
+    if (name == "engines") return engineAgreement();
+
+    std::cerr << "Unknown benchmark: " << name << std::endl;
+    std::cerr << "Available: keywords, scanner, scanalloc, bigfile, astarena, parsealloc, exprparse, parallel, broken, flatast, visitor, dispatch, teardown, astcache, modules, interp, vm, vmdispatch, fold, typed, native, engines" << std::endl;
+    return 64;
+}
+
+} // namespace bench
+
+#endif // DUELSCRIPT_BENCHMARKS_H
@@ -0,0 +1,337 @@
+#ifndef DUELSCRIPT_BYTECODE_H
+#define DUELSCRIPT_BYTECODE_H
+
+#include "AstNodes.h"
+#include "Resolver.h"
+#include "Value.h"
+#include <cstddef>
+#include <cstdint>
+#include <iomanip>
+#include <ostream>
+#include <string>
+#include <vector>
+
+// --- OpCode ---
+// كل instruction = 32 bit: opcode في أول byte ثم الـ operands (مثل Lua):
+//   ABC  : A، B، C كل واحد 8 bit (registers أو رقم member)
+//   ABx  : A 8 bit، Bx 16 bit (رقم constant / global / حقل / Ritual / layout)
+//   AsBx : A 8 bit، sBx 16 bit بإشارة (مسافة القفز من الـ instruction التالي)
+// الـ registers هي الـ frame نفسه: أول frameSize منها متغيرات الـ Ritual (نفس slots
+// الـ Resolver، البارامترات أولاً) والباقي مؤقتات يحجزها الـ Compiler.
+enum class OpCode : uint8_t {
+    MOVE,      // A B   : R[A] = R[B]
+    LOADK,     // A Bx  : R[A] = K[Bx]
+    GETGLOBAL, // A Bx  : R[A] = globals[Bx]
+    SETGLOBAL, // A Bx  : globals[Bx] = R[A]
+    GETSELF,   // A Bx  : R[A] = self.fields[Bx]
+    SETSELF,   // A Bx  : self.fields[Bx] = R[A]
+    GETFIELD,  // A B C : R[A] = R[B].member[C]
+    SETFIELD,  // A B C : R[A].member[C] = R[B]
+    NEWOBJ,    // A Bx  : R[A] = object جديد من layout Bx (يشغل الـ constructor الخاص به)
+
+    ADD,       // A B C : R[A] = R[B] + R[C]
+    SUB,
+    MUL,
+    DIV,
+    EQ,
+    NE,
+    LT,
+    LE,
+    GT,
+    GE,
+    NEG,       // A B   : R[A] = -R[B]
+    NOT,       // A B   : R[A] = !R[B]
+
+    JMP,       // sBx
+    JMPF,      // A sBx : إذا كان R[A] false
+
+    CALL,      // A Bx  : R[A] = rituals[Bx](R[A]...)؛ البارامترات تبدأ من R[A]
+    CALLSELF,  // A Bx  : نفسه مع self الحالي
+    CALLM,     // A Bx  : R[A] = R[A].member[Bx](R[A+1]...)
+    RETURN,    // A     : Tribute R[A]
+    RETURN0,   //       : Tribute بدون قيمة (أو نهاية الجسم)
+
+    SUMMON,    // A     : اطبع R[A]
+    DRAW,      // A     : R[A] = كلمة من الـ input
+    TODOUBLE,  // A     : R[A] = double إذا كان DarkMagician (قبل تخزينه في BlueEyesWhiteDragon)
+
+    // --- superinstructions: أكثر السلاسل تكراراً في instruction واحد ---
+    // (كلمة ثانية بعدها: Bx في أول 16 bit و sBx في آخرها، والقفز من بعد الكلمتين)
+    JMPCMP,    // A B C [sBx]      : اقفز إذا لم يكن R[A] <C> R[B]  (C = EQ .. GE)
+    JMPCMPK,   // A C [Bx sBx]     : اقفز إذا لم يكن R[A] <C> K[Bx]
+    JMPFIELDK, // A B C [Bx sBx]   : اقفز إذا لم يكن R[A].member[B] <C> K[Bx]
+    SUMMONS,   // A [operands...]  : اطبع A قيم؛ operand لكل 16 bit (register، أو K إذا كان فيه SUMMON_CONSTANT)
+
+    // --- typed: الـ TypeChecker أثبت نوع الـ operands، فلا فحص للنوع وقت التنفيذ ---
+    // (بنفس ترتيب ADD .. DIV)
+    ADDI,      // A B C : R[A] = R[B] + R[C] كـ DarkMagician
+    SUBI,
+    MULI,
+    DIVI,
+    ADDF,      // A B C : نفسه كـ BlueEyesWhiteDragon
+    SUBF,
+    MULF,
+    DIVF,
+    JMPCMPI,   // A B C [sBx]  : JMPCMP والطرفان DarkMagician
+    JMPCMPKI,  // A C [Bx sBx] : JMPCMPK والطرفان DarkMagician
+    JMPFB,     // A sBx        : JMPF والشرط TimeWizard
+};
+
+using Instruction = uint32_t;
+
+namespace bytecode {
+
+constexpr size_t OPCODE_COUNT = static_cast<size_t>(OpCode::JMPFB) + 1;
+constexpr uint32_t MAX_REGISTERS = 256;
+constexpr uint32_t SUMMON_CONSTANT = 0x8000;
+constexpr uint32_t MAX_BX = UINT16_MAX;
+constexpr int32_t SBX_BIAS = INT16_MAX;
+
+constexpr Instruction encode(OpCode op, uint32_t a, uint32_t b = 0, uint32_t c = 0) {
+    return static_cast<uint32_t>(op) | a << 8 | b << 16 | c << 24;
+}
+
+constexpr Instruction encodeBx(OpCode op, uint32_t a, uint32_t bx) {
+    return static_cast<uint32_t>(op) | a << 8 | bx << 16;
+}
+
+constexpr Instruction encodeSBx(OpCode op, uint32_t a, int32_t sbx) {
+    return encodeBx(op, a, static_cast<uint32_t>(sbx + SBX_BIAS));
+}
+
+constexpr OpCode op(Instruction i) { return static_cast<OpCode>(i & 0xFF); }
+constexpr uint32_t a(Instruction i) { return i >> 8 & 0xFF; }
+constexpr uint32_t b(Instruction i) { return i >> 16 & 0xFF; }
+constexpr uint32_t c(Instruction i) { return i >> 24; }
+constexpr uint32_t bx(Instruction i) { return i >> 16; }
+constexpr int32_t sbx(Instruction i) { return static_cast<int32_t>(i >> 16) - SBX_BIAS; }
+constexpr uint32_t low(Instruction i) { return i & 0xFFFF; }
+
+// عدد الكلمات (الـ superinstructions لها كلمات إضافية)
+constexpr size_t width(Instruction i) {
+    switch (op(i)) {
+        case OpCode::JMPCMP: case OpCode::JMPCMPK: case OpCode::JMPFIELDK: return 2;
+        case OpCode::JMPCMPI: case OpCode::JMPCMPKI: return 2;
+        case OpCode::SUMMONS: return 1 + (a(i) + 1) / 2;
+        default: return 1;
+    }
+}
+
+} // namespace bytecode
+
+// حقل أو method عبر object (نفس فكرة MemberSlot: صالح إذا كان الـ object من layout،
+// وإلا بحث بالاسم). argc للـ methods فقط.
+struct MemberRef {
+    uint32_t layout;
+    uint32_t index;
+    uint32_t argc;
+    Token name;
+};
+
+// --- Chunk ---
+// جسم Ritual واحد (أو الـ constructor الخاص بـ layout، أو المستوى الأعلى).
+struct Chunk {
+    std::vector<Instruction> code;
+    std::vector<Token> sites;       // (لكل instruction: الـ Token الذي تُنسب إليه أخطاؤه)
+    std::vector<MemberRef> members;
+    Token name;
+    uint32_t registers = 0;         // حجم الـ frame: المتغيرات + المؤقتات
+    uint32_t layout = MemberSlot::NONE;
+};
+
+// --- BytecodeProgram ---
+// ناتج الـ BytecodeCompiler: constant pool واحد لكل البرنامج، و chunk لكل Ritual
+// (بنفس أرقام ResolvedProgram::rituals) ولكل layout.
+struct BytecodeProgram {
+    const ResolvedProgram* resolved = nullptr;
+    std::vector<Value> constants;
+    std::vector<Chunk> rituals;
+    std::vector<Chunk> constructors;
+    Chunk script; // الـ defaults العامة، المستوى الأعلى لكل الـ units، ثم استدعاء Yugi()
+
+    size_t instructionCount() const {
+        size_t count = script.code.size();
+        for (const Chunk& chunk : rituals) count += chunk.code.size();
+        for (const Chunk& chunk : constructors) count += chunk.code.size();
+        return count;
+    }
+};
+
+// --- Disassembler (--bytecode) ---
+
+inline const char* opName(OpCode op) {
+    switch (op) {
+        case OpCode::MOVE: return "MOVE";
+        case OpCode::LOADK: return "LOADK";
+        case OpCode::GETGLOBAL: return "GETGLOBAL";
+        case OpCode::SETGLOBAL: return "SETGLOBAL";
+        case OpCode::GETSELF: return "GETSELF";
+        case OpCode::SETSELF: return "SETSELF";
+        case OpCode::GETFIELD: return "GETFIELD";
+        case OpCode::SETFIELD: return "SETFIELD";
+        case OpCode::NEWOBJ: return "NEWOBJ";
+        case OpCode::ADD: return "ADD";
+        case OpCode::SUB: return "SUB";
+        case OpCode::MUL: return "MUL";
+        case OpCode::DIV: return "DIV";
+        case OpCode::EQ: return "EQ";
+        case OpCode::NE: return "NE";
+        case OpCode::LT: return "LT";
+        case OpCode::LE: return "LE";
+        case OpCode::GT: return "GT";
+        case OpCode::GE: return "GE";
+        case OpCode::NEG: return "NEG";
+        case OpCode::NOT: return "NOT";
+        case OpCode::JMP: return "JMP";
+        case OpCode::JMPF: return "JMPF";
+        case OpCode::CALL: return "CALL";
+        case OpCode::CALLSELF: return "CALLSELF";
+        case OpCode::CALLM: return "CALLM";
+        case OpCode::RETURN: return "RETURN";
+        case OpCode::RETURN0: return "RETURN0";
+        case OpCode::SUMMON: return "SUMMON";
+        case OpCode::DRAW: return "DRAW";
+        case OpCode::TODOUBLE: return "TODOUBLE";
+        case OpCode::JMPCMP: return "JMPCMP";
+        case OpCode::JMPCMPK: return "JMPCMPK";
+        case OpCode::JMPFIELDK: return "JMPFIELDK";
+        case OpCode::SUMMONS: return "SUMMONS";
+        case OpCode::ADDI: return "ADDI";
+        case OpCode::SUBI: return "SUBI";
+        case OpCode::MULI: return "MULI";
+        case OpCode::DIVI: return "DIVI";
+        case OpCode::ADDF: return "ADDF";
+        case OpCode::SUBF: return "SUBF";
+        case OpCode::MULF: return "MULF";
+        case OpCode::DIVF: return "DIVF";
+        case OpCode::JMPCMPI: return "JMPCMPI";
+        case OpCode::JMPCMPKI: return "JMPCMPKI";
+        case OpCode::JMPFB: return "JMPFB";
+    }
+    return "?";
+}
+
+class Disassembler {
+public:
+    explicit Disassembler(const BytecodeProgram& program) : program(program) {}
+
+    void print(std::ostream& out) const {
+        out << "--- Bytecode (" << program.instructionCount() << " instructions, " << program.constants.size()
+            << " constants) ---" << std::endl;
+        printChunk(out, "<script>", program.script);
+        for (size_t i = 0; i < program.constructors.size(); ++i) {
+            printChunk(out, std::string(program.constructors[i].name.lexeme) + " <fields>", program.constructors[i]);
+        }
+        for (const Chunk& chunk : program.rituals) printChunk(out, std::string(chunk.name.lexeme), chunk);
+    }
+
+private:
+    void printChunk(std::ostream& out, const std::string& title, const Chunk& chunk) const {
+        out << title << " (" << chunk.registers << " registers, " << chunk.code.size() << " instructions)" << std::endl;
+        for (size_t pc = 0; pc < chunk.code.size(); pc += bytecode::width(chunk.code[pc])) {
+            Instruction i = chunk.code[pc];
+            OpCode op = bytecode::op(i);
+            out << "  " << std::setw(4) << pc << "  [line " << chunk.sites[pc].line << "]  " << std::left
+                << std::setw(10) << opName(op) << std::right;
+            uint32_t a = bytecode::a(i), b = bytecode::b(i), c = bytecode::c(i), bx = bytecode::bx(i);
+            switch (op) {
+                case OpCode::MOVE: case OpCode::NEG: case OpCode::NOT:
+                    out << " r" << a << ", r" << b;
+                    break;
+                case OpCode::LOADK:
+                    out << " r" << a << ", k" << bx << "  ; " << describe(program.constants[bx]);
+                    break;
+                case OpCode::GETGLOBAL: case OpCode::SETGLOBAL:
+                    out << " r" << a << ", g" << bx << "  ; " << program.resolved->globals[bx]->name.lexeme;
+                    break;
+                case OpCode::GETSELF: case OpCode::SETSELF:
+                    out << " r" << a << ", f" << bx;
+                    break;
+                case OpCode::GETFIELD: case OpCode::SETFIELD:
+                    out << " r" << a << ", r" << b << ", m" << c << "  ; ." << chunk.members[c].name.lexeme;
+                    break;
+                case OpCode::NEWOBJ:
+                    out << " r" << a << ", " << program.resolved->layouts[bx].name.lexeme;
+                    break;
+                case OpCode::JMP:
+                    out << " -> " << pc + 1 + bytecode::sbx(i);
+                    break;
+                case OpCode::JMPF: case OpCode::JMPFB:
+                    out << " r" << a << " -> " << pc + 1 + bytecode::sbx(i);
+                    break;
+                case OpCode::CALL: case OpCode::CALLSELF:
+                    out << " r" << a << ", " << program.rituals[bx].name.lexeme;
+                    break;
+                case OpCode::CALLM:
+                    out << " r" << a << ", m" << bx << "  ; ." << chunk.members[bx].name.lexeme;
+                    break;
+                case OpCode::RETURN: case OpCode::SUMMON: case OpCode::DRAW: case OpCode::TODOUBLE:
+                    out << " r" << a;
+                    break;
+                case OpCode::RETURN0:
+                    break;
+                case OpCode::JMPCMP: case OpCode::JMPCMPI:
+                    out << " r" << a << ' ' << compareSymbol(c) << " r" << b << " else -> "
+                        << pc + 2 + bytecode::sbx(chunk.code[pc + 1]);
+                    break;
+                case OpCode::JMPCMPK: case OpCode::JMPCMPKI: {
+                    Instruction extra = chunk.code[pc + 1];
+                    out << " r" << a << ' ' << compareSymbol(c) << ' ' << describe(program.constants[bytecode::low(extra)])
+                        << " else -> " << pc + 2 + bytecode::sbx(extra);
+                    break;
+                }
+                case OpCode::JMPFIELDK: {
+                    Instruction extra = chunk.code[pc + 1];
+                    out << " r" << a << '.' << chunk.members[b].name.lexeme << ' ' << compareSymbol(c) << ' '
+                        << describe(program.constants[bytecode::low(extra)]) << " else -> " << pc + 2 + bytecode::sbx(extra);
+                    break;
+                }
+                case OpCode::SUMMONS:
+                    for (uint32_t n = 0; n < a; ++n) {
+                        Instruction operands = chunk.code[pc + 1 + n / 2];
+                        uint32_t operand = n % 2 == 0 ? bytecode::low(operands) : operands >> 16;
+                        out << (n == 0 ? " " : ", ");
+                        if (operand & bytecode::SUMMON_CONSTANT) {
+                            out << describe(program.constants[operand & ~bytecode::SUMMON_CONSTANT]);
+                        } else {
+                            out << 'r' << operand;
+                        }
+                    }
+                    break;
+                default:
+                    out << " r" << a << ", r" << b << ", r" << c;
+                    break;
+            }
+            out << std::endl;
+        }
+    }
+
+    static const char* compareSymbol(uint32_t kind) {
+        switch (static_cast<OpCode>(kind)) {
+            case OpCode::EQ: return "==";
+            case OpCode::NE: return "!=";
+            case OpCode::LT: return "<";
+            case OpCode::LE: return "<=";
+            case OpCode::GT: return ">";
+            default: return ">=";
+        }
+    }
+
+    static std::string describe(const Value& value) {
+        switch (value.type) {
+            case Value::Type::INT: return std::to_string(value.asInt);
+            case Value::Type::DOUBLE: return std::to_string(value.asDouble);
+            case Value::Type::BOOL: return value.asBool ? "true" : "false";
+            case Value::Type::STRING: {
+                std::string text = "\"";
+                for (char c : value.stringValue()) text += c == '\n' ? "\\n" : std::string(1, c);
+                return text + "\"";
+            }
+            default: return "nil";
+        }
+    }
+
+    const BytecodeProgram& program;
+};
+
+#endif // DUELSCRIPT_BYTECODE_H
@@ -0,0 +1,650 @@
+#ifndef DUELSCRIPT_BYTECODECOMPILER_H
+#define DUELSCRIPT_BYTECODECOMPILER_H
+
+#include "AstNodes.h"
+#include "Bytecode.h"
+#include "Diagnostics.h"
+#include "Resolver.h"
+#include "Runtime.h"
+#include <algorithm>
+#include <cstring>
+#include <map>
+#include <utility>
+#include <vector>
+
+// --- BytecodeCompiler ---
+// يحول الـ AST بعد الـ Resolver إلى bytecode للـ VM: chunk لكل Ritual ولكل layout
+// (الحقول بترتيب تعريفها) وللمستوى الأعلى.
+// كل تعبير يُترجم إلى register محدد (target): المتغير المحلي يُستخدم كـ operand
+// مباشرة بدون MOVE، والمؤقتات تُحجز فوق المتغيرات كـ stack وتُحرر بعد كل تعبير.
+// الاستدعاء يضع البارامترات في registers متتالية في أعلى الـ frame، فيصبح أولها
+// أول register في frame الـ Ritual المستدعى بدون أي نسخ.
+// بعد الـ TypeChecker (Expr::type) الحساب والمقارنات على DarkMagician / BlueEyesWhiteDragon
+// والشروط من نوع TimeWizard تصبح typed opcodes لا تفحص النوع وقت التنفيذ.
+class BytecodeCompiler : public StaticVisitor<BytecodeCompiler, void, void> {
+public:
+    // (superinstructions = false: instruction لكل عملية، للمقارنة في --bench vmdispatch)
+    explicit BytecodeCompiler(Diagnostics& diagnostics, bool superinstructions = true)
+            : diagnostics(diagnostics), superinstructions(superinstructions) {}
+
+    bool compile(const ResolvedProgram& program, BytecodeProgram& result) {
+        resolved = &program;
+        out = &result;
+        failed = false;
+        constantIndex.clear();
+        result = BytecodeProgram();
+        result.resolved = &program;
+
+        result.rituals.resize(program.rituals.size());
+        for (size_t i = 0; i < program.rituals.size(); ++i) compileRitual(program.rituals[i], result.rituals[i]);
+        result.constructors.resize(program.layouts.size());
+        for (size_t i = 0; i < program.layouts.size(); ++i) {
+            compileConstructor(static_cast<uint32_t>(i), result.constructors[i]);
+        }
+        compileScript(result.script);
+        return !failed;
+    }
+
+    // --- الجمل ---
+
+    void visitExpressionStmt(const ExpressionStmt& stmt) {
+        uint32_t mark = freeReg;
+        const Expr& expression = *stmt.expression;
+        if (expression.kind == ExprKind::Assign && static_cast<const AssignExpr&>(expression).slot.depth == VarSlot::LOCAL) {
+            // (x = ... كجملة: القيمة تُحسب في register المتغير مباشرة)
+            const AssignExpr& assign = static_cast<const AssignExpr&>(expression);
+            expr(*assign.value, assign.slot.slot);
+            toDouble(assign.slot, *assign.value, assign.slot.slot);
+        } else if (expression.kind == ExprKind::Set) {
+            uint32_t object;
+            setField(static_cast<const SetExpr&>(expression), object); // (بدون نسخ القيمة إلى أي مكان)
+        } else {
+            expr(expression, temp());
+        }
+        freeReg = mark;
+    }
+
+    void visitSummonStmt(const SummonStmt& stmt) { summon(*stmt.expression); }
+
+    void visitDrawStmt(const DrawStmt& stmt) {
+        site = stmt.name;
+        if (stmt.slot.depth == VarSlot::LOCAL) {
+            emit(bytecode::encode(OpCode::DRAW, stmt.slot.slot));
+            return;
+        }
+        uint32_t mark = freeReg;
+        uint32_t reg = temp();
+        OpCode get = stmt.slot.depth == VarSlot::FIELD ? OpCode::GETSELF : OpCode::GETGLOBAL;
+        OpCode set = stmt.slot.depth == VarSlot::FIELD ? OpCode::SETSELF : OpCode::SETGLOBAL;
+        emit(bytecode::encodeBx(get, reg, stmt.slot.slot));
+        emit(bytecode::encode(OpCode::DRAW, reg));
+        emit(bytecode::encodeBx(set, reg, stmt.slot.slot));
+        freeReg = mark;
+    }
+
+    void visitVarDeclStmt(const VarDeclStmt& stmt) {
+        site = stmt.name;
+        if (stmt.slot.depth == VarSlot::LOCAL) {
+            initialize(stmt, stmt.slot.slot);
+        } else if (stmt.initializer) {
+            // (العام بدون initializer أخذ قيمته الافتراضية في بداية الـ script)
+            uint32_t mark = freeReg;
+            uint32_t reg = temp();
+            expr(*stmt.initializer, reg);
+            site = stmt.name;
+            toDouble(stmt.slot, *stmt.initializer, reg);
+            emit(bytecode::encodeBx(OpCode::SETGLOBAL, reg, stmt.slot.slot));
+            freeReg = mark;
+        }
+    }
+
+    void visitBlockStmt(const BlockStmt& stmt) {
+        for (const NodePtr<Stmt>& statement : stmt.statements) visit(*statement);
+    }
+
+    void visitIfStmt(const IfStmt& stmt) {
+        size_t skipThen = conditionJump(*stmt.condition);
+        visit(*stmt.thenBranch);
+        if (!stmt.elseBranch) {
+            patch(skipThen);
+            return;
+        }
+        size_t skipElse = emitJump(OpCode::JMP, 0);
+        patch(skipThen);
+        visit(*stmt.elseBranch);
+        patch(skipElse);
+    }
+
+    void visitWhileStmt(const WhileStmt& stmt) {
+        size_t start = chunk->code.size();
+        size_t exit = conditionJump(*stmt.condition);
+        visit(*stmt.body);
+        emitLoop(start);
+        patch(exit);
+    }
+
+    void visitReturnStmt(const ReturnStmt& stmt) {
+        if (!stmt.value) {
+            site = stmt.keyword;
+            emit(bytecode::encode(OpCode::RETURN0, 0));
+            return;
+        }
+        uint32_t mark = freeReg;
+        uint32_t reg = operand(*stmt.value);
+        site = stmt.keyword;
+        emit(bytecode::encode(OpCode::RETURN, reg));
+        freeReg = mark;
+    }
+
+    // (كل Ritual و layout له chunk خاص به)
+    void visitFunctionStmt(const FunctionStmt&) {}
+    void visitClassStmt(const ClassStmt&) {}
+    void visitStructStmt(const StructStmt&) {}
+    void visitIncludeStmt(const IncludeStmt&) {}
+    void visitUsingStmt(const UsingStmt&) {}
+
+    // --- التعبيرات: كل visit يكتب النتيجة في target ---
+
+    void visitBinaryExpr(const BinaryExpr& expr) {
+        uint32_t dest = target;
+        // (المتغير المحلي على اليسار يُقرأ مباشرة إلا إذا كان اليمين قد يغيره: x + (x = 1))
+        uint32_t left = operand(*expr.left, !assignsLocal(*expr.right));
+        uint32_t right = operand(*expr.right);
+        site = expr.op;
+        emit(bytecode::encode(arithmeticOp(expr), dest, left, right));
+    }
+
+    void visitGroupingExpr(const GroupingExpr& expr) { visit(*expr.expression); }
+
+    void visitLiteralExpr(const LiteralExpr& expr) {
+        site = expr.token;
+        emit(bytecode::encodeBx(OpCode::LOADK, target, constant(expr.value)));
+    }
+
+    void visitUnaryExpr(const UnaryExpr& expr) {
+        uint32_t dest = target;
+        uint32_t right = operand(*expr.right);
+        site = expr.op;
+        emit(bytecode::encode(expr.op.type == TokenType::BANG ? OpCode::NOT : OpCode::NEG, dest, right));
+    }
+
+    void visitVariableExpr(const VariableExpr& expr) {
+        site = expr.name;
+        switch (expr.slot.depth) {
+            case VarSlot::LOCAL: move(target, expr.slot.slot); break;
+            case VarSlot::FIELD: emit(bytecode::encodeBx(OpCode::GETSELF, target, expr.slot.slot)); break;
+            default: emit(bytecode::encodeBx(OpCode::GETGLOBAL, target, expr.slot.slot)); break;
+        }
+    }
+
+    void visitAssignExpr(const AssignExpr& expr) {
+        uint32_t dest = target;
+        if (expr.slot.depth == VarSlot::LOCAL) {
+            this->expr(*expr.value, expr.slot.slot);
+            site = expr.name;
+            toDouble(expr.slot, *expr.value, expr.slot.slot);
+            move(dest, expr.slot.slot);
+            return;
+        }
+        this->expr(*expr.value, dest);
+        site = expr.name;
+        toDouble(expr.slot, *expr.value, dest);
+        OpCode set = expr.slot.depth == VarSlot::FIELD ? OpCode::SETSELF : OpCode::SETGLOBAL;
+        emit(bytecode::encodeBx(set, dest, expr.slot.slot));
+    }
+
+    void visitCallExpr(const CallExpr& expr) {
+        uint32_t dest = target;
+        // الـ window: [receiver] ثم البارامترات، في أعلى الـ frame
+        // (إن كان target نفسه أعلى مؤقت، تبدأ منه ويصبح الـ MOVE غير ضروري)
+        uint32_t base = dest + 1 == freeReg && dest >= locals ? dest : temp();
+        uint32_t next = base;
+        if (expr.target.kind == CallTarget::METHOD) {
+            const GetExpr& get = static_cast<const GetExpr&>(*expr.callee);
+            this->expr(*get.object, next++);
+        }
+        for (const NodePtr<Expr>& argument : expr.arguments) {
+            uint32_t reg = next++;
+            if (reg >= freeReg) reg = temp();
+            this->expr(*argument, reg);
+        }
+
+        site = expr.paren;
+        switch (expr.target.kind) {
+            case CallTarget::FUNCTION:
+                emit(bytecode::encodeBx(OpCode::CALL, base, expr.target.index));
+                break;
+            case CallTarget::SELF_METHOD:
+                emit(bytecode::encodeBx(OpCode::CALLSELF, base, expr.target.index));
+                break;
+            default: {
+                const GetExpr& get = static_cast<const GetExpr&>(*expr.callee);
+                uint32_t argc = static_cast<uint32_t>(expr.arguments.size());
+                emit(bytecode::encodeBx(OpCode::CALLM, base, member(get.name, get.member, argc, bytecode::MAX_BX)));
+                break;
+            }
+        }
+        move(dest, base);
+    }
+
+    void visitGetExpr(const GetExpr& expr) {
+        uint32_t dest = target;
+        uint32_t object = operand(*expr.object);
+        site = expr.name;
+        emit(bytecode::encode(OpCode::GETFIELD, dest, object, member(expr.name, expr.member, 0, UINT8_MAX)));
+    }
+
+    void visitSetExpr(const SetExpr& expr) {
+        uint32_t dest = target;
+        uint32_t object;
+        uint32_t value = setField(expr, object);
+        // (قيمة التعبير = ما خُزن فعلاً: DarkMagician في حقل BlueEyesWhiteDragon أصبح double،
+        //  ونوع الـ object قد لا يُعرف إلا وقت التنفيذ، فنقرأ الحقل نفسه بعد تخزينه)
+        if (expr.value->type == StaticType::INT || expr.value->type == StaticType::UNKNOWN) {
+            emit(bytecode::encode(OpCode::GETFIELD, dest, object, member(expr.name, expr.member, 0, UINT8_MAX)));
+        } else {
+            move(dest, value);
+        }
+    }
+
+private:
+    void limit(const char* what) {
+        if (!failed) diagnostics.report({DiagCode::BYTECODE_LIMIT, 0, site.line, false, site.lexeme, what});
+        failed = true;
+    }
+
+    // --- الـ chunks ---
+
+    void begin(Chunk& target, uint32_t frameSize, const Token& name, uint32_t layout) {
+        chunk = &target;
+        chunk->name = name;
+        chunk->layout = layout;
+        site = name;
+        locals = freeReg = maxReg = frameSize;
+        if (frameSize > bytecode::MAX_REGISTERS) limit("more than 256 registers in one Ritual");
+    }
+
+    void end() {
+        emit(bytecode::encode(OpCode::RETURN0, 0));
+        chunk->registers = maxReg;
+    }
+
+    void compileRitual(const RitualInfo& ritual, Chunk& target) {
+        begin(target, ritual.frameSize, ritual.decl->name, ritual.layout);
+        // (البارامترات في أول الـ registers، من أي استدعاء: CALL، CALLSELF أو CALLM)
+        for (uint32_t param : ritual.doubleParams) emit(bytecode::encode(OpCode::TODOUBLE, param));
+        visitBlockStmt(*ritual.decl->body);
+        site = ritual.decl->name;
+        end();
+    }
+
+    // الحقول بترتيب تعريفها، والـ object الجديد هو self
+    void compileConstructor(uint32_t layoutIndex, Chunk& target) {
+        const ClassLayout& layout = resolved->layouts[layoutIndex];
+        begin(target, 0, layout.name, layoutIndex);
+        for (uint32_t i = 0; i < layout.fields.size(); ++i) {
+            uint32_t reg = temp();
+            initialize(*layout.fields[i], reg);
+            emit(bytecode::encodeBx(OpCode::SETSELF, reg, i));
+            freeReg = locals;
+        }
+        end();
+    }
+
+    void compileScript(Chunk& target) {
+        begin(target, resolved->scriptFrameSize, Token(), MemberSlot::NONE);
+
+        // (مثل الـ Interpreter: القيمة الافتراضية لكل متغير عام بالترتيب قبل أي جملة)
+        for (uint32_t i = 0; i < resolved->globals.size(); ++i) {
+            const VarDeclStmt& global = *resolved->globals[i];
+            site = global.name;
+            uint32_t reg = temp();
+            defaultValue(global, reg);
+            emit(bytecode::encodeBx(OpCode::SETGLOBAL, reg, i));
+            freeReg = locals;
+        }
+
+        for (const std::vector<NodePtr<Stmt>>* unit : resolved->units) {
+            for (const NodePtr<Stmt>& statement : *unit) visit(*statement);
+        }
+        // (Tribute في المستوى الأعلى ينهي الـ script قبل الوصول إلى هنا)
+        if (resolved->entry != ResolvedProgram::NO_ENTRY) {
+            site = resolved->rituals[resolved->entry].decl->name;
+            emit(bytecode::encodeBx(OpCode::CALL, temp(), resolved->entry));
+            freeReg = locals;
+        }
+        end();
+    }
+
+    // --- القيم الافتراضية ---
+
+    void initialize(const VarDeclStmt& decl, uint32_t reg) {
+        if (decl.initializer) {
+            expr(*decl.initializer, reg);
+            site = decl.name;
+            toDouble(decl.slot, *decl.initializer, reg);
+        } else {
+            site = decl.name;
+            defaultValue(decl, reg);
+        }
+    }
+
+    // صفر النوع، أو object جديد لـ LordOfD / ToonWorld
+    void defaultValue(const VarDeclStmt& decl, uint32_t reg) {
+        Value value;
+        if (!runtime::primitiveDefault(decl.type.type, value) && decl.layout != MemberSlot::NONE) {
+            emit(bytecode::encodeBx(OpCode::NEWOBJ, reg, decl.layout));
+            return;
+        }
+        emit(bytecode::encodeBx(OpCode::LOADK, reg, constant(value)));
+    }
+
+    // --- الـ registers ---
+
+    uint32_t temp() {
+        if (freeReg >= bytecode::MAX_REGISTERS) {
+            limit("more than 256 registers in one Ritual");
+            return 0;
+        }
+        uint32_t reg = freeReg++;
+        maxReg = std::max(maxReg, freeReg);
+        return reg;
+    }
+
+    // يترجم التعبير إلى dest، ويحرر كل المؤقتات التي احتاجها
+    void expr(const Expr& expression, uint32_t dest) {
+        uint32_t saved = target, mark = freeReg;
+        target = dest;
+        visit(expression);
+        target = saved;
+        freeReg = mark;
+    }
+
+    static const Expr* unwrap(const Expr& expression) {
+        const Expr* inner = &expression;
+        while (inner->kind == ExprKind::Grouping) inner = static_cast<const GroupingExpr&>(*inner).expression.get();
+        return inner;
+    }
+
+    // register يحمل قيمة التعبير: المتغير المحلي نفسه، أو مؤقت جديد
+    uint32_t operand(const Expr& expression, bool allowLocal = true) {
+        const Expr* inner = unwrap(expression);
+        if (allowLocal && inner->kind == ExprKind::Variable) {
+            const VariableExpr& variable = static_cast<const VariableExpr&>(*inner);
+            if (variable.slot.depth == VarSlot::LOCAL) return variable.slot.slot;
+        }
+        uint32_t reg = temp();
+        expr(*inner, reg);
+        return reg;
+    }
+
+    // هل يغير التعبير متغيراً محلياً؟ (الـ Ritual المستدعى لا يرى الـ frame الحالي)
+    static bool assignsLocal(const Expr& expression) {
+        switch (expression.kind) {
+            case ExprKind::Assign: {
+                const AssignExpr& assign = static_cast<const AssignExpr&>(expression);
+                return assign.slot.depth == VarSlot::LOCAL || assignsLocal(*assign.value);
+            }
+            case ExprKind::Binary: {
+                const BinaryExpr& binary = static_cast<const BinaryExpr&>(expression);
+                return assignsLocal(*binary.left) || assignsLocal(*binary.right);
+            }
+            case ExprKind::Grouping: return assignsLocal(*static_cast<const GroupingExpr&>(expression).expression);
+            case ExprKind::Unary: return assignsLocal(*static_cast<const UnaryExpr&>(expression).right);
+            case ExprKind::Call: {
+                const CallExpr& call = static_cast<const CallExpr&>(expression);
+                if (assignsLocal(*call.callee)) return true;
+                for (const NodePtr<Expr>& argument : call.arguments) {
+                    if (assignsLocal(*argument)) return true;
+                }
+                return false;
+            }
+            case ExprKind::Get: return assignsLocal(*static_cast<const GetExpr&>(expression).object);
+            case ExprKind::Set: {
+                const SetExpr& set = static_cast<const SetExpr&>(expression);
+                return assignsLocal(*set.object) || assignsLocal(*set.value);
+            }
+            default: return false;
+        }
+    }
+
+    // (يعيد الـ register الذي يحمل القيمة)
+    // (القيمة في register الناتج، والـ object في object)
+    uint32_t setField(const SetExpr& expr, uint32_t& object) {
+        object = operand(*expr.object, !assignsLocal(*expr.value));
+        uint32_t value = operand(*expr.value);
+        site = expr.name;
+        emit(bytecode::encode(OpCode::SETFIELD, object, value, member(expr.name, expr.member, 0, UINT8_MAX)));
+        return value;
+    }
+
+    // قيمة تُخزن في متغير BlueEyesWhiteDragon: الـ DarkMagician يصبح double (انظر runtime::widen)
+    // (بعد الـ TypeChecker القيمة DOUBLE غالباً، فلا instruction إضافية)
+    void toDouble(VarSlot slot, const Expr& value, uint32_t reg) {
+        if (slot.toDouble && value.type != StaticType::DOUBLE) emit(bytecode::encode(OpCode::TODOUBLE, reg));
+    }
+
+    void move(uint32_t dest, uint32_t source) {
+        if (dest != source) emit(bytecode::encode(OpCode::MOVE, dest, source));
+    }
+
+    // --- Summon: كل جزء من السلسلة a << b << c يُطبع بالترتيب ---
+
+    void summonParts(const Expr& expression, std::vector<const Expr*>& parts) {
+        if (expression.kind == ExprKind::Binary) {
+            const BinaryExpr& chain = static_cast<const BinaryExpr&>(expression);
+            if (chain.op.type == TokenType::SUMMON_OP) {
+                summonParts(*chain.left, parts);
+                summonParts(*chain.right, parts);
+                return;
+            }
+        }
+        parts.push_back(&expression);
+    }
+
+    // الأجزاء التي لا تفشل ولا تغير شيئاً (literal، متغير) تُجمع في SUMMONS واحد.
+    // أي جزء آخر (استدعاء، حساب، حقل object) يُحسب بعد طباعة ما قبله، مثل الـ Interpreter،
+    // ثم تبدأ نتيجته مجموعة جديدة.
+    void summon(const Expr& expression) {
+        std::vector<const Expr*> parts;
+        summonParts(expression, parts);
+        uint32_t mark = freeReg;
+        std::vector<uint32_t> pending;
+        for (const Expr* part : parts) {
+            const Expr* inner = unwrap(*part);
+            if (!superinstructions) {
+                emit(bytecode::encode(OpCode::SUMMON, operand(*inner)));
+                freeReg = mark;
+                continue;
+            }
+            if (inner->kind == ExprKind::Literal) {
+                site = static_cast<const LiteralExpr&>(*inner).token;
+                uint32_t index = constant(static_cast<const LiteralExpr&>(*inner).value);
+                if (index < bytecode::SUMMON_CONSTANT) {
+                    pending.push_back(index | bytecode::SUMMON_CONSTANT);
+                    continue;
+                }
+            }
+            if (inner->kind != ExprKind::Variable) {
+                emitSummons(pending);
+                freeReg = mark;
+            }
+            // (GETSELF / GETGLOBAL لا تفشل: يكفي أن تُقرأ قبل الطباعة)
+            pending.push_back(operand(*inner));
+        }
+        emitSummons(pending);
+        freeReg = mark;
+    }
+
+    void emitSummons(std::vector<uint32_t>& operands) {
+        if (operands.size() == 1 && !(operands[0] & bytecode::SUMMON_CONSTANT)) {
+            emit(bytecode::encode(OpCode::SUMMON, operands[0]));
+            operands.clear();
+            return;
+        }
+        for (size_t first = 0; first < operands.size(); first += UINT8_MAX) {
+            size_t count = std::min<size_t>(UINT8_MAX, operands.size() - first);
+            emit(bytecode::encode(OpCode::SUMMONS, static_cast<uint32_t>(count)));
+            for (size_t n = 0; n < count; n += 2) {
+                uint32_t second = n + 1 < count ? operands[first + n + 1] : 0;
+                emit(operands[first + n] | second << 16);
+            }
+        }
+        operands.clear();
+    }
+
+    // --- القفز ---
+
+    // يقفز فوق ما بعده إذا كان الشرط false.
+    // مقارنة واحدة تصبح superinstruction بدلاً من (GETFIELD +) LOADK + مقارنة + JMPF:
+    //   x.attack > 1500  -> JMPFIELDK
+    //   i < 1000         -> JMPCMPK
+    //   i < n            -> JMPCMP
+    size_t conditionJump(const Expr& condition) {
+        uint32_t mark = freeReg;
+        const Expr* inner = unwrap(condition);
+        if (superinstructions && inner->kind == ExprKind::Binary) {
+            const BinaryExpr& comparison = static_cast<const BinaryExpr&>(*inner);
+            OpCode kind = binaryOp(comparison.op.type);
+            if (kind >= OpCode::EQ && kind <= OpCode::GE) {
+                const Expr* left = unwrap(*comparison.left);
+                const Expr* right = unwrap(*comparison.right);
+                uint32_t extra = 0;
+                if (right->kind == ExprKind::Literal) {
+                    extra = constant(static_cast<const LiteralExpr&>(*right).value);
+                    if (left->kind == ExprKind::Get) {
+                        const GetExpr& get = static_cast<const GetExpr&>(*left);
+                        uint32_t object = operand(*get.object);
+                        uint32_t field = member(get.name, get.member, 0, UINT8_MAX);
+                        site = comparison.op;
+                        emit(bytecode::encode(OpCode::JMPFIELDK, object, field, static_cast<uint32_t>(kind)));
+                    } else {
+                        uint32_t reg = operand(*left);
+                        site = comparison.op;
+                        OpCode fused = integers(*left, *right) ? OpCode::JMPCMPKI : OpCode::JMPCMPK;
+                        emit(bytecode::encode(fused, reg, 0, static_cast<uint32_t>(kind)));
+                    }
+                } else {
+                    uint32_t leftReg = operand(*left, !assignsLocal(*right));
+                    uint32_t rightReg = operand(*right);
+                    site = comparison.op;
+                    OpCode fused = integers(*left, *right) ? OpCode::JMPCMPI : OpCode::JMPCMP;
+                    emit(bytecode::encode(fused, leftReg, rightReg, static_cast<uint32_t>(kind)));
+                }
+                emit(extra); // (الـ sBx يُكتب في patch)
+                freeReg = mark;
+                return chunk->code.size() - 1;
+            }
+        }
+        uint32_t reg = operand(condition);
+        freeReg = mark;
+        return emitJump(condition.type == StaticType::BOOL ? OpCode::JMPFB : OpCode::JMPF, reg);
+    }
+
+    // (jump = الكلمة التي تحمل الـ sBx في آخر 16 bit؛ القفز من الكلمة التي بعدها)
+    size_t emitJump(OpCode op, uint32_t reg) {
+        emit(bytecode::encodeSBx(op, reg, 0));
+        return chunk->code.size() - 1;
+    }
+
+    void patch(size_t jump) {
+        setOffset(jump, static_cast<int64_t>(chunk->code.size()) - static_cast<int64_t>(jump + 1));
+    }
+
+    void emitLoop(size_t start) {
+        size_t jump = emitJump(OpCode::JMP, 0);
+        setOffset(jump, static_cast<int64_t>(start) - static_cast<int64_t>(jump + 1));
+    }
+
+    void setOffset(size_t jump, int64_t offset) {
+        if (offset > bytecode::SBX_BIAS || offset < -bytecode::SBX_BIAS) {
+            limit("a jump over more than 32767 instructions");
+            return;
+        }
+        Instruction& instruction = chunk->code[jump];
+        instruction = bytecode::low(instruction) | static_cast<uint32_t>(offset + bytecode::SBX_BIAS) << 16;
+    }
+
+    // --- الجداول ---
+
+    void emit(Instruction instruction) {
+        chunk->code.push_back(instruction);
+        chunk->sites.push_back(site);
+    }
+
+    // (نفس القيمة = نفس الـ constant في كل البرنامج)
+    uint32_t constant(const Value& value) {
+        uint64_t bits;
+        std::memcpy(&bits, &value.asInt, sizeof(bits));
+        auto [it, inserted] = constantIndex.emplace(std::make_pair(value.type, bits),
+                                                    static_cast<uint32_t>(out->constants.size()));
+        if (inserted) {
+            if (out->constants.size() > bytecode::MAX_BX) limit("more than 65536 constants");
+            out->constants.push_back(value);
+        }
+        return it->second & bytecode::MAX_BX;
+    }
+
+    uint32_t member(const Token& name, MemberSlot slot, uint32_t argc, uint32_t max) {
+        std::vector<MemberRef>& members = chunk->members;
+        for (uint32_t i = 0; i < members.size(); ++i) {
+            const MemberRef& ref = members[i];
+            if (ref.name.symbol == name.symbol && ref.layout == slot.layout && ref.index == slot.index && ref.argc == argc) {
+                if (i <= max) return i;
+            }
+        }
+        if (members.size() > max) {
+            limit("more than 256 member accesses in one Ritual");
+            return 0;
+        }
+        members.push_back({slot.layout, slot.index, argc, name});
+        return static_cast<uint32_t>(members.size() - 1);
+    }
+
+    static OpCode binaryOp(TokenType type) {
+        switch (type) {
+            case TokenType::PLUS: return OpCode::ADD;
+            case TokenType::MINUS: return OpCode::SUB;
+            case TokenType::STAR: return OpCode::MUL;
+            case TokenType::SLASH: return OpCode::DIV;
+            case TokenType::EQUAL_EQUAL: return OpCode::EQ;
+            case TokenType::BANG_EQUAL: return OpCode::NE;
+            case TokenType::LESS: return OpCode::LT;
+            case TokenType::LESS_EQUAL: return OpCode::LE;
+            case TokenType::GREATER: return OpCode::GT;
+            default: return OpCode::GE;
+        }
+    }
+
+    // + - * / بنوع أثبته الـ TypeChecker للطرفين: نسخة typed بدون فحص النوع (وإلا العامة)
+    static OpCode arithmeticOp(const BinaryExpr& expr) {
+        OpCode op = binaryOp(expr.op.type);
+        if (op > OpCode::DIV || expr.left->type != expr.right->type) return op;
+        uint8_t offset = static_cast<uint8_t>(op) - static_cast<uint8_t>(OpCode::ADD);
+        switch (expr.left->type) {
+            case StaticType::INT: return static_cast<OpCode>(static_cast<uint8_t>(OpCode::ADDI) + offset);
+            case StaticType::DOUBLE: return static_cast<OpCode>(static_cast<uint8_t>(OpCode::ADDF) + offset);
+            default: return op;
+        }
+    }
+
+    static bool integers(const Expr& left, const Expr& right) {
+        return left.type == StaticType::INT && right.type == StaticType::INT;
+    }
+
+    Diagnostics& diagnostics;
+    bool superinstructions;
+    const ResolvedProgram* resolved = nullptr;
+    BytecodeProgram* out = nullptr;
+    std::map<std::pair<Value::Type, uint64_t>, uint32_t> constantIndex;
+
+    Chunk* chunk = nullptr;
+    Token site;           // (الـ Token الذي تُنسب إليه الـ instructions التالية)
+    uint32_t locals = 0;  // أول register بعد المتغيرات
+    uint32_t freeReg = 0; // أول register مؤقت غير محجوز
+    uint32_t maxReg = 0;
+    uint32_t target = 0;
+    bool failed = false;
+};
+
+#endif // DUELSCRIPT_BYTECODECOMPILER_H
@@ -0,0 +1,35 @@
+#ifndef DUELSCRIPT_COMPILATIONUNIT_H
+#define DUELSCRIPT_COMPILATIONUNIT_H
+
+#include "AstArena.h"
+#include "SourceBuffer.h"
+#include <string>
+#include <string_view>
+
+// --- CompilationUnit ---
+// يملك الـ source buffer الوحيد للملف. كل الـ Tokens (والـ AST) تشير
+// إلى داخل هذا الـ buffer، لذلك لا يمكن نسخه أو نقله.
+// ويملك أيضاً الـ arena التي تُحجز فيها كل nodes الـ AST الخاصة بالملف.
+class CompilationUnit {
+public:
+    CompilationUnit(std::string path, SourceBuffer source)
+            : path(std::move(path)), source(std::move(source)) {}
+
+    CompilationUnit(std::string path, std::string source)
+            : path(std::move(path)), source(SourceBuffer::fromString(std::move(source))) {}
+
+    CompilationUnit(const CompilationUnit&) = delete;
+    CompilationUnit& operator=(const CompilationUnit&) = delete;
+
+    const std::string& getPath() const { return path; }
+    std::string_view text() const { return source.text(); }
+    bool isMapped() const { return source.isMapped(); }
+    AstArena& getArena() { return arena; }
+
+private:
+    std::string path;
+    SourceBuffer source;
+    AstArena arena;
+};
+
+#endif // DUELSCRIPT_COMPILATIONUNIT_H
@@ -0,0 +1,872 @@
+#ifndef DUELSCRIPT_CPPEMITTER_H
+#define DUELSCRIPT_CPPEMITTER_H
+
+#include "AstNodes.h"
+#include "Diagnostics.h"
+#include "Resolver.h"
+#include "TypeChecker.h"
+#include <cerrno>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define DUELSCRIPT_HAVE_SPAWN 1
+#include <fcntl.h>
+#include <spawn.h>
+#include <sys/wait.h>
+extern char** environ;
+#endif
+
+// --- CppEmitter (--emit-cpp) ---
+// يحول البرنامج بعد الـ TypeChecker إلى C++ مقروء يُبنى بأي compiler (AOT):
+//   LordOfD -> class، ToonWorld -> struct، Ritual -> دالة (أو method)، Summon -> ds::print (buffer)،
+//   DarkMagician -> int64_t، BlueEyesWhiteDragon -> double، RedEyesBlackDragon -> std::string،
+//   TimeWizard -> bool، والـ objects -> pointers (تعيش حتى نهاية البرنامج، مثل الـ heap في الـ Interpreter).
+// نفس قواعد Runtime بالضبط: INT يلتف عند الـ overflow (ds::add ...)، القسمة على صفر وعمق 1000 Ritual
+// نفس رسالة الخطأ و exit code 70، وترتيب التنفيذ من اليسار (C++ لا يرتب operands الـ + ولا
+// البارامترات، فالتعبير الذي له أثر يُحسب في lambda بالترتيب الصحيح).
+// كل اسم من الـ script يأخذ suffix حسب نوعه (متغير x_، Ritual x_r، نوع x_t): لا تصادم مع كلمات C++
+// ولا بين متغير و Ritual بنفس الاسم.
+// Ritual لا يعود أبداً (نوعه UNKNOWN) يصبح void: يمكن استدعاؤه كجملة، لكن قيمته لا تُستخدم.
+class CppEmitter : public StaticVisitor<CppEmitter, std::string> {
+public:
+    // (false = قيمة Ritual لا يعود أبداً مستخدمة في تعبير: لا نوع C++ لها، أو Yugi ببارامترات؛
+    //  الخطأ في diagnostics)
+    bool emit(const ResolvedProgram& resolved, const TypeChecker& types, Diagnostics& sink,
+              std::string_view sourceName, std::string& result) {
+        program = &resolved;
+        checker = &types;
+        diagnostics = &sink;
+        failed = false;
+        text.clear();
+        indent = 0;
+        temps = 0;
+        for (uint32_t i = 0; i < program->layouts.size(); ++i) layoutByName.emplace(program->layouts[i].name.symbol, i);
+
+        line("// Generated by DuelScript --emit-cpp from " + std::string(sourceName) + ". Do not edit.");
+        line("// Build: c++ -std=c++17 -O2 file.cpp (or -shared -fPIC -DDUELSCRIPT_NO_MAIN for duelscript_run()).");
+        text += prelude();
+        declarations();
+        constructors();
+        for (uint32_t i = 0; i < program->rituals.size(); ++i) ritual(i);
+        script();
+        if (failed) return false;
+        result = std::move(text);
+        return true;
+    }
+
+    // --- الجمل ---
+
+    void visitExpressionStmt(const ExpressionStmt& stmt) {
+        const Expr& expression = *stmt.expression;
+        discarded = unwrap(expression)->kind == ExprKind::Call;
+        bool effect = expression.kind == ExprKind::Call || expression.kind == ExprKind::Assign ||
+                      expression.kind == ExprKind::Set;
+        line(effect ? bare(visit(expression)) + ";" : "(void)" + visit(expression) + ";");
+    }
+
+    void visitSummonStmt(const SummonStmt& stmt) {
+        std::vector<const Expr*> parts;
+        summonParts(*stmt.expression, parts);
+        std::string code = "ds::print";
+        for (const Expr* part : parts) {
+            const Expr* inner = unwrap(*part);
+            // (نص ثابت يُطبع كما هو بدون std::string)
+            if (inner->kind == ExprKind::Literal && static_cast<const LiteralExpr&>(*inner).value.type == Value::Type::STRING) {
+                code += " << " + quote(static_cast<const LiteralExpr&>(*inner).value.stringValue());
+            } else {
+                code += " << " + visit(*part);
+            }
+        }
+        line(code + ";");
+    }
+
+    void visitDrawStmt(const DrawStmt& stmt) { line("ds::draw(" + reference(stmt.name, stmt.slot) + ");"); }
+
+    void visitVarDeclStmt(const VarDeclStmt& stmt) {
+        // (متغير عام: القيمة الافتراضية وُضعت في بداية script()، هنا الـ initializer فقط)
+        if (stmt.slot.depth == VarSlot::GLOBAL) {
+            if (stmt.initializer) line(reference(stmt.name, stmt.slot) + " = " + bare(visit(*stmt.initializer)) + ";");
+            return;
+        }
+        std::string declaration = cppType(declaredType(stmt.type, stmt.layout)) + " " + variable(stmt.name);
+        if (!stmt.initializer) {
+            line(declaration + defaultValue(stmt) + ";");
+        } else if (mentions(*stmt.initializer, stmt.name.symbol)) {
+            // (DarkMagician a = a + 1 يقرأ a الخارجي؛ في C++ الاسم الجديد يبدأ قبل الـ initializer)
+            std::string temp = "initial" + std::to_string(++temps);
+            line("auto " + temp + " = " + bare(visit(*stmt.initializer)) + ";");
+            line(declaration + " = " + temp + ";");
+        } else {
+            line(declaration + " = " + bare(visit(*stmt.initializer)) + ";");
+        }
+    }
+
+    void visitBlockStmt(const BlockStmt& stmt) {
+        line("{");
+        body(stmt.statements);
+        line("}");
+    }
+
+    void visitIfStmt(const IfStmt& stmt) {
+        line("if (" + condition(*stmt.condition) + ") {");
+        branch(*stmt.thenBranch);
+        const Stmt* elseBranch = stmt.elseBranch ? &*stmt.elseBranch : nullptr;
+        // (SolemnJudgment JudgmentOfAnubis ... -> else if)
+        while (elseBranch && elseBranch->kind == StmtKind::If) {
+            const IfStmt& next = static_cast<const IfStmt&>(*elseBranch);
+            line("} else if (" + condition(*next.condition) + ") {");
+            branch(*next.thenBranch);
+            elseBranch = next.elseBranch ? &*next.elseBranch : nullptr;
+        }
+        if (elseBranch) {
+            line("} else {");
+            branch(*elseBranch);
+        }
+        line("}");
+    }
+
+    void visitWhileStmt(const WhileStmt& stmt) {
+        line("while (" + condition(*stmt.condition) + ") {");
+        branch(*stmt.body);
+        line("}");
+    }
+
+    void visitReturnStmt(const ReturnStmt& stmt) {
+        // (Tribute في المستوى الأعلى يوقف البرنامج كله، وقيمته تُحسب ثم تُهمل)
+        // (Ritual بدون نوع = void في C++، و return f() مسموح فيه إذا كانت f أيضاً void)
+        if (stmt.value) discarded = unwrap(*stmt.value)->kind == ExprKind::Call && (inScript || returnsVoid);
+        if (inScript) {
+            if (stmt.value) line("(void)" + visit(*stmt.value) + ";");
+            line("return;");
+            return;
+        }
+        line(stmt.value ? "return " + bare(visit(*stmt.value)) + ";" : "return;");
+    }
+
+    // (التعريفات تُكتب من ResolvedProgram، لا من مكانها في الـ script)
+    void visitFunctionStmt(const FunctionStmt&) {}
+    void visitClassStmt(const ClassStmt&) {}
+    void visitStructStmt(const StructStmt&) {}
+    void visitIncludeStmt(const IncludeStmt&) {}
+    void visitUsingStmt(const UsingStmt&) {}
+
+    // --- التعبيرات: كل visit يعيد تعبير C++ (بين أقواس إذا كان له operator) ---
+
+    std::string visitBinaryExpr(const BinaryExpr& expr) {
+        std::string left = visit(*expr.left);
+        std::string right = visit(*expr.right);
+        if (independent(*expr.left, *expr.right)) return binary(expr, left, right);
+        // (اليسار أولاً مثل الـ Interpreter: اليمين قد يغيره، أو يطبع شيئاً)
+        return "[&] { auto left = " + bare(left) + "; return " + bare(binary(expr, "left", right)) + "; }()";
+    }
+
+    std::string visitGroupingExpr(const GroupingExpr& expr) { return visit(*expr.expression); }
+
+    std::string visitLiteralExpr(const LiteralExpr& expr) {
+        const Value& value = expr.value;
+        switch (value.type) {
+            case Value::Type::INT:
+                return value.asInt == INT64_MIN ? "INT64_MIN" : std::to_string(value.asInt);
+            case Value::Type::DOUBLE: return number(value.asDouble);
+            case Value::Type::BOOL: return value.asBool ? "true" : "false";
+            case Value::Type::STRING: return "std::string(" + quote(value.stringValue()) + ")";
+            default: return "0";
+        }
+    }
+
+    std::string visitUnaryExpr(const UnaryExpr& expr) {
+        std::string right = visit(*expr.right);
+        if (expr.op.type == TokenType::BANG) return "(!" + truthy(*expr.right, right) + ")";
+        return expr.right->type == StaticType::INT ? "ds::neg(" + bare(right) + ")" : "(-" + right + ")";
+    }
+
+    std::string visitVariableExpr(const VariableExpr& expr) { return reference(expr.name, expr.slot); }
+
+    std::string visitAssignExpr(const AssignExpr& expr) {
+        return "(" + reference(expr.name, expr.slot) + " = " + bare(visit(*expr.value)) + ")";
+    }
+
+    std::string visitCallExpr(const CallExpr& expr) {
+        bool used = !discarded;
+        discarded = false;
+        std::string object;
+        uint32_t ritual = expr.target.index;
+        if (expr.target.kind == CallTarget::METHOD) {
+            const GetExpr& get = static_cast<const GetExpr&>(*expr.callee);
+            object = visit(*get.object);
+            ritual = program->layouts[get.member.layout].methods[get.member.index];
+        }
+        const Token& ritualName = program->rituals[ritual].decl->name;
+        if (used && checker->returnType(ritual).kind == StaticType::UNKNOWN) {
+            diagnostics->report({DiagCode::UNTYPED_RITUAL, 0, expr.paren.line, false, expr.paren.lexeme, ritualName.lexeme});
+            failed = true;
+        }
+        // (Ritual عام بنفس اسم method: الـ Resolver اختار العام، فـ :: يمنع C++ من اختيار الـ method)
+        std::string callee = (object.empty() ? (expr.target.kind == CallTarget::FUNCTION ? "::" : "") : object + "->") +
+                             name(ritualName, "_r");
+        std::string enter = "ds::enter(" + std::to_string(expr.paren.line) + ", " + quote(expr.paren.lexeme) + ")";
+
+        std::vector<std::string> arguments;
+        bool ordered = true; // (أي ترتيب للـ arguments يعطي نفس النتيجة)
+        for (size_t i = 0; i < expr.arguments.size(); ++i) {
+            arguments.push_back(bare(visit(*expr.arguments[i])));
+            for (size_t j = 0; j < i; ++j) ordered &= independent(*expr.arguments[j], *expr.arguments[i]);
+        }
+        if (ordered) return "(" + enter + ", " + callee + "(" + join(arguments) + "))";
+
+        // (البارامترات بالترتيب من اليسار، ثم الاستدعاء)
+        std::string code = "[&] { ";
+        if (!object.empty()) {
+            code += "auto object = " + bare(object) + "; ";
+            callee = "object->" + name(ritualName, "_r");
+        }
+        code += enter + "; ";
+        for (size_t i = 0; i < arguments.size(); ++i) {
+            code += "auto argument" + std::to_string(i) + " = " + arguments[i] + "; ";
+            arguments[i] = "argument" + std::to_string(i);
+        }
+        return code + "return " + callee + "(" + join(arguments) + "); }()";
+    }
+
+    std::string visitGetExpr(const GetExpr& expr) { return visit(*expr.object) + "->" + name(expr.name, "_"); }
+
+    std::string visitSetExpr(const SetExpr& expr) {
+        std::string object = visit(*expr.object);
+        std::string value = bare(visit(*expr.value));
+        // (C++ يحسب يمين = قبل يساره، والـ Interpreter الـ object أولاً)
+        if (independent(*expr.object, *expr.value)) return "(" + object + "->" + name(expr.name, "_") + " = " + value + ")";
+        return "[&] { auto object = " + bare(object) + "; return object->" + name(expr.name, "_") + " = " + value + "; }()";
+    }
+
+private:
+    // --- أجزاء الملف ---
+
+    // (الـ runtime الصغير الذي يحتاجه كل ملف: الطباعة، الحساب بدون undefined behavior، والأخطاء)
+    static std::string prelude() {
+        std::string code = R"(
+#include <charconv>
+#include <cstdint>
+#include <cstdio>
+#include <iostream>
+#include <limits>
+#include <string>
+#include <type_traits>
+
+namespace ds {
+
+constexpr int MAX_DEPTH = 1000;
+constexpr size_t OUTPUT_FLUSH = 64 * 1024;
+)";
+        code += "const char* const DIVISION_BY_ZERO = " + quote(diagnosticTemplate(DiagCode::DIVISION_BY_ZERO)) + ";\n";
+        code += "const char* const STACK_OVERFLOW = " + quote(diagnosticTemplate(DiagCode::STACK_OVERFLOW)) + ";\n";
+        code += R"(
+struct Failure {}; // (الخطأ طُبع؛ duelscript_run يعيد 70)
+
+inline std::string output; // (Summon يكتب هنا، ويُفرغ كل OUTPUT_FLUSH وعند النهاية)
+inline int depth = 0;
+
+inline void flush() {
+    std::fwrite(output.data(), 1, output.size(), stdout);
+    std::fflush(stdout);
+    output.clear();
+}
+
+[[noreturn]] inline void fail(int line, const char* at, const char* message) {
+    flush();
+    std::fprintf(stderr, "[Line %d] Error at '%s': %s\n", line, at, message);
+    throw Failure{};
+}
+
+// Summon: كل قيمة كنص بدون سطر جديد (مثل cout)
+struct Print {
+    template <typename T>
+    Print& operator<<(const T& value) {
+        char buffer[32];
+        if constexpr (std::is_same_v<T, bool>) {
+            output += value ? "true" : "false";
+        } else if constexpr (std::is_integral_v<T>) {
+            auto [end, ignored] = std::to_chars(buffer, buffer + sizeof(buffer), static_cast<int64_t>(value));
+            output.append(buffer, end);
+        } else if constexpr (std::is_floating_point_v<T>) {
+            int length = std::snprintf(buffer, sizeof(buffer), "%g", static_cast<double>(value));
+            output.append(buffer, static_cast<size_t>(length));
+        } else if constexpr (std::is_same_v<T, std::string> || std::is_array_v<T>) {
+            output += value;
+        } else {
+            output += "<object>";
+        }
+        if (output.size() >= OUTPUT_FLUSH) flush();
+        return *this;
+    }
+};
+inline Print print;
+
+// (الـ overflow في DarkMagician يلتف مثل unsigned)
+inline int64_t add(int64_t a, int64_t b) { return static_cast<int64_t>(static_cast<uint64_t>(a) + static_cast<uint64_t>(b)); }
+inline int64_t sub(int64_t a, int64_t b) { return static_cast<int64_t>(static_cast<uint64_t>(a) - static_cast<uint64_t>(b)); }
+inline int64_t mul(int64_t a, int64_t b) { return static_cast<int64_t>(static_cast<uint64_t>(a) * static_cast<uint64_t>(b)); }
+inline int64_t neg(int64_t a) { return static_cast<int64_t>(0 - static_cast<uint64_t>(a)); }
+inline int64_t div(int64_t a, int64_t b, int line) {
+    if (b == 0) fail(line, "/", DIVISION_BY_ZERO);
+    return b == -1 ? neg(a) : a / b;
+}
+
+template <typename T>
+bool truthy(const T& value) {
+    if constexpr (std::is_same_v<T, std::string>) {
+        return !value.empty();
+    } else if constexpr (std::is_pointer_v<T>) {
+        return true;
+    } else {
+        return value != 0;
+    }
+}
+
+inline bool same(const void* a, const void* b) { return a == b; }
+
+// (قبل كل Ritual و object جديد: نفس حد الـ Interpreter)
+inline void enter(int line, const char* at) {
+    if (depth >= MAX_DEPTH) fail(line, at, STACK_OVERFLOW);
+}
+
+struct Frame {
+    Frame() { ++depth; }
+    ~Frame() { --depth; }
+};
+
+template <typename T>
+T* make(int line, const char* at) {
+    enter(line, at);
+    Frame frame;
+    return new T();
+}
+
+// Draw: كلمة من الـ input بنوع المتغير (مثل cin)
+inline std::string word() {
+    flush();
+    std::string text;
+    std::cin >> text;
+    return text;
+}
+inline void draw(std::string& value) { value = word(); }
+inline void draw(bool& value) {
+    std::string text = word();
+    value = text == "true" || text == "1";
+}
+inline void draw(int64_t& value) {
+    std::string text = word();
+    int64_t number = 0;
+    auto [end, error] = std::from_chars(text.data(), text.data() + text.size(), number);
+    value = error == std::errc() ? number : 0;
+}
+inline void draw(double& value) {
+    std::string text = word();
+    value = 0;
+    std::from_chars(text.data(), text.data() + text.size(), value);
+}
+
+} // namespace ds
+)";
+        return code;
+    }
+
+    // الأنواع، المتغيرات العامة، وتعريف كل دالة قبل أي جسم (الـ Rituals تستدعي بعضها بأي ترتيب)
+    void declarations() {
+        line("");
+        line("// --- LordOfD / ToonWorld ---");
+        for (const ClassLayout& layout : program->layouts) line(classKey(layout) + " " + name(layout.name, "_t") + ";");
+
+        line("");
+        line("// --- Globals ---");
+        for (const VarDeclStmt* global : program->globals) {
+            CheckedType type = declaredType(global->type, global->layout);
+            line("static " + cppType(type) + " " + variable(global->name) + initialValue(type) + ";");
+        }
+
+        for (const ClassLayout& layout : program->layouts) {
+            line("");
+            line(classKey(layout) + " " + name(layout.name, "_t") + " {");
+            if (!layout.isStruct) line("public:");
+            indent++;
+            for (const VarDeclStmt* field : layout.fields) {
+                CheckedType type = declaredType(field->type, field->layout);
+                line(cppType(type) + " " + variable(field->name) + initialValue(type) + ";");
+            }
+            line("");
+            line(name(layout.name, "_t") + "();");
+            for (uint32_t method : layout.methods) line(signature(method, false) + ";");
+            indent--;
+            line("};");
+        }
+
+        line("");
+        line("// --- Rituals ---");
+        for (uint32_t i = 0; i < program->rituals.size(); ++i) {
+            if (program->rituals[i].layout == MemberSlot::NONE) line("static " + signature(i, false) + ";");
+        }
+    }
+
+    // (الحقول بترتيب تعريفها، والـ object الجديد هو this)
+    void constructors() {
+        for (const ClassLayout& layout : program->layouts) {
+            std::string type = name(layout.name, "_t");
+            line("");
+            line(type + "::" + type + "() {");
+            indent++;
+            for (const VarDeclStmt* field : layout.fields) {
+                if (field->initializer) {
+                    line(variable(field->name) + " = " + bare(visit(*field->initializer)) + ";");
+                } else if (field->layout != MemberSlot::NONE) {
+                    line(variable(field->name) + defaultValue(*field) + ";");
+                }
+            }
+            indent--;
+            line("}");
+        }
+    }
+
+    void ritual(uint32_t index) {
+        const FunctionStmt& decl = *program->rituals[index].decl;
+        line("");
+        StaticType returns = checker->returnType(index).kind;
+        returnsVoid = returns == StaticType::NIL || returns == StaticType::UNKNOWN;
+        line(signature(index, true) + " {");
+        line("    ds::Frame frame;");
+        // (متغير في أول الجسم بنفس اسم بارامتر: مسموح في DuelScript لكن ليس في أعلى دالة C++)
+        bool shadows = false;
+        for (const NodePtr<Stmt>& statement : decl.body->statements) {
+            if (statement->kind != StmtKind::VarDecl) continue;
+            for (const FunctionParameter& param : decl.params) {
+                shadows |= static_cast<const VarDeclStmt&>(*statement).name.symbol == param.name.symbol;
+            }
+        }
+        if (shadows) {
+            indent++;
+            visitBlockStmt(*decl.body);
+            indent--;
+        } else {
+            body(decl.body->statements);
+        }
+        line("}");
+    }
+
+    // القيم الافتراضية للعام، المستوى الأعلى لكل الـ units، ثم Yugi() (مثل Interpreter::run)
+    void script() {
+        line("");
+        line("// --- Script ---");
+        line("static void script() {");
+        inScript = true;
+        indent++;
+        for (const VarDeclStmt* global : program->globals) {
+            CheckedType type = declaredType(global->type, global->layout);
+            line("::" + variable(global->name) + (type.kind == StaticType::OBJECT ? defaultValue(*global) : initialValue(type)) + ";");
+        }
+        indent--;
+        for (const std::vector<NodePtr<Stmt>>* unit : program->units) body(*unit);
+        indent++;
+        if (program->entry != ResolvedProgram::NO_ENTRY) {
+            const FunctionStmt& decl = *program->rituals[program->entry].decl;
+            const Token& entry = decl.name;
+            // (الـ Resolver يرفض Yugi ببارامترات؛ هنا فقط حتى لا يخرج C++ لا يُبنى: Yugi_r() بدون قيم)
+            if (!decl.params.empty()) {
+                const Token& param = decl.params[0].name;
+                diagnostics->report({DiagCode::ENTRY_PARAMETERS, 0, param.line, false, param.lexeme, {}});
+                failed = true;
+            }
+            line("ds::enter(" + std::to_string(entry.line) + ", " + quote(entry.lexeme) + ");");
+            line(name(entry, "_r") + "();");
+        }
+        inScript = false;
+        indent--;
+        line("}");
+        line("");
+        line("extern \"C\" int duelscript_run() {");
+        line("    ds::depth = 0;");
+        line("    try {");
+        line("        script();");
+        line("    } catch (const ds::Failure&) {");
+        line("        return 70;");
+        line("    }");
+        line("    ds::flush();");
+        line("    return 0;");
+        line("}");
+        line("");
+        line("#ifndef DUELSCRIPT_NO_MAIN");
+        line("int main() { return duelscript_run(); }");
+        line("#endif");
+    }
+
+    // --- أجزاء صغيرة ---
+
+    void line(const std::string& code) {
+        if (!code.empty()) text.append(indent * 4, ' ');
+        text += code;
+        text += '\n';
+    }
+
+    void body(const std::vector<NodePtr<Stmt>>& statements) {
+        indent++;
+        for (const NodePtr<Stmt>& statement : statements) {
+            if (statement) visit(*statement);
+        }
+        indent--;
+    }
+
+    // (فرع if / جسم while: الـ block يُكتب بدون أقواس إضافية)
+    void branch(const Stmt& stmt) {
+        if (stmt.kind == StmtKind::Block) {
+            body(static_cast<const BlockStmt&>(stmt).statements);
+            return;
+        }
+        indent++;
+        visit(stmt);
+        indent--;
+    }
+
+    // (if ((t = x)) بقوسين: الإسناد كشرط مقصود)
+    std::string condition(const Expr& expr) {
+        std::string code = truthy(expr, visit(expr));
+        ExprKind kind = unwrap(expr)->kind;
+        return kind == ExprKind::Assign || kind == ExprKind::Set ? code : bare(code);
+    }
+
+    static std::string truthy(const Expr& expr, const std::string& code) {
+        return expr.type == StaticType::BOOL ? code : "ds::truthy(" + bare(code) + ")";
+    }
+
+    std::string binary(const BinaryExpr& expr, const std::string& left, const std::string& right) const {
+        StaticType leftType = expr.left->type, rightType = expr.right->type;
+        bool integers = leftType == StaticType::INT && rightType == StaticType::INT;
+        const char* helper = nullptr;
+        switch (expr.op.type) {
+            case TokenType::PLUS: helper = "add"; break;
+            case TokenType::MINUS: helper = "sub"; break;
+            case TokenType::STAR: helper = "mul"; break;
+            case TokenType::SLASH: {
+                if (!integers) break;
+                // (قسمة على ثابت غير 0 و -1 لا تحتاج أي فحص)
+                const Expr* divisor = unwrap(*expr.right);
+                if (divisor->kind == ExprKind::Literal) {
+                    int64_t value = static_cast<const LiteralExpr&>(*divisor).value.asInt;
+                    if (value != 0 && value != -1) break;
+                }
+                return "ds::div(" + bare(left) + ", " + bare(right) + ", " + std::to_string(expr.op.line) + ")";
+            }
+            case TokenType::EQUAL_EQUAL:
+            case TokenType::BANG_EQUAL: {
+                bool equal = expr.op.type == TokenType::EQUAL_EQUAL;
+                bool numbers = (leftType == StaticType::INT || leftType == StaticType::DOUBLE) &&
+                               (rightType == StaticType::INT || rightType == StaticType::DOUBLE);
+                if (leftType == StaticType::OBJECT && rightType == StaticType::OBJECT) {
+                    return std::string(equal ? "" : "!") + "ds::same(" + bare(left) + ", " + bare(right) + ")";
+                }
+                // (نوعان مختلفان لا يتساويان أبداً، لكن الطرفان يُحسبان)
+                if (!numbers && leftType != rightType) {
+                    return "((void)" + left + ", (void)" + right + ", " + (equal ? "false" : "true") + ")";
+                }
+                break;
+            }
+            default: break;
+        }
+        if (integers && helper) return std::string("ds::") + helper + "(" + bare(left) + ", " + bare(right) + ")";
+        return "(" + left + " " + std::string(expr.op.lexeme) + " " + right + ")";
+    }
+
+    // (Summon << a << b: كل جزء قيمة مستقلة)
+    static void summonParts(const Expr& expr, std::vector<const Expr*>& parts) {
+        if (expr.kind == ExprKind::Binary) {
+            const BinaryExpr& chain = static_cast<const BinaryExpr&>(expr);
+            if (chain.op.type == TokenType::SUMMON_OP) {
+                summonParts(*chain.left, parts);
+                summonParts(*chain.right, parts);
+                return;
+            }
+        }
+        parts.push_back(&expr);
+    }
+
+    static const Expr* unwrap(const Expr& expr) {
+        const Expr* inner = &expr;
+        while (inner->kind == ExprKind::Grouping) inner = &*static_cast<const GroupingExpr&>(*inner).expression;
+        return inner;
+    }
+
+    // تعبير يغير متغيراً أو يستدعي Ritual (فترتيبه بالنسبة لما حوله مهم)
+    static bool impure(const Expr& expr) {
+        switch (expr.kind) {
+            case ExprKind::Binary: {
+                const BinaryExpr& binary = static_cast<const BinaryExpr&>(expr);
+                return impure(*binary.left) || impure(*binary.right);
+            }
+            case ExprKind::Grouping: return impure(*static_cast<const GroupingExpr&>(expr).expression);
+            case ExprKind::Unary: return impure(*static_cast<const UnaryExpr&>(expr).right);
+            case ExprKind::Get: return impure(*static_cast<const GetExpr&>(expr).object);
+            case ExprKind::Literal:
+            case ExprKind::Variable:
+                return false;
+            case ExprKind::Assign:
+            case ExprKind::Call:
+            case ExprKind::Set:
+                break;
+        }
+        return true;
+    }
+
+    // (تعبيران يمكن حسابهما بأي ترتيب: لا أثر لأحدهما، أو أحدهما ثابت)
+    static bool independent(const Expr& first, const Expr& second) {
+        return (!impure(first) && !impure(second)) || constant(first) || constant(second);
+    }
+
+    // (قيمته لا تتغير مهما حدث قبله أو بعده)
+    static bool constant(const Expr& expr) {
+        const Expr* inner = unwrap(expr);
+        if (inner->kind == ExprKind::Unary) return constant(*static_cast<const UnaryExpr&>(*inner).right);
+        return inner->kind == ExprKind::Literal;
+    }
+
+    // هل يقرأ التعبير أو يكتب متغيراً بهذا الاسم؟
+    static bool mentions(const Expr& expr, Symbol symbol) {
+        switch (expr.kind) {
+            case ExprKind::Binary: {
+                const BinaryExpr& binary = static_cast<const BinaryExpr&>(expr);
+                return mentions(*binary.left, symbol) || mentions(*binary.right, symbol);
+            }
+            case ExprKind::Grouping: return mentions(*static_cast<const GroupingExpr&>(expr).expression, symbol);
+            case ExprKind::Unary: return mentions(*static_cast<const UnaryExpr&>(expr).right, symbol);
+            case ExprKind::Variable: return static_cast<const VariableExpr&>(expr).name.symbol == symbol;
+            case ExprKind::Assign: {
+                const AssignExpr& assign = static_cast<const AssignExpr&>(expr);
+                return assign.name.symbol == symbol || mentions(*assign.value, symbol);
+            }
+            case ExprKind::Call: {
+                const CallExpr& call = static_cast<const CallExpr&>(expr);
+                if (call.callee->kind == ExprKind::Get && mentions(*call.callee, symbol)) return true;
+                for (const NodePtr<Expr>& argument : call.arguments) {
+                    if (mentions(*argument, symbol)) return true;
+                }
+                return false;
+            }
+            case ExprKind::Get: return mentions(*static_cast<const GetExpr&>(expr).object, symbol);
+            case ExprKind::Set: {
+                const SetExpr& set = static_cast<const SetExpr&>(expr);
+                return mentions(*set.object, symbol) || mentions(*set.value, symbol);
+            }
+            case ExprKind::Literal: break;
+        }
+        return false;
+    }
+
+    // --- الأنواع والأسماء ---
+
+    CheckedType declaredType(const Token& type, uint32_t layout) const {
+        switch (type.type) {
+            case TokenType::KEYWORD_DARKMAGICIAN: return {StaticType::INT};
+            case TokenType::KEYWORD_BLUEEYESWHITEDRAGON: return {StaticType::DOUBLE};
+            case TokenType::KEYWORD_REDEYESBLACKDRAGON: return {StaticType::STRING};
+            case TokenType::KEYWORD_TIMEWIZARD: return {StaticType::BOOL};
+            default: break;
+        }
+        if (layout == MemberSlot::NONE) {
+            auto found = layoutByName.find(type.symbol);
+            if (found != layoutByName.end()) layout = found->second;
+        }
+        return {StaticType::OBJECT, layout};
+    }
+
+    std::string cppType(CheckedType type) const {
+        switch (type.kind) {
+            case StaticType::INT: return "int64_t";
+            case StaticType::DOUBLE: return "double";
+            case StaticType::BOOL: return "bool";
+            case StaticType::STRING: return "std::string";
+            case StaticType::OBJECT: return name(program->layouts[type.layout].name, "_t") + "*";
+            default: return "void";
+        }
+    }
+
+    static std::string initialValue(CheckedType type) {
+        switch (type.kind) {
+            case StaticType::INT: return " = 0";
+            case StaticType::DOUBLE: return " = 0.0";
+            case StaticType::BOOL: return " = false";
+            case StaticType::OBJECT: return " = nullptr";
+            default: return "";
+        }
+    }
+
+    // (بدون initializer: صفر النوع، أو object جديد لـ LordOfD / ToonWorld)
+    std::string defaultValue(const VarDeclStmt& decl) const {
+        CheckedType type = declaredType(decl.type, decl.layout);
+        if (type.kind != StaticType::OBJECT) return initialValue(type);
+        return " = ds::make<" + name(program->layouts[type.layout].name, "_t") + ">(" + std::to_string(decl.name.line) +
+               ", " + quote(decl.name.lexeme) + ")";
+    }
+
+    static std::string classKey(const ClassLayout& layout) { return layout.isStruct ? "struct" : "class"; }
+
+    // (qualified = التعريف خارج الـ class: Owner_t::Name_r)
+    std::string signature(uint32_t index, bool qualified) const {
+        const RitualInfo& ritual = program->rituals[index];
+        std::string code = cppType(checker->returnType(index)) + " ";
+        if (qualified && ritual.layout != MemberSlot::NONE) {
+            code += name(program->layouts[ritual.layout].name, "_t") + "::";
+        }
+        code += name(ritual.decl->name, "_r") + "(";
+        std::vector<std::string> params;
+        for (const FunctionParameter& param : ritual.decl->params) {
+            params.push_back(cppType(declaredType(param.type, MemberSlot::NONE)) + " " + variable(param.name));
+        }
+        code += join(params) + ")";
+        if (qualified && ritual.layout == MemberSlot::NONE) code = "static " + code;
+        return code;
+    }
+
+    static std::string name(const Token& token, const char* suffix) { return std::string(token.lexeme) + suffix; }
+    static std::string variable(const Token& token) { return name(token, "_"); }
+
+    // (مكان المتغير كما حدده الـ Resolver، لا كما يبحث عنه C++: الحقل والعام قد يحملان نفس الاسم)
+    static std::string reference(const Token& token, VarSlot slot) {
+        switch (slot.depth) {
+            case VarSlot::FIELD: return "this->" + variable(token);
+            case VarSlot::GLOBAL: return "::" + variable(token);
+            default: return variable(token);
+        }
+    }
+
+    static std::string join(const std::vector<std::string>& items) {
+        std::string code;
+        for (size_t i = 0; i < items.size(); ++i) code += (i == 0 ? "" : ", ") + items[i];
+        return code;
+    }
+
+    // (الأقواس الخارجية فقط إذا كانت تحيط بالتعبير كله، وليس فيه comma operator)
+    static std::string bare(const std::string& code) {
+        if (code.size() < 2 || code.front() != '(' || code.back() != ')') return code;
+        int depth = 0;
+        bool inString = false;
+        for (size_t i = 0; i + 1 < code.size(); ++i) {
+            char c = code[i];
+            if (inString) {
+                if (c == '\\') ++i;
+                else if (c == '"') inString = false;
+                continue;
+            }
+            if (c == '"') inString = true;
+            else if (c == '(') depth++;
+            else if (c == ')' && --depth == 0) return code; // ((a) + (b))
+            else if (c == ',' && depth == 1) return code;   // (enter(), f()) لا يصبح بارامترين
+        }
+        return code.substr(1, code.size() - 2);
+    }
+
+    // BlueEyesWhiteDragon كـ literal يعود بنفس القيمة بالضبط
+    static std::string number(double value) {
+        if (std::isnan(value)) return "std::numeric_limits<double>::quiet_NaN()";
+        if (std::isinf(value)) return value > 0 ? "std::numeric_limits<double>::infinity()" : "(-std::numeric_limits<double>::infinity())";
+        char buffer[32];
+        std::snprintf(buffer, sizeof(buffer), "%.17g", value);
+        std::string code = buffer;
+        if (code.find_first_of(".e") == std::string::npos) code += ".0";
+        return value < 0 ? "(" + code + ")" : code;
+    }
+
+    static std::string quote(std::string_view value) {
+        std::string code = "\"";
+        for (unsigned char c : value) {
+            switch (c) {
+                case '"': code += "\\\""; break;
+                case '\\': code += "\\\\"; break;
+                case '\n': code += "\\n"; break;
+                case '\t': code += "\\t"; break;
+                default:
+                    if (c < 0x20 || c == 0x7F) {
+                        char escape[8];
+                        std::snprintf(escape, sizeof(escape), "\\%03o", c);
+                        code += escape;
+                    } else {
+                        code += static_cast<char>(c);
+                    }
+            }
+        }
+        return code + "\"";
+    }
+
+    const ResolvedProgram* program = nullptr;
+    const TypeChecker* checker = nullptr;
+    Diagnostics* diagnostics = nullptr;
+    bool failed = false;
+    bool discarded = false;   // (الـ Call التالي جملة كاملة: قيمته لا تُستخدم)
+    bool returnsVoid = false; // (الـ Ritual الحالي بدون قيمة)
+    std::unordered_map<Symbol, uint32_t> layoutByName;
+    std::string text;
+    int indent = 0;
+    int temps = 0;
+    bool inScript = false;
+};
+
+// --- NativeBuild: الـ C++ الناتج -> executable أو shared object بالـ compiler الموجود في النظام ---
+
+// تشغيل برنامج بـ argv مباشرة (بدون shell: المسارات تمر كما هي مهما كانت حروفها)، وانتظار نهايته.
+// stdoutPath / stderrPath (اختياري) = تحويل المخرجات إلى ملف.
+// (الـ exit code نفسه؛ 128 + رقم الـ signal إن قُتل؛ 127 إن لم يُوجد البرنامج)
+inline int runProcess(const std::vector<std::string>& args, const char* stdoutPath = nullptr,
+                      const char* stderrPath = nullptr) {
+#if defined(DUELSCRIPT_HAVE_SPAWN)
+    std::vector<char*> argv;
+    for (const std::string& arg : args) argv.push_back(const_cast<char*>(arg.c_str()));
+    argv.push_back(nullptr);
+
+    posix_spawn_file_actions_t actions;
+    posix_spawn_file_actions_init(&actions);
+    if (stdoutPath) posix_spawn_file_actions_addopen(&actions, 1, stdoutPath, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (stderrPath) posix_spawn_file_actions_addopen(&actions, 2, stderrPath, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    pid_t pid;
+    int error = posix_spawnp(&pid, argv[0], &actions, nullptr, argv.data(), environ);
+    posix_spawn_file_actions_destroy(&actions);
+    if (error != 0) return 127;
+
+    int status = 0;
+    while (waitpid(pid, &status, 0) == -1) {
+        if (errno != EINTR) return 1;
+    }
+    if (WIFEXITED(status)) return WEXITSTATUS(status);
+    return WIFSIGNALED(status) ? 128 + WTERMSIG(status) : 1;
+#else
+    (void)args, (void)stdoutPath, (void)stderrPath;
+    return 127;
+#endif
+}
+
+// الـ compiler: $CXX إن وُجد، مقسوماً على المسافات مثل "ccache g++"، وإلا c++
+inline std::vector<std::string> compilerCommand() {
+    std::vector<std::string> args;
+    const char* compiler = std::getenv("CXX");
+    std::string_view words = compiler && *compiler ? compiler : "c++";
+    while (!words.empty()) {
+        size_t start = words.find_first_not_of(" \t");
+        if (start == std::string_view::npos) break;
+        size_t end = words.find_first_of(" \t", start);
+        args.emplace_back(words.substr(start, end - start));
+        words = end == std::string_view::npos ? std::string_view() : words.substr(end);
+    }
+    if (args.empty()) args.emplace_back("c++");
+    return args;
+}
+
+// (الـ exit code الخاص بالـ compiler يعود كما هو، و 127 إذا تعذر تشغيله أصلاً)
+inline int buildNative(const std::string& source, const std::string& output, bool shared) {
+    std::vector<std::string> args = compilerCommand();
+    args.insert(args.end(), {"-std=c++17", "-O2"});
+    if (shared) args.insert(args.end(), {"-shared", "-fPIC", "-DDUELSCRIPT_NO_MAIN"});
+    args.insert(args.end(), {"-o", output, source});
+    return runProcess(args);
+}
+
+#endif // DUELSCRIPT_CPPEMITTER_H
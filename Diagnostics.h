@@ -0,0 +1,255 @@
+#ifndef DUELSCRIPT_DIAGNOSTICS_H
+#define DUELSCRIPT_DIAGNOSTICS_H
+
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <sstream>
+#include <string_view>
+#include <vector>
+
+// --- DiagCode ---
+// كل رسالة خطأ ممكنة لها رقم ثابت؛ النص نفسه في diagnosticTemplate.
+enum class DiagCode : uint16_t {
+    // --- Scanner ---
+    UNTERMINATED_STRING,
+    UNTERMINATED_SHADOW_REALM,
+    UNEXPECTED_CHARACTER,
+    SOURCE_TOO_LARGE,
+
+    // --- Parser ---
+    EXPECT_MODULE_NAME,
+    EXPECT_SEMICOLON_AFTER_SETFIELD,
+    EXPECT_JOEY,
+    EXPECT_SEMICOLON_AFTER_USING,
+    EXPECT_CLASS_NAME,
+    EXPECT_LEFT_BRACE_BEFORE_CLASS_BODY,
+    EXPECT_CLASS_MEMBER,
+    EXPECT_RIGHT_BRACE_AFTER_CLASS_BODY,
+    EXPECT_SEMICOLON_AFTER_CLASS,
+    EXPECT_STRUCT_NAME,
+    EXPECT_LEFT_BRACE_BEFORE_STRUCT_BODY,
+    EXPECT_RIGHT_BRACE_AFTER_STRUCT_BODY,
+    EXPECT_SEMICOLON_AFTER_STRUCT,
+    EXPECT_RITUAL_NAME,
+    EXPECT_LEFT_PAREN_AFTER_RITUAL_NAME,
+    EXPECT_RIGHT_PAREN_AFTER_PARAMETERS,
+    EXPECT_LEFT_BRACE_BEFORE_RITUAL_BODY,
+    TOO_MANY_PARAMETERS,
+    EXPECT_PARAMETER_TYPE,
+    EXPECT_PARAMETER_NAME,
+    EXPECT_VARIABLE_TYPE,
+    EXPECT_VARIABLE_NAME,
+    EXPECT_SEMICOLON_AFTER_VARIABLE,
+    EXPECT_LEFT_PAREN_AFTER_IF,
+    EXPECT_RIGHT_PAREN_AFTER_CONDITION,
+    EXPECT_LEFT_PAREN_AFTER_WHILE,
+    EXPECT_RIGHT_PAREN_AFTER_WHILE_CONDITION,
+    EXPECT_SEMICOLON_AFTER_TRIBUTE,
+    EXPECT_SUMMON_OP,
+    EXPECT_SEMICOLON_AFTER_SUMMON,
+    EXPECT_RIGHT_BRACE_AFTER_BLOCK,
+    EXPECT_SEMICOLON_AFTER_EXPRESSION,
+    EXPECT_PROPERTY_NAME,
+    INVALID_ASSIGNMENT_TARGET,
+    TOO_MANY_ARGUMENTS,
+    EXPECT_RIGHT_PAREN_AFTER_ARGUMENTS,
+    EXPECT_RIGHT_PAREN_AFTER_EXPRESSION,
+    EXPECT_EXPRESSION,
+
+    // --- Modules ---
+    MODULE_NOT_FOUND,
+
+    // --- Resolver ---
+    UNDEFINED_VARIABLE,
+    UNDEFINED_RITUAL,
+    UNDEFINED_MEMBER,
+    UNKNOWN_TYPE,
+    ALREADY_DECLARED,
+    NOT_CALLABLE,
+    WRONG_ARGUMENT_COUNT,
+    NESTED_DECLARATION,
+    ENTRY_PARAMETERS,
+
+    // --- TypeChecker ---
+    TYPE_MISMATCH,
+    NO_TRIBUTE_VALUE,
+    MIXED_TRIBUTE,
+
+    // --- CppEmitter ---
+    UNTYPED_RITUAL,
+
+    // --- Runtime ---
+    OPERANDS_MUST_BE_NUMBERS,
+    OPERAND_MUST_BE_NUMBER,
+    DIVISION_BY_ZERO,
+    NOT_AN_OBJECT,
+    STACK_OVERFLOW,
+    STRING_TOO_LONG,
+
+    // --- Bytecode ---
+    BYTECODE_LIMIT,
+};
+
+// (%s = الـ arg المحفوظ مع الخطأ، مثل "function" / "method" أو الحرف غير المتوقع)
+constexpr std::string_view diagnosticTemplate(DiagCode code) {
+    switch (code) {
+        case DiagCode::UNTERMINATED_STRING: return "Unterminated string.";
+        case DiagCode::UNTERMINATED_SHADOW_REALM: return "Unterminated ShadowRealm block.";
+        case DiagCode::UNEXPECTED_CHARACTER: return "Unexpected character '%s'";
+        case DiagCode::SOURCE_TOO_LARGE: return "Source file is too large (more than %s bytes).";
+
+        case DiagCode::EXPECT_MODULE_NAME: return "Expect module name (string) after #SetField.";
+        case DiagCode::EXPECT_SEMICOLON_AFTER_SETFIELD: return "Expect ';' after #SetField declaration.";
+        case DiagCode::EXPECT_JOEY: return "Expect 'Joey' after 'Kaiba'.";
+        case DiagCode::EXPECT_SEMICOLON_AFTER_USING: return "Expect ';' after 'using' declaration.";
+        case DiagCode::EXPECT_CLASS_NAME: return "Expect class name.";
+        case DiagCode::EXPECT_LEFT_BRACE_BEFORE_CLASS_BODY: return "Expect '{' before class body.";
+        case DiagCode::EXPECT_CLASS_MEMBER: return "Expect method (Ritual) or field declaration inside class.";
+        case DiagCode::EXPECT_RIGHT_BRACE_AFTER_CLASS_BODY: return "Expect '}' after class body.";
+        case DiagCode::EXPECT_SEMICOLON_AFTER_CLASS: return "Expect ';' after class declaration.";
+        case DiagCode::EXPECT_STRUCT_NAME: return "Expect struct name.";
+        case DiagCode::EXPECT_LEFT_BRACE_BEFORE_STRUCT_BODY: return "Expect '{' before struct body.";
+        case DiagCode::EXPECT_RIGHT_BRACE_AFTER_STRUCT_BODY: return "Expect '}' after struct body.";
+        case DiagCode::EXPECT_SEMICOLON_AFTER_STRUCT: return "Expect ';' after struct declaration.";
+        case DiagCode::EXPECT_RITUAL_NAME: return "Expect %s name.";
+        case DiagCode::EXPECT_LEFT_PAREN_AFTER_RITUAL_NAME: return "Expect '(' after %s name.";
+        case DiagCode::EXPECT_RIGHT_PAREN_AFTER_PARAMETERS: return "Expect ')' after parameters.";
+        case DiagCode::EXPECT_LEFT_BRACE_BEFORE_RITUAL_BODY: return "Expect '{' before %s body.";
+        case DiagCode::TOO_MANY_PARAMETERS: return "Can't have more than 255 parameters.";
+        case DiagCode::EXPECT_PARAMETER_TYPE: return "Expect parameter type (e.g., DarkMagician).";
+        case DiagCode::EXPECT_PARAMETER_NAME: return "Expect parameter name.";
+        case DiagCode::EXPECT_VARIABLE_TYPE: return "Expect variable type.";
+        case DiagCode::EXPECT_VARIABLE_NAME: return "Expect variable name.";
+        case DiagCode::EXPECT_SEMICOLON_AFTER_VARIABLE: return "Expect ';' after variable declaration.";
+        case DiagCode::EXPECT_LEFT_PAREN_AFTER_IF: return "Expect '(' after 'JudgmentOfAnubis'.";
+        case DiagCode::EXPECT_RIGHT_PAREN_AFTER_CONDITION: return "Expect ')' after if condition.";
+        case DiagCode::EXPECT_LEFT_PAREN_AFTER_WHILE: return "Expect '(' after 'FairyBox'.";
+        case DiagCode::EXPECT_RIGHT_PAREN_AFTER_WHILE_CONDITION: return "Expect ')' after loop condition.";
+        case DiagCode::EXPECT_SEMICOLON_AFTER_TRIBUTE: return "Expect ';' after 'Tribute' value.";
+        case DiagCode::EXPECT_SUMMON_OP: return "Expect '<<' after 'Summon'.";
+        case DiagCode::EXPECT_SEMICOLON_AFTER_SUMMON: return "Expect ';' after 'Summon' statement.";
+        case DiagCode::EXPECT_RIGHT_BRACE_AFTER_BLOCK: return "Expect '}' after block.";
+        case DiagCode::EXPECT_SEMICOLON_AFTER_EXPRESSION: return "Expect ';' after expression.";
+        case DiagCode::EXPECT_PROPERTY_NAME: return "Expect property name after '.'.";
+        case DiagCode::INVALID_ASSIGNMENT_TARGET: return "Invalid assignment target.";
+        case DiagCode::TOO_MANY_ARGUMENTS: return "Can't have more than 255 arguments.";
+        case DiagCode::EXPECT_RIGHT_PAREN_AFTER_ARGUMENTS: return "Expect ')' after arguments.";
+        case DiagCode::EXPECT_RIGHT_PAREN_AFTER_EXPRESSION: return "Expect ')' after expression.";
+        case DiagCode::EXPECT_EXPRESSION: return "Expect expression.";
+
+        case DiagCode::MODULE_NOT_FOUND: return "Cannot find module in the module search paths.";
+
+        case DiagCode::UNDEFINED_VARIABLE: return "Undefined variable.";
+        case DiagCode::UNDEFINED_RITUAL: return "Undefined Ritual.";
+        case DiagCode::UNDEFINED_MEMBER: return "'%s' has no field or method with this name.";
+        case DiagCode::UNKNOWN_TYPE: return "Unknown type (expect a monster type, LordOfD or ToonWorld).";
+        case DiagCode::ALREADY_DECLARED: return "Already declared in this scope.";
+        case DiagCode::NOT_CALLABLE: return "Can only call Rituals and methods.";
+        case DiagCode::WRONG_ARGUMENT_COUNT: return "Wrong number of arguments for this Ritual.";
+        case DiagCode::NESTED_DECLARATION: return "Ritual, LordOfD and ToonWorld can only be declared at the top level.";
+        case DiagCode::ENTRY_PARAMETERS: return "Yugi() is called with no arguments, so it cannot take parameters.";
+
+        case DiagCode::TYPE_MISMATCH: return "Type mismatch: expected %s.";
+        case DiagCode::NO_TRIBUTE_VALUE: return "Ritual '%s' does not Tribute a value.";
+        case DiagCode::MIXED_TRIBUTE: return "Ritual '%s' must Tribute one type on every path.";
+        case DiagCode::UNTYPED_RITUAL: return "Cannot emit C++ for the value of Ritual '%s': it never Tributes.";
+
+        case DiagCode::OPERANDS_MUST_BE_NUMBERS: return "Operands must be numbers.";
+        case DiagCode::OPERAND_MUST_BE_NUMBER: return "Operand must be a number.";
+        case DiagCode::DIVISION_BY_ZERO: return "Division by zero.";
+        case DiagCode::NOT_AN_OBJECT: return "Only LordOfD and ToonWorld values have fields and methods.";
+        case DiagCode::STACK_OVERFLOW: return "Stack overflow (Rituals nested too deeply).";
+        case DiagCode::STRING_TOO_LONG: return "String is too long (more than 4294967295 bytes).";
+        case DiagCode::BYTECODE_LIMIT: return "Too large for the bytecode VM (%s).";
+    }
+    return "Unknown error.";
+}
+
+// --- Diagnostic ---
+// خطأ واحد كما حدث، بدون أي نص مُنسق: الرقم، مكان الـ Token، والـ arg.
+// (كل الـ string_views تشير إلى الـ source أو إلى نصوص ثابتة، لا حجز ذاكرة)
+struct Diagnostic {
+    static constexpr uint32_t NO_TOKEN = UINT32_MAX; // (أخطاء الـ Scanner)
+
+    DiagCode code;
+    uint32_t token;          // index الـ Token في الملف
+    int line;
+    bool atEnd;              // الخطأ عند الـ EOF
+    std::string_view lexeme; // الـ Token الذي حدث عنده الخطأ
+    std::string_view arg;
+};
+
+// --- Diagnostics ---
+// الـ sink الوحيد لأخطاء الـ Scanner والـ Parser معاً (بترتيب حدوثها).
+// التسجيل رخيص (push_back لـ struct صغير)، والتنسيق يحدث فقط في emit().
+// بعد LIMIT خطأ لا يُحفظ شيء، والـ Parser يتوقف (full()).
+class Diagnostics {
+public:
+    static constexpr size_t DEFAULT_LIMIT = 100;
+
+    explicit Diagnostics(size_t limit = DEFAULT_LIMIT) : limit(limit) {}
+
+    void report(const Diagnostic& diagnostic) {
+        reported++;
+        if (entries.size() < limit) entries.push_back(diagnostic);
+    }
+
+    // (خطأ Scanner: لا يوجد Token بعد، فقط السطر والـ arg)
+    void reportScanner(DiagCode code, int line, std::string_view arg = {}) {
+        report({code, Diagnostic::NO_TOKEN, line, false, {}, arg});
+    }
+
+    bool empty() const { return reported == 0; }
+    bool full() const { return reported >= limit; }
+    size_t count() const { return reported; }
+    size_t getLimit() const { return limit; }
+    const std::vector<Diagnostic>& all() const { return entries; }
+
+    // يطبع ما لم يُطبع بعد، بنفس الصيغة القديمة للـ Scanner والـ Parser
+    // (std::cerr بدون buffer: نُنسق في ostringstream ثم كتابة واحدة)
+    void emit(std::ostream& out) {
+        std::ostringstream text;
+        for (; emitted < entries.size(); ++emitted) {
+            format(text, entries[emitted]);
+            text << '\n';
+        }
+        if (reported > limit && !noticePrinted) {
+            text << "Too many errors (" << reported << "), only the first " << limit << " are shown.\n";
+            noticePrinted = true;
+        }
+        out << text.str();
+        out.flush();
+    }
+
+    static void format(std::ostream& out, const Diagnostic& diagnostic) {
+        if (diagnostic.token == Diagnostic::NO_TOKEN) {
+            out << "Line " << diagnostic.line << ": Error! ";
+        } else {
+            out << "[Line " << diagnostic.line << "] Error";
+            if (diagnostic.atEnd) {
+                out << " at end";
+            } else {
+                out << " at '" << diagnostic.lexeme << "'";
+            }
+            out << ": ";
+        }
+
+        std::string_view text = diagnosticTemplate(diagnostic.code);
+        size_t hole = text.find("%s");
+        if (hole == std::string_view::npos) {
+            out << text;
+        } else {
+            out << text.substr(0, hole) << diagnostic.arg << text.substr(hole + 2);
+        }
+    }
+
+private:
+    size_t limit;
+    size_t reported = 0;
+    size_t emitted = 0;
+    bool noticePrinted = false;
+    std::vector<Diagnostic> entries;
+};
+
+#endif // DUELSCRIPT_DIAGNOSTICS_H
@@ -1,11 +1,15 @@
 #ifndef DUELSCRIPT_SCANNER_H
 #define DUELSCRIPT_SCANNER_H
 
+#include <cstdint>
 #include <iostream>
 #include <string>
+#include <string_view>
 #include <vector>
-#include <map>
 #include <cctype>
+#include "Diagnostics.h"
+#include "ScanKernels.h"
+#include "SymbolTable.h"
 
 enum class TokenType {
     // ... (نفس الـ Tokens) ...
@@ -86,65 +90,144 @@ inline std::string tokenTypeToString(TokenType type) {
     }
 }
 
+// --- Token ---
+// الـ lexeme مجرد view داخل الـ source buffer (بدون أي نسخ).
+// الـ buffer نفسه مملوك للـ CompilationUnit ويجب أن يعيش أطول من الـ Tokens.
+// بالنسبة للـ STRING: الـ lexeme هو النص الخام بين علامتي التنصيص.
+// الـ IDENTIFIER والـ STRING يحملان أيضاً symbol من الـ SymbolTable.
 struct Token {
     TokenType type;
-    std::string lexeme;
+    std::string_view lexeme;
     int line;
+    Symbol symbol;
 
-    Token() : type(TokenType::TOKEN_EOF), lexeme(""), line(0) {}
+    Token() : type(TokenType::TOKEN_EOF), lexeme(), line(0), symbol(SymbolTable::EMPTY) {}
 
-    Token(TokenType type, std::string lexeme, int line)
-            : type(type), lexeme(lexeme), line(line) {}
+    Token(TokenType type, std::string_view lexeme, int line, Symbol symbol = SymbolTable::EMPTY)
+            : type(type), lexeme(lexeme), line(line), symbol(symbol) {}
 
     std::string toString() const {
         return "Line " + std::to_string(line) + ": " +
-               tokenTypeToString(type) + " [" + lexeme + "]";
+               tokenTypeToString(type) + " [" + std::string(lexeme) + "]";
     }
 };
 
+// --- جدول الكلمات المحجوزة (Perfect Hash) ---
+// الـ hash يعتمد على الطول وأول وآخر حرف فقط، والجدول يُبنى وقت الترجمة.
+// أي تصادم بين كلمتين يوقف الترجمة عند الـ static_assert.
+namespace keyword_table {
+
+struct Entry {
+    std::string_view text;
+    TokenType type = TokenType::IDENTIFIER;
+};
+
+inline constexpr Entry keywords[] = {
+    {"Yugi", TokenType::KEYWORD_YUGI},
+    {"LordOfD", TokenType::KEYWORD_LORDOFD},
+    {"ToonWorld", TokenType::KEYWORD_TOONWORLD},
+    {"Ritual", TokenType::KEYWORD_RITUAL},
+
+    {"Kaiba", TokenType::KEYWORD_KAIBA},
+    {"Joey", TokenType::KEYWORD_JOEY},
+    {"Summon", TokenType::KEYWORD_SUMMON},
+    {"Draw", TokenType::KEYWORD_DRAW},
+    {"JudgmentOfAnubis", TokenType::KEYWORD_JUDGMENTOFANUBIS},
+    {"SolemnJudgment", TokenType::KEYWORD_SOLEMNJUDGMENT},
+    {"FairyBox", TokenType::KEYWORD_FAIRYBOX},
+    {"SwordsOfRevealingLight", TokenType::KEYWORD_SWORDSOFREVEALINGLIGHT},
+    {"Tribute", TokenType::KEYWORD_TRIBUTE},
+
+    {"DarkMagician", TokenType::KEYWORD_DARKMAGICIAN},
+    {"BlueEyesWhiteDragon", TokenType::KEYWORD_BLUEEYESWHITEDRAGON},
+    {"RedEyesBlackDragon", TokenType::KEYWORD_REDEYESBLACKDRAGON},
+    {"TimeWizard", TokenType::KEYWORD_TIMEWIZARD},
+
+    {"true", TokenType::KEYWORD_TRUE},
+    {"false", TokenType::KEYWORD_FALSE},
+};
+
+constexpr std::size_t TABLE_SIZE = 64;
+
+// (النص لا يكون فارغاً أبداً: identifier() يستهلك حرفاً واحداً على الأقل)
+constexpr std::size_t hash(std::string_view text) {
+    return (text.size()
+            + static_cast<unsigned char>(text.front())
+            + static_cast<unsigned char>(text.back()) * 5u) & (TABLE_SIZE - 1);
+}
+
+struct Table {
+    Entry slots[TABLE_SIZE] = {};
+    bool collision = false;
+};
+
+constexpr Table build() {
+    Table table;
+    for (const Entry& entry : keywords) {
+        Entry& slot = table.slots[hash(entry.text)];
+        if (!slot.text.empty()) table.collision = true;
+        slot = entry;
+    }
+    return table;
+}
+
+inline constexpr Table table = build();
+static_assert(!table.collision, "keyword_table::hash has a collision, pick new constants");
+
+} // namespace keyword_table
+
+// مقارنة واحدة فقط لكل identifier
+inline TokenType lookupKeyword(std::string_view text) {
+    const keyword_table::Entry& slot = keyword_table::table.slots[keyword_table::hash(text)];
+    return slot.text == text ? slot.type : TokenType::IDENTIFIER;
+}
+
 class Scanner {
 public:
-    Scanner(const std::string& source)
-            : source(source), start(0), current(0), line(1) {
-        keywords["Yugi"] = TokenType::KEYWORD_YUGI;
-        keywords["LordOfD"] = TokenType::KEYWORD_LORDOFD;
-        keywords["ToonWorld"] = TokenType::KEYWORD_TOONWORLD;
-        keywords["Ritual"] = TokenType::KEYWORD_RITUAL;
-
-        keywords["Kaiba"] = TokenType::KEYWORD_KAIBA;
-        keywords["Joey"] = TokenType::KEYWORD_JOEY;
-        keywords["Summon"] = TokenType::KEYWORD_SUMMON;
-        keywords["Draw"] = TokenType::KEYWORD_DRAW;
-        keywords["JudgmentOfAnubis"] = TokenType::KEYWORD_JUDGMENTOFANUBIS;
-        keywords["SolemnJudgment"] = TokenType::KEYWORD_SOLEMNJUDGMENT;
-        keywords["FairyBox"] = TokenType::KEYWORD_FAIRYBOX;
-        keywords["SwordsOfRevealingLight"] = TokenType::KEYWORD_SWORDSOFREVEALINGLIGHT;
-        keywords["Tribute"] = TokenType::KEYWORD_TRIBUTE;
-
-        keywords["DarkMagician"] = TokenType::KEYWORD_DARKMAGICIAN;
-        keywords["BlueEyesWhiteDragon"] = TokenType::KEYWORD_BLUEEYESWHITEDRAGON;
-        keywords["RedEyesBlackDragon"] = TokenType::KEYWORD_REDEYESBLACKDRAGON;
-        keywords["TimeWizard"] = TokenType::KEYWORD_TIMEWIZARD;
-
-        keywords["true"] = TokenType::KEYWORD_TRUE;
-        keywords["false"] = TokenType::KEYWORD_FALSE;
+    // (الـ Scanner لا ينسخ الـ source؛ المستدعي يملك الـ buffer)
+    // (جدول الكلمات المحجوزة ثابت وقت الترجمة، لا يحتاج أي تهيئة هنا)
+    // (diagnostics: الأخطاء تُسجل هناك؛ بدونه تُطبع على std::cerr فوراً)
+    Scanner(std::string_view source, Diagnostics* diagnostics = nullptr)
+            : source(source), diagnostics(diagnostics), start(0), current(0), line(1) {
+        // (الـ offsets هنا int، وفي TokenBuffer / FlatAst uint32: ملف أكبر يلتف بصمت، فنرفضه كله)
+        if (source.size() > MAX_SOURCE_BYTES) {
+            report(DiagCode::SOURCE_TOO_LARGE, MAX_SOURCE_TEXT);
+            this->source = source.substr(0, 0);
+        }
     }
 
+    static constexpr size_t MAX_SOURCE_BYTES = INT32_MAX;
+    static constexpr std::string_view MAX_SOURCE_TEXT = "2147483647";
 
+
+    // --- الـ Batch API: كل الـ Tokens مرة واحدة ---
     std::vector<Token> scanTokens() {
-        while (!isAtEnd()) {
+        std::vector<Token> tokens;
+        do {
+            tokens.push_back(nextToken());
+        } while (tokens.back().type != TokenType::TOKEN_EOF);
+        return tokens;
+    }
+
+    // --- الـ Streaming API: Token واحد عند الطلب ---
+    // (بعد نهاية الملف تعيد EOF في كل مرة)
+    Token nextToken() {
+        hasToken = false;
+        while (!hasToken) {
+            if (isAtEnd()) {
+                return Token(TokenType::TOKEN_EOF, source.substr(source.length()), line);
+            }
             start = current;
             scanToken();
         }
-
-        tokens.push_back(Token(TokenType::TOKEN_EOF, "", line));
-        return tokens;
+        return token;
     }
 
 private:
-    std::string source;
-    std::vector<Token> tokens;
-    std::map<std::string, TokenType> keywords;
+    std::string_view source;
+    Diagnostics* diagnostics;
+    Token token;          // (آخر Token أنتجه scanToken)
+    bool hasToken = false;
     int start;
     int current;
     int line;
@@ -157,15 +240,25 @@ private:
         return source[current++];
     }
 
-    // --- (الإصلاح) ---
-    // إضافة دالة previous() التي كانت مفقودة
-    Token previous() {
-        return tokens.back();
+    // --- تحويل بين الـ offsets والمؤشرات (للـ scan_kernels) ---
+    const char* at(int offset) const { return source.data() + offset; }
+    const char* sourceEnd() const { return source.data() + source.length(); }
+    int offsetOf(const char* p) const { return static_cast<int>(p - source.data()); }
+
+    // (أول target بعد current، والأسطر بينهما تُضاف إلى line)
+    const char* untilCounting(char target) {
+        const char* found = scan_kernels::findByte(at(current), sourceEnd(), target);
+        line += scan_kernels::countNewlines(at(current), found);
+        return found;
+    }
+
+    void emit(const Token& produced) {
+        token = produced;
+        hasToken = true;
     }
 
     void addToken(TokenType type) {
-        std::string text = source.substr(start, current - start);
-        tokens.push_back(Token(type, text, line));
+        emit(Token(type, source.substr(start, current - start), line));
     }
 
     char peek() {
@@ -179,11 +272,13 @@ private:
     }
 
 
-    bool peekString(const std::string& str) {
-        if (current + str.length() > source.length()) {
+    // (مقارنة في مكانها بدون أي نسخ؛ تستهلك النص فقط إذا تطابق)
+    bool matchRest(std::string_view rest) {
+        if (source.compare(current, rest.length(), rest) != 0) {
             return false;
         }
-        return source.substr(current, str.length()) == str;
+        current += rest.length();
+        return true;
     }
 
     bool match(char expected) {
@@ -201,83 +296,79 @@ private:
         // سنستخدم 'source[current-1]' (الحرف السابق)
         char quoteType = source[current-1]; // (")
 
-        while (peek() != quoteType && !isAtEnd()) {
-            if (peek() == '\n') line++;
-            advance();
-        }
+        current = offsetOf(untilCounting(quoteType));
 
         if (isAtEnd()) {
-            std::cerr << "Line " << line << ": Error! Unterminated string." << std::endl;
+            report(DiagCode::UNTERMINATED_STRING);
             return;
         }
 
         advance();
 
         // إزالة علامات التنصيص
-        std::string value = source.substr(start + 1, (current - start) - 2);
+        std::string_view value = source.substr(start + 1, (current - start) - 2);
         // (استدعاء 'addToken' مع 'value' بدلاً من 'text')
-        tokens.push_back(Token(TokenType::STRING, value, line));
+        emit(Token(TokenType::STRING, value, line, SymbolTable::global().intern(value)));
     }
 
 
     void numberLiteral() {
-        while (isdigit(peek())) advance();
+        current = offsetOf(scan_kernels::skipDigits(at(current), sourceEnd()));
 
         if (peek() == '.' && isdigit(peekNext())) {
             advance();
-            while (isdigit(peek())) advance();
+            current = offsetOf(scan_kernels::skipDigits(at(current), sourceEnd()));
         }
         addToken(TokenType::NUMBER);
     }
 
     void identifier() {
-        while (isalnum(peek()) || peek() == '_') advance();
+        current = offsetOf(scan_kernels::skipIdentifier(at(current), sourceEnd()));
 
-        std::string text = source.substr(start, current - start);
-        TokenType type;
-        if (keywords.count(text)) {
-            type = keywords[text];
+        std::string_view text = source.substr(start, current - start);
+        TokenType type = lookupKeyword(text);
+        if (type == TokenType::IDENTIFIER) {
+            // (كل اسم يأخذ رقمه من الجدول المشترك مرة واحدة هنا)
+            emit(Token(type, text, line, SymbolTable::global().intern(text)));
         } else {
-            type = TokenType::IDENTIFIER;
+            emit(Token(type, text, line));
         }
-        addToken(type);
     }
 
 
-    void scanToken() {
+    // "MillenniumEye:" استُهلكت بالفعل
+    void lineComment() {
+        current = offsetOf(scan_kernels::findByte(at(current), sourceEnd(), '\n'));
+    }
 
-        if (peekString("MillenniumEye:")) {
-            current += 14;
-            while (peek() != '\n' && !isAtEnd()) {
-                advance();
-            }
+    // "ShadowRealm{" استُهلكت بالفعل
+    void blockComment() {
+        current = offsetOf(untilCounting('}'));
+
+        if (isAtEnd()) {
+            report(DiagCode::UNTERMINATED_SHADOW_REALM);
             return;
         }
 
+        advance(); // ابلع '}'
+    }
 
-        if (peekString("ShadowRealm{")) {
-            current += 12;
-            while (!peekString("}") && !isAtEnd()) {
-                if (peek() == '\n') line++;
-                advance();
-            }
-
-            if (isAtEnd()) {
-                std::cerr << "Line " << line << ": Error! Unterminated ShadowRealm block." << std::endl;
-                return;
-            }
-
-            advance(); // ابلع '}'
-            return;
-        }
+    // (الحرف نفسه view داخل الـ source)
+    void unexpectedCharacter() {
+        report(DiagCode::UNEXPECTED_CHARACTER, source.substr(start, 1));
+    }
 
-        if (peekString("#SetField")) {
-            current += 9;
-            addToken(TokenType::KEYWORD_SETFIELD);
-            return;
+    void report(DiagCode code, std::string_view arg = {}) {
+        if (diagnostics) {
+            diagnostics->reportScanner(code, line, arg);
+        } else {
+            Diagnostics::format(std::cerr, {code, Diagnostic::NO_TOKEN, line, false, {}, arg});
+            std::cerr << std::endl;
         }
+    }
 
 
+    void scanToken() {
         char c = advance();
         switch (c) {
             case '(': addToken(TokenType::LEFT_PAREN); break;
@@ -300,14 +391,28 @@ private:
             case ' ':
             case '\r':
             case '\t':
-                break;
             case '\n':
-                line++;
+                // (ابتلاع الـ run كاملاً مرة واحدة، بما فيه الحرف الذي استهلكه advance)
+                // (المسافة المفردة بين الـ tokens شائعة جداً: لا داعي للـ kernel)
+                if (c == ' ' && !scan_kernels::scalar::isWhitespace(peek())) break;
+                current = offsetOf(scan_kernels::skipWhitespace(at(start), sourceEnd(), line));
                 break;
 
 
             case '"': stringLiteral(); break;
 
+            // --- البادئات الخاصة ---
+            // (الحرف الأول يحدد النص الوحيد الذي قد يطابق؛ وإلا فهو identifier عادي)
+            case 'M':
+                if (matchRest("illenniumEye:")) lineComment(); else identifier();
+                break;
+            case 'S':
+                if (matchRest("hadowRealm{")) blockComment(); else identifier();
+                break;
+            case '#':
+                if (matchRest("SetField")) addToken(TokenType::KEYWORD_SETFIELD); else unexpectedCharacter();
+                break;
+
             default:
                 if (isdigit(c)) {
                     numberLiteral();
@@ -315,7 +420,7 @@ private:
 
                     identifier();
                 } else {
-                    std::cerr << "Line " << line << ": Error! Unexpected character '" << c << "'" << std::endl;
+                    unexpectedCharacter();
                 }
                 break;
         }
@@ -0,0 +1,450 @@
+#ifndef DUELSCRIPT_FLATAST_H
+#define DUELSCRIPT_FLATAST_H
+
+#include "AstNodes.h"
+#include "TokenBuffer.h"
+#include <cstdint>
+#include <vector>
+
+// --- Flat AST ---
+// نفس الشجرة لكن بدون pointers: كل نوع node في مصفوفة متصلة خاصة به، والأبناء
+// handles بحجم 32-bit، وكل Token مجرد index داخل الـ TokenBuffer.
+// كل الـ structs هنا trivially copyable: النسخ أو الحفظ على القرص = memcpy للمصفوفات.
+namespace flat {
+
+// (نفس الـ kinds المحفوظة في الـ Expr / Stmt العادية)
+using ExprKind = ::ExprKind;
+using StmtKind = ::StmtKind;
+
+// (index داخل الـ TokenBuffer)
+using TokenRef = uint32_t;
+constexpr TokenRef NO_TOKEN = UINT32_MAX;
+
+// --- Handle ---
+// أعلى 4 bits = نوع الـ node، الباقي = index داخل مصفوفة ذلك النوع.
+template<typename Kind>
+struct Handle {
+    static constexpr uint32_t INDEX_BITS = 28;
+    static constexpr uint32_t INDEX_MASK = (1u << INDEX_BITS) - 1;
+
+    uint32_t bits = UINT32_MAX; // (UINT32_MAX = لا يوجد، مثل nullptr)
+
+    Handle() = default;
+    Handle(Kind kind, uint32_t index) : bits(static_cast<uint32_t>(kind) << INDEX_BITS | index) {}
+
+    bool valid() const { return bits != UINT32_MAX; }
+    Kind kind() const { return static_cast<Kind>(bits >> INDEX_BITS); }
+    uint32_t index() const { return bits & INDEX_MASK; }
+};
+
+using ExprRef = Handle<ExprKind>;
+using StmtRef = Handle<StmtKind>;
+
+// (قائمة أبناء: [first, first + count) داخل exprLists / stmtLists / params)
+struct Range {
+    uint32_t first = 0;
+    uint32_t count = 0;
+};
+
+// --- Expression nodes ---
+struct Binary   { ExprRef left; TokenRef op; ExprRef right; };
+struct Grouping { ExprRef expression; };
+struct Literal  { TokenRef token; }; // (القيمة تُقرأ من الـ Token: NUMBER / STRING / true / false)
+struct Unary    { TokenRef op; ExprRef right; };
+struct Variable { TokenRef name; };
+struct Assign   { TokenRef name; ExprRef value; };
+struct Call     { ExprRef callee; TokenRef paren; Range arguments; };
+struct Get      { ExprRef object; TokenRef name; };
+struct Set      { ExprRef object; TokenRef name; ExprRef value; };
+
+// --- Statement nodes ---
+struct Parameter  { TokenRef type; TokenRef name; };
+struct Expression { ExprRef expression; };
+struct Summon     { ExprRef expression; };
+struct Draw       { TokenRef name; };
+struct VarDecl    { TokenRef type; TokenRef name; ExprRef initializer; };
+struct Block      { Range statements; };
+struct If         { ExprRef condition; StmtRef thenBranch; StmtRef elseBranch; };
+struct While      { ExprRef condition; StmtRef body; };
+struct Function   { TokenRef name; Range params; StmtRef body; };
+struct Return     { TokenRef keyword; ExprRef value; };
+struct Class      { TokenRef name; Range fields; Range methods; };
+struct Struct     { TokenRef name; Range fields; };
+struct Include    { TokenRef path; };
+struct Using      { TokenRef keyword; TokenRef name; };
+
+struct FlatAst {
+    const TokenBuffer* tokens = nullptr;
+
+    std::vector<Binary> binaries;
+    std::vector<Grouping> groupings;
+    std::vector<Literal> literals;
+    std::vector<Unary> unaries;
+    std::vector<Variable> variables;
+    std::vector<Assign> assigns;
+    std::vector<Call> calls;
+    std::vector<Get> gets;
+    std::vector<Set> sets;
+
+    std::vector<Expression> expressions;
+    std::vector<Summon> summons;
+    std::vector<Draw> draws;
+    std::vector<VarDecl> varDecls;
+    std::vector<Block> blocks;
+    std::vector<If> ifs;
+    std::vector<While> whiles;
+    std::vector<Function> functions;
+    std::vector<Return> returns;
+    std::vector<Class> classes;
+    std::vector<Struct> structs;
+    std::vector<Include> includes;
+    std::vector<Using> usings;
+
+    std::vector<ExprRef> exprLists;
+    std::vector<StmtRef> stmtLists;
+    std::vector<Parameter> params;
+    Range roots; // (الـ statements العليا، داخل stmtLists)
+
+    // (يستدعي f على كل مصفوفة؛ الحجم، النسخ، والحفظ كلها تمر من هنا)
+    template<typename F>
+    void forEachArray(F&& f) {
+        f(binaries); f(groupings); f(literals); f(unaries); f(variables);
+        f(assigns); f(calls); f(gets); f(sets);
+        f(expressions); f(summons); f(draws); f(varDecls); f(blocks); f(ifs); f(whiles);
+        f(functions); f(returns); f(classes); f(structs); f(includes); f(usings);
+        f(exprLists); f(stmtLists); f(params);
+    }
+
+    template<typename F>
+    void forEachArray(F&& f) const {
+        const_cast<FlatAst*>(this)->forEachArray([&](const auto& array) { f(array); });
+    }
+
+    size_t nodeCount() const {
+        return binaries.size() + groupings.size() + literals.size() + unaries.size() + variables.size() +
+               assigns.size() + calls.size() + gets.size() + sets.size() +
+               expressions.size() + summons.size() + draws.size() + varDecls.size() + blocks.size() +
+               ifs.size() + whiles.size() + functions.size() + returns.size() + classes.size() +
+               structs.size() + includes.size() + usings.size();
+    }
+
+    // (bytes المستخدمة فعلاً في كل المصفوفات)
+    size_t bytes() const {
+        size_t total = 0;
+        forEachArray([&](const auto& array) { total += array.size() * sizeof(array[0]); });
+        return total;
+    }
+};
+
+// --- Builder: الـ AST العادي -> FlatAst ---
+// (يعمل في الـ Batch فقط: كل Token في الشجرة يشير إلى داخل tokens)
+class Builder : public ExprVisitor<ExprRef>, public StmtVisitor<void> {
+public:
+    explicit Builder(const TokenBuffer& tokens) { ast.tokens = &tokens; }
+
+    FlatAst build(const std::vector<NodePtr<Stmt>>& statements) {
+        ast.roots = stmtList(statements);
+        return std::move(ast);
+    }
+
+    // --- Expressions ---
+    ExprRef visitBinaryExpr(const BinaryExpr& expr) override {
+        ExprRef left = flattenExpr(expr.left), right = flattenExpr(expr.right);
+        return add(ExprKind::Binary, ast.binaries, Binary{left, ref(expr.op), right});
+    }
+
+    ExprRef visitGroupingExpr(const GroupingExpr& expr) override {
+        return add(ExprKind::Grouping, ast.groupings, Grouping{flattenExpr(expr.expression)});
+    }
+
+    ExprRef visitLiteralExpr(const LiteralExpr& expr) override {
+        return add(ExprKind::Literal, ast.literals, Literal{ref(expr.token)});
+    }
+
+    ExprRef visitUnaryExpr(const UnaryExpr& expr) override {
+        return add(ExprKind::Unary, ast.unaries, Unary{ref(expr.op), flattenExpr(expr.right)});
+    }
+
+    ExprRef visitVariableExpr(const VariableExpr& expr) override {
+        return add(ExprKind::Variable, ast.variables, Variable{ref(expr.name)});
+    }
+
+    ExprRef visitAssignExpr(const AssignExpr& expr) override {
+        return add(ExprKind::Assign, ast.assigns, Assign{ref(expr.name), flattenExpr(expr.value)});
+    }
+
+    ExprRef visitCallExpr(const CallExpr& expr) override {
+        ExprRef callee = flattenExpr(expr.callee);
+        std::vector<ExprRef> arguments;
+        arguments.reserve(expr.arguments.size());
+        for (const auto& argument : expr.arguments) arguments.push_back(flattenExpr(argument));
+        Range range{static_cast<uint32_t>(ast.exprLists.size()), static_cast<uint32_t>(arguments.size())};
+        ast.exprLists.insert(ast.exprLists.end(), arguments.begin(), arguments.end());
+        return add(ExprKind::Call, ast.calls, Call{callee, ref(expr.paren), range});
+    }
+
+    ExprRef visitGetExpr(const GetExpr& expr) override {
+        return add(ExprKind::Get, ast.gets, Get{flattenExpr(expr.object), ref(expr.name)});
+    }
+
+    ExprRef visitSetExpr(const SetExpr& expr) override {
+        ExprRef object = flattenExpr(expr.object), value = flattenExpr(expr.value);
+        return add(ExprKind::Set, ast.sets, Set{object, ref(expr.name), value});
+    }
+
+    // --- Statements (النتيجة في lastStmt) ---
+    void visitExpressionStmt(const ExpressionStmt& stmt) override {
+        lastStmt = add(StmtKind::Expression, ast.expressions, Expression{flattenExpr(stmt.expression)});
+    }
+
+    void visitSummonStmt(const SummonStmt& stmt) override {
+        lastStmt = add(StmtKind::Summon, ast.summons, Summon{flattenExpr(stmt.expression)});
+    }
+
+    void visitDrawStmt(const DrawStmt& stmt) override {
+        lastStmt = add(StmtKind::Draw, ast.draws, Draw{ref(stmt.name)});
+    }
+
+    void visitVarDeclStmt(const VarDeclStmt& stmt) override {
+        lastStmt = add(StmtKind::VarDecl, ast.varDecls,
+                       VarDecl{ref(stmt.type), ref(stmt.name), flattenExpr(stmt.initializer)});
+    }
+
+    void visitBlockStmt(const BlockStmt& stmt) override {
+        Range statements = stmtList(stmt.statements);
+        lastStmt = add(StmtKind::Block, ast.blocks, Block{statements});
+    }
+
+    void visitIfStmt(const IfStmt& stmt) override {
+        ExprRef condition = flattenExpr(stmt.condition);
+        StmtRef thenBranch = flattenStmt(stmt.thenBranch);
+        StmtRef elseBranch = flattenStmt(stmt.elseBranch);
+        lastStmt = add(StmtKind::If, ast.ifs, If{condition, thenBranch, elseBranch});
+    }
+
+    void visitWhileStmt(const WhileStmt& stmt) override {
+        ExprRef condition = flattenExpr(stmt.condition);
+        StmtRef body = flattenStmt(stmt.body);
+        lastStmt = add(StmtKind::While, ast.whiles, While{condition, body});
+    }
+
+    void visitFunctionStmt(const FunctionStmt& stmt) override {
+        Range params{static_cast<uint32_t>(ast.params.size()), static_cast<uint32_t>(stmt.params.size())};
+        for (const FunctionParameter& param : stmt.params) {
+            ast.params.push_back({ref(param.type), ref(param.name)});
+        }
+        StmtRef body = flattenStmt(stmt.body);
+        lastStmt = add(StmtKind::Function, ast.functions, Function{ref(stmt.name), params, body});
+    }
+
+    void visitReturnStmt(const ReturnStmt& stmt) override {
+        lastStmt = add(StmtKind::Return, ast.returns, Return{ref(stmt.keyword), flattenExpr(stmt.value)});
+    }
+
+    void visitClassStmt(const ClassStmt& stmt) override {
+        Range fields = stmtList(stmt.fields);
+        Range methods = stmtList(stmt.methods);
+        lastStmt = add(StmtKind::Class, ast.classes, Class{ref(stmt.name), fields, methods});
+    }
+
+    void visitStructStmt(const StructStmt& stmt) override {
+        Range fields = stmtList(stmt.fields);
+        lastStmt = add(StmtKind::Struct, ast.structs, Struct{ref(stmt.name), fields});
+    }
+
+    void visitIncludeStmt(const IncludeStmt& stmt) override {
+        lastStmt = add(StmtKind::Include, ast.includes, Include{ref(stmt.path)});
+    }
+
+    void visitUsingStmt(const UsingStmt& stmt) override {
+        lastStmt = add(StmtKind::Using, ast.usings, Using{ref(stmt.keyword), ref(stmt.name)});
+    }
+
+private:
+    FlatAst ast;
+    StmtRef lastStmt;
+
+    TokenRef ref(const Token& token) const {
+        size_t index = ast.tokens->indexOf(token.lexeme);
+        return index == TokenBuffer::NOT_FOUND ? NO_TOKEN : static_cast<TokenRef>(index);
+    }
+
+    template<typename Kind, typename Node>
+    static Handle<Kind> add(Kind kind, std::vector<Node>& nodes, const Node& node) {
+        nodes.push_back(node);
+        return Handle<Kind>(kind, static_cast<uint32_t>(nodes.size() - 1));
+    }
+
+    ExprRef flattenExpr(const NodePtr<Expr>& expr) {
+        if (!expr) return ExprRef();
+        return visit(*expr);
+    }
+
+    template<typename T>
+    StmtRef flattenStmt(const NodePtr<T>& stmt) {
+        if (!stmt) return StmtRef();
+        stmt->accept(*this);
+        return lastStmt;
+    }
+
+    // (الأبناء أولاً، ثم handles القائمة متتالية في stmtLists)
+    template<typename T>
+    Range stmtList(const std::vector<NodePtr<T>>& statements) {
+        std::vector<StmtRef> refs;
+        refs.reserve(statements.size());
+        for (const auto& statement : statements) refs.push_back(flattenStmt(statement));
+        Range range{static_cast<uint32_t>(ast.stmtLists.size()), static_cast<uint32_t>(refs.size())};
+        ast.stmtLists.insert(ast.stmtLists.end(), refs.begin(), refs.end());
+        return range;
+    }
+};
+
+inline FlatAst flatten(const std::vector<NodePtr<Stmt>>& statements, const TokenBuffer& tokens) {
+    return Builder(tokens).build(statements);
+}
+
+// --- Expander: FlatAst -> الـ AST العادي ---
+// العكس: يبني nodes عادية في الـ arena من الـ FlatAst (مثلاً بعد تحميله من الـ AstCache)
+// حتى تستقبل المراحل التالية نفس الشجرة التي كان الـ Parser سيعطيها.
+// (يفترض FlatAst سليماً: كل handle صالح ومن النوع المتوقع، انظر AstCache::validate)
+class Expander {
+public:
+    Expander(const FlatAst& ast, AstArena& arena) : ast(ast), tokens(*ast.tokens), arena(arena) {}
+
+    std::vector<NodePtr<Stmt>> expand() { return stmtList<Stmt>(ast.roots); }
+
+private:
+    const FlatAst& ast;
+    const TokenBuffer& tokens;
+    AstArena& arena;
+    size_t lineHint = 0;
+
+    Token token(TokenRef ref) {
+        return ref == NO_TOKEN ? Token() : tokens.token(ref, lineHint);
+    }
+
+    NodePtr<Expr> expr(ExprRef ref) {
+        if (!ref.valid()) return nullptr;
+        uint32_t i = ref.index();
+        switch (ref.kind()) {
+            case ExprKind::Binary: {
+                const Binary& node = ast.binaries[i];
+                NodePtr<Expr> left = expr(node.left);
+                return arena.make<BinaryExpr>(std::move(left), token(node.op), expr(node.right));
+            }
+            case ExprKind::Grouping:
+                return arena.make<GroupingExpr>(expr(ast.groupings[i].expression));
+            case ExprKind::Literal: {
+                Token literal = token(ast.literals[i].token);
+                return arena.make<LiteralExpr>(literalValue(literal), literal);
+            }
+            case ExprKind::Unary:
+                return arena.make<UnaryExpr>(token(ast.unaries[i].op), expr(ast.unaries[i].right));
+            case ExprKind::Variable:
+                return arena.make<VariableExpr>(token(ast.variables[i].name));
+            case ExprKind::Assign:
+                return arena.make<AssignExpr>(token(ast.assigns[i].name), expr(ast.assigns[i].value));
+            case ExprKind::Call: {
+                const Call& node = ast.calls[i];
+                NodePtr<Expr> callee = expr(node.callee);
+                std::vector<NodePtr<Expr>> arguments;
+                arguments.reserve(node.arguments.count);
+                for (uint32_t a = 0; a < node.arguments.count; ++a) {
+                    arguments.push_back(expr(ast.exprLists[node.arguments.first + a]));
+                }
+                return arena.make<CallExpr>(std::move(callee), token(node.paren), std::move(arguments));
+            }
+            case ExprKind::Get:
+                return arena.make<GetExpr>(expr(ast.gets[i].object), token(ast.gets[i].name));
+            case ExprKind::Set: {
+                const Set& node = ast.sets[i];
+                NodePtr<Expr> object = expr(node.object);
+                return arena.make<SetExpr>(std::move(object), token(node.name), expr(node.value));
+            }
+        }
+        return nullptr;
+    }
+
+    NodePtr<Stmt> stmt(StmtRef ref) {
+        if (!ref.valid()) return nullptr;
+        uint32_t i = ref.index();
+        switch (ref.kind()) {
+            case StmtKind::Expression:
+                return arena.make<ExpressionStmt>(expr(ast.expressions[i].expression));
+            case StmtKind::Summon:
+                return arena.make<SummonStmt>(expr(ast.summons[i].expression));
+            case StmtKind::Draw:
+                return arena.make<DrawStmt>(token(ast.draws[i].name));
+            case StmtKind::VarDecl: {
+                const VarDecl& node = ast.varDecls[i];
+                Token type = token(node.type);
+                return arena.make<VarDeclStmt>(type, token(node.name), expr(node.initializer));
+            }
+            case StmtKind::Block:
+                return arena.make<BlockStmt>(stmtList<Stmt>(ast.blocks[i].statements));
+            case StmtKind::If: {
+                const If& node = ast.ifs[i];
+                NodePtr<Expr> condition = expr(node.condition);
+                NodePtr<Stmt> thenBranch = stmt(node.thenBranch);
+                return arena.make<IfStmt>(std::move(condition), std::move(thenBranch), stmt(node.elseBranch));
+            }
+            case StmtKind::While: {
+                NodePtr<Expr> condition = expr(ast.whiles[i].condition);
+                return arena.make<WhileStmt>(std::move(condition), stmt(ast.whiles[i].body));
+            }
+            case StmtKind::Function:
+                return function(ast.functions[i]);
+            case StmtKind::Return: {
+                Token keyword = token(ast.returns[i].keyword);
+                return arena.make<ReturnStmt>(keyword, expr(ast.returns[i].value));
+            }
+            case StmtKind::Class: {
+                const Class& node = ast.classes[i];
+                Token name = token(node.name);
+                std::vector<NodePtr<VarDeclStmt>> fields = stmtList<VarDeclStmt>(node.fields);
+                return arena.make<ClassStmt>(name, std::move(fields), stmtList<FunctionStmt>(node.methods));
+            }
+            case StmtKind::Struct: {
+                Token name = token(ast.structs[i].name);
+                return arena.make<StructStmt>(name, stmtList<VarDeclStmt>(ast.structs[i].fields));
+            }
+            case StmtKind::Include:
+                return arena.make<IncludeStmt>(token(ast.includes[i].path));
+            case StmtKind::Using:
+                return arena.make<UsingStmt>(token(ast.usings[i].keyword), token(ast.usings[i].name));
+        }
+        return nullptr;
+    }
+
+    NodePtr<FunctionStmt> function(const Function& node) {
+        Token name = token(node.name);
+        std::vector<FunctionParameter> params;
+        params.reserve(node.params.count);
+        for (uint32_t p = 0; p < node.params.count; ++p) {
+            const Parameter& param = ast.params[node.params.first + p];
+            Token type = token(param.type);
+            params.push_back({type, token(param.name)});
+        }
+        NodePtr<BlockStmt> body(static_cast<BlockStmt*>(stmt(node.body).release()));
+        return arena.make<FunctionStmt>(name, std::move(params), std::move(body));
+    }
+
+    // (T = النوع الذي يضمنه الـ validate لكل عنصر: VarDeclStmt للحقول، FunctionStmt للـ methods)
+    template<typename T>
+    std::vector<NodePtr<T>> stmtList(Range range) {
+        std::vector<NodePtr<T>> statements;
+        statements.reserve(range.count);
+        for (uint32_t i = 0; i < range.count; ++i) {
+            statements.push_back(NodePtr<T>(static_cast<T*>(stmt(ast.stmtLists[range.first + i]).release())));
+        }
+        return statements;
+    }
+};
+
+inline std::vector<NodePtr<Stmt>> expand(const FlatAst& ast, AstArena& arena) {
+    return Expander(ast, arena).expand();
+}
+
+} // namespace flat
+
+#endif // DUELSCRIPT_FLATAST_H
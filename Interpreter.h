@@ -0,0 +1,376 @@
+#ifndef DUELSCRIPT_INTERPRETER_H
+#define DUELSCRIPT_INTERPRETER_H
+
+#include "AstNodes.h"
+#include "Diagnostics.h"
+#include "Resolver.h"
+#include "Runtime.h"
+#include "Value.h"
+#include <algorithm>
+#include <deque>
+#include <iostream>
+#include <string>
+#include <vector>
+
+// نتيجة تنفيذ جملة: التالية، Tribute، أو خطأ runtime (سُجل في الـ Diagnostics)
+enum class ExecFlow : uint8_t { NEXT, RETURN, ERROR };
+
+// --- Interpreter ---
+// يمشي على الـ AST مباشرة بعد الـ Resolver (dispatch ثابت عبر StaticVisitor).
+// كل متغير = index: frame[slot] للمحلي، self->fields[slot] للحقل، globals[slot] للعام.
+// كل الـ frames في stack واحد محجوز مسبقاً، فاستدعاء Ritual لا يحجز أي ذاكرة.
+// (بدون exceptions، مثل الـ Parser: الخطأ يضع failed ويعود كل visit فوراً)
+// الـ objects ونصوص وقت التنفيذ (StringHeap) يملكها الـ Interpreter وتعيش حتى الـ run() التالي.
+class Interpreter : public StaticVisitor<Interpreter, Value, ExecFlow> {
+public:
+    static constexpr int MAX_DEPTH = 1000;
+    static constexpr size_t OUTPUT_FLUSH = 64 * 1024;
+
+    Interpreter(const ResolvedProgram& program, Diagnostics& diagnostics, std::ostream& out = std::cout)
+            : program(program), diagnostics(diagnostics), out(out), stack(stackSlots(program)) {}
+
+    // (مثل الـ VM: الـ stack يتسع لـ MAX_DEPTH من أكبر frame، فالعمق وحده يحدد الـ stack overflow)
+    static size_t stackSlots(const ResolvedProgram& program) {
+        size_t largest = 0;
+        for (const RitualInfo& ritual : program.rituals) largest = std::max<size_t>(largest, ritual.frameSize);
+        return program.scriptFrameSize + (MAX_DEPTH + 2) * largest;
+    }
+
+    // المستوى الأعلى لكل الـ units بالترتيب، ثم Ritual Yugi() إن وُجد
+    // (يمكن استدعاؤه أكثر من مرة: كل تشغيل يبدأ من globals و objects جديدة)
+    bool run() {
+        failed = false;
+        depth = 0;
+        heap.clear();
+        strings.clear();
+        frame = stack.data();
+        top = frame + program.scriptFrameSize;
+        self = nullptr;
+
+        globals.assign(program.globals.size(), Value());
+        for (size_t i = 0; i < globals.size() && !failed; ++i) globals[i] = defaultValue(*program.globals[i]);
+
+        ExecFlow flow = failed ? ExecFlow::ERROR : ExecFlow::NEXT;
+        for (size_t u = 0; u < program.units.size() && flow == ExecFlow::NEXT; ++u) {
+            for (const NodePtr<Stmt>& statement : *program.units[u]) {
+                flow = visit(*statement);
+                if (flow != ExecFlow::NEXT) break;
+            }
+        }
+        if (flow == ExecFlow::NEXT && program.entry != ResolvedProgram::NO_ENTRY) {
+            call(program.rituals[program.entry], nullptr, nullptr);
+        }
+        flush();
+        return !failed;
+    }
+
+    const std::vector<Value>& getGlobals() const { return globals; }
+
+    // --- الجمل ---
+
+    ExecFlow visitExpressionStmt(const ExpressionStmt& stmt) {
+        visit(*stmt.expression);
+        return failed ? ExecFlow::ERROR : ExecFlow::NEXT;
+    }
+
+    ExecFlow visitSummonStmt(const SummonStmt& stmt) {
+        summon(*stmt.expression);
+        if (output.size() >= OUTPUT_FLUSH) flush();
+        return failed ? ExecFlow::ERROR : ExecFlow::NEXT;
+    }
+
+    ExecFlow visitDrawStmt(const DrawStmt& stmt) {
+        flush();
+        std::string word;
+        std::cin >> word;
+        store(stmt.slot, runtime::drawValue(word, load(stmt.slot), strings));
+        return ExecFlow::NEXT;
+    }
+
+    ExecFlow visitVarDeclStmt(const VarDeclStmt& stmt) {
+        Value value;
+        if (stmt.initializer) {
+            value = visit(*stmt.initializer);
+        } else if (stmt.slot.depth == VarSlot::GLOBAL) {
+            return ExecFlow::NEXT; // (القيمة الافتراضية وُضعت في بداية run)
+        } else {
+            value = defaultValue(stmt);
+        }
+        if (failed) return ExecFlow::ERROR;
+        store(stmt.slot, value);
+        return ExecFlow::NEXT;
+    }
+
+    ExecFlow visitBlockStmt(const BlockStmt& stmt) {
+        for (const NodePtr<Stmt>& statement : stmt.statements) {
+            ExecFlow flow = visit(*statement);
+            if (flow != ExecFlow::NEXT) return flow;
+        }
+        return ExecFlow::NEXT;
+    }
+
+    ExecFlow visitIfStmt(const IfStmt& stmt) {
+        Value condition = visit(*stmt.condition);
+        if (failed) return ExecFlow::ERROR;
+        if (runtime::isTruthy(condition)) return visit(*stmt.thenBranch);
+        if (stmt.elseBranch) return visit(*stmt.elseBranch);
+        return ExecFlow::NEXT;
+    }
+
+    ExecFlow visitWhileStmt(const WhileStmt& stmt) {
+        while (true) {
+            Value condition = visit(*stmt.condition);
+            if (failed) return ExecFlow::ERROR;
+            if (!runtime::isTruthy(condition)) return ExecFlow::NEXT;
+            ExecFlow flow = visit(*stmt.body);
+            if (flow != ExecFlow::NEXT) return flow;
+        }
+    }
+
+    ExecFlow visitReturnStmt(const ReturnStmt& stmt) {
+        returned = stmt.value ? visit(*stmt.value) : Value();
+        return failed ? ExecFlow::ERROR : ExecFlow::RETURN;
+    }
+
+    // (التعريفات سُجلت كلها في الـ Resolver)
+    ExecFlow visitFunctionStmt(const FunctionStmt&) { return ExecFlow::NEXT; }
+    ExecFlow visitClassStmt(const ClassStmt&) { return ExecFlow::NEXT; }
+    ExecFlow visitStructStmt(const StructStmt&) { return ExecFlow::NEXT; }
+    ExecFlow visitIncludeStmt(const IncludeStmt&) { return ExecFlow::NEXT; }
+    ExecFlow visitUsingStmt(const UsingStmt&) { return ExecFlow::NEXT; }
+
+    // --- التعبيرات ---
+
+    Value visitBinaryExpr(const BinaryExpr& expr) {
+        Value left = visit(*expr.left);
+        if (failed) return Value();
+        Value right = visit(*expr.right);
+        if (failed) return Value();
+
+        Value result;
+        DiagCode code;
+        if (!runtime::binary(expr.op.type, left, right, result, code, &strings)) return error(expr.op, code);
+        return result;
+    }
+
+    Value visitGroupingExpr(const GroupingExpr& expr) { return visit(*expr.expression); }
+
+    Value visitLiteralExpr(const LiteralExpr& expr) { return expr.value; }
+
+    Value visitUnaryExpr(const UnaryExpr& expr) {
+        Value right = visit(*expr.right);
+        if (failed) return Value();
+        if (expr.op.type == TokenType::BANG) return Value::boolean(!runtime::isTruthy(right));
+        Value result;
+        DiagCode code;
+        if (!runtime::negate(right, result, code)) return error(expr.op, code);
+        return result;
+    }
+
+    Value visitVariableExpr(const VariableExpr& expr) { return load(expr.slot); }
+
+    Value visitAssignExpr(const AssignExpr& expr) {
+        Value value = visit(*expr.value);
+        if (failed) return Value();
+        return store(expr.slot, value);
+    }
+
+    Value visitCallExpr(const CallExpr& expr) {
+        switch (expr.target.kind) {
+            case CallTarget::FUNCTION:
+                return call(program.rituals[expr.target.index], nullptr, &expr);
+            case CallTarget::SELF_METHOD:
+                return call(program.rituals[expr.target.index], self, &expr);
+            case CallTarget::METHOD: {
+                const GetExpr& get = static_cast<const GetExpr&>(*expr.callee);
+                Instance* instance = object(get);
+                if (!instance) return Value();
+                const ClassLayout& layout = program.layouts[instance->layout];
+                uint32_t method = get.member.layout == instance->layout ? get.member.index
+                                                                         : layout.methodIndex(get.name.symbol);
+                if (method == MemberSlot::NONE) return error(get.name, DiagCode::UNDEFINED_MEMBER, layout.name.lexeme);
+                const RitualInfo& ritual = program.rituals[layout.methods[method]];
+                if (ritual.decl->params.size() != expr.arguments.size()) {
+                    return error(expr.paren, DiagCode::WRONG_ARGUMENT_COUNT);
+                }
+                return call(ritual, instance, &expr);
+            }
+            case CallTarget::UNRESOLVED:
+                break;
+        }
+        return error(expr.paren, DiagCode::NOT_CALLABLE);
+    }
+
+    Value visitGetExpr(const GetExpr& expr) {
+        Instance* instance = object(expr);
+        if (!instance) return Value();
+        uint32_t field = fieldOf(*instance, expr.name, expr.member);
+        return field == MemberSlot::NONE ? Value() : instance->fields[field];
+    }
+
+    Value visitSetExpr(const SetExpr& expr) {
+        // (الـ object ثم القيمة ثم الحقل، بنفس ترتيب الـ VM)
+        Value target = visit(*expr.object);
+        if (failed) return Value();
+        Value value = visit(*expr.value);
+        if (failed) return Value();
+        if (target.type != Value::Type::OBJECT) return error(expr.name, DiagCode::NOT_AN_OBJECT);
+        uint32_t field = fieldOf(*target.asObject, expr.name, expr.member);
+        if (field == MemberSlot::NONE) return Value();
+        if (program.layouts[target.asObject->layout].fields[field]->slot.toDouble) runtime::widen(value);
+        target.asObject->fields[field] = value;
+        return value;
+    }
+
+private:
+    Value error(const Token& token, DiagCode code, std::string_view arg = {}) {
+        failed = true;
+        diagnostics.report({code, 0, token.line, false, token.lexeme, arg});
+        return Value();
+    }
+
+    // --- المتغيرات: (depth, slot) -> مكان واحد ---
+
+    Value load(VarSlot slot) const {
+        switch (slot.depth) {
+            case VarSlot::LOCAL: return frame[slot.slot];
+            case VarSlot::FIELD: return self->fields[slot.slot];
+            default: return globals[slot.slot];
+        }
+    }
+
+    // (القيمة كما خُزنت فعلاً: بعد التحويل إلى double إذا كان المتغير BlueEyesWhiteDragon)
+    Value store(VarSlot slot, Value value) {
+        if (slot.toDouble) runtime::widen(value);
+        switch (slot.depth) {
+            case VarSlot::LOCAL: frame[slot.slot] = value; break;
+            case VarSlot::FIELD: self->fields[slot.slot] = value; break;
+            default: globals[slot.slot] = value; break;
+        }
+        return value;
+    }
+
+    // قيمة متغير أو حقل بدون initializer: صفر النوع، أو object جديد لـ LordOfD / ToonWorld
+    Value defaultValue(const VarDeclStmt& decl) {
+        Value value;
+        if (runtime::primitiveDefault(decl.type.type, value)) return value;
+        return decl.layout == MemberSlot::NONE ? Value() : construct(decl.layout, decl.name);
+    }
+
+    // الحقول بترتيب تعريفها: القيمة الافتراضية أو الـ initializer (والـ object الجديد هو self)
+    Value construct(uint32_t layoutIndex, const Token& site) {
+        if (depth >= MAX_DEPTH) return error(site, DiagCode::STACK_OVERFLOW);
+        const ClassLayout& layout = program.layouts[layoutIndex];
+        // (الـ deque لا ينقل عناصره، فالـ pointer يبقى صالحاً مهما أُنشئ بعده)
+        Instance* instance = &heap.emplace_back(Instance{layoutIndex, std::vector<Value>(layout.fields.size())});
+
+        Instance* saved = self;
+        self = instance;
+        depth++;
+        for (size_t i = 0; i < layout.fields.size() && !failed; ++i) {
+            const VarDeclStmt& field = *layout.fields[i];
+            Value value = field.initializer ? visit(*field.initializer) : defaultValue(field);
+            if (field.slot.toDouble) runtime::widen(value);
+            instance->fields[i] = value;
+        }
+        depth--;
+        self = saved;
+        return failed ? Value() : Value::object(instance);
+    }
+
+    // frame جديد فوق الحالي: البارامترات في أول الـ slots (تُحسب في frame المستدعي)
+    Value call(const RitualInfo& ritual, Instance* receiver, const CallExpr* site) {
+        const Token& where = site ? site->paren : ritual.decl->name;
+        if (depth >= MAX_DEPTH) return error(where, DiagCode::STACK_OVERFLOW);
+
+        Value* base = top;
+        top += ritual.frameSize;
+        if (site) {
+            for (size_t i = 0; i < site->arguments.size(); ++i) {
+                base[i] = visit(*site->arguments[i]);
+                if (failed) {
+                    top = base;
+                    return Value();
+                }
+            }
+            for (uint32_t param : ritual.doubleParams) runtime::widen(base[param]);
+        }
+
+        Value* savedFrame = frame;
+        Instance* savedSelf = self;
+        frame = base;
+        self = receiver;
+        depth++;
+        ExecFlow flow = visitBlockStmt(*ritual.decl->body);
+        depth--;
+        frame = savedFrame;
+        self = savedSelf;
+        top = base;
+
+        if (flow != ExecFlow::RETURN) return Value();
+        Value result = returned;
+        returned = Value();
+        return result;
+    }
+
+    Instance* object(const GetExpr& expr) { return object(*expr.object, expr.name); }
+
+    Instance* object(const Expr& expr, const Token& name) {
+        Value value = visit(expr);
+        if (failed) return nullptr;
+        if (value.type != Value::Type::OBJECT) {
+            error(name, DiagCode::NOT_AN_OBJECT);
+            return nullptr;
+        }
+        return value.asObject;
+    }
+
+    // (الرقم من الـ Resolver إن كان الـ object من النوع المتوقع، وإلا البحث بالاسم)
+    uint32_t fieldOf(const Instance& instance, const Token& name, MemberSlot member) {
+        if (member.layout == instance.layout) return member.index;
+        const ClassLayout& layout = program.layouts[instance.layout];
+        uint32_t field = layout.fieldIndex(name.symbol);
+        if (field == MemberSlot::NONE) error(name, DiagCode::UNDEFINED_MEMBER, layout.name.lexeme);
+        return field;
+    }
+
+    // --- Summon: السلسلة a << b << c تُطبع من اليسار، بدون سطر جديد (مثل cout) ---
+
+    void summon(const Expr& expr) {
+        if (expr.kind == ExprKind::Binary) {
+            const BinaryExpr& chain = static_cast<const BinaryExpr&>(expr);
+            if (chain.op.type == TokenType::SUMMON_OP) {
+                summon(*chain.left);
+                if (!failed) summon(*chain.right);
+                return;
+            }
+        }
+        Value value = visit(expr);
+        if (!failed) runtime::append(output, value);
+    }
+
+    void flush() {
+        out << output;
+        out.flush();
+        output.clear();
+    }
+
+    const ResolvedProgram& program;
+    Diagnostics& diagnostics;
+    std::ostream& out;
+    std::string output; // (Summon يكتب هنا، ويُفرغ كل OUTPUT_FLUSH وعند النهاية)
+
+    std::vector<Value> stack;
+    Value* frame = nullptr; // الـ frame الحالي (LOCAL)
+    Value* top = nullptr;   // أول slot فارغ بعده
+    Instance* self = nullptr;
+    std::vector<Value> globals;
+    std::deque<Instance> heap;
+    StringHeap strings; // (نصوص وقت التنفيذ، تعيش مثل الـ objects حتى الـ run التالي)
+
+    Value returned; // (قيمة آخر Tribute)
+    bool failed = false;
+    int depth = 0;
+};
+
+#endif // DUELSCRIPT_INTERPRETER_H
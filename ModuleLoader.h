@@ -0,0 +1,272 @@
+#ifndef DUELSCRIPT_MODULELOADER_H
+#define DUELSCRIPT_MODULELOADER_H
+
+#include "AstNodes.h"
+#include "CompilationUnit.h"
+#include "Diagnostics.h"
+#include "Parser.h"
+#include "ThreadPool.h"
+#include "TokenBuffer.h"
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <memory>
+#include <optional>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+// --- Module ---
+// ملف DuelScript واحد تم تحميله بسبب #SetField (الـ module رقم 0 هو ملف البرنامج نفسه).
+// كل module يملك الـ CompilationUnit والـ Tokens والـ AST والأخطاء الخاصة به.
+struct Module {
+    std::string path;      // المسار بعد الـ canonicalization (مفتاح منع التكرار)
+    std::string_view name; // الاسم كما كُتب في أول #SetField وصل إليه
+    size_t level = 0;      // المسافة من الـ root في الـ include graph
+    size_t includer = 0;   // أول module طلبه
+    Token includedAt;      // الـ Token الخاص بذلك الـ #SetField
+
+    std::unique_ptr<CompilationUnit> unit;
+    std::optional<TokenBuffer> tokens;
+    std::vector<NodePtr<Stmt>> statements;
+    Diagnostics diagnostics;
+    std::vector<size_t> includes; // الـ edges: أرقام الـ modules التي يطلبها
+
+    bool failed = false;
+    double readMs = 0;
+    double scanMs = 0;
+    double parseMs = 0;
+
+    explicit Module(size_t maxErrors) : diagnostics(maxErrors) {}
+};
+
+// --- ModuleLoader ---
+// يحل كل #SetField إلى ملف: أولاً بجانب الملف الذي كتبه، ثم في الـ search paths بالترتيب
+// (الاسم كما هو، ثم الاسم + ".duelscript").
+// التحميل BFS بالمستويات: كل modules المستوى الجديد مستقلة عن بعضها، فتُقرأ وتُمسح
+// وتُحلل بالتوازي على الـ ThreadPool، ثم تُجمع الـ #SetField الخاصة بها على الـ thread
+// المستدعي. كل ملف يُحمل مرة واحدة فقط مهما تكرر طلبه (ومعه الـ cycles).
+class ModuleLoader {
+public:
+    ModuleLoader(std::vector<std::string> searchPaths, ThreadPool& pool,
+                 size_t maxErrors = Diagnostics::DEFAULT_LIMIT)
+            : searchPaths(std::move(searchPaths)), pool(pool), maxErrors(maxErrors) {}
+
+    ModuleLoader(const ModuleLoader&) = delete;
+    ModuleLoader& operator=(const ModuleLoader&) = delete;
+
+    // يحمل كل ما يطلبه الـ root (مباشرة أو عبر modules أخرى).
+    // (أخطاء #SetField داخل الـ root تذهب إلى rootDiagnostics، وأخطاء كل module إلى الـ module نفسه)
+    // يعيد false إذا لم يُعثر على module ما أو فشل تحليله.
+    bool load(const std::string& rootPath, const std::vector<NodePtr<Stmt>>& rootStatements,
+              Diagnostics& rootDiagnostics) {
+        auto start = std::chrono::steady_clock::now();
+        root = &rootDiagnostics;
+        modules.clear();
+        index.clear();
+
+        modules.push_back(std::make_unique<Module>(maxErrors));
+        modules[0]->path = canonical(rootPath);
+        modules[0]->name = rootPath;
+        index.emplace(modules[0]->path, 0);
+
+        bool ok = true;
+        std::vector<size_t> level{0};
+        while (!level.empty()) {
+            std::vector<size_t> next;
+            for (size_t id : level) {
+                const std::vector<NodePtr<Stmt>>& statements = id == 0 ? rootStatements : modules[id]->statements;
+                ok &= resolveIncludes(id, statements, next);
+            }
+
+            pool.parallelFor(next.size(), [&](size_t i) { parseModule(*modules[next[i]]); });
+
+            for (size_t id : next) {
+                Module& module = *modules[id];
+                if (!module.unit) {
+                    // (الملف موجود لكن تعذرت قراءته: الخطأ عند الـ #SetField الذي طلبه)
+                    reportMissing(module.includer, module.includedAt);
+                }
+                ok &= !module.failed;
+            }
+            level = std::move(next);
+        }
+
+        totalMs = millisecondsSince(start);
+        return ok;
+    }
+
+    const std::vector<std::unique_ptr<Module>>& getModules() const { return modules; }
+
+    // ترتيب تنفيذ الـ modules (بدون الـ root، الذي يأتي بعدها كلها): post-order DFS على
+    // الـ includes بترتيب كتابتها، فكل module بعد كل ما يطلبه، مثل ترتيب الـ #include في C++.
+    // (الـ BFS بالمستويات لا يضمن ذلك: b في المستوى 1 قد يطلب a من نفس المستوى؛ والـ cycle
+    //  يُقطع عند أول module نصل إليه مرة ثانية. stack صريح: لا recursion مهما طالت السلسلة)
+    std::vector<size_t> initializationOrder() const {
+        std::vector<size_t> order;
+        order.reserve(modules.size());
+        std::vector<bool> seen(modules.size());
+        std::vector<std::pair<size_t, size_t>> stack{{0, 0}}; // (module، الـ include التالي فيه)
+        seen[0] = true;
+        while (!stack.empty()) {
+            auto& [id, next] = stack.back();
+            const std::vector<size_t>& includes = modules[id]->includes;
+            if (next < includes.size()) {
+                size_t include = includes[next++];
+                if (!seen[include]) {
+                    seen[include] = true;
+                    stack.push_back({include, 0});
+                }
+                continue;
+            }
+            if (id != 0) order.push_back(id);
+            stack.pop_back();
+        }
+        return order;
+    }
+    size_t moduleCount() const { return modules.size(); }
+
+    size_t edgeCount() const {
+        size_t edges = 0;
+        for (const auto& module : modules) edges += module->includes.size();
+        return edges;
+    }
+
+    double getTotalMs() const { return totalMs; }
+
+    // (--modules) الـ include graph مع زمن كل module
+    void print(std::ostream& out) const {
+        out << "--- Module graph (" << modules.size() << " modules, " << edgeCount() << " includes, "
+            << pool.size() << " threads, " << totalMs << " ms) ---" << std::endl;
+        for (size_t id = 0; id < modules.size(); ++id) {
+            const Module& module = *modules[id];
+            out << "  [" << id << "] " << module.path;
+            if (id == 0) {
+                out << " (root)";
+            } else {
+                out << "  level " << module.level << ", read " << module.readMs << " ms, scan " << module.scanMs
+                    << " ms, parse " << module.parseMs << " ms";
+                if (module.tokens) out << ", " << module.tokens->size() << " tokens";
+                if (module.failed) out << ", FAILED";
+            }
+            if (!module.includes.empty()) {
+                out << "  ->";
+                for (size_t include : module.includes) out << ' ' << include;
+            }
+            out << std::endl;
+        }
+    }
+
+private:
+    static double millisecondsSince(std::chrono::steady_clock::time_point start) {
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    static std::string canonical(const std::filesystem::path& path) {
+        std::error_code error;
+        std::filesystem::path result = std::filesystem::weakly_canonical(path, error);
+        return error ? path.lexically_normal().string() : result.string();
+    }
+
+    static bool isFile(const std::filesystem::path& path) {
+        std::error_code error;
+        return std::filesystem::is_regular_file(path, error);
+    }
+
+    // الاسم -> المسار (فارغ = غير موجود)
+    std::string resolve(std::string_view name, const std::string& includerPath) const {
+        std::filesystem::path file(name);
+        auto tryIn = [&](const std::filesystem::path& directory) -> std::string {
+            std::filesystem::path candidate = directory / file;
+            if (isFile(candidate)) return canonical(candidate);
+            candidate += ".duelscript";
+            if (isFile(candidate)) return canonical(candidate);
+            return {};
+        };
+
+        if (file.is_absolute()) return tryIn({});
+        std::string found = tryIn(std::filesystem::path(includerPath).parent_path());
+        for (size_t i = 0; found.empty() && i < searchPaths.size(); ++i) found = tryIn(searchPaths[i]);
+        return found;
+    }
+
+    Diagnostics& diagnosticsOf(size_t id) { return id == 0 ? *root : modules[id]->diagnostics; }
+
+    void reportMissing(size_t includer, const Token& token) {
+        Diagnostic diagnostic{DiagCode::MODULE_NOT_FOUND, 0, token.line, false, token.lexeme, {}};
+        diagnosticsOf(includer).report(diagnostic);
+    }
+
+    // يجمع الـ #SetField في المستوى الأعلى من الملف، ويضيف الـ modules الجديدة إلى next
+    bool resolveIncludes(size_t id, const std::vector<NodePtr<Stmt>>& statements, std::vector<size_t>& next) {
+        bool ok = true;
+        for (const NodePtr<Stmt>& statement : statements) {
+            if (!statement || statement->kind != StmtKind::Include) continue;
+            const Token& path = static_cast<const IncludeStmt&>(*statement).path;
+            // (الاسم من الـ SymbolTable: view ثابت يعيش بعد انتهاء الـ module)
+            std::string_view name = literalValue(path).stringValue();
+
+            std::string resolved = resolve(name, modules[id]->path);
+            if (resolved.empty()) {
+                reportMissing(id, path);
+                ok = false;
+                continue;
+            }
+
+            auto [it, inserted] = index.emplace(resolved, modules.size());
+            if (inserted) {
+                auto module = std::make_unique<Module>(maxErrors);
+                module->path = std::move(resolved);
+                module->name = name;
+                module->level = modules[id]->level + 1;
+                module->includer = id;
+                module->includedAt = path;
+                next.push_back(modules.size());
+                modules.push_back(std::move(module));
+            }
+
+            std::vector<size_t>& includes = modules[id]->includes;
+            if (std::find(includes.begin(), includes.end(), it->second) == includes.end()) {
+                includes.push_back(it->second);
+            }
+        }
+        return ok;
+    }
+
+    // (على أي thread: كل ما يلمسه خاص بهذا الـ module، والـ SymbolTable آمنة)
+    static void parseModule(Module& module) {
+        auto start = std::chrono::steady_clock::now();
+        std::optional<SourceBuffer> source = SourceBuffer::fromFile(module.path);
+        if (!source) {
+            module.failed = true;
+            return;
+        }
+        module.unit = std::make_unique<CompilationUnit>(module.path, std::move(*source));
+        module.readMs = millisecondsSince(start);
+
+        start = std::chrono::steady_clock::now();
+        module.tokens.emplace(scanPacked(module.unit->text(), &module.diagnostics));
+        module.scanMs = millisecondsSince(start);
+
+        start = std::chrono::steady_clock::now();
+        Parser parser(*module.tokens, module.unit->getArena(), &module.diagnostics);
+        module.statements = parser.parse();
+        module.parseMs = millisecondsSince(start);
+        module.failed = parser.hadError || module.diagnostics.full() ||
+                        module.unit->text().size() > Scanner::MAX_SOURCE_BYTES;
+    }
+
+    std::vector<std::string> searchPaths;
+    ThreadPool& pool;
+    size_t maxErrors;
+
+    Diagnostics* root = nullptr;
+    std::vector<std::unique_ptr<Module>> modules;
+    std::unordered_map<std::string, size_t> index; // المسار -> رقم الـ module
+    double totalMs = 0;
+};
+
+#endif // DUELSCRIPT_MODULELOADER_H
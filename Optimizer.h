@@ -0,0 +1,280 @@
+#ifndef DUELSCRIPT_OPTIMIZER_H
+#define DUELSCRIPT_OPTIMIZER_H
+
+#include "AstNodes.h"
+#include "Runtime.h"
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+// --- Optimizer ---
+// pass يعدّل الـ AST بعد الـ Resolver (فالأخطاء وأرقام الـ slots كما هي، والـ dead code نفسه فُحص):
+//   - constant folding: Binary / Unary / Grouping على literals تصبح LiteralExpr واحداً، بنفس
+//     قواعد Runtime (والعملية التي تفشل مثل 1 / 0 تبقى كما هي ليظهر خطأها وقت التنفيذ)
+//   - JudgmentOfAnubis بشرط ثابت يُستبدل بالفرع المأخوذ، و FairyBox (false) يُحذف
+//   - الجمل بعد Tribute (أو بعد block / if كل طرقه تنتهي بـ Tribute) لا تُنفذ أبداً فتُحذف
+// الـ nodes المحذوفة تبقى في الـ AstArena، فأي pointer إليها في ResolvedProgram يبقى صالحاً.
+class Optimizer {
+public:
+    struct Stats {
+        size_t folded = 0;      // تعبيرات ثابتة أصبحت literal
+        size_t branches = 0;    // JudgmentOfAnubis / FairyBox بشرط ثابت
+        size_t unreachable = 0; // جمل بعد Tribute
+        size_t removed = 0;     // كل الـ nodes التي خرجت من الشجرة
+    };
+
+    // (الـ arena الخاصة بالـ unit: الـ literals الجديدة تُحجز فيها مع باقي الشجرة)
+    void optimize(std::vector<NodePtr<Stmt>>& statements, AstArena& unitArena) {
+        arena = &unitArena;
+        list(statements, true);
+    }
+
+    const Stats& getStats() const { return stats; }
+
+private:
+    // (المستوى الأعلى: Tribute فيه يوقف البرنامج كله، لكن ما بعده قد يعرّف Rituals وأنواعاً، فلا نحذفه)
+    void list(std::vector<NodePtr<Stmt>>& statements, bool topLevel) {
+        size_t kept = 0;
+        bool reachable = true;
+        for (NodePtr<Stmt>& node : statements) {
+            if (!node) continue;
+            if (!reachable) {
+                stats.unreachable++;
+                stats.removed += size(*node);
+                continue;
+            }
+            NodePtr<Stmt> result = statement(std::move(node));
+            if (!result) continue;
+            if (!topLevel && returns(*result)) reachable = false;
+            statements[kept++] = std::move(result);
+        }
+        statements.resize(kept);
+    }
+
+    // (nullptr = الجملة اختفت كلها)
+    NodePtr<Stmt> statement(NodePtr<Stmt> node) {
+        switch (node->kind) {
+            case StmtKind::Expression: fold(static_cast<ExpressionStmt&>(*node).expression); break;
+            case StmtKind::Summon: fold(static_cast<SummonStmt&>(*node).expression); break;
+            case StmtKind::VarDecl: {
+                VarDeclStmt& stmt = static_cast<VarDeclStmt&>(*node);
+                if (stmt.initializer) fold(stmt.initializer);
+                break;
+            }
+            case StmtKind::Block: list(static_cast<BlockStmt&>(*node).statements, false); break;
+            case StmtKind::If: {
+                IfStmt& stmt = static_cast<IfStmt&>(*node);
+                fold(stmt.condition);
+                if (stmt.condition->kind != ExprKind::Literal) {
+                    stmt.thenBranch = branch(std::move(stmt.thenBranch));
+                    if (stmt.elseBranch) stmt.elseBranch = statement(std::move(stmt.elseBranch));
+                    break;
+                }
+                bool taken = runtime::isTruthy(static_cast<const LiteralExpr&>(*stmt.condition).value);
+                NodePtr<Stmt>& kept = taken ? stmt.thenBranch : stmt.elseBranch;
+                const NodePtr<Stmt>& dropped = taken ? stmt.elseBranch : stmt.thenBranch;
+                stats.branches++;
+                stats.removed += 2 + (dropped ? size(*dropped) : 0); // (الـ if والـ literal)
+                return kept ? statement(std::move(kept)) : nullptr;
+            }
+            case StmtKind::While: {
+                WhileStmt& stmt = static_cast<WhileStmt&>(*node);
+                fold(stmt.condition);
+                if (stmt.condition->kind == ExprKind::Literal &&
+                    !runtime::isTruthy(static_cast<const LiteralExpr&>(*stmt.condition).value)) {
+                    stats.branches++;
+                    stats.removed += size(*node);
+                    return nullptr;
+                }
+                stmt.body = branch(std::move(stmt.body));
+                break;
+            }
+            case StmtKind::Function: list(static_cast<FunctionStmt&>(*node).body->statements, false); break;
+            case StmtKind::Return: {
+                ReturnStmt& stmt = static_cast<ReturnStmt&>(*node);
+                if (stmt.value) fold(stmt.value);
+                break;
+            }
+            case StmtKind::Class: {
+                ClassStmt& stmt = static_cast<ClassStmt&>(*node);
+                for (NodePtr<VarDeclStmt>& field : stmt.fields) {
+                    if (field->initializer) fold(field->initializer);
+                }
+                for (NodePtr<FunctionStmt>& method : stmt.methods) list(method->body->statements, false);
+                break;
+            }
+            case StmtKind::Struct:
+                for (NodePtr<VarDeclStmt>& field : static_cast<StructStmt&>(*node).fields) {
+                    if (field->initializer) fold(field->initializer);
+                }
+                break;
+            case StmtKind::Draw:
+            case StmtKind::Include:
+            case StmtKind::Using:
+                break;
+        }
+        return node;
+    }
+
+    // فرع if / جسم while: لا يمكن أن يكون فارغاً، فالجملة التي اختفت تصبح block فارغاً
+    NodePtr<Stmt> branch(NodePtr<Stmt> node) {
+        NodePtr<Stmt> result = statement(std::move(node));
+        if (result) return result;
+        stats.removed--;
+        return arena->make<BlockStmt>(std::vector<NodePtr<Stmt>>());
+    }
+
+    void fold(NodePtr<Expr>& slot) {
+        switch (slot->kind) {
+            case ExprKind::Binary: {
+                BinaryExpr& expr = static_cast<BinaryExpr&>(*slot);
+                fold(expr.left);
+                fold(expr.right);
+                if (expr.left->kind != ExprKind::Literal || expr.right->kind != ExprKind::Literal) break;
+                const LiteralExpr& left = static_cast<const LiteralExpr&>(*expr.left);
+                const LiteralExpr& right = static_cast<const LiteralExpr&>(*expr.right);
+                Value result;
+                DiagCode code;
+                if (runtime::binary(expr.op.type, left.value, right.value, result, code)) {
+                    replace(slot, result, left.token, 3);
+                }
+                break;
+            }
+            case ExprKind::Grouping: {
+                GroupingExpr& expr = static_cast<GroupingExpr&>(*slot);
+                fold(expr.expression);
+                // (فقط حول literal: "Summon << (a << b)" ليست جزءاً من سلسلة الـ Summon)
+                if (expr.expression->kind != ExprKind::Literal) break;
+                slot = std::move(expr.expression);
+                stats.removed++;
+                break;
+            }
+            case ExprKind::Unary: {
+                UnaryExpr& expr = static_cast<UnaryExpr&>(*slot);
+                fold(expr.right);
+                if (expr.right->kind != ExprKind::Literal) break;
+                const Value& right = static_cast<const LiteralExpr&>(*expr.right).value;
+                Value result;
+                DiagCode code;
+                if (expr.op.type == TokenType::BANG) {
+                    replace(slot, Value::boolean(!runtime::isTruthy(right)), expr.op, 2);
+                } else if (runtime::negate(right, result, code)) {
+                    replace(slot, result, expr.op, 2);
+                }
+                break;
+            }
+            case ExprKind::Assign: fold(static_cast<AssignExpr&>(*slot).value); break;
+            case ExprKind::Call:
+                for (NodePtr<Expr>& argument : static_cast<CallExpr&>(*slot).arguments) fold(argument);
+                break;
+            case ExprKind::Get: fold(static_cast<GetExpr&>(*slot).object); break;
+            case ExprKind::Set: {
+                SetExpr& expr = static_cast<SetExpr&>(*slot);
+                fold(expr.object);
+                fold(expr.value);
+                break;
+            }
+            case ExprKind::Literal:
+            case ExprKind::Variable:
+                break;
+        }
+    }
+
+    // (nodes = حجم الشجرة القديمة، وكلها تصبح literal واحداً بنفس النوع الذي أثبته الـ TypeChecker)
+    void replace(NodePtr<Expr>& slot, Value value, Token token, size_t nodes) {
+        StaticType type = slot->type;
+        slot = arena->make<LiteralExpr>(value, token);
+        slot->type = type;
+        stats.folded++;
+        stats.removed += nodes - 1;
+    }
+
+    // كل الطرق داخل الجملة تنتهي بـ Tribute
+    static bool returns(const Stmt& stmt) {
+        switch (stmt.kind) {
+            case StmtKind::Return: return true;
+            case StmtKind::Block: {
+                const auto& statements = static_cast<const BlockStmt&>(stmt).statements;
+                return !statements.empty() && statements.back() && returns(*statements.back());
+            }
+            case StmtKind::If: {
+                const IfStmt& branch = static_cast<const IfStmt&>(stmt);
+                return branch.elseBranch && returns(*branch.thenBranch) && returns(*branch.elseBranch);
+            }
+            default: return false;
+        }
+    }
+
+    // --- عدد الـ nodes في شجرة (للإحصائيات فقط) ---
+
+    static size_t size(const Expr& expr) {
+        switch (expr.kind) {
+            case ExprKind::Binary: {
+                const BinaryExpr& binary = static_cast<const BinaryExpr&>(expr);
+                return 1 + size(*binary.left) + size(*binary.right);
+            }
+            case ExprKind::Grouping: return 1 + size(*static_cast<const GroupingExpr&>(expr).expression);
+            case ExprKind::Unary: return 1 + size(*static_cast<const UnaryExpr&>(expr).right);
+            case ExprKind::Assign: return 1 + size(*static_cast<const AssignExpr&>(expr).value);
+            case ExprKind::Call: {
+                const CallExpr& call = static_cast<const CallExpr&>(expr);
+                size_t total = 1 + size(*call.callee);
+                for (const NodePtr<Expr>& argument : call.arguments) total += size(*argument);
+                return total;
+            }
+            case ExprKind::Get: return 1 + size(*static_cast<const GetExpr&>(expr).object);
+            case ExprKind::Set: {
+                const SetExpr& set = static_cast<const SetExpr&>(expr);
+                return 1 + size(*set.object) + size(*set.value);
+            }
+            case ExprKind::Literal:
+            case ExprKind::Variable:
+                break;
+        }
+        return 1;
+    }
+
+    static size_t size(const Stmt& stmt) {
+        switch (stmt.kind) {
+            case StmtKind::Expression: return 1 + size(*static_cast<const ExpressionStmt&>(stmt).expression);
+            case StmtKind::Summon: return 1 + size(*static_cast<const SummonStmt&>(stmt).expression);
+            case StmtKind::VarDecl: {
+                const VarDeclStmt& decl = static_cast<const VarDeclStmt&>(stmt);
+                return 1 + (decl.initializer ? size(*decl.initializer) : 0);
+            }
+            case StmtKind::Block: {
+                size_t total = 1;
+                for (const NodePtr<Stmt>& statement : static_cast<const BlockStmt&>(stmt).statements) {
+                    if (statement) total += size(*statement);
+                }
+                return total;
+            }
+            case StmtKind::If: {
+                const IfStmt& branch = static_cast<const IfStmt&>(stmt);
+                return 1 + size(*branch.condition) + size(*branch.thenBranch) +
+                       (branch.elseBranch ? size(*branch.elseBranch) : 0);
+            }
+            case StmtKind::While: {
+                const WhileStmt& loop = static_cast<const WhileStmt&>(stmt);
+                return 1 + size(*loop.condition) + size(*loop.body);
+            }
+            case StmtKind::Return: {
+                const ReturnStmt& tribute = static_cast<const ReturnStmt&>(stmt);
+                return 1 + (tribute.value ? size(*tribute.value) : 0);
+            }
+            case StmtKind::Function: return 1 + size(*static_cast<const FunctionStmt&>(stmt).body);
+            case StmtKind::Class:
+            case StmtKind::Struct:
+            case StmtKind::Draw:
+            case StmtKind::Include:
+            case StmtKind::Using:
+                break; // (الأنواع لا تكون داخل Ritual، فلا تُحذف أبداً)
+        }
+        return 1;
+    }
+
+    AstArena* arena = nullptr;
+    Stats stats;
+};
+
+#endif // DUELSCRIPT_OPTIMIZER_H
@@ -1,25 +1,121 @@
 #include "Parser.h"
+#include "ThreadPool.h"
+#include <algorithm>
 #include <iostream>
 
-Parser::Parser(const std::vector<Token>& tokens) : tokens(tokens) {}
+Parser::Parser(const TokenBuffer& tokens, AstArena& arena, Diagnostics* diagnostics)
+        : diagnostics(diagnostics ? diagnostics : &ownDiagnostics), tokens(&tokens), arena(arena) {}
+
+Parser::Parser(Scanner& scanner, AstArena& arena, Diagnostics* diagnostics)
+        : diagnostics(diagnostics ? diagnostics : &ownDiagnostics), stream(std::in_place, scanner), arena(arena) {}
 
 //----------------------------------------------------------------//
 // الدالة الرئيسية
 //----------------------------------------------------------------//
-std::vector<std::unique_ptr<Stmt>> Parser::parse() {
-    std::vector<std::unique_ptr<Stmt>> statements;
-    while (!isAtEnd()) {
-        try {
-            statements.push_back(declaration());
-        } catch (const ParseError& e) {
-            std::cerr << e.what() << std::endl;
-            hadError = true;
+std::vector<NodePtr<Stmt>> Parser::parse() {
+    std::vector<NodePtr<Stmt>> statements;
+    // (بعد الحد الأقصى للأخطاء لا فائدة من المتابعة)
+    while (!isAtEnd() && !diagnostics->full()) {
+        NodePtr<Stmt> statement = declaration();
+        if (panicking) {
+            panicking = false;
             synchronize(); // محاولة المزامنة
+        } else {
+            statements.push_back(std::move(statement));
+        }
+    }
+    return statements;
+}
+
+//----------------------------------------------------------------//
+// الـ Parsing المتوازي
+//----------------------------------------------------------------//
+namespace {
+
+// (أقل عدد Tokens لكل مهمة: أقل من ذلك وتكلفة التوزيع أكبر من الفائدة)
+constexpr size_t MIN_TASK_TOKENS = 1024;
+
+// Pre-pass رخيص على مصفوفة الأنواع فقط: كل Ritual / LordOfD / ToonWorld خارج
+// أي {} يبدأ declaration مستقلة. نجمع declarations متتالية في مهام بحجم
+// متقارب (حوالي 8 مهام لكل thread). النتيجة: بداية كل مهمة + index الـ EOF.
+std::vector<size_t> splitTopLevel(const TokenBuffer& tokens, unsigned threads) {
+    const uint8_t* types = tokens.typeData();
+    size_t end = tokens.size() - 1;
+    size_t target = std::max(end / (threads * 8), MIN_TASK_TOKENS);
+
+    std::vector<size_t> starts{0};
+    size_t depth = 0;
+    for (size_t i = 0; i < end; ++i) {
+        switch (static_cast<TokenType>(types[i])) {
+            case TokenType::LEFT_BRACE:
+                depth++;
+                break;
+            case TokenType::RIGHT_BRACE:
+                if (depth > 0) depth--;
+                break;
+            case TokenType::KEYWORD_RITUAL:
+            case TokenType::KEYWORD_LORDOFD:
+            case TokenType::KEYWORD_TOONWORLD:
+                if (depth == 0 && i - starts.back() >= target) starts.push_back(i);
+                break;
+            default:
+                break;
         }
     }
+    starts.push_back(end);
+    return starts;
+}
+
+} // namespace
+
+std::vector<NodePtr<Stmt>> Parser::parseParallel(ThreadPool& pool) {
+    if (!tokens) return parse();
+
+    std::vector<size_t> starts = splitTopLevel(*tokens, pool.size());
+    size_t taskCount = starts.size() - 1;
+
+    struct Task {
+        AstArena arena;
+        std::vector<NodePtr<Stmt>> statements;
+        bool ok = false;
+    };
+    std::vector<Task> tasks(taskCount);
+
+    pool.parallelFor(taskCount, [&](size_t i) {
+        Parser worker(*tokens, tasks[i].arena);
+        worker.current = static_cast<int>(starts[i]);
+        tasks[i].ok = worker.parseRange(starts[i + 1], tasks[i].statements);
+    });
+
+    // الدمج بترتيب الملف حتى أول مهمة فشلت
+    std::vector<NodePtr<Stmt>> statements;
+    size_t good = 0;
+    for (; good < taskCount && tasks[good].ok; ++good) {
+        for (NodePtr<Stmt>& statement : tasks[good].statements) statements.push_back(std::move(statement));
+        arena.adopt(tasks[good].arena);
+    }
+
+    // خطأ (أو حدود خاطئة من الـ pre-pass): الباقي يُحلل تسلسلياً من بداية تلك
+    // المهمة، فتخرج نفس رسائل الخطأ ونفس الـ recovery كما في parse() تماماً.
+    if (good < taskCount) {
+        for (size_t i = good; i < taskCount; ++i) tasks[i].statements.clear();
+        current = static_cast<int>(starts[good]);
+        for (NodePtr<Stmt>& statement : parse()) statements.push_back(std::move(statement));
+    }
     return statements;
 }
 
+bool Parser::parseRange(size_t end, std::vector<NodePtr<Stmt>>& statements) {
+    while (static_cast<size_t>(current) < end && !isAtEnd()) {
+        NodePtr<Stmt> statement = declaration();
+        // (أي خطأ، حتى بدون panic، يعني إعادة التحليل تسلسلياً مع الـ sink الحقيقي)
+        if (panicking || hadError) return false;
+        statements.push_back(std::move(statement));
+    }
+    // (declaration تجاوزت حدود المهمة = الـ pre-pass أخطأ في التقسيم)
+    return static_cast<size_t>(current) == end;
+}
+
 //----------------------------------------------------------------//
 // قواعد الجمل (Statements)
 //----------------------------------------------------------------//
@@ -33,20 +129,20 @@ bool Parser::isTypeKeyword() {
            check(TokenType::IDENTIFIER); // (للأنواع المخصصة مثل Duelist)
 }
 
-std::unique_ptr<Stmt> Parser::declaration() {
-    if (match({TokenType::KEYWORD_SETFIELD})) {
+NodePtr<Stmt> Parser::declaration() {
+    if (match(TokenType::KEYWORD_SETFIELD)) {
         return includeDeclaration();
     }
-    if (match({TokenType::KEYWORD_KAIBA})) { // (using Kaiba...)
+    if (match(TokenType::KEYWORD_KAIBA)) { // (using Kaiba...)
         return usingDeclaration();
     }
-    if (match({TokenType::KEYWORD_LORDOFD})) {
+    if (match(TokenType::KEYWORD_LORDOFD)) {
         return classDeclaration();
     }
-    if (match({TokenType::KEYWORD_TOONWORLD})) {
+    if (match(TokenType::KEYWORD_TOONWORLD)) {
         return structDeclaration();
     }
-    if (match({TokenType::KEYWORD_RITUAL})) {
+    if (match(TokenType::KEYWORD_RITUAL)) {
         return ritualDeclaration("function");
     }
 
@@ -73,83 +169,119 @@ std::unique_ptr<Stmt> Parser::declaration() {
     return statement();
 }
 
-std::unique_ptr<Stmt> Parser::includeDeclaration() {
-    Token path = consume(TokenType::STRING, "Expect module name (string) after #SetField.");
-    consume(TokenType::SEMICOLON, "Expect ';' after #SetField declaration.");
-    return std::make_unique<IncludeStmt>(path);
+// (في كل دوال القواعد: بعد أي استدعاء قد يفشل، "if (panicking) return nullptr;"
+//  يعيدنا مباشرة إلى حلقة parse() بدون استهلاك أي Token آخر، تماماً كما كان
+//  الـ throw يفعل)
+
+NodePtr<Stmt> Parser::includeDeclaration() {
+    Token path = tokenAt(consume(TokenType::STRING, DiagCode::EXPECT_MODULE_NAME));
+    if (panicking) return nullptr;
+    consume(TokenType::SEMICOLON, DiagCode::EXPECT_SEMICOLON_AFTER_SETFIELD);
+    if (panicking) return nullptr;
+    return arena.make<IncludeStmt>(path);
 }
 
-std::unique_ptr<Stmt> Parser::usingDeclaration() {
+NodePtr<Stmt> Parser::usingDeclaration() {
     // "Kaiba" was already consumed
     Token keyword = previous();
-    Token name = consume(TokenType::KEYWORD_JOEY, "Expect 'Joey' after 'Kaiba'.");
-    consume(TokenType::SEMICOLON, "Expect ';' after 'using' declaration.");
-    return std::make_unique<UsingStmt>(keyword, name);
+    Token name = tokenAt(consume(TokenType::KEYWORD_JOEY, DiagCode::EXPECT_JOEY));
+    if (panicking) return nullptr;
+    consume(TokenType::SEMICOLON, DiagCode::EXPECT_SEMICOLON_AFTER_USING);
+    if (panicking) return nullptr;
+    return arena.make<UsingStmt>(keyword, name);
 }
 
-std::unique_ptr<Stmt> Parser::classDeclaration() {
-    Token name = consume(TokenType::IDENTIFIER, "Expect class name.");
-    consume(TokenType::LEFT_BRACE, "Expect '{' before class body.");
+NodePtr<Stmt> Parser::classDeclaration() {
+    Token name = tokenAt(consume(TokenType::IDENTIFIER, DiagCode::EXPECT_CLASS_NAME));
+    if (panicking) return nullptr;
+    consume(TokenType::LEFT_BRACE, DiagCode::EXPECT_LEFT_BRACE_BEFORE_CLASS_BODY);
+    if (panicking) return nullptr;
 
-    std::vector<std::unique_ptr<VarDeclStmt>> fields;
-    std::vector<std::unique_ptr<FunctionStmt>> methods;
+    std::vector<NodePtr<VarDeclStmt>> fields;
+    std::vector<NodePtr<FunctionStmt>> methods;
 
     while (!check(TokenType::RIGHT_BRACE) && !isAtEnd()) {
-        if (match({TokenType::KEYWORD_RITUAL})) {
-            methods.push_back(ritualDeclaration("method"));
+        if (match(TokenType::KEYWORD_RITUAL)) {
+            NodePtr<FunctionStmt> method = ritualDeclaration("method");
+            if (panicking) return nullptr;
+            methods.push_back(std::move(method));
         }
         else if (isTypeKeyword()) {
-            fields.push_back(std::unique_ptr<VarDeclStmt>(
-                    static_cast<VarDeclStmt*>(varDeclaration().release())
+            NodePtr<Stmt> field = varDeclaration();
+            if (panicking) return nullptr;
+            fields.push_back(NodePtr<VarDeclStmt>(
+                    static_cast<VarDeclStmt*>(field.release())
             ));
         } else {
             // (السماح بأسطر فارغة أو تعليقات)
-            if (peek().type == TokenType::SEMICOLON) {
+            if (typeAt(current) == TokenType::SEMICOLON) {
                 advance();
             } else {
-                throw error(peek(), "Expect method (Ritual) or field declaration inside class.");
+                errorAtCurrent(DiagCode::EXPECT_CLASS_MEMBER);
+                return nullptr;
             }
         }
     }
 
-    consume(TokenType::RIGHT_BRACE, "Expect '}' after class body.");
-    consume(TokenType::SEMICOLON, "Expect ';' after class declaration.");
-    return std::make_unique<ClassStmt>(name, std::move(fields), std::move(methods));
+    consume(TokenType::RIGHT_BRACE, DiagCode::EXPECT_RIGHT_BRACE_AFTER_CLASS_BODY);
+    if (panicking) return nullptr;
+    consume(TokenType::SEMICOLON, DiagCode::EXPECT_SEMICOLON_AFTER_CLASS);
+    if (panicking) return nullptr;
+    return arena.make<ClassStmt>(name, std::move(fields), std::move(methods));
 }
 
-std::unique_ptr<Stmt> Parser::structDeclaration() {
-    Token name = consume(TokenType::IDENTIFIER, "Expect struct name.");
-    consume(TokenType::LEFT_BRACE, "Expect '{' before struct body.");
+NodePtr<Stmt> Parser::structDeclaration() {
+    Token name = tokenAt(consume(TokenType::IDENTIFIER, DiagCode::EXPECT_STRUCT_NAME));
+    if (panicking) return nullptr;
+    consume(TokenType::LEFT_BRACE, DiagCode::EXPECT_LEFT_BRACE_BEFORE_STRUCT_BODY);
+    if (panicking) return nullptr;
 
-    std::vector<std::unique_ptr<VarDeclStmt>> fields;
+    std::vector<NodePtr<VarDeclStmt>> fields;
     while (!check(TokenType::RIGHT_BRACE) && !isAtEnd()) {
-        fields.push_back(std::unique_ptr<VarDeclStmt>(
-                static_cast<VarDeclStmt*>(varDeclaration().release())
+        NodePtr<Stmt> field = varDeclaration();
+        if (panicking) return nullptr;
+        fields.push_back(NodePtr<VarDeclStmt>(
+                static_cast<VarDeclStmt*>(field.release())
         ));
     }
 
-    consume(TokenType::RIGHT_BRACE, "Expect '}' after struct body.");
-    consume(TokenType::SEMICOLON, "Expect ';' after struct declaration.");
-    return std::make_unique<StructStmt>(name, std::move(fields));
+    consume(TokenType::RIGHT_BRACE, DiagCode::EXPECT_RIGHT_BRACE_AFTER_STRUCT_BODY);
+    if (panicking) return nullptr;
+    consume(TokenType::SEMICOLON, DiagCode::EXPECT_SEMICOLON_AFTER_STRUCT);
+    if (panicking) return nullptr;
+    return arena.make<StructStmt>(name, std::move(fields));
 }
 
-std::unique_ptr<FunctionStmt> Parser::ritualDeclaration(std::string kind) {
+NodePtr<FunctionStmt> Parser::ritualDeclaration(std::string_view kind) {
+    // (kind يُحفظ كـ arg مع الخطأ، والرسالة تُنسق فقط عند الطباعة)
     Token name; // (هذا سليم الآن بسبب إصلاح Token struct)
-    if (match({TokenType::KEYWORD_YUGI})) {
+    if (match(TokenType::KEYWORD_YUGI)) {
         name = previous();
+    } else if (check(TokenType::IDENTIFIER)) {
+        name = tokenAt(advance());
     } else {
-        name = consume(TokenType::IDENTIFIER, "Expect " + kind + " name.");
+        errorAtCurrent(DiagCode::EXPECT_RITUAL_NAME, kind);
+        return nullptr;
     }
 
-    consume(TokenType::LEFT_PAREN, "Expect '(' after " + kind + " name.");
+    if (!match(TokenType::LEFT_PAREN)) {
+        errorAtCurrent(DiagCode::EXPECT_LEFT_PAREN_AFTER_RITUAL_NAME, kind);
+        return nullptr;
+    }
 
     std::vector<FunctionParameter> parameters = parseParameters();
+    if (panicking) return nullptr;
 
-    consume(TokenType::RIGHT_PAREN, "Expect ')' after parameters.");
-    consume(TokenType::LEFT_BRACE, "Expect '{' before " + kind + " body.");
+    consume(TokenType::RIGHT_PAREN, DiagCode::EXPECT_RIGHT_PAREN_AFTER_PARAMETERS);
+    if (panicking) return nullptr;
+    if (!match(TokenType::LEFT_BRACE)) {
+        errorAtCurrent(DiagCode::EXPECT_LEFT_BRACE_BEFORE_RITUAL_BODY, kind);
+        return nullptr;
+    }
 
-    std::unique_ptr<BlockStmt> body = block();
-    return std::make_unique<FunctionStmt>(name, std::move(parameters), std::move(body));
+    NodePtr<BlockStmt> body = block();
+    if (panicking) return nullptr;
+    return arena.make<FunctionStmt>(name, std::move(parameters), std::move(body));
 }
 
 std::vector<FunctionParameter> Parser::parseParameters() {
@@ -161,285 +293,341 @@ std::vector<FunctionParameter> Parser::parseParameters() {
 
     do {
         if (parameters.size() >= 255) {
-            error(peek(), "Can't have more than 255 parameters.");
+            error(current, DiagCode::TOO_MANY_PARAMETERS);
         }
 
         Token type; // (هذا سليم الآن)
         if (isTypeKeyword()) {
-            type = advance();
+            type = tokenAt(advance());
         } else {
-            throw error(peek(), "Expect parameter type (e.g., DarkMagician).");
+            errorAtCurrent(DiagCode::EXPECT_PARAMETER_TYPE);
+            return parameters;
         }
 
-        Token name = consume(TokenType::IDENTIFIER, "Expect parameter name.");
+        Token name = tokenAt(consume(TokenType::IDENTIFIER, DiagCode::EXPECT_PARAMETER_NAME));
+        if (panicking) return parameters;
 
         parameters.push_back({type, name});
 
-    } while (match({TokenType::COMMA}));
+    } while (match(TokenType::COMMA));
 
     return parameters;
 }
 
 
-std::unique_ptr<Stmt> Parser::varDeclaration() {
+NodePtr<Stmt> Parser::varDeclaration() {
     Token type; // (هذا سليم الآن)
 
     // (التحقق إذا كانت 'declaration()' قد استهلكت النوع بالفعل)
-    if (previous().type == TokenType::KEYWORD_DARKMAGICIAN ||
-        previous().type == TokenType::KEYWORD_BLUEEYESWHITEDRAGON ||
-        previous().type == TokenType::KEYWORD_REDEYESBLACKDRAGON ||
-        previous().type == TokenType::KEYWORD_TIMEWIZARD ||
-        previous().type == TokenType::IDENTIFIER)
+    TokenType previousType = current > 0 ? typeAt(current - 1) : TokenType::TOKEN_EOF;
+    if (previousType == TokenType::KEYWORD_DARKMAGICIAN ||
+        previousType == TokenType::KEYWORD_BLUEEYESWHITEDRAGON ||
+        previousType == TokenType::KEYWORD_REDEYESBLACKDRAGON ||
+        previousType == TokenType::KEYWORD_TIMEWIZARD ||
+        previousType == TokenType::IDENTIFIER)
     {
         type = previous();
     }
         // (إذا لم تُستهلك، استهلكها الآن)
     else if(isTypeKeyword()) {
-        type = advance();
+        type = tokenAt(advance());
     } else {
-        throw error(peek(), "Expect variable type.");
+        errorAtCurrent(DiagCode::EXPECT_VARIABLE_TYPE);
+        return nullptr;
     }
 
 
-    Token name = consume(TokenType::IDENTIFIER, "Expect variable name.");
+    Token name = tokenAt(consume(TokenType::IDENTIFIER, DiagCode::EXPECT_VARIABLE_NAME));
+    if (panicking) return nullptr;
 
-    std::unique_ptr<Expr> initializer = nullptr;
-    if (match({TokenType::EQUAL})) {
+    NodePtr<Expr> initializer = nullptr;
+    if (match(TokenType::EQUAL)) {
         initializer = expression();
+        if (panicking) return nullptr;
     }
 
-    consume(TokenType::SEMICOLON, "Expect ';' after variable declaration.");
-    return std::make_unique<VarDeclStmt>(type, name, std::move(initializer));
+    consume(TokenType::SEMICOLON, DiagCode::EXPECT_SEMICOLON_AFTER_VARIABLE);
+    if (panicking) return nullptr;
+    return arena.make<VarDeclStmt>(type, name, std::move(initializer));
 }
 
 
-std::unique_ptr<Stmt> Parser::statement() {
-    if (match({TokenType::KEYWORD_JUDGMENTOFANUBIS})) {
+NodePtr<Stmt> Parser::statement() {
+    if (match(TokenType::KEYWORD_JUDGMENTOFANUBIS)) {
         return ifStatement();
     }
-    if (match({TokenType::KEYWORD_SUMMON})) {
+    if (match(TokenType::KEYWORD_FAIRYBOX)) {
+        return whileStatement();
+    }
+    if (match(TokenType::KEYWORD_SUMMON)) {
         return summonStatement();
     }
-    if (match({TokenType::KEYWORD_TRIBUTE})) {
+    if (match(TokenType::KEYWORD_TRIBUTE)) {
         return returnStatement();
     }
-    if (match({TokenType::LEFT_BRACE})) {
+    if (match(TokenType::LEFT_BRACE)) {
         return block();
     }
 
     return expressionStatement();
 }
 
-std::unique_ptr<Stmt> Parser::ifStatement() {
-    consume(TokenType::LEFT_PAREN, "Expect '(' after 'JudgmentOfAnubis'.");
-    std::unique_ptr<Expr> condition = expression();
-    consume(TokenType::RIGHT_PAREN, "Expect ')' after if condition.");
+NodePtr<Stmt> Parser::ifStatement() {
+    consume(TokenType::LEFT_PAREN, DiagCode::EXPECT_LEFT_PAREN_AFTER_IF);
+    if (panicking) return nullptr;
+    NodePtr<Expr> condition = expression();
+    if (panicking) return nullptr;
+    consume(TokenType::RIGHT_PAREN, DiagCode::EXPECT_RIGHT_PAREN_AFTER_CONDITION);
+    if (panicking) return nullptr;
 
-    std::unique_ptr<Stmt> thenBranch = statement();
-    std::unique_ptr<Stmt> elseBranch = nullptr;
-    if (match({TokenType::KEYWORD_SOLEMNJUDGMENT})) {
+    NodePtr<Stmt> thenBranch = statement();
+    if (panicking) return nullptr;
+    NodePtr<Stmt> elseBranch = nullptr;
+    if (match(TokenType::KEYWORD_SOLEMNJUDGMENT)) {
         elseBranch = statement();
+        if (panicking) return nullptr;
     }
 
-    return std::make_unique<IfStmt>(std::move(condition), std::move(thenBranch), std::move(elseBranch));
+    return arena.make<IfStmt>(std::move(condition), std::move(thenBranch), std::move(elseBranch));
 }
 
-std::unique_ptr<Stmt> Parser::returnStatement() {
+// FairyBox (condition) statement
+NodePtr<Stmt> Parser::whileStatement() {
+    consume(TokenType::LEFT_PAREN, DiagCode::EXPECT_LEFT_PAREN_AFTER_WHILE);
+    if (panicking) return nullptr;
+    NodePtr<Expr> condition = expression();
+    if (panicking) return nullptr;
+    consume(TokenType::RIGHT_PAREN, DiagCode::EXPECT_RIGHT_PAREN_AFTER_WHILE_CONDITION);
+    if (panicking) return nullptr;
+
+    NodePtr<Stmt> body = statement();
+    if (panicking) return nullptr;
+    return arena.make<WhileStmt>(std::move(condition), std::move(body));
+}
+
+NodePtr<Stmt> Parser::returnStatement() {
     Token keyword = previous();
-    std::unique_ptr<Expr> value = nullptr;
+    NodePtr<Expr> value = nullptr;
     if (!check(TokenType::SEMICOLON)) {
         value = expression();
+        if (panicking) return nullptr;
     }
 
-    consume(TokenType::SEMICOLON, "Expect ';' after 'Tribute' value.");
-    return std::make_unique<ReturnStmt>(keyword, std::move(value));
+    consume(TokenType::SEMICOLON, DiagCode::EXPECT_SEMICOLON_AFTER_TRIBUTE);
+    if (panicking) return nullptr;
+    return arena.make<ReturnStmt>(keyword, std::move(value));
 }
 
-std::unique_ptr<Stmt> Parser::summonStatement() {
-    consume(TokenType::SUMMON_OP, "Expect '<<' after 'Summon'.");
+NodePtr<Stmt> Parser::summonStatement() {
+    consume(TokenType::SUMMON_OP, DiagCode::EXPECT_SUMMON_OP);
+    if (panicking) return nullptr;
 
-    std::unique_ptr<Expr> expr = expression();
+    NodePtr<Expr> expr = expression();
+    if (panicking) return nullptr;
 
-    while (match({TokenType::SUMMON_OP})) {
+    while (match(TokenType::SUMMON_OP)) {
         Token op = previous();
-        std::unique_ptr<Expr> right = expression();
-        expr = std::make_unique<BinaryExpr>(std::move(expr), op, std::move(right));
+        NodePtr<Expr> right = expression();
+        if (panicking) return nullptr;
+        expr = arena.make<BinaryExpr>(std::move(expr), op, std::move(right));
     }
 
-    consume(TokenType::SEMICOLON, "Expect ';' after 'Summon' statement.");
-    return std::make_unique<SummonStmt>(std::move(expr));
+    consume(TokenType::SEMICOLON, DiagCode::EXPECT_SEMICOLON_AFTER_SUMMON);
+    if (panicking) return nullptr;
+    return arena.make<SummonStmt>(std::move(expr));
 }
 
 
-std::unique_ptr<BlockStmt> Parser::block() {
-    std::vector<std::unique_ptr<Stmt>> statements;
+NodePtr<BlockStmt> Parser::block() {
+    std::vector<NodePtr<Stmt>> statements;
 
     while (!check(TokenType::RIGHT_BRACE) && !isAtEnd()) {
-        statements.push_back(declaration());
+        NodePtr<Stmt> statement = declaration();
+        if (panicking) return nullptr;
+        statements.push_back(std::move(statement));
     }
 
-    consume(TokenType::RIGHT_BRACE, "Expect '}' after block.");
-    return std::make_unique<BlockStmt>(std::move(statements));
+    consume(TokenType::RIGHT_BRACE, DiagCode::EXPECT_RIGHT_BRACE_AFTER_BLOCK);
+    if (panicking) return nullptr;
+    return arena.make<BlockStmt>(std::move(statements));
 }
 
-std::unique_ptr<Stmt> Parser::expressionStatement() {
-    std::unique_ptr<Expr> expr = expression();
-    consume(TokenType::SEMICOLON, "Expect ';' after expression.");
-    return std::make_unique<ExpressionStmt>(std::move(expr));
+NodePtr<Stmt> Parser::expressionStatement() {
+    NodePtr<Expr> expr = expression();
+    if (panicking) return nullptr;
+    consume(TokenType::SEMICOLON, DiagCode::EXPECT_SEMICOLON_AFTER_EXPRESSION);
+    if (panicking) return nullptr;
+    return arena.make<ExpressionStmt>(std::move(expr));
 }
 
 //----------------------------------------------------------------//
 // قواعد التعبيرات (Expressions)
 //----------------------------------------------------------------//
 
-std::unique_ptr<Expr> Parser::expression() {
-    return assignment();
-}
-
-std::unique_ptr<Expr> Parser::assignment() {
-    std::unique_ptr<Expr> expr = equality();
-
-    if (match({TokenType::EQUAL})) {
-        Token equals = previous();
-        std::unique_ptr<Expr> value = assignment();
-
-        if (VariableExpr* varExpr = dynamic_cast<VariableExpr*>(expr.get())) {
-            Token name = varExpr->name;
-            return std::make_unique<AssignExpr>(name, std::move(value));
-        }
-        else if (GetExpr* getExpr = dynamic_cast<GetExpr*>(expr.get())) {
-            return std::make_unique<SetExpr>(std::move(getExpr->object), getExpr->name, std::move(value));
-        }
-
-        error(equals, "Invalid assignment target.");
-    }
-
-    return expr;
-}
-
-std::unique_ptr<Expr> Parser::logicOr() {
-    return logicAnd();
-}
-
-std::unique_ptr<Expr> Parser::logicAnd() {
-    return equality();
-}
-
-
-std::unique_ptr<Expr> Parser::equality() {
-    std::unique_ptr<Expr> expr = comparison();
-
-    while (match({TokenType::BANG_EQUAL, TokenType::EQUAL_EQUAL})) {
-        Token op = previous();
-        std::unique_ptr<Expr> right = comparison();
-        expr = std::make_unique<BinaryExpr>(std::move(expr), op, std::move(right));
-    }
-
-    return expr;
-}
-
-std::unique_ptr<Expr> Parser::comparison() {
-    std::unique_ptr<Expr> expr = term();
-
-    while (match({TokenType::GREATER, TokenType::GREATER_EQUAL, TokenType::LESS, TokenType::LESS_EQUAL})) {
-        Token op = previous();
-        std::unique_ptr<Expr> right = term();
-        expr = std::make_unique<BinaryExpr>(std::move(expr), op, std::move(right));
-    }
-
-    return expr;
-}
-
-std::unique_ptr<Expr> Parser::term() {
-    std::unique_ptr<Expr> expr = factor();
-
-    while (match({TokenType::MINUS, TokenType::PLUS})) {
-        Token op = previous();
-        std::unique_ptr<Expr> right = factor();
-        expr = std::make_unique<BinaryExpr>(std::move(expr), op, std::move(right));
-    }
-
-    return expr;
-}
-
-std::unique_ptr<Expr> Parser::factor() {
-    std::unique_ptr<Expr> expr = unary();
-
-    while (match({TokenType::SLASH, TokenType::STAR})) {
-        Token op = previous();
-        std::unique_ptr<Expr> right = unary();
-        expr = std::make_unique<BinaryExpr>(std::move(expr), op, std::move(right));
+// --- Precedence climbing (Pratt) ---
+// بدلاً من سلسلة assignment -> equality -> comparison -> term -> factor -> unary
+// -> call -> primary (10 استدعاءات قبل أي literal)، جدول واحد يعطي أولوية كل
+// operator يأتي بعد الـ operand، وحلقة واحدة تبني نفس الـ nodes.
+namespace {
+
+constexpr size_t TOKEN_TYPE_COUNT = static_cast<size_t>(TokenType::TOKEN_EOF) + 1;
+
+struct PrecedenceTable {
+    Parser::Precedence infix[TOKEN_TYPE_COUNT] = {};
+};
+
+constexpr PrecedenceTable buildPrecedenceTable() {
+    using P = Parser::Precedence;
+    PrecedenceTable table;
+    auto set = [&table](TokenType type, P precedence) { table.infix[static_cast<size_t>(type)] = precedence; };
+    set(TokenType::EQUAL, P::ASSIGNMENT);
+    set(TokenType::BANG_EQUAL, P::EQUALITY);
+    set(TokenType::EQUAL_EQUAL, P::EQUALITY);
+    set(TokenType::GREATER, P::COMPARISON);
+    set(TokenType::GREATER_EQUAL, P::COMPARISON);
+    set(TokenType::LESS, P::COMPARISON);
+    set(TokenType::LESS_EQUAL, P::COMPARISON);
+    set(TokenType::MINUS, P::TERM);
+    set(TokenType::PLUS, P::TERM);
+    set(TokenType::SLASH, P::FACTOR);
+    set(TokenType::STAR, P::FACTOR);
+    set(TokenType::LEFT_PAREN, P::CALL);
+    set(TokenType::DOT, P::CALL);
+    return table;
+}
+
+constexpr PrecedenceTable precedenceTable = buildPrecedenceTable();
+
+// (الـ operand الأيمن لـ operator يساري الترابط يبدأ من المستوى التالي)
+constexpr Parser::Precedence nextLevel(Parser::Precedence precedence) {
+    return static_cast<Parser::Precedence>(static_cast<uint8_t>(precedence) + 1);
+}
+
+} // namespace
+
+NodePtr<Expr> Parser::expression() {
+    return parsePrecedence(Precedence::ASSIGNMENT);
+}
+
+NodePtr<Expr> Parser::parsePrecedence(Precedence minPrecedence) {
+    // --- prefix: '!' / '-' أو operand ---
+    NodePtr<Expr> expr;
+    TokenType type = typeAt(current);
+    if (type == TokenType::BANG || type == TokenType::MINUS) {
+        Token op = tokenAt(advance());
+        NodePtr<Expr> right = parsePrecedence(Precedence::UNARY);
+        if (panicking) return nullptr;
+        expr = arena.make<UnaryExpr>(op, std::move(right));
+    } else {
+        expr = primary();
+        if (panicking) return nullptr;
     }
 
-    return expr;
-}
-
-std::unique_ptr<Expr> Parser::unary() {
-    if (match({TokenType::BANG, TokenType::MINUS})) {
-        Token op = previous();
-        std::unique_ptr<Expr> right = unary();
-        return std::make_unique<UnaryExpr>(op, std::move(right));
-    }
+    // --- infix / postfix: كل operator أولويته >= minPrecedence ---
+    while (true) {
+        type = typeAt(current);
+        Precedence precedence = precedenceTable.infix[static_cast<size_t>(type)];
+        if (precedence == Precedence::NONE || precedence < minPrecedence) break;
+        advance();
 
-    return call();
-}
+        switch (type) {
+            case TokenType::LEFT_PAREN:
+                expr = finishCall(std::move(expr));
+                if (panicking) return nullptr;
+                break;
+
+            case TokenType::DOT: {
+                Token name = tokenAt(consume(TokenType::IDENTIFIER, DiagCode::EXPECT_PROPERTY_NAME));
+                if (panicking) return nullptr;
+                expr = arena.make<GetExpr>(std::move(expr), name);
+                break;
+            }
 
-std::unique_ptr<Expr> Parser::call() {
-    std::unique_ptr<Expr> expr = primary();
+            case TokenType::EQUAL: {
+                // (يميني الترابط: a = b = c)
+                // (نسخة من الـ Token وليس الـ index فقط: بعد الطرف الأيمن يكون قد خرج من نافذة الـ TokenStream)
+                size_t equalsIndex = current - 1;
+                Token equals = previous();
+                NodePtr<Expr> value = parsePrecedence(Precedence::ASSIGNMENT);
+                if (panicking) return nullptr;
+
+                // (الـ kind بدل dynamic_cast: مقارنة byte واحد بدون RTTI)
+                switch (expr->kind) {
+                    case ExprKind::Variable: {
+                        Token name = static_cast<VariableExpr&>(*expr).name;
+                        return arena.make<AssignExpr>(name, std::move(value));
+                    }
+                    case ExprKind::Get: {
+                        GetExpr& getExpr = static_cast<GetExpr&>(*expr);
+                        return arena.make<SetExpr>(std::move(getExpr.object), getExpr.name, std::move(value));
+                    }
+                    default:
+                        break;
+                }
+
+                // (يُسجل بدون panic: الـ parsing يستمر من هنا عادي)
+                error(equals, equalsIndex, DiagCode::INVALID_ASSIGNMENT_TARGET);
+                return expr;
+            }
 
-    while (true) {
-        if (match({TokenType::LEFT_PAREN})) {
-            expr = finishCall(std::move(expr));
-        } else if (match({TokenType::DOT})) {
-            Token name = consume(TokenType::IDENTIFIER, "Expect property name after '.'.");
-            expr = std::make_unique<GetExpr>(std::move(expr), name);
-        } else {
-            break;
+            default: {
+                Token op = previous();
+                NodePtr<Expr> right = parsePrecedence(nextLevel(precedence));
+                if (panicking) return nullptr;
+                expr = arena.make<BinaryExpr>(std::move(expr), op, std::move(right));
+                break;
+            }
         }
     }
 
     return expr;
 }
 
-std::unique_ptr<Expr> Parser::finishCall(std::unique_ptr<Expr> callee) {
-    std::vector<std::unique_ptr<Expr>> arguments;
+NodePtr<Expr> Parser::finishCall(NodePtr<Expr> callee) {
+    std::vector<NodePtr<Expr>> arguments;
     if (!check(TokenType::RIGHT_PAREN)) {
         do {
             if (arguments.size() >= 255) {
-                error(peek(), "Can't have more than 255 arguments.");
+                error(current, DiagCode::TOO_MANY_ARGUMENTS);
             }
-            arguments.push_back(expression());
-        } while (match({TokenType::COMMA}));
+            NodePtr<Expr> argument = expression();
+            if (panicking) return nullptr;
+            arguments.push_back(std::move(argument));
+        } while (match(TokenType::COMMA));
     }
 
-    Token paren = consume(TokenType::RIGHT_PAREN, "Expect ')' after arguments.");
-    return std::make_unique<CallExpr>(std::move(callee), paren, std::move(arguments));
+    Token paren = tokenAt(consume(TokenType::RIGHT_PAREN, DiagCode::EXPECT_RIGHT_PAREN_AFTER_ARGUMENTS));
+    if (panicking) return nullptr;
+    return arena.make<CallExpr>(std::move(callee), paren, std::move(arguments));
 }
 
 
-std::unique_ptr<Expr> Parser::primary() {
-    if (match({TokenType::KEYWORD_FALSE})) return std::make_unique<LiteralExpr>(false);
-    if (match({TokenType::KEYWORD_TRUE})) return std::make_unique<LiteralExpr>(true);
-
-    if (match({TokenType::NUMBER})) {
-        return std::make_unique<LiteralExpr>(std::stod(previous().lexeme));
-    }
+NodePtr<Expr> Parser::primary() {
+    switch (typeAt(current)) {
+        case TokenType::KEYWORD_FALSE:
+        case TokenType::KEYWORD_TRUE:
+        case TokenType::NUMBER:
+        case TokenType::STRING: {
+            Token token = tokenAt(advance());
+            return arena.make<LiteralExpr>(literalValue(token), token);
+        }
 
-    if (match({TokenType::STRING})) {
-        return std::make_unique<LiteralExpr>(previous().lexeme);
-    }
+        case TokenType::IDENTIFIER:
+            return arena.make<VariableExpr>(tokenAt(advance()));
 
-    if (match({TokenType::IDENTIFIER})) {
-        return std::make_unique<VariableExpr>(previous());
-    }
+        case TokenType::LEFT_PAREN: {
+            advance();
+            NodePtr<Expr> expr = expression();
+            if (panicking) return nullptr;
+            consume(TokenType::RIGHT_PAREN, DiagCode::EXPECT_RIGHT_PAREN_AFTER_EXPRESSION);
+            if (panicking) return nullptr;
+            return arena.make<GroupingExpr>(std::move(expr));
+        }
 
-    if (match({TokenType::LEFT_PAREN})) {
-        std::unique_ptr<Expr> expr = expression();
-        consume(TokenType::RIGHT_PAREN, "Expect ')' after expression.");
-        return std::make_unique<GroupingExpr>(std::move(expr));
+        default:
+            errorAtCurrent(DiagCode::EXPECT_EXPRESSION);
+            return nullptr;
     }
-
-    throw error(peek(), "Expect expression.");
 }
 
 
@@ -447,77 +635,86 @@ std::unique_ptr<Expr> Parser::primary() {
 // دوال مساعدة (Helper Functions)
 //----------------------------------------------------------------//
 
+// (المكانان الوحيدان اللذان يعرفان من أين تأتي الـ Tokens)
+// (أي index بعد النهاية يعيد آخر توكن وهو EOF)
+TokenType Parser::typeAt(size_t index) {
+    if (stream) return stream->at(index).type;
+    return tokens->type(std::min(index, tokens->size() - 1));
+}
+
+// (الـ lexeme ورقم السطر يُحسبان هنا فقط، عند الحاجة لـ Token كامل)
+Token Parser::tokenAt(size_t index) {
+    if (stream) return stream->at(index);
+    return tokens->token(std::min(index, tokens->size() - 1), lineHint);
+}
+
 bool Parser::isAtEnd() {
-    return peek().type == TokenType::TOKEN_EOF;
+    return typeAt(current) == TokenType::TOKEN_EOF;
 }
 
 Token Parser::peek() {
-    return tokens[current];
+    return tokenAt(current);
 }
 
 // --- (الإصلاح) ---
 Token Parser::peekNext() {
-    if (current + 1 >= tokens.size()) {
-        // (إرجاع آخر توكن وهو EOF)
-        return tokens.back();
-    }
-    return tokens[current + 1];
+    // (tokenAt يعيد آخر توكن وهو EOF إذا تجاوزنا النهاية)
+    return tokenAt(current + 1);
 }
 
 
 Token Parser::previous() {
-    return tokens[current - 1];
+    // (لا يوجد توكن قبل الأول)
+    if (current == 0) return Token();
+    return tokenAt(current - 1);
 }
 
-Token Parser::advance() {
+size_t Parser::advance() {
     if (!isAtEnd()) current++;
-    return previous();
+    return current > 0 ? current - 1 : 0;
 }
 
 bool Parser::check(TokenType type) {
     if (isAtEnd()) return false;
-    return peek().type == type;
+    return typeAt(current) == type;
 }
 
 bool Parser::checkNext(TokenType type) {
     if (isAtEnd()) return false;
     // (التأكد أننا لسنا في نهاية الملف تماماً)
-    if (tokens[current + 1].type == TokenType::TOKEN_EOF) return false;
-    return tokens[current + 1].type == type;
+    if (typeAt(current + 1) == TokenType::TOKEN_EOF) return false;
+    return typeAt(current + 1) == type;
 }
 
-bool Parser::match(const std::vector<TokenType>& types) {
-    for (TokenType type : types) {
-        if (check(type)) {
-            advance();
-            return true;
-        }
-    }
-    return false;
+// (عند الفشل: يسجل الخطأ ويدخل الـ panic mode؛ الـ index المُعاد لا يُستخدم)
+size_t Parser::consume(TokenType type, DiagCode code) {
+    if (check(type)) return advance();
+    errorAtCurrent(code);
+    return current;
 }
 
-Token Parser::consume(TokenType type, const std::string& message) {
-    if (check(type)) return advance();
-    throw error(peek(), message);
+// (لا تنسيق هنا: فقط الرقم ومكان الـ Token؛ النص يُبنى في Diagnostics::emit)
+void Parser::error(size_t index, DiagCode code, std::string_view arg) {
+    error(tokenAt(index), index, code, arg);
 }
 
-Parser::ParseError Parser::error(Token token, const std::string& message) {
-    std::string errorMessage = "[Line " + std::to_string(token.line) + "] Error";
-    if (token.type == TokenType::TOKEN_EOF) {
-        errorMessage += " at end";
-    } else {
-        errorMessage += " at '" + token.lexeme + "'";
-    }
-    errorMessage += ": " + message;
-    return ParseError(errorMessage);
+void Parser::error(const Token& token, size_t index, DiagCode code, std::string_view arg) {
+    hadError = true;
+    diagnostics->report({code, static_cast<uint32_t>(index), token.line,
+                         token.type == TokenType::TOKEN_EOF, token.lexeme, arg});
+}
+
+void Parser::errorAtCurrent(DiagCode code, std::string_view arg) {
+    error(current, code, arg);
+    panicking = true;
 }
 
 void Parser::synchronize() {
     advance();
     while (!isAtEnd()) {
-        if (previous().type == TokenType::SEMICOLON) return;
+        if (typeAt(current - 1) == TokenType::SEMICOLON) return;
 
-        switch (peek().type) {
+        switch (typeAt(current)) {
             case TokenType::KEYWORD_RITUAL:
             case TokenType::KEYWORD_LORDOFD:
             case TokenType::KEYWORD_TOONWORLD:
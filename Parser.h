@@ -1,76 +1,114 @@
 #ifndef DUELSCRIPT_PARSER_H
 #define DUELSCRIPT_PARSER_H
 
+#include "Diagnostics.h"
 #include "DuelScriptScanner.h"
+#include "TokenBuffer.h"
+#include "TokenStream.h"
 #include "AstNodes.h"
+#include <cstdint>
 #include <vector>
 #include <memory>
-#include <stdexcept>
+#include <optional>
+
+class ThreadPool;
 
 class Parser {
 public:
-    class ParseError : public std::runtime_error {
-    public:
-        // --- (الإصلاح) ---
-        // 'stda' -> 'std'
-        ParseError(const std::string& message) : std::runtime_error(message) {}
-    };
+    // Batch: كل الـ Tokens موجودة مسبقاً (مصفوفات منفصلة، انظر TokenBuffer)
+    // (diagnostics: الـ sink المشترك مع الـ Scanner؛ بدونه يستخدم الـ Parser sink خاصاً به)
+    Parser(const TokenBuffer& tokens, AstArena& arena, Diagnostics* diagnostics = nullptr);
+    // Streaming: الـ Parser يسحب الـ Tokens من الـ Scanner عند الحاجة
+    Parser(Scanner& scanner, AstArena& arena, Diagnostics* diagnostics = nullptr);
 
-    Parser(const std::vector<Token>& tokens);
-
-    std::vector<std::unique_ptr<Stmt>> parse();
+    std::vector<NodePtr<Stmt>> parse();
+    // (Batch فقط) تقسيم الملف عند الـ declarations العليا وتحليلها على الـ pool،
+    // ثم دمجها بترتيب الملف. النتيجة والأخطاء مطابقة تماماً لـ parse().
+    std::vector<NodePtr<Stmt>> parseParallel(ThreadPool& pool);
     bool hadError = false;
+    const Diagnostics& getDiagnostics() const { return *diagnostics; }
+
+    // أولوية الـ operators من الأضعف للأقوى (انظر precedenceTable في Parser.cpp)
+    enum class Precedence : uint8_t {
+        NONE,
+        ASSIGNMENT, // =
+        EQUALITY,   // == !=
+        COMPARISON, // > >= < <=
+        TERM,       // + -
+        FACTOR,     // * /
+        UNARY,      // ! -
+        CALL,       // () .
+    };
 
 private:
     // --- دوال مساعدة ---
+    // (لا شيء هنا يحجز ذاكرة: الـ Tokens تُبنى من الـ index فقط عند الحاجة،
+    //  و advance/consume تعيد index الـ Token المستهلك بدلاً من نسخه)
+    TokenType typeAt(size_t index);
+    Token tokenAt(size_t index);
     bool isAtEnd();
     Token peek();
     Token peekNext(); // <-- (الإصلاح) إضافة الدالة
     Token previous();
-    Token advance();
+    size_t advance();
     bool check(TokenType type);
     bool checkNext(TokenType type);
-    bool match(const std::vector<TokenType>& types);
-    Token consume(TokenType type, const std::string& message);
+    size_t consume(TokenType type, DiagCode code);
+
+    // match(A, B, ...) بدلاً من match({A, B, ...}): بدون vector مؤقت لكل استدعاء
+    template<typename... Types>
+    bool match(Types... types) {
+        if ((check(types) || ...)) {
+            advance();
+            return true;
+        }
+        return false;
+    }
+
+    // (Parsing متوازي: declarations حتى end بالضبط، false عند أي خطأ)
+    bool parseRange(size_t end, std::vector<NodePtr<Stmt>>& statements);
 
     // --- التحقق من النوع ---
     bool isTypeKeyword();
 
     // --- دوال القواعد (Grammar Rules) ---
-    std::unique_ptr<Stmt> declaration();
-    std::unique_ptr<Stmt> includeDeclaration();
-    std::unique_ptr<Stmt> usingDeclaration();
-    std::unique_ptr<Stmt> classDeclaration();
-    std::unique_ptr<Stmt> structDeclaration();
-    std::unique_ptr<FunctionStmt> ritualDeclaration(std::string kind);
+    NodePtr<Stmt> declaration();
+    NodePtr<Stmt> includeDeclaration();
+    NodePtr<Stmt> usingDeclaration();
+    NodePtr<Stmt> classDeclaration();
+    NodePtr<Stmt> structDeclaration();
+    NodePtr<FunctionStmt> ritualDeclaration(std::string_view kind);
     std::vector<FunctionParameter> parseParameters();
-    std::unique_ptr<Stmt> varDeclaration();
-    std::unique_ptr<Stmt> statement();
-    std::unique_ptr<Stmt> ifStatement();
-    std::unique_ptr<Stmt> returnStatement();
-    std::unique_ptr<Stmt> summonStatement();
-    std::unique_ptr<Stmt> expressionStatement();
-    std::unique_ptr<BlockStmt> block();
+    NodePtr<Stmt> varDeclaration();
+    NodePtr<Stmt> statement();
+    NodePtr<Stmt> ifStatement();
+    NodePtr<Stmt> whileStatement();
+    NodePtr<Stmt> returnStatement();
+    NodePtr<Stmt> summonStatement();
+    NodePtr<Stmt> expressionStatement();
+    NodePtr<BlockStmt> block();
 
     // --- التعبيرات (Expressions) ---
-    std::unique_ptr<Expr> expression();
-    std::unique_ptr<Expr> assignment();
-    std::unique_ptr<Expr> logicOr();
-    std::unique_ptr<Expr> logicAnd();
-    std::unique_ptr<Expr> equality();
-    std::unique_ptr<Expr> comparison();
-    std::unique_ptr<Expr> term();
-    std::unique_ptr<Expr> factor();
-    std::unique_ptr<Expr> unary();
-    std::unique_ptr<Expr> call();
-    std::unique_ptr<Expr> primary();
-    std::unique_ptr<Expr> finishCall(std::unique_ptr<Expr> callee);
-
-    // --- الأخطاء ---
-    ParseError error(Token token, const std::string& message);
+    NodePtr<Expr> expression();
+    NodePtr<Expr> parsePrecedence(Precedence minPrecedence);
+    NodePtr<Expr> primary();
+    NodePtr<Expr> finishCall(NodePtr<Expr> callee);
+
+    // --- الأخطاء (بدون exceptions) ---
+    // error: يسجل فقط. errorAtCurrent: يسجل ويدخل الـ panic mode، فتعود كل دوال
+    // القواعد فوراً حتى حلقة parse() التي تستدعي synchronize().
+    void error(size_t index, DiagCode code, std::string_view arg = {});
+    void error(const Token& token, size_t index, DiagCode code, std::string_view arg = {}); // (Token محفوظ مسبقاً)
+    void errorAtCurrent(DiagCode code, std::string_view arg = {});
     void synchronize();
+    bool panicking = false;
 
-    const std::vector<Token>& tokens;
+    Diagnostics ownDiagnostics;
+    Diagnostics* diagnostics;
+    const TokenBuffer* tokens = nullptr; // (Batch)
+    size_t lineHint = 0;                 // (آخر سطر حُسب في tokens)
+    std::optional<TokenStream> stream;   // (Streaming)
+    AstArena& arena;                     // (كل الـ nodes تُحجز هنا)
     int current = 0;
 };
 
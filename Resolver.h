@@ -0,0 +1,480 @@
+#ifndef DUELSCRIPT_RESOLVER_H
+#define DUELSCRIPT_RESOLVER_H
+
+#include "AstNodes.h"
+#include "Diagnostics.h"
+#include <algorithm>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+// --- ClassLayout ---
+// شكل كل LordOfD / ToonWorld: الحقول بترتيب تعريفها (= ترتيبها داخل الـ Instance)
+// والـ methods كأرقام في ResolvedProgram::rituals.
+struct ClassLayout {
+    Token name;
+    bool isStruct = false;
+    std::vector<const VarDeclStmt*> fields;
+    std::vector<Symbol> methodNames;
+    std::vector<uint32_t> methods;
+
+    // (عدد الحقول صغير دائماً: بحث خطي أسرع من أي map)
+    uint32_t fieldIndex(Symbol name) const {
+        for (uint32_t i = 0; i < fields.size(); ++i) {
+            if (fields[i]->name.symbol == name) return i;
+        }
+        return MemberSlot::NONE;
+    }
+
+    uint32_t methodIndex(Symbol name) const {
+        for (uint32_t i = 0; i < methodNames.size(); ++i) {
+            if (methodNames[i] == name) return i;
+        }
+        return MemberSlot::NONE;
+    }
+};
+
+// --- RitualInfo ---
+struct RitualInfo {
+    const FunctionStmt* decl;
+    uint32_t layout = MemberSlot::NONE; // (method: الـ LordOfD الذي يملكه)
+    uint32_t frameSize = 0;             // البارامترات + أكبر عدد متغيرات محلية حية معاً
+    std::vector<uint32_t> doubleParams; // (البارامترات BlueEyesWhiteDragon: تتحول عند الربط)
+};
+
+// --- ResolvedProgram ---
+// كل ما يحتاجه التنفيذ بعد الـ Resolver: لا أسماء، فقط أرقام.
+struct ResolvedProgram {
+    static constexpr uint32_t NO_ENTRY = UINT32_MAX;
+
+    std::vector<RitualInfo> rituals;
+    std::vector<ClassLayout> layouts;
+    std::vector<const VarDeclStmt*> globals;
+    std::vector<const std::vector<NodePtr<Stmt>>*> units; // (الـ statements العليا بترتيب التنفيذ)
+    uint32_t scriptFrameSize = 0; // (متغيرات الـ blocks في المستوى الأعلى)
+    uint32_t entry = NO_ENTRY;    // Ritual Yugi()
+};
+
+// --- Resolver ---
+// يمر مرة واحدة على الـ AST قبل التنفيذ ويكتب في كل node مكان ما يشير إليه:
+//   - VariableExpr / AssignExpr / VarDeclStmt / DrawStmt: (depth, slot)، انظر VarSlot
+//   - GetExpr / SetExpr: رقم الحقل إذا كان نوع الـ object معروفاً من تعريفه
+//   - CallExpr: رقم الـ Ritual أو الـ method
+// فالـ Interpreter لا يبحث عن أي اسم في الحالة العادية؛ كل وصول = index في مصفوفة.
+// المتغيرات المحلية لكل Ritual في frame واحد مسطح: كل block يأخذ الـ slots التالية
+// ويعيدها عند نهايته، فحجم الـ frame = أكبر عدد متغيرات حية في نفس الوقت.
+// (visit يعيد الـ layout الثابت للتعبير إن كان معروفاً، وإلا MemberSlot::NONE)
+class Resolver : public StaticVisitor<Resolver, uint32_t> {
+public:
+    // ملف واحد: الـ statements العليا والـ sink الخاص بأخطائه
+    struct Unit {
+        const std::vector<NodePtr<Stmt>>* statements;
+        Diagnostics* diagnostics;
+    };
+
+    // (الـ units بترتيب التنفيذ: الـ modules أولاً ثم البرنامج نفسه؛ كلها تشترك في نفس الأسماء العليا)
+    bool resolve(const std::vector<Unit>& units, ResolvedProgram& result) {
+        program = &result;
+        hadError = false;
+
+        // --- 1. الأسماء العليا: الأنواع والـ Rituals أولاً (يمكن استخدامها قبل تعريفها) ---
+        for (const Unit& unit : units) {
+            diagnostics = unit.diagnostics;
+            program->units.push_back(unit.statements);
+            for (const NodePtr<Stmt>& statement : *unit.statements) {
+                if (statement) declareTopLevel(*statement);
+            }
+        }
+        // (ثم المتغيرات العامة: أنواعها قد تكون أي LordOfD / ToonWorld)
+        for (const Unit& unit : units) {
+            diagnostics = unit.diagnostics;
+            for (const NodePtr<Stmt>& statement : *unit.statements) {
+                if (statement && statement->kind == StmtKind::VarDecl) {
+                    declareGlobal(static_cast<const VarDeclStmt&>(*statement));
+                }
+            }
+        }
+
+        // --- 2. الأجسام ---
+        for (const Unit& unit : units) {
+            diagnostics = unit.diagnostics;
+            for (const NodePtr<Stmt>& statement : *unit.statements) {
+                if (statement) visit(*statement);
+            }
+        }
+        program->scriptFrameSize = std::max(program->scriptFrameSize, frameSize);
+        return !hadError;
+    }
+
+    // --- الجمل ---
+
+    void visitExpressionStmt(const ExpressionStmt& stmt) { visit(*stmt.expression); }
+
+    void visitSummonStmt(const SummonStmt& stmt) { visit(*stmt.expression); }
+
+    void visitDrawStmt(const DrawStmt& stmt) { lookup(stmt.name, stmt.slot); }
+
+    void visitVarDeclStmt(const VarDeclStmt& stmt) {
+        if (stmt.initializer) visit(*stmt.initializer);
+        // (المتغيرات العامة سُجلت في المرحلة الأولى، أو كانت مكررة وسُجل الخطأ هناك)
+        if (scopes.empty()) return;
+
+        stmt.layout = typeLayout(stmt.type);
+        for (size_t i = scopes.back(); i < locals.size(); ++i) {
+            if (locals[i].name == stmt.name.symbol) error(stmt.name, DiagCode::ALREADY_DECLARED);
+        }
+        stmt.slot = declareLocal(stmt.name.symbol, stmt.layout, isDouble(stmt.type));
+    }
+
+    void visitBlockStmt(const BlockStmt& stmt) {
+        beginScope();
+        for (const NodePtr<Stmt>& statement : stmt.statements) visit(*statement);
+        endScope();
+    }
+
+    void visitIfStmt(const IfStmt& stmt) {
+        visit(*stmt.condition);
+        visit(*stmt.thenBranch);
+        if (stmt.elseBranch) visit(*stmt.elseBranch);
+    }
+
+    void visitWhileStmt(const WhileStmt& stmt) {
+        visit(*stmt.condition);
+        visit(*stmt.body);
+    }
+
+    void visitFunctionStmt(const FunctionStmt& stmt) {
+        if (!scopes.empty()) {
+            error(stmt.name, DiagCode::NESTED_DECLARATION);
+            return;
+        }
+        resolveRitual(ritualIndex.at(&stmt));
+    }
+
+    void visitReturnStmt(const ReturnStmt& stmt) {
+        if (stmt.value) visit(*stmt.value);
+    }
+
+    void visitClassStmt(const ClassStmt& stmt) {
+        if (!scopes.empty()) {
+            error(stmt.name, DiagCode::NESTED_DECLARATION);
+            return;
+        }
+        uint32_t layout = layoutByName.at(stmt.name.symbol);
+        resolveFields(layout);
+        for (uint32_t ritual : program->layouts[layout].methods) resolveRitual(ritual);
+    }
+
+    void visitStructStmt(const StructStmt& stmt) {
+        if (!scopes.empty()) {
+            error(stmt.name, DiagCode::NESTED_DECLARATION);
+            return;
+        }
+        resolveFields(layoutByName.at(stmt.name.symbol));
+    }
+
+    void visitIncludeStmt(const IncludeStmt&) {}
+    void visitUsingStmt(const UsingStmt&) {}
+
+    // --- التعبيرات ---
+
+    uint32_t visitBinaryExpr(const BinaryExpr& expr) {
+        visit(*expr.left);
+        visit(*expr.right);
+        return MemberSlot::NONE;
+    }
+
+    uint32_t visitGroupingExpr(const GroupingExpr& expr) { return visit(*expr.expression); }
+
+    uint32_t visitLiteralExpr(const LiteralExpr&) { return MemberSlot::NONE; }
+
+    uint32_t visitUnaryExpr(const UnaryExpr& expr) {
+        visit(*expr.right);
+        return MemberSlot::NONE;
+    }
+
+    uint32_t visitVariableExpr(const VariableExpr& expr) { return lookup(expr.name, expr.slot); }
+
+    uint32_t visitAssignExpr(const AssignExpr& expr) {
+        visit(*expr.value);
+        return lookup(expr.name, expr.slot);
+    }
+
+    uint32_t visitCallExpr(const CallExpr& expr) {
+        const FunctionStmt* callee = nullptr;
+        if (expr.callee->kind == ExprKind::Variable) {
+            const Token& name = static_cast<const VariableExpr&>(*expr.callee).name;
+            uint32_t method = currentLayout == MemberSlot::NONE
+                              ? MemberSlot::NONE : program->layouts[currentLayout].methodIndex(name.symbol);
+            auto function = ritualByName.find(name.symbol);
+            if (method != MemberSlot::NONE) {
+                expr.target = {CallTarget::SELF_METHOD, program->layouts[currentLayout].methods[method]};
+            } else if (function != ritualByName.end()) {
+                expr.target = {CallTarget::FUNCTION, function->second};
+            } else {
+                error(name, isVariable(name.symbol) ? DiagCode::NOT_CALLABLE : DiagCode::UNDEFINED_RITUAL);
+            }
+            if (expr.target.kind != CallTarget::UNRESOLVED) callee = program->rituals[expr.target.index].decl;
+        } else if (expr.callee->kind == ExprKind::Get) {
+            const GetExpr& get = static_cast<const GetExpr&>(*expr.callee);
+            uint32_t layout = visit(*get.object);
+            expr.target = {CallTarget::METHOD, 0};
+            if (layout != MemberSlot::NONE) {
+                const ClassLayout& owner = program->layouts[layout];
+                uint32_t method = owner.methodIndex(get.name.symbol);
+                if (method != MemberSlot::NONE) {
+                    get.member = {layout, method};
+                    callee = program->rituals[owner.methods[method]].decl;
+                } else {
+                    error(get.name, owner.fieldIndex(get.name.symbol) != MemberSlot::NONE
+                                    ? DiagCode::NOT_CALLABLE : DiagCode::UNDEFINED_MEMBER, owner.name.lexeme);
+                }
+            }
+        } else {
+            visit(*expr.callee);
+            error(expr.paren, DiagCode::NOT_CALLABLE);
+        }
+
+        if (callee && callee->params.size() != expr.arguments.size()) {
+            error(expr.paren, DiagCode::WRONG_ARGUMENT_COUNT);
+        }
+        for (const NodePtr<Expr>& argument : expr.arguments) visit(*argument);
+        return MemberSlot::NONE;
+    }
+
+    uint32_t visitGetExpr(const GetExpr& expr) { return resolveMember(visit(*expr.object), expr.name, expr.member); }
+
+    uint32_t visitSetExpr(const SetExpr& expr) {
+        uint32_t layout = resolveMember(visit(*expr.object), expr.name, expr.member);
+        visit(*expr.value);
+        return layout;
+    }
+
+private:
+    struct Local {
+        Symbol name;
+        uint32_t layout;
+        bool isDouble;
+    };
+
+    void error(const Token& token, DiagCode code, std::string_view arg = {}) {
+        hadError = true;
+        diagnostics->report({code, 0, token.line, token.type == TokenType::TOKEN_EOF, token.lexeme, arg});
+    }
+
+    // --- المرحلة الأولى ---
+
+    void declareTopLevel(const Stmt& statement) {
+        switch (statement.kind) {
+            case StmtKind::Function: {
+                const FunctionStmt& function = static_cast<const FunctionStmt&>(statement);
+                uint32_t index = addRitual(function, MemberSlot::NONE);
+                if (function.name.type == TokenType::KEYWORD_YUGI) {
+                    if (program->entry != ResolvedProgram::NO_ENTRY) error(function.name, DiagCode::ALREADY_DECLARED);
+                    // (لا أحد يمرر له قيماً، فالبارامترات ستبقى بدون قيمة وبنوع غير مضمون في كل engine)
+                    if (!function.params.empty()) error(function.params[0].name, DiagCode::ENTRY_PARAMETERS);
+                    program->entry = index;
+                } else if (!ritualByName.emplace(function.name.symbol, index).second) {
+                    error(function.name, DiagCode::ALREADY_DECLARED);
+                }
+                break;
+            }
+            case StmtKind::Class: {
+                const ClassStmt& stmt = static_cast<const ClassStmt&>(statement);
+                ClassLayout& layout = addLayout(stmt.name, stmt.fields, false);
+                uint32_t owner = static_cast<uint32_t>(program->layouts.size() - 1);
+                for (const NodePtr<FunctionStmt>& method : stmt.methods) {
+                    if (layout.methodIndex(method->name.symbol) != MemberSlot::NONE) {
+                        error(method->name, DiagCode::ALREADY_DECLARED);
+                    }
+                    layout.methodNames.push_back(method->name.symbol);
+                    layout.methods.push_back(addRitual(*method, owner));
+                }
+                break;
+            }
+            case StmtKind::Struct: {
+                const StructStmt& stmt = static_cast<const StructStmt&>(statement);
+                addLayout(stmt.name, stmt.fields, true);
+                break;
+            }
+            default:
+                break;
+        }
+    }
+
+    uint32_t addRitual(const FunctionStmt& function, uint32_t layout) {
+        uint32_t index = static_cast<uint32_t>(program->rituals.size());
+        program->rituals.push_back({&function, layout, 0, {}});
+        ritualIndex.emplace(&function, index);
+        return index;
+    }
+
+    ClassLayout& addLayout(const Token& name, const std::vector<NodePtr<VarDeclStmt>>& fields, bool isStruct) {
+        uint32_t index = static_cast<uint32_t>(program->layouts.size());
+        if (!layoutByName.emplace(name.symbol, index).second) error(name, DiagCode::ALREADY_DECLARED);
+        ClassLayout& layout = program->layouts.emplace_back();
+        layout.name = name;
+        layout.isStruct = isStruct;
+        for (const NodePtr<VarDeclStmt>& field : fields) {
+            if (layout.fieldIndex(field->name.symbol) != MemberSlot::NONE) error(field->name, DiagCode::ALREADY_DECLARED);
+            layout.fields.push_back(field.get());
+        }
+        return layout;
+    }
+
+    void declareGlobal(const VarDeclStmt& stmt) {
+        uint32_t index = static_cast<uint32_t>(program->globals.size());
+        if (!globalByName.emplace(stmt.name.symbol, index).second) {
+            error(stmt.name, DiagCode::ALREADY_DECLARED);
+            return;
+        }
+        stmt.layout = typeLayout(stmt.type);
+        stmt.slot = {VarSlot::GLOBAL, isDouble(stmt.type), index};
+        program->globals.push_back(&stmt);
+    }
+
+    static bool isDouble(const Token& type) { return type.type == TokenType::KEYWORD_BLUEEYESWHITEDRAGON; }
+
+    // (الأنواع الأساسية ليس لها layout؛ IDENTIFIER يجب أن يكون LordOfD / ToonWorld معرّفاً)
+    uint32_t typeLayout(const Token& type) {
+        if (type.type != TokenType::IDENTIFIER) return MemberSlot::NONE;
+        auto found = layoutByName.find(type.symbol);
+        if (found == layoutByName.end()) {
+            error(type, DiagCode::UNKNOWN_TYPE);
+            return MemberSlot::NONE;
+        }
+        return found->second;
+    }
+
+    // --- المرحلة الثانية ---
+
+    void beginScope() { scopes.push_back(locals.size()); }
+
+    void endScope() {
+        locals.resize(scopes.back());
+        scopes.pop_back();
+    }
+
+    VarSlot declareLocal(Symbol name, uint32_t layout, bool isDouble) {
+        uint32_t slot = static_cast<uint32_t>(locals.size());
+        locals.push_back({name, layout, isDouble});
+        frameSize = std::max(frameSize, slot + 1);
+        return {VarSlot::LOCAL, isDouble, slot};
+    }
+
+    bool isVariable(Symbol name) const {
+        for (const Local& local : locals) {
+            if (local.name == name) return true;
+        }
+        return (currentLayout != MemberSlot::NONE &&
+                program->layouts[currentLayout].fieldIndex(name) != MemberSlot::NONE) ||
+               globalByName.count(name) != 0;
+    }
+
+    // الاسم -> (depth, slot): المحلي الأقرب، ثم حقول الـ object الحالي، ثم العام
+    uint32_t lookup(const Token& name, VarSlot& slot) {
+        for (size_t i = locals.size(); i-- > 0;) {
+            if (locals[i].name == name.symbol) {
+                slot = {VarSlot::LOCAL, locals[i].isDouble, static_cast<uint32_t>(i)};
+                return locals[i].layout;
+            }
+        }
+        if (currentLayout != MemberSlot::NONE) {
+            const ClassLayout& layout = program->layouts[currentLayout];
+            uint32_t field = layout.fieldIndex(name.symbol);
+            if (field != MemberSlot::NONE) {
+                slot = {VarSlot::FIELD, isDouble(layout.fields[field]->type), field};
+                return layout.fields[field]->layout;
+            }
+        }
+        auto global = globalByName.find(name.symbol);
+        if (global != globalByName.end()) {
+            slot = {VarSlot::GLOBAL, isDouble(program->globals[global->second]->type), global->second};
+            return program->globals[global->second]->layout;
+        }
+        error(name, DiagCode::UNDEFINED_VARIABLE);
+        return MemberSlot::NONE;
+    }
+
+    // obj.name: إذا كان نوع الـ object معروفاً نكتب رقم الحقل (ونوعه للسلاسل a.b.c)
+    uint32_t resolveMember(uint32_t layout, const Token& name, MemberSlot& member) {
+        if (layout == MemberSlot::NONE) return MemberSlot::NONE;
+        const ClassLayout& owner = program->layouts[layout];
+        uint32_t field = owner.fieldIndex(name.symbol);
+        if (field == MemberSlot::NONE) {
+            error(name, DiagCode::UNDEFINED_MEMBER, owner.name.lexeme);
+            return MemberSlot::NONE;
+        }
+        member = {layout, field};
+        return owner.fields[field]->layout;
+    }
+
+    // (كل Ritual يبدأ بحالة فارغة: لا closures، فلا شيء يُرى من الخارج إلا الحقول والعام)
+    struct Saved {
+        std::vector<Local> locals;
+        std::vector<size_t> scopes;
+        uint32_t frameSize;
+        uint32_t layout;
+    };
+
+    Saved enter(uint32_t layout) {
+        Saved saved{std::move(locals), std::move(scopes), frameSize, currentLayout};
+        locals.clear();
+        scopes.clear();
+        frameSize = 0;
+        currentLayout = layout;
+        return saved;
+    }
+
+    void leave(Saved& saved) {
+        locals = std::move(saved.locals);
+        scopes = std::move(saved.scopes);
+        frameSize = saved.frameSize;
+        currentLayout = saved.layout;
+    }
+
+    void resolveRitual(uint32_t index) {
+        RitualInfo& ritual = program->rituals[index];
+        Saved saved = enter(ritual.layout);
+        beginScope();
+        for (const FunctionParameter& param : ritual.decl->params) {
+            for (const Local& local : locals) {
+                if (local.name == param.name.symbol) error(param.name, DiagCode::ALREADY_DECLARED);
+            }
+            VarSlot slot = declareLocal(param.name.symbol, typeLayout(param.type), isDouble(param.type));
+            if (slot.toDouble) ritual.doubleParams.push_back(slot.slot);
+        }
+        visit(*ritual.decl->body);
+        endScope();
+        ritual.frameSize = frameSize;
+        leave(saved);
+    }
+
+    // (الـ initializers تُنفذ عند إنشاء كل object، والحقول الأخرى مرئية فيها)
+    void resolveFields(uint32_t layout) {
+        Saved saved = enter(layout);
+        for (const VarDeclStmt* field : program->layouts[layout].fields) {
+            field->layout = typeLayout(field->type);
+            field->slot = {VarSlot::FIELD, isDouble(field->type), program->layouts[layout].fieldIndex(field->name.symbol)};
+            if (field->initializer) visit(*field->initializer);
+        }
+        leave(saved);
+    }
+
+    ResolvedProgram* program = nullptr;
+    Diagnostics* diagnostics = nullptr;
+    bool hadError = false;
+
+    std::unordered_map<Symbol, uint32_t> ritualByName;
+    std::unordered_map<Symbol, uint32_t> layoutByName;
+    std::unordered_map<Symbol, uint32_t> globalByName;
+    std::unordered_map<const FunctionStmt*, uint32_t> ritualIndex;
+
+    // (الـ Ritual الحالي، أو المستوى الأعلى)
+    std::vector<Local> locals;
+    std::vector<size_t> scopes;
+    uint32_t frameSize = 0;
+    uint32_t currentLayout = MemberSlot::NONE;
+};
+
+#endif // DUELSCRIPT_RESOLVER_H
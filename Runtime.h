@@ -0,0 +1,188 @@
+#ifndef DUELSCRIPT_RUNTIME_H
+#define DUELSCRIPT_RUNTIME_H
+
+#include "Diagnostics.h"
+#include "DuelScriptScanner.h"
+#include "StringHeap.h"
+#include "Value.h"
+#include <charconv>
+#include <cstdio>
+#include <cstring>
+#include <string>
+
+// --- Runtime ---
+// قواعد القيم المشتركة بين الـ Interpreter والـ VM، حتى يعطي كلاهما نفس النتيجة بالضبط.
+// (كل engine يجرب الـ fast path الخاص به، INT مع INT مثلاً، ثم يعود إلى هنا)
+namespace runtime {
+
+// (الـ overflow في INT يلتف مثل unsigned بدلاً من undefined behavior)
+inline int64_t wrap(uint64_t value) { return static_cast<int64_t>(value); }
+
+inline bool isTruthy(const Value& value) {
+    switch (value.type) {
+        case Value::Type::BOOL: return value.asBool;
+        case Value::Type::INT: return value.asInt != 0;
+        case Value::Type::DOUBLE: return value.asDouble != 0;
+        case Value::Type::STRING: return value.length != 0;
+        case Value::Type::OBJECT: return true;
+        case Value::Type::NIL: break;
+    }
+    return false;
+}
+
+inline bool equals(const Value& a, const Value& b) {
+    if (a.type == Value::Type::INT && b.type == Value::Type::INT) return a.asInt == b.asInt;
+    if (a.isNumber() && b.isNumber()) return a.toDouble() == b.toDouble();
+    if (a.type != b.type) return false;
+    switch (a.type) {
+        case Value::Type::BOOL: return a.asBool == b.asBool;
+        case Value::Type::STRING:
+            return a.length == b.length &&
+                   (a.asChars == b.asChars || a.length == 0 || std::memcmp(a.asChars, b.asChars, a.length) == 0);
+        case Value::Type::OBJECT: return a.asObject == b.asObject;
+        default: return true; // (NIL)
+    }
+}
+
+// operator ثنائي (op = نوع الـ Token: PLUS، LESS، ...).
+// INT مع INT يبقى INT مثل C++، وأي DOUBLE يجعل العملية DOUBLE، و + يصل نصين في strings.
+// (strings = nullptr وقت الـ compile، في الـ Optimizer: النص الناتج literal فيُسجل في الـ SymbolTable)
+// (false = خطأ runtime والرقم في error)
+inline bool binary(TokenType op, const Value& left, const Value& right, Value& result, DiagCode& error,
+                   StringHeap* strings = nullptr) {
+    if (op == TokenType::EQUAL_EQUAL || op == TokenType::BANG_EQUAL) {
+        result = Value::boolean(equals(left, right) == (op == TokenType::EQUAL_EQUAL));
+        return true;
+    }
+
+    if (left.type == Value::Type::INT && right.type == Value::Type::INT) {
+        int64_t a = left.asInt, b = right.asInt;
+        switch (op) {
+            case TokenType::PLUS: result = Value::integer(wrap(uint64_t(a) + uint64_t(b))); return true;
+            case TokenType::MINUS: result = Value::integer(wrap(uint64_t(a) - uint64_t(b))); return true;
+            case TokenType::STAR: result = Value::integer(wrap(uint64_t(a) * uint64_t(b))); return true;
+            case TokenType::SLASH:
+                if (b == 0) {
+                    error = DiagCode::DIVISION_BY_ZERO;
+                    return false;
+                }
+                result = Value::integer(b == -1 ? wrap(0 - uint64_t(a)) : a / b);
+                return true;
+            case TokenType::GREATER: result = Value::boolean(a > b); return true;
+            case TokenType::GREATER_EQUAL: result = Value::boolean(a >= b); return true;
+            case TokenType::LESS: result = Value::boolean(a < b); return true;
+            case TokenType::LESS_EQUAL: result = Value::boolean(a <= b); return true;
+            default: break;
+        }
+    }
+
+    if (op == TokenType::PLUS && left.type == Value::Type::STRING && right.type == Value::Type::STRING) {
+        // (نفس الحد قبل الـ Optimizer أيضاً: ما بعده لا يُطوى ولا يدخل الـ SymbolTable، بل يبقى
+        //  لوقت التنفيذ فيظهر خطأه هناك مثل 1 / 0)
+        if (uint64_t(left.length) + right.length > StringHeap::MAX_LENGTH) {
+            error = DiagCode::STRING_TOO_LONG;
+            return false;
+        }
+        if (strings) {
+            strings->concat(left.stringValue(), right.stringValue(), result);
+            return true;
+        }
+        std::string text(left.stringValue());
+        text += right.stringValue();
+        result = Value::interned(SymbolTable::global().intern(text));
+        return true;
+    }
+
+    if (!left.isNumber() || !right.isNumber()) {
+        error = DiagCode::OPERANDS_MUST_BE_NUMBERS;
+        return false;
+    }
+    double a = left.toDouble(), b = right.toDouble();
+    switch (op) {
+        case TokenType::PLUS: result = Value::number(a + b); return true;
+        case TokenType::MINUS: result = Value::number(a - b); return true;
+        case TokenType::STAR: result = Value::number(a * b); return true;
+        case TokenType::SLASH: result = Value::number(a / b); return true;
+        case TokenType::GREATER: result = Value::boolean(a > b); return true;
+        case TokenType::GREATER_EQUAL: result = Value::boolean(a >= b); return true;
+        case TokenType::LESS: result = Value::boolean(a < b); return true;
+        case TokenType::LESS_EQUAL: result = Value::boolean(a <= b); return true;
+        default: break;
+    }
+    error = DiagCode::OPERANDS_MUST_BE_NUMBERS;
+    return false;
+}
+
+// '-' الأحادي (الـ '!' هو !isTruthy ولا يفشل أبداً)
+inline bool negate(const Value& value, Value& result, DiagCode& error) {
+    if (value.type == Value::Type::INT) {
+        result = Value::integer(wrap(0 - uint64_t(value.asInt)));
+    } else if (value.type == Value::Type::DOUBLE) {
+        result = Value::number(-value.asDouble);
+    } else {
+        error = DiagCode::OPERAND_MUST_BE_NUMBER;
+        return false;
+    }
+    return true;
+}
+
+// تخزين في مكان BlueEyesWhiteDragon (متغير، حقل، بارامتر): الـ DarkMagician يصبح double، مثل C++
+// (فـ 'BlueEyesWhiteDragon x = 5; x / 2' = 2.5 في كل engine، مع الـ TypeChecker أو بدونه)
+inline void widen(Value& value) {
+    if (value.type == Value::Type::INT) value = Value::number(static_cast<double>(value.asInt));
+}
+
+// القيمة الافتراضية لمتغير من نوع أساسي (false = نوع LordOfD / ToonWorld، يحتاج object)
+inline bool primitiveDefault(TokenType type, Value& result) {
+    switch (type) {
+        case TokenType::KEYWORD_DARKMAGICIAN: result = Value::integer(0); return true;
+        case TokenType::KEYWORD_BLUEEYESWHITEDRAGON: result = Value::number(0); return true;
+        case TokenType::KEYWORD_REDEYESBLACKDRAGON: result = Value::string({}); return true;
+        case TokenType::KEYWORD_TIMEWIZARD: result = Value::boolean(false); return true;
+        default: break;
+    }
+    result = Value();
+    return false;
+}
+
+// Summon: قيمة واحدة كنص، بدون سطر جديد (مثل cout)
+inline void append(std::string& output, const Value& value) {
+    char buffer[32];
+    switch (value.type) {
+        case Value::Type::INT: {
+            auto [end, ignored] = std::to_chars(buffer, buffer + sizeof(buffer), value.asInt);
+            output.append(buffer, end);
+            break;
+        }
+        case Value::Type::DOUBLE: {
+            // (نفس صيغة cout الافتراضية)
+            int length = std::snprintf(buffer, sizeof(buffer), "%g", value.asDouble);
+            output.append(buffer, static_cast<size_t>(length));
+            break;
+        }
+        case Value::Type::BOOL: output += value.asBool ? "true" : "false"; break;
+        case Value::Type::STRING: output += value.stringValue(); break;
+        case Value::Type::OBJECT: output += "<object>"; break;
+        case Value::Type::NIL: output += "nil"; break;
+    }
+}
+
+// Draw: كلمة واحدة من الـ input تُقرأ بنوع المتغير الحالي (مثل cin)، فلا يتغير نوعه أبداً
+// (وهذا ما يضمنه الـ TypeChecker: DarkMagician يبقى INT حتى بعد Draw)
+inline Value drawValue(const std::string& word, const Value& current, StringHeap& strings) {
+    switch (current.type) {
+        case Value::Type::INT: {
+            int64_t integer = 0;
+            auto [end, error] = std::from_chars(word.data(), word.data() + word.size(), integer);
+            return Value::integer(error == std::errc() ? integer : 0);
+        }
+        case Value::Type::DOUBLE: return Value::number(word.empty() ? 0 : numberValue(word).toDouble());
+        case Value::Type::BOOL: return Value::boolean(word == "true" || word == "1");
+        default: break;
+    }
+    return strings.make(word);
+}
+
+} // namespace runtime
+
+#endif // DUELSCRIPT_RUNTIME_H
@@ -0,0 +1,175 @@
+#ifndef DUELSCRIPT_SCANKERNELS_H
+#define DUELSCRIPT_SCANKERNELS_H
+
+#include <cstddef>
+#include <cstdint>
+
+#if defined(__AVX2__) || defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+// --- Scanner Kernels ---
+// حلقات الـ Scanner الطويلة (مسافات، أسماء، أرقام، تعليقات، نصوص) تُنفّذ هنا
+// على 16/32 بايت في كل خطوة. الـ AVX2 أو SSE2 يُختار وقت الترجمة (لا فرع وقت التشغيل)، ونسخة
+// scalar موجودة دائماً كـ fallback؛ الـ benchmark يستدعي scalar:: و simd:: مباشرة للمقارنة.
+// كل دالة تأخذ [p, end) وتعيد مؤشراً لأول بايت لا ينتمي للـ run.
+// (النصوص والتعليقات الطويلة: findByte للنهاية، ثم countNewlines على ما بينهما)
+namespace scan_kernels {
+
+namespace scalar {
+
+inline bool isWhitespace(char c) {
+    return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+}
+
+inline bool isIdentifierChar(char c) {
+    return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '_';
+}
+
+inline const char* skipWhitespace(const char* p, const char* end, int& newlines) {
+    while (p < end && isWhitespace(*p)) {
+        if (*p == '\n') newlines++;
+        p++;
+    }
+    return p;
+}
+
+inline const char* skipIdentifier(const char* p, const char* end) {
+    while (p < end && isIdentifierChar(*p)) p++;
+    return p;
+}
+
+inline const char* skipDigits(const char* p, const char* end) {
+    while (p < end && *p >= '0' && *p <= '9') p++;
+    return p;
+}
+
+inline const char* findByte(const char* p, const char* end, char target) {
+    while (p < end && *p != target) p++;
+    return p;
+}
+
+inline int countNewlines(const char* p, const char* end) {
+    int newlines = 0;
+    for (; p < end; ++p) newlines += *p == '\n';
+    return newlines;
+}
+
+} // namespace scalar
+
+#if defined(__AVX2__) || defined(__SSE2__)
+#define DUELSCRIPT_SIMD_SCANNER 1
+
+namespace simd {
+
+#if defined(__AVX2__)
+using Vec = __m256i;
+using Mask = uint32_t;
+constexpr std::size_t WIDTH = 32;
+inline Vec load(const char* p) { return _mm256_loadu_si256(reinterpret_cast<const Vec*>(p)); }
+inline Vec splat(char c) { return _mm256_set1_epi8(c); }
+inline Vec eq(Vec a, Vec b) { return _mm256_cmpeq_epi8(a, b); }
+inline Vec gt(Vec a, Vec b) { return _mm256_cmpgt_epi8(a, b); }
+inline Vec orv(Vec a, Vec b) { return _mm256_or_si256(a, b); }
+inline Vec andv(Vec a, Vec b) { return _mm256_and_si256(a, b); }
+inline Mask bits(Vec v) { return static_cast<Mask>(_mm256_movemask_epi8(v)); }
+#else
+using Vec = __m128i;
+using Mask = uint32_t;
+constexpr std::size_t WIDTH = 16;
+inline Vec load(const char* p) { return _mm_loadu_si128(reinterpret_cast<const Vec*>(p)); }
+inline Vec splat(char c) { return _mm_set1_epi8(c); }
+inline Vec eq(Vec a, Vec b) { return _mm_cmpeq_epi8(a, b); }
+inline Vec gt(Vec a, Vec b) { return _mm_cmpgt_epi8(a, b); }
+inline Vec orv(Vec a, Vec b) { return _mm_or_si128(a, b); }
+inline Vec andv(Vec a, Vec b) { return _mm_and_si128(a, b); }
+inline Mask bits(Vec v) { return static_cast<Mask>(_mm_movemask_epi8(v)); }
+#endif
+
+constexpr Mask FULL = WIDTH == 32 ? ~Mask(0) : Mask((1u << WIDTH) - 1);
+
+inline int firstSet(Mask m) { return __builtin_ctz(m); }
+inline int popcount(Mask m) { return __builtin_popcount(m); }
+// (البتات الأقل من index فقط)
+inline Mask below(int index) { return index >= 32 ? ~Mask(0) : (Mask(1) << index) - 1; }
+
+// lo <= c <= hi (للـ ASCII فقط؛ البايتات >= 0x80 سالبة فتسقط تلقائياً)
+inline Vec inRange(Vec v, char lo, char hi) {
+    return andv(gt(v, splat(static_cast<char>(lo - 1))), gt(splat(static_cast<char>(hi + 1)), v));
+}
+
+inline const char* skipWhitespace(const char* p, const char* end, int& newlines) {
+    while (p + WIDTH <= end) {
+        Vec v = load(p);
+        Mask nl = bits(eq(v, splat('\n')));
+        Mask ws = nl | bits(orv(orv(eq(v, splat(' ')), eq(v, splat('\t'))), eq(v, splat('\r'))));
+        Mask other = ~ws & FULL;
+        if (other) {
+            int index = firstSet(other);
+            newlines += popcount(nl & below(index));
+            return p + index;
+        }
+        newlines += popcount(nl);
+        p += WIDTH;
+    }
+    return scalar::skipWhitespace(p, end, newlines);
+}
+
+inline const char* skipIdentifier(const char* p, const char* end) {
+    while (p + WIDTH <= end) {
+        Vec v = load(p);
+        Vec letter = inRange(orv(v, splat(0x20)), 'a', 'z');
+        Vec ok = orv(orv(letter, inRange(v, '0', '9')), eq(v, splat('_')));
+        Mask other = ~bits(ok) & FULL;
+        if (other) return p + firstSet(other);
+        p += WIDTH;
+    }
+    return scalar::skipIdentifier(p, end);
+}
+
+inline const char* skipDigits(const char* p, const char* end) {
+    while (p + WIDTH <= end) {
+        Mask other = ~bits(inRange(load(p), '0', '9')) & FULL;
+        if (other) return p + firstSet(other);
+        p += WIDTH;
+    }
+    return scalar::skipDigits(p, end);
+}
+
+inline const char* findByte(const char* p, const char* end, char target) {
+    while (p + WIDTH <= end) {
+        Mask hit = bits(eq(load(p), splat(target)));
+        if (hit) return p + firstSet(hit);
+        p += WIDTH;
+    }
+    return scalar::findByte(p, end, target);
+}
+
+inline int countNewlines(const char* p, const char* end) {
+    int newlines = 0;
+    while (p + WIDTH <= end) {
+        newlines += popcount(bits(eq(load(p), splat('\n'))));
+        p += WIDTH;
+    }
+    return newlines + scalar::countNewlines(p, end);
+}
+
+} // namespace simd
+#endif
+
+// --- نقاط الدخول التي يستخدمها الـ Scanner ---
+#ifdef DUELSCRIPT_SIMD_SCANNER
+namespace active = simd;
+#else
+namespace active = scalar;
+#endif
+
+using active::skipWhitespace;
+using active::skipIdentifier;
+using active::skipDigits;
+using active::findByte;
+using active::countNewlines;
+
+} // namespace scan_kernels
+
+#endif // DUELSCRIPT_SCANKERNELS_H
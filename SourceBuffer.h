@@ -0,0 +1,112 @@
+#ifndef DUELSCRIPT_SOURCEBUFFER_H
+#define DUELSCRIPT_SOURCEBUFFER_H
+
+#include <cstddef>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define DUELSCRIPT_HAVE_MMAP 1
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#else
+#include <fstream>
+#include <sstream>
+#endif
+
+// --- SourceBuffer ---
+// buffer للقراءة فقط يحمل نص الملف كما هو. الملفات العادية تُقرأ عبر mmap
+// (بدون أي نسخ)، أما الـ pipes والـ stdin ("-") فتُقرأ مرة واحدة إلى string.
+// الـ Scanner يستهلك text() مباشرة.
+class SourceBuffer {
+public:
+    SourceBuffer() = default;
+
+    // (للمصادر الموجودة في الذاكرة أصلاً: benchmarks، نصوص مولّدة...)
+    static SourceBuffer fromString(std::string text) {
+        SourceBuffer buffer;
+        buffer.owned = std::move(text);
+        return buffer;
+    }
+
+    // يعيد std::nullopt إذا تعذّر فتح/قراءة الملف
+    static std::optional<SourceBuffer> fromFile(const std::string& path) {
+#ifdef DUELSCRIPT_HAVE_MMAP
+        int fd = path == "-" ? STDIN_FILENO : ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) return std::nullopt;
+
+        std::optional<SourceBuffer> result;
+        struct stat info;
+        if (::fstat(fd, &info) == 0 && S_ISREG(info.st_mode) && info.st_size > 0) {
+            void* data = ::mmap(nullptr, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (data != MAP_FAILED) {
+                ::madvise(data, info.st_size, MADV_SEQUENTIAL);
+                result.emplace();
+                result->mapped = static_cast<const char*>(data);
+                result->mappedSize = static_cast<std::size_t>(info.st_size);
+            }
+        }
+        if (!result) {
+            // (fallback: pipe، stdin، ملف فارغ، أو فشل الـ mmap)
+            std::string text;
+            char chunk[64 * 1024];
+            ssize_t n;
+            while ((n = ::read(fd, chunk, sizeof(chunk))) > 0) {
+                text.append(chunk, static_cast<std::size_t>(n));
+            }
+            if (n == 0) result = fromString(std::move(text));
+        }
+
+        if (fd != STDIN_FILENO) ::close(fd);
+        return result;
+#else
+        std::ifstream file(path, std::ios::binary);
+        if (!file.is_open()) return std::nullopt;
+        std::stringstream buffer;
+        buffer << file.rdbuf();
+        return fromString(buffer.str());
+#endif
+    }
+
+    SourceBuffer(SourceBuffer&& other) noexcept { *this = std::move(other); }
+
+    SourceBuffer& operator=(SourceBuffer&& other) noexcept {
+        if (this != &other) {
+            release();
+            mapped = std::exchange(other.mapped, nullptr);
+            mappedSize = std::exchange(other.mappedSize, 0);
+            owned = std::move(other.owned);
+        }
+        return *this;
+    }
+
+    SourceBuffer(const SourceBuffer&) = delete;
+    SourceBuffer& operator=(const SourceBuffer&) = delete;
+
+    ~SourceBuffer() { release(); }
+
+    std::string_view text() const {
+        return mapped ? std::string_view(mapped, mappedSize) : std::string_view(owned);
+    }
+
+    bool isMapped() const { return mapped != nullptr; }
+
+private:
+    const char* mapped = nullptr;
+    std::size_t mappedSize = 0;
+    std::string owned;
+
+    void release() {
+#ifdef DUELSCRIPT_HAVE_MMAP
+        if (mapped) ::munmap(const_cast<char*>(mapped), mappedSize);
+#endif
+        mapped = nullptr;
+        mappedSize = 0;
+    }
+};
+
+#endif // DUELSCRIPT_SOURCEBUFFER_H
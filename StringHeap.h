@@ -0,0 +1,91 @@
+#ifndef DUELSCRIPT_STRINGHEAP_H
+#define DUELSCRIPT_STRINGHEAP_H
+
+#include "Value.h"
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <string_view>
+#include <vector>
+
+// --- StringHeap ---
+// النصوص التي تُبنى وقت التنفيذ (+ بين نصين، Draw) تعيش هنا وليس في الـ SymbolTable:
+// الـ SymbolTable للأسماء والـ literals فقط. كل engine يملك StringHeap خاصاً به، ويُفرغ
+// مع الـ objects في بداية كل run() (ويُحرر كله مع الـ engine)، بدون lock وبدون hash.
+// النصوص لا تتغير أبداً بعد كتابتها، فالـ Value مجرد (pointer، طول) ونسخه مجاني.
+// 's = s + x' في حلقة: إذا كان النص الأيسر آخر ما كُتب في الـ block، يُلحق الأيمن بعده
+// مباشرة بدل نسخ الاثنين (القيمة القديمة لـ s تبقى صحيحة: طولها لم يتغير)، والـ block
+// الجديد ضعف النص على الأقل، فالحلقة كلها تحجز ذاكرة خطية وليست تربيعية.
+class StringHeap {
+public:
+    static constexpr size_t MAX_LENGTH = UINT32_MAX;
+
+    // (false = النتيجة أطول من MAX_LENGTH)
+    bool concat(std::string_view left, std::string_view right, Value& result) {
+        if (left.size() + right.size() > MAX_LENGTH) return false;
+        if (right.empty() || left.empty()) {
+            result = Value::string(right.empty() ? left : right); // (لا شيء يُنسخ)
+            return true;
+        }
+        if (endsAtCursor(left) && size_t(limit - cursor) >= right.size()) {
+            std::memcpy(cursor, right.data(), right.size());
+            cursor += right.size();
+            result = Value::string({left.data(), left.size() + right.size()});
+            return true;
+        }
+        char* destination = allocate(left.size() + right.size());
+        std::memcpy(destination, left.data(), left.size());
+        std::memcpy(destination + left.size(), right.data(), right.size());
+        result = Value::string({destination, left.size() + right.size()});
+        return true;
+    }
+
+    // (كلمة من Draw؛ ما بعد MAX_LENGTH يُقطع)
+    Value make(std::string_view text) {
+        size_t size = std::min(text.size(), MAX_LENGTH);
+        if (size == 0) return Value::string({});
+        char* destination = allocate(size);
+        std::memcpy(destination, text.data(), size);
+        return Value::string({destination, size});
+    }
+
+    // (يُستدعى في بداية run: كل النصوص السابقة تصبح غير صالحة)
+    void clear() {
+        blocks.clear();
+        blockStart = cursor = limit = nullptr;
+        reserved = 0;
+    }
+
+    size_t bytesReserved() const { return reserved; }
+
+private:
+    static constexpr size_t BLOCK_SIZE = 64 * 1024;
+
+    bool endsAtCursor(std::string_view text) const {
+        std::less_equal<const char*> before;
+        return text.data() + text.size() == cursor && before(blockStart, text.data());
+    }
+
+    char* allocate(size_t size) {
+        if (size_t(limit - cursor) < size) {
+            size_t blockSize = std::max(BLOCK_SIZE, 2 * size);
+            blocks.emplace_back(new char[blockSize]);
+            reserved += blockSize;
+            blockStart = cursor = blocks.back().get();
+            limit = cursor + blockSize;
+        }
+        char* result = cursor;
+        cursor += size;
+        return result;
+    }
+
+    std::vector<std::unique_ptr<char[]>> blocks;
+    char* blockStart = nullptr;
+    char* cursor = nullptr;
+    char* limit = nullptr;
+    size_t reserved = 0;
+};
+
+#endif // DUELSCRIPT_STRINGHEAP_H
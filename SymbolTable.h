@@ -0,0 +1,177 @@
+#ifndef DUELSCRIPT_SYMBOLTABLE_H
+#define DUELSCRIPT_SYMBOLTABLE_H
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <string_view>
+#include <vector>
+
+// --- Symbol ---
+// رقم 32-bit لكل اسم (identifier) أو نص ثابت مختلف. مقارنة اسمين = مقارنة رقمين.
+using Symbol = uint32_t;
+
+// --- SymbolTable (Interner) ---
+// جدول واحد لكل الـ process يشترك فيه الـ Scanner والـ Parser وكل المراحل التالية،
+// لذلك الذاكرة تتناسب مع عدد الأسماء المختلفة وليس عدد مرات ظهورها.
+// آمن للاستخدام من أكثر من thread (الـ Parsing المتوازي وتحميل الـ modules):
+//   - intern: الجدول مقسوم إلى SHARDS أجزاء حسب الـ hash، لكل جزء mutex خاص به، فـ threads
+//     تسجل أسماء مختلفة نادراً ما تنتظر بعضها
+//   - name / size: بدون أي lock؛ النصوص في chunks لا تتحرك أبداً بعد كتابتها
+// الـ Symbol = (رقمه داخل الجزء << SHARD_BITS) | رقم الجزء.
+class SymbolTable {
+public:
+    // الرمز 0 محجوز دائماً للنص الفارغ
+    static constexpr Symbol EMPTY = 0;
+
+    static SymbolTable& global() {
+        static SymbolTable table;
+        return table;
+    }
+
+    Symbol intern(std::string_view text) {
+        if (text.empty()) return EMPTY;
+        uint64_t h = hash(text);
+        uint32_t shardIndex = static_cast<uint32_t>(h & (SHARDS - 1));
+        Shard& shard = shards[shardIndex];
+        uint32_t tag = static_cast<uint32_t>(h >> 32);
+
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        size_t mask = shard.slots.size() - 1;
+        for (size_t i = tag & mask;; i = (i + 1) & mask) {
+            Slot& slot = shard.slots[i];
+            if (slot.entry == 0) {
+                uint32_t index = shard.add(text);
+                slot = {tag, index + 1};
+                if (shard.used() * 2 > shard.slots.size()) shard.grow();
+                return (index << SHARD_BITS) | shardIndex;
+            }
+            if (slot.tag == tag && shard.entry(slot.entry - 1) == text) {
+                return ((slot.entry - 1) << SHARD_BITS) | shardIndex;
+            }
+        }
+    }
+
+    // (الـ Symbol جاء من intern، فكتابة نصه حدثت قبل أن يراه أي thread آخر)
+    std::string_view name(Symbol symbol) const {
+        return shards[symbol & (SHARDS - 1)].entry(symbol >> SHARD_BITS);
+    }
+
+    size_t size() const {
+        size_t total = 0;
+        for (const Shard& shard : shards) total += shard.count.load(std::memory_order_relaxed);
+        return total;
+    }
+
+private:
+    static constexpr uint32_t SHARD_BITS = 4;
+    static constexpr uint32_t SHARDS = 1u << SHARD_BITS;
+    static constexpr uint32_t CHUNK_BITS = 12;           // (4096 اسم في كل chunk)
+    static constexpr uint32_t MAX_CHUNKS = 1024;         // (4M اسم لكل جزء، 64M للجدول كله)
+    static constexpr size_t TEXT_BLOCK = 64 * 1024;
+
+    // (tag = النصف الأعلى من الـ hash، entry = رقم الاسم + 1؛ 0 = خانة فارغة)
+    struct Slot {
+        uint32_t tag = 0;
+        uint32_t entry = 0;
+    };
+
+    struct Shard {
+        std::mutex mutex;
+        std::vector<Slot> slots = std::vector<Slot>(64);
+        std::atomic<std::string_view*> chunks[MAX_CHUNKS] = {};
+        std::atomic<uint32_t> count{0};
+        std::vector<std::unique_ptr<char[]>> blocks; // (النصوص نفسها)
+        size_t blockUsed = TEXT_BLOCK;
+
+        ~Shard() {
+            for (auto& chunk : chunks) delete[] chunk.load(std::memory_order_relaxed);
+        }
+
+        size_t used() const { return count.load(std::memory_order_relaxed); }
+
+        std::string_view entry(uint32_t index) const {
+            return chunks[index >> CHUNK_BITS].load(std::memory_order_acquire)[index & ((1u << CHUNK_BITS) - 1)];
+        }
+
+        // (تحت الـ mutex)
+        uint32_t add(std::string_view text) {
+            uint32_t index = count.load(std::memory_order_relaxed);
+            if ((index >> CHUNK_BITS) >= MAX_CHUNKS) {
+                std::fprintf(stderr, "SymbolTable: too many unique names\n");
+                std::abort();
+            }
+            std::atomic<std::string_view*>& chunk = chunks[index >> CHUNK_BITS];
+            if (!chunk.load(std::memory_order_relaxed)) {
+                chunk.store(new std::string_view[1u << CHUNK_BITS], std::memory_order_release);
+            }
+            chunk.load(std::memory_order_relaxed)[index & ((1u << CHUNK_BITS) - 1)] = copy(text);
+            count.store(index + 1, std::memory_order_release);
+            return index;
+        }
+
+        std::string_view copy(std::string_view text) {
+            if (text.empty()) return {};
+            if (TEXT_BLOCK - blockUsed < text.size()) {
+                blocks.emplace_back(new char[std::max(TEXT_BLOCK, text.size())]);
+                blockUsed = 0;
+            }
+            char* destination = blocks.back().get() + blockUsed;
+            std::memcpy(destination, text.data(), text.size());
+            blockUsed += text.size();
+            return {destination, text.size()};
+        }
+
+        // (الـ tag يكفي لإعادة التوزيع: لا حاجة لحساب الـ hash من النص مرة أخرى)
+        void grow() {
+            std::vector<Slot> larger(slots.size() * 2);
+            size_t mask = larger.size() - 1;
+            for (const Slot& slot : slots) {
+                if (slot.entry == 0) continue;
+                size_t i = slot.tag & mask;
+                while (larger[i].entry != 0) i = (i + 1) & mask;
+                larger[i] = slot;
+            }
+            slots = std::move(larger);
+        }
+    };
+
+    SymbolTable() {
+        // (رقم 0 في الجزء 0 = النص الفارغ، خارج الـ hash table: intern("") يعيده مباشرة)
+        shards[0].add("");
+    }
+
+    // (8 بايت في كل خطوة، وآخر كلمة تُقرأ متداخلة مع ما قبلها بدل نسخ الباقي بايت بايت)
+    static uint64_t hash(std::string_view text) {
+        const char* p = text.data();
+        size_t n = text.size();
+        uint64_t h = 0x9E3779B97F4A7C15ull ^ n;
+        if (n >= 8) {
+            for (; n > 8; p += 8, n -= 8) {
+                h = (h ^ load64(p)) * 0xFF51AFD7ED558CCDull;
+                h ^= h >> 32;
+            }
+            h ^= load64(p + n - 8);
+        } else if (n >= 4) {
+            h ^= (uint64_t(load32(p)) << 32) | load32(p + n - 4);
+        } else {
+            h ^= uint64_t(uint8_t(p[0])) | uint64_t(uint8_t(p[n / 2])) << 8 | uint64_t(uint8_t(p[n - 1])) << 16;
+        }
+        h *= 0xC4CEB9FE1A85EC53ull;
+        h ^= h >> 29;
+        h *= 0xBF58476D1CE4E5B9ull;
+        return h ^ (h >> 32);
+    }
+
+    static uint64_t load64(const char* p) { uint64_t word; std::memcpy(&word, p, 8); return word; }
+    static uint32_t load32(const char* p) { uint32_t word; std::memcpy(&word, p, 4); return word; }
+
+    Shard shards[SHARDS];
+};
+
+#endif // DUELSCRIPT_SYMBOLTABLE_H
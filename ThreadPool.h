@@ -0,0 +1,113 @@
+#ifndef DUELSCRIPT_THREADPOOL_H
+#define DUELSCRIPT_THREADPOOL_H
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// --- ThreadPool ---
+// عدد ثابت من الـ threads يعيش طوال عمر الـ pool. العمل الوحيد المدعوم هو
+// parallelFor: كل thread (ومعها الـ thread المستدعي) تسحب الـ index التالي من
+// عداد atomic حتى تنتهي المهام، لذلك المهام غير المتساوية تتوزع تلقائياً.
+class ThreadPool {
+public:
+    // threads: العدد الكلي بما فيه الـ thread المستدعي (0 = عدد الـ cores)
+    explicit ThreadPool(unsigned threads = 0) {
+        if (threads == 0) threads = std::max(1u, std::thread::hardware_concurrency());
+        for (unsigned i = 1; i < threads; ++i) {
+            workers.emplace_back([this] { workerLoop(); });
+        }
+    }
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    ~ThreadPool() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        wake.notify_all();
+        for (std::thread& worker : workers) worker.join();
+    }
+
+    // (pool مشترك لكل الـ process، يُنشأ عند أول استخدام)
+    static ThreadPool& shared() {
+        static ThreadPool pool;
+        return pool;
+    }
+
+    unsigned size() const { return static_cast<unsigned>(workers.size()) + 1; }
+
+    // يستدعي body(i) لكل i في [0, count) ولا يعود إلا بعد انتهائها كلها.
+    // (استدعاء واحد في كل مرة؛ body يجب ألا يرمي exceptions)
+    void parallelFor(size_t count, const std::function<void(size_t)>& body) {
+        if (count == 0) return;
+        if (workers.empty() || count == 1) {
+            for (size_t i = 0; i < count; ++i) body(i);
+            return;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            job = &body;
+            jobCount = count;
+            next.store(0, std::memory_order_relaxed);
+            busy = workers.size();
+            generation++;
+        }
+        wake.notify_all();
+
+        runJob(body, count);
+
+        std::unique_lock<std::mutex> lock(mutex);
+        done.wait(lock, [this] { return busy == 0; });
+        job = nullptr;
+    }
+
+private:
+    void runJob(const std::function<void(size_t)>& body, size_t count) {
+        for (size_t i; (i = next.fetch_add(1, std::memory_order_relaxed)) < count;) {
+            body(i);
+        }
+    }
+
+    void workerLoop() {
+        size_t seen = 0;
+        while (true) {
+            const std::function<void(size_t)>* body;
+            size_t count;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                wake.wait(lock, [&] { return stopping || generation != seen; });
+                if (stopping) return;
+                seen = generation;
+                body = job;
+                count = jobCount;
+            }
+
+            runJob(*body, count);
+
+            std::lock_guard<std::mutex> lock(mutex);
+            if (--busy == 0) done.notify_one();
+        }
+    }
+
+    std::vector<std::thread> workers;
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::condition_variable done;
+    const std::function<void(size_t)>* job = nullptr;
+    size_t jobCount = 0;
+    std::atomic<size_t> next{0};
+    size_t busy = 0;
+    size_t generation = 0;
+    bool stopping = false;
+};
+
+#endif // DUELSCRIPT_THREADPOOL_H
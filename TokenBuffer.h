@@ -0,0 +1,107 @@
+#ifndef DUELSCRIPT_TOKENBUFFER_H
+#define DUELSCRIPT_TOKENBUFFER_H
+
+#include "DuelScriptScanner.h"
+#include "ScanKernels.h"
+#include <algorithm>
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+// --- TokenBuffer (Structure of Arrays) ---
+// بدلاً من vector<Token> (حوالي 32 بايت لكل Token)، كل حقل في مصفوفة منفصلة:
+// النوع (بايت واحد) + offset + length داخل الـ source + symbol = 13 بايت لكل Token.
+// حلقات check/match في الـ Parser تقرأ مصفوفة الأنواع فقط؛ الـ lexeme ورقم
+// السطر يُحسبان عند الطلب (أخطاء، أسماء، قيم ثابتة).
+class TokenBuffer {
+public:
+    explicit TokenBuffer(std::string_view source) : source(source) {}
+
+    void push(TokenType type, std::string_view lexeme, Symbol symbol) {
+        types.push_back(static_cast<uint8_t>(type));
+        offsets.push_back(static_cast<uint32_t>(lexeme.data() - source.data()));
+        lengths.push_back(static_cast<uint32_t>(lexeme.size()));
+        symbols.push_back(symbol);
+    }
+
+    // (يُستدعى مرة واحدة بعد آخر Token: يبني جدول بدايات الأسطر)
+    void finish() {
+        const char* begin = source.data();
+        const char* end = begin + source.size();
+        for (const char* p = begin; (p = scan_kernels::findByte(p, end, '\n')) < end; ++p) {
+            newlines.push_back(static_cast<uint32_t>(p - begin));
+        }
+    }
+
+    size_t size() const { return types.size(); }
+    const uint8_t* typeData() const { return types.data(); }
+    std::string_view getSource() const { return source; }
+
+    TokenType type(size_t index) const { return static_cast<TokenType>(types[index]); }
+
+    std::string_view lexeme(size_t index) const {
+        return source.substr(offsets[index], lengths[index]);
+    }
+
+    Symbol symbol(size_t index) const { return symbols[index]; }
+
+    // رقم السطر كما كان الـ Scanner سيعطيه: سطر نهاية الـ lexeme
+    // (يفرق فقط مع النصوص الممتدة على أكثر من سطر).
+    // hint: آخر نتيجة للمستدعي؛ الوصول المتتابع يصبح O(1) تقريباً.
+    int line(size_t index, size_t& hint) const {
+        uint32_t position = offsets[index] + lengths[index];
+        if (hint > newlines.size()) hint = 0;
+        if (hint > 0 && newlines[hint - 1] >= position) {
+            hint = std::lower_bound(newlines.begin(), newlines.begin() + hint, position) - newlines.begin();
+        }
+        while (hint < newlines.size() && newlines[hint] < position) hint++;
+        return static_cast<int>(hint) + 1;
+    }
+
+    int line(size_t index) const {
+        size_t hint = std::lower_bound(newlines.begin(), newlines.end(), offsets[index] + lengths[index])
+                      - newlines.begin();
+        return static_cast<int>(hint) + 1;
+    }
+
+    static constexpr size_t NOT_FOUND = SIZE_MAX;
+
+    // index الـ Token الذي يبدأ عند lexeme.data() (كل lexeme هو view داخل الـ source)
+    size_t indexOf(std::string_view lexeme) const {
+        if (lexeme.data() < source.data() || lexeme.data() > source.data() + source.size()) return NOT_FOUND;
+        uint32_t offset = static_cast<uint32_t>(lexeme.data() - source.data());
+        auto found = std::lower_bound(offsets.begin(), offsets.end(), offset);
+        if (found == offsets.end() || *found != offset) return NOT_FOUND;
+        return static_cast<size_t>(found - offsets.begin());
+    }
+
+    Token token(size_t index, size_t& lineHint) const {
+        return Token(type(index), lexeme(index), line(index, lineHint), symbols[index]);
+    }
+
+private:
+    friend class AstCache; // (يحفظ المصفوفات ويعيدها كما هي)
+
+    std::string_view source;
+    std::vector<uint8_t> types;
+    std::vector<uint32_t> offsets;
+    std::vector<uint32_t> lengths;
+    std::vector<Symbol> symbols;
+    std::vector<uint32_t> newlines; // (offset كل '\n': السطر n يبدأ بعد newlines[n-2])
+};
+
+// --- Scanner -> TokenBuffer ---
+// (ملف أكبر من MAX_SOURCE_BYTES: الـ Scanner يسجل الخطأ، والـ buffer فيه EOF فقط)
+inline TokenBuffer scanPacked(std::string_view source, Diagnostics* diagnostics = nullptr) {
+    Scanner scanner(source, diagnostics);
+    TokenBuffer buffer(source.size() > Scanner::MAX_SOURCE_BYTES ? source.substr(0, 0) : source);
+    Token token;
+    do {
+        token = scanner.nextToken();
+        buffer.push(token.type, token.lexeme, token.symbol);
+    } while (token.type != TokenType::TOKEN_EOF);
+    buffer.finish();
+    return buffer;
+}
+
+#endif // DUELSCRIPT_TOKENBUFFER_H
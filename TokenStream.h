@@ -0,0 +1,43 @@
+#ifndef DUELSCRIPT_TOKENSTREAM_H
+#define DUELSCRIPT_TOKENSTREAM_H
+
+#include "DuelScriptScanner.h"
+#include <cassert>
+#include <cstddef>
+
+// --- TokenStream ---
+// نافذة lookahead صغيرة (ring buffer) فوق Scanner::nextToken().
+// الـ Parser يطلب الـ Tokens بالـ index المطلق، ولا يحتاج أبداً أكثر من
+// previous و peek و peekNext، لذلك تبقى الذاكرة ثابتة مهما كبر الملف.
+class TokenStream {
+public:
+    explicit TokenStream(Scanner& scanner) : scanner(scanner) {}
+
+    // index يجب أن يكون داخل النافذة: [scanned - WINDOW, ...)
+    // (أي index بعد الـ EOF يعيد الـ EOF نفسه)
+    const Token& at(size_t index) {
+        while (scanned <= index && !reachedEof) {
+            Token& slot = ring[scanned & (WINDOW - 1)];
+            slot = scanner.nextToken();
+            reachedEof = slot.type == TokenType::TOKEN_EOF;
+            scanned++;
+        }
+        // (index أقدم من النافذة: مكانه في الـ ring أصبح Token آخر)
+        assert(index + WINDOW >= scanned && "TokenStream::at: index already left the lookahead window");
+        if (index >= scanned) index = scanned - 1;
+        return ring[index & (WINDOW - 1)];
+    }
+
+    // عدد الـ Tokens التي سُحبت من الـ Scanner حتى الآن
+    size_t count() const { return scanned; }
+
+private:
+    static constexpr size_t WINDOW = 4; // (قوة للعدد 2)
+
+    Scanner& scanner;
+    Token ring[WINDOW];
+    size_t scanned = 0;
+    bool reachedEof = false;
+};
+
+#endif // DUELSCRIPT_TOKENSTREAM_H
@@ -0,0 +1,498 @@
+#ifndef DUELSCRIPT_TYPECHECKER_H
+#define DUELSCRIPT_TYPECHECKER_H
+
+#include "AstNodes.h"
+#include "Diagnostics.h"
+#include "Resolver.h"
+#include "Runtime.h"
+#include <cstdint>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+// نوع أثناء الفحص: StaticType + الـ layout للـ OBJECT
+// (UNKNOWN هنا = Ritual لم يُعرف نوعه بعد: لا يسبب أي خطأ ويُقبل في كل مكان)
+struct CheckedType {
+    StaticType kind = StaticType::UNKNOWN;
+    uint32_t layout = MemberSlot::NONE;
+
+    bool operator==(const CheckedType& other) const { return kind == other.kind && layout == other.layout; }
+    bool operator!=(const CheckedType& other) const { return !(*this == other); }
+    bool isNumber() const { return kind == StaticType::INT || kind == StaticType::DOUBLE; }
+};
+
+// --- TypeChecker ---
+// يمر على البرنامج بعد الـ Resolver، يكتب في كل Expr نوعه الثابت (Expr::type)، ويرفض قبل التنفيذ
+// كل عملية كانت ستفشل بسبب النوع وكل قيمة تكسر نوع متغير:
+//   DarkMagician = INT، BlueEyesWhiteDragon = DOUBLE، RedEyesBlackDragon = STRING، TimeWizard = BOOL،
+//   و LordOfD / ToonWorld = OBJECT من ذلك الـ layout.
+// العمليات بنفس قواعد Runtime (INT مع INT يبقى INT، وأي DOUBLE يجعلها DOUBLE)، والقيمة التي تُخزن في
+// متغير أو حقل أو بارامتر يجب أن تكون من نوعه، إلا DarkMagician في مكان BlueEyesWhiteDragon: كل
+// engine يحوله إلى double عند التخزين (runtime::widen)، مثل C++. (والرقم الثابت 5، -5، (5) هناك
+// يصبح 5.0 في الشجرة نفسها: نفس النتيجة، بدون تحويل وقت التنفيذ)
+// الـ Rituals بدون نوع معلن: نوعها = نوع كل Tribute فيها (NIL إذا وصل الجسم إلى نهايته)، ويُستنتج
+// بالتكرار حتى يثبت لأن Fib مثلاً يعتمد على نفسه. (بدون exceptions، مثل الـ Resolver)
+class TypeChecker : public StaticVisitor<TypeChecker, CheckedType> {
+public:
+    // (نفس الـ units التي أخذها الـ Resolver: كل خطأ يذهب إلى sink الملف الذي حدث فيه)
+    bool check(const std::vector<Resolver::Unit>& units, const ResolvedProgram& resolved) {
+        program = &resolved;
+        hadError = false;
+        for (uint32_t i = 0; i < program->layouts.size(); ++i) layoutByName.emplace(program->layouts[i].name.symbol, i);
+        for (uint32_t i = 0; i < program->rituals.size(); ++i) ritualIndex.emplace(program->rituals[i].decl, i);
+
+        // --- 1. أنواع الـ Rituals: كل مرور يثبت نوع Ritual واحد على الأقل أو يتوقف ---
+        // (النوع لا يتغير بعد أن يُعرف، فعدد المرات <= عدد الـ Rituals + 1)
+        returns.assign(program->rituals.size(), CheckedType());
+        reporting = false;
+        for (bool changed = true; changed;) {
+            changed = false;
+            for (uint32_t i = 0; i < returns.size(); ++i) {
+                if (returns[i].kind != StaticType::UNKNOWN) continue;
+                returns[i] = checkRitual(i);
+                changed |= returns[i].kind != StaticType::UNKNOWN;
+            }
+        }
+
+        // --- 2. مرور أخير يكتب كل الأنواع ويسجل الأخطاء ---
+        reporting = true;
+        for (const Resolver::Unit& unit : units) {
+            diagnostics = unit.diagnostics;
+            locals.assign(program->scriptFrameSize, CheckedType());
+            currentRitual = NO_RITUAL;
+            currentLayout = MemberSlot::NONE;
+            for (const NodePtr<Stmt>& statement : *unit.statements) {
+                if (statement) visit(*statement);
+            }
+        }
+        return !hadError;
+    }
+
+    // (بعد check: نوع كل Ritual بأرقام ResolvedProgram::rituals؛ UNKNOWN = لا يعود أبداً)
+    CheckedType returnType(uint32_t ritual) const { return returns[ritual]; }
+
+    // --- الجمل ---
+
+    void visitExpressionStmt(const ExpressionStmt& stmt) { visit(*stmt.expression); }
+
+    void visitSummonStmt(const SummonStmt& stmt) { summon(*stmt.expression); }
+
+    void visitDrawStmt(const DrawStmt& stmt) {
+        CheckedType target = variable(stmt.slot);
+        if (target.kind == StaticType::OBJECT) error(stmt.name, DiagCode::TYPE_MISMATCH, "a monster type");
+    }
+
+    void visitVarDeclStmt(const VarDeclStmt& stmt) {
+        CheckedType declared = declaredType(stmt.type, stmt.layout);
+        if (stmt.initializer) assign(stmt.initializer, declared);
+        if (stmt.slot.depth == VarSlot::LOCAL && stmt.slot.slot < locals.size()) locals[stmt.slot.slot] = declared;
+    }
+
+    void visitBlockStmt(const BlockStmt& stmt) {
+        for (const NodePtr<Stmt>& statement : stmt.statements) visit(*statement);
+    }
+
+    void visitIfStmt(const IfStmt& stmt) {
+        value(*stmt.condition);
+        visit(*stmt.thenBranch);
+        if (stmt.elseBranch) visit(*stmt.elseBranch);
+    }
+
+    void visitWhileStmt(const WhileStmt& stmt) {
+        value(*stmt.condition);
+        visit(*stmt.body);
+    }
+
+    void visitFunctionStmt(const FunctionStmt& stmt) { checkRitual(ritualIndex.at(&stmt)); }
+
+    void visitReturnStmt(const ReturnStmt& stmt) {
+        CheckedType result{StaticType::NIL};
+        if (stmt.value) result = value(*stmt.value);
+        if (currentRitual == NO_RITUAL || result.kind == StaticType::UNKNOWN) return;
+        if (tribute.kind == StaticType::UNKNOWN) {
+            tribute = result;
+        } else if (tribute != result) {
+            mixedTribute = true;
+        }
+    }
+
+    void visitClassStmt(const ClassStmt& stmt) {
+        checkFields(layoutByName.at(stmt.name.symbol));
+        for (const NodePtr<FunctionStmt>& method : stmt.methods) visit(*method);
+    }
+
+    void visitStructStmt(const StructStmt& stmt) { checkFields(layoutByName.at(stmt.name.symbol)); }
+
+    void visitIncludeStmt(const IncludeStmt&) {}
+    void visitUsingStmt(const UsingStmt&) {}
+
+    // --- التعبيرات ---
+
+    CheckedType visitBinaryExpr(const BinaryExpr& expr) {
+        CheckedType left = value(*expr.left);
+        CheckedType right = value(*expr.right);
+        if (left.kind == StaticType::UNKNOWN || right.kind == StaticType::UNKNOWN) return annotate(expr, CheckedType());
+
+        switch (expr.op.type) {
+            case TokenType::EQUAL_EQUAL:
+            case TokenType::BANG_EQUAL:
+                return annotate(expr, {StaticType::BOOL});
+            case TokenType::LESS:
+            case TokenType::LESS_EQUAL:
+            case TokenType::GREATER:
+            case TokenType::GREATER_EQUAL:
+                if (!left.isNumber() || !right.isNumber()) error(expr.op, DiagCode::OPERANDS_MUST_BE_NUMBERS);
+                return annotate(expr, {StaticType::BOOL});
+            case TokenType::PLUS:
+                if (left.kind == StaticType::STRING && right.kind == StaticType::STRING) {
+                    return annotate(expr, {StaticType::STRING});
+                }
+                break;
+            default:
+                break;
+        }
+        if (!left.isNumber() || !right.isNumber()) {
+            error(expr.op, DiagCode::OPERANDS_MUST_BE_NUMBERS);
+            return annotate(expr, CheckedType());
+        }
+        bool integers = left.kind == StaticType::INT && right.kind == StaticType::INT;
+        return annotate(expr, {integers ? StaticType::INT : StaticType::DOUBLE});
+    }
+
+    CheckedType visitGroupingExpr(const GroupingExpr& expr) { return annotate(expr, visit(*expr.expression)); }
+
+    CheckedType visitLiteralExpr(const LiteralExpr& expr) {
+        switch (expr.value.type) {
+            case Value::Type::INT: return annotate(expr, {StaticType::INT});
+            case Value::Type::DOUBLE: return annotate(expr, {StaticType::DOUBLE});
+            case Value::Type::BOOL: return annotate(expr, {StaticType::BOOL});
+            case Value::Type::STRING: return annotate(expr, {StaticType::STRING});
+            default: return annotate(expr, CheckedType());
+        }
+    }
+
+    CheckedType visitUnaryExpr(const UnaryExpr& expr) {
+        CheckedType right = value(*expr.right);
+        if (expr.op.type == TokenType::BANG) return annotate(expr, {StaticType::BOOL});
+        if (right.kind == StaticType::UNKNOWN || right.isNumber()) return annotate(expr, right);
+        error(expr.op, DiagCode::OPERAND_MUST_BE_NUMBER);
+        return annotate(expr, CheckedType());
+    }
+
+    CheckedType visitVariableExpr(const VariableExpr& expr) { return annotate(expr, variable(expr.slot)); }
+
+    CheckedType visitAssignExpr(const AssignExpr& expr) {
+        CheckedType target = variable(expr.slot);
+        assign(expr.value, target);
+        return annotate(expr, target);
+    }
+
+    CheckedType visitCallExpr(const CallExpr& expr) {
+        uint32_t ritual = NO_RITUAL;
+        switch (expr.target.kind) {
+            case CallTarget::FUNCTION:
+            case CallTarget::SELF_METHOD:
+                ritual = expr.target.index;
+                break;
+            case CallTarget::METHOD: {
+                const GetExpr& get = static_cast<const GetExpr&>(*expr.callee);
+                uint32_t layout = objectLayout(value(*get.object), get.name);
+                if (layout == MemberSlot::NONE) break;
+                const ClassLayout& owner = program->layouts[layout];
+                uint32_t method = owner.methodIndex(get.name.symbol);
+                if (method == MemberSlot::NONE) {
+                    error(get.name, owner.fieldIndex(get.name.symbol) != MemberSlot::NONE
+                                    ? DiagCode::NOT_CALLABLE : DiagCode::UNDEFINED_MEMBER, owner.name.lexeme);
+                    break;
+                }
+                // (الـ Resolver لم يعرف نوع الـ object؛ الآن نعرفه، فلا بحث بالاسم وقت التنفيذ)
+                get.member = {layout, method};
+                ritual = owner.methods[method];
+                if (program->rituals[ritual].decl->params.size() != expr.arguments.size()) {
+                    error(expr.paren, DiagCode::WRONG_ARGUMENT_COUNT);
+                }
+                break;
+            }
+            case CallTarget::UNRESOLVED:
+                break;
+        }
+
+        const std::vector<FunctionParameter>* params = ritual == NO_RITUAL ? nullptr : &program->rituals[ritual].decl->params;
+        for (size_t i = 0; i < expr.arguments.size(); ++i) {
+            if (params && i < params->size()) {
+                const Token& type = (*params)[i].type;
+                assign(expr.arguments[i], declaredType(type, layoutOf(type)));
+            } else {
+                value(*expr.arguments[i]);
+            }
+        }
+        if (ritual == NO_RITUAL) return annotate(expr, CheckedType());
+        calleeName = program->rituals[ritual].decl->name.lexeme;
+        return annotate(expr, returns[ritual]);
+    }
+
+    CheckedType visitGetExpr(const GetExpr& expr) {
+        uint32_t layout = objectLayout(value(*expr.object), expr.name);
+        return annotate(expr, field(layout, expr.name, expr.member));
+    }
+
+    CheckedType visitSetExpr(const SetExpr& expr) {
+        uint32_t layout = objectLayout(value(*expr.object), expr.name);
+        CheckedType target = field(layout, expr.name, expr.member);
+        assign(expr.value, target);
+        return annotate(expr, target);
+    }
+
+private:
+    static constexpr uint32_t NO_RITUAL = UINT32_MAX;
+
+    void error(const Token& token, DiagCode code, std::string_view arg = {}) {
+        if (!reporting) return;
+        hadError = true;
+        diagnostics->report({code, 0, token.line, token.type == TokenType::TOKEN_EOF, token.lexeme, arg});
+    }
+
+    static CheckedType annotate(const Expr& expr, CheckedType type) {
+        expr.type = type.kind;
+        return type;
+    }
+
+    // (تعبير يُستخدم كقيمة: Ritual بدون Tribute بقيمة لا يصلح هنا)
+    CheckedType value(const Expr& expr) {
+        CheckedType type = visit(expr);
+        if (type.kind != StaticType::NIL) return type;
+        error(site(expr), DiagCode::NO_TRIBUTE_VALUE, calleeName);
+        return CheckedType();
+    }
+
+    // قيمة تُخزن في مكان نوعه target (متغير، حقل، بارامتر)
+    void assign(const NodePtr<Expr>& expr, CheckedType target) {
+        CheckedType type = value(*expr);
+        if (type.kind == StaticType::UNKNOWN || target.kind == StaticType::UNKNOWN || type == target) return;
+        if (target.kind == StaticType::DOUBLE && type.kind == StaticType::INT) {
+            widen(expr.get());
+            return;
+        }
+        error(site(*expr), DiagCode::TYPE_MISMATCH, typeName(target));
+    }
+
+    // رقم صحيح ثابت في مكان DOUBLE: الـ literal نفسه يصبح DOUBLE بدل TODOUBLE وقت التنفيذ
+    // (الـ nodes ملك الشجرة وليست const، مثل ما يفعل الـ Optimizer)
+    bool widen(Expr* expr) {
+        switch (expr->kind) {
+            case ExprKind::Literal: {
+                LiteralExpr& literal = static_cast<LiteralExpr&>(*expr);
+                if (literal.value.type != Value::Type::INT) return false;
+                if (reporting) literal.value = Value::number(static_cast<double>(literal.value.asInt));
+                break;
+            }
+            case ExprKind::Grouping:
+                if (!widen(static_cast<GroupingExpr&>(*expr).expression.get())) return false;
+                break;
+            case ExprKind::Unary: {
+                UnaryExpr& unary = static_cast<UnaryExpr&>(*expr);
+                if (unary.op.type != TokenType::MINUS || !widen(unary.right.get())) return false;
+                break;
+            }
+            default:
+                return false;
+        }
+        if (reporting) expr->type = StaticType::DOUBLE;
+        return true;
+    }
+
+    // Summon << a << b: كل جزء قيمة مستقلة (والسلسلة نفسها نص)
+    void summon(const Expr& expr) {
+        if (expr.kind == ExprKind::Binary) {
+            const BinaryExpr& chain = static_cast<const BinaryExpr&>(expr);
+            if (chain.op.type == TokenType::SUMMON_OP) {
+                summon(*chain.left);
+                summon(*chain.right);
+                annotate(expr, {StaticType::STRING});
+                return;
+            }
+        }
+        value(expr);
+    }
+
+    // --- الأنواع ---
+
+    CheckedType declaredType(const Token& type, uint32_t layout) const {
+        switch (type.type) {
+            case TokenType::KEYWORD_DARKMAGICIAN: return {StaticType::INT};
+            case TokenType::KEYWORD_BLUEEYESWHITEDRAGON: return {StaticType::DOUBLE};
+            case TokenType::KEYWORD_REDEYESBLACKDRAGON: return {StaticType::STRING};
+            case TokenType::KEYWORD_TIMEWIZARD: return {StaticType::BOOL};
+            default: break;
+        }
+        if (layout == MemberSlot::NONE) return CheckedType();
+        return {StaticType::OBJECT, layout};
+    }
+
+    uint32_t layoutOf(const Token& type) const {
+        auto found = layoutByName.find(type.symbol);
+        return type.type == TokenType::IDENTIFIER && found != layoutByName.end() ? found->second : MemberSlot::NONE;
+    }
+
+    std::string_view typeName(CheckedType type) const {
+        switch (type.kind) {
+            case StaticType::INT: return "DarkMagician";
+            case StaticType::DOUBLE: return "BlueEyesWhiteDragon";
+            case StaticType::STRING: return "RedEyesBlackDragon";
+            case StaticType::BOOL: return "TimeWizard";
+            case StaticType::OBJECT: return program->layouts[type.layout].name.lexeme;
+            default: return "a value";
+        }
+    }
+
+    CheckedType variable(const VarSlot& slot) const {
+        switch (slot.depth) {
+            case VarSlot::LOCAL: return slot.slot < locals.size() ? locals[slot.slot] : CheckedType();
+            case VarSlot::FIELD: {
+                const VarDeclStmt& field = *program->layouts[currentLayout].fields[slot.slot];
+                return declaredType(field.type, field.layout);
+            }
+            case VarSlot::GLOBAL: {
+                const VarDeclStmt& global = *program->globals[slot.slot];
+                return declaredType(global.type, global.layout);
+            }
+            default: return CheckedType();
+        }
+    }
+
+    // (MemberSlot::NONE = ليس object معروفاً، والخطأ سُجل إن لم يكن UNKNOWN)
+    uint32_t objectLayout(CheckedType type, const Token& name) {
+        if (type.kind == StaticType::OBJECT) return type.layout;
+        if (type.kind != StaticType::UNKNOWN) error(name, DiagCode::NOT_AN_OBJECT);
+        return MemberSlot::NONE;
+    }
+
+    CheckedType field(uint32_t layout, const Token& name, MemberSlot& member) {
+        if (layout == MemberSlot::NONE) return CheckedType();
+        const ClassLayout& owner = program->layouts[layout];
+        uint32_t index = owner.fieldIndex(name.symbol);
+        if (index == MemberSlot::NONE) {
+            error(name, DiagCode::UNDEFINED_MEMBER, owner.name.lexeme);
+            return CheckedType();
+        }
+        member = {layout, index};
+        return declaredType(owner.fields[index]->type, owner.fields[index]->layout);
+    }
+
+    // الـ Token الذي يُنسب إليه خطأ في تعبير
+    static const Token& site(const Expr& expr) {
+        switch (expr.kind) {
+            case ExprKind::Binary: return static_cast<const BinaryExpr&>(expr).op;
+            case ExprKind::Grouping: return site(*static_cast<const GroupingExpr&>(expr).expression);
+            case ExprKind::Literal: return static_cast<const LiteralExpr&>(expr).token;
+            case ExprKind::Unary: return static_cast<const UnaryExpr&>(expr).op;
+            case ExprKind::Variable: return static_cast<const VariableExpr&>(expr).name;
+            case ExprKind::Assign: return static_cast<const AssignExpr&>(expr).name;
+            case ExprKind::Call: return static_cast<const CallExpr&>(expr).paren;
+            case ExprKind::Get: return static_cast<const GetExpr&>(expr).name;
+            case ExprKind::Set: return static_cast<const SetExpr&>(expr).name;
+        }
+        return static_cast<const LiteralExpr&>(expr).token;
+    }
+
+    // --- الـ Rituals والـ layouts ---
+
+    // (يعيد نوع الـ Ritual كما يظهر من هذا المرور)
+    CheckedType checkRitual(uint32_t index) {
+        const RitualInfo& ritual = program->rituals[index];
+        Saved saved = enter(index, ritual.layout, ritual.frameSize);
+        const std::vector<FunctionParameter>& params = ritual.decl->params;
+        for (size_t i = 0; i < params.size() && i < locals.size(); ++i) {
+            locals[i] = declaredType(params[i].type, layoutOf(params[i].type));
+        }
+        visit(*ritual.decl->body);
+        if (completes(*ritual.decl->body)) {
+            if (tribute.kind == StaticType::UNKNOWN) {
+                tribute = {StaticType::NIL};
+            } else if (tribute.kind != StaticType::NIL) {
+                mixedTribute = true;
+            }
+        }
+        if (mixedTribute) error(ritual.decl->name, DiagCode::MIXED_TRIBUTE, ritual.decl->name.lexeme);
+        CheckedType result = tribute;
+        leave(saved);
+        return result;
+    }
+
+    // (الـ initializers تُنفذ في الـ constructor، والحقول الأخرى مرئية فيها)
+    void checkFields(uint32_t layout) {
+        Saved saved = enter(NO_RITUAL, layout, 0);
+        for (const VarDeclStmt* field : program->layouts[layout].fields) {
+            if (field->initializer) assign(field->initializer, declaredType(field->type, field->layout));
+        }
+        leave(saved);
+    }
+
+    // هل يمكن أن يصل التنفيذ إلى نهاية الجملة (بدون Tribute)؟
+    // (لا break في DuelScript، فـ FairyBox بشرط true ثابت لا ينتهي إلا بـ Tribute)
+    static bool completes(const Stmt& stmt) {
+        switch (stmt.kind) {
+            case StmtKind::Return: return false;
+            case StmtKind::Block:
+                for (const NodePtr<Stmt>& statement : static_cast<const BlockStmt&>(stmt).statements) {
+                    if (!completes(*statement)) return false;
+                }
+                return true;
+            case StmtKind::If: {
+                const IfStmt& branch = static_cast<const IfStmt&>(stmt);
+                return !branch.elseBranch || completes(*branch.thenBranch) || completes(*branch.elseBranch);
+            }
+            case StmtKind::While: {
+                const Expr& condition = *static_cast<const WhileStmt&>(stmt).condition;
+                return condition.kind != ExprKind::Literal ||
+                       !runtime::isTruthy(static_cast<const LiteralExpr&>(condition).value);
+            }
+            default: return true;
+        }
+    }
+
+    struct Saved {
+        std::vector<CheckedType> locals;
+        uint32_t ritual;
+        uint32_t layout;
+        CheckedType tribute;
+        bool mixedTribute;
+    };
+
+    Saved enter(uint32_t ritual, uint32_t layout, uint32_t frameSize) {
+        Saved saved{std::move(locals), currentRitual, currentLayout, tribute, mixedTribute};
+        locals.assign(frameSize, CheckedType());
+        currentRitual = ritual;
+        currentLayout = layout;
+        tribute = CheckedType();
+        mixedTribute = false;
+        return saved;
+    }
+
+    void leave(Saved& saved) {
+        locals = std::move(saved.locals);
+        currentRitual = saved.ritual;
+        currentLayout = saved.layout;
+        tribute = saved.tribute;
+        mixedTribute = saved.mixedTribute;
+    }
+
+    const ResolvedProgram* program = nullptr;
+    Diagnostics* diagnostics = nullptr;
+    bool hadError = false;
+    bool reporting = false; // (المرور الأخير فقط)
+
+    std::unordered_map<Symbol, uint32_t> layoutByName;
+    std::unordered_map<const FunctionStmt*, uint32_t> ritualIndex;
+    std::vector<CheckedType> returns; // (نوع كل Ritual، بنفس أرقام ResolvedProgram::rituals)
+
+    // (الـ Ritual الحالي، أو المستوى الأعلى / constructor)
+    std::vector<CheckedType> locals; // (نوع كل slot محلي الآن: الـ slots يُعاد استخدامها بين الـ blocks)
+    uint32_t currentRitual = NO_RITUAL;
+    uint32_t currentLayout = MemberSlot::NONE;
+    CheckedType tribute;
+    bool mixedTribute = false;
+    std::string_view calleeName; // (آخر Ritual استُدعي، لرسالة NO_TRIBUTE_VALUE)
+};
+
+#endif // DUELSCRIPT_TYPECHECKER_H
@@ -0,0 +1,465 @@
+#ifndef DUELSCRIPT_VM_H
+#define DUELSCRIPT_VM_H
+
+#include "Bytecode.h"
+#include "Diagnostics.h"
+#include "Resolver.h"
+#include "Runtime.h"
+#include "Value.h"
+#include <deque>
+#include <iostream>
+#include <string>
+#include <vector>
+
+// --- الـ dispatch: computed goto أو switch ---
+// مع GCC / Clang كل handler يقفز مباشرة إلى handler الـ instruction التالي
+// (goto *labels[op]) بدلاً من الرجوع إلى switch واحد: لكل opcode قفزة خاصة به
+// يتعلمها الـ branch predictor. -DDUELSCRIPT_SWITCH_DISPATCH يفرض الـ switch
+// المحمول، وهو الوحيد المتاح مع أي compiler آخر.
+#if defined(__GNUC__) && !defined(DUELSCRIPT_SWITCH_DISPATCH)
+#define DUELSCRIPT_COMPUTED_GOTO 1
+#endif
+
+#ifdef DUELSCRIPT_COMPUTED_GOTO
+#define DUELSCRIPT_VM_CASE(name) case OpCode::name: op_##name:
+#define DUELSCRIPT_VM_NEXT()                                                                                      \
+    if constexpr (Threaded) {                                                                                   \
+        i = *ip++;                                                                                              \
+        goto* labels[static_cast<uint8_t>(op(i))];                                                              \
+    } else                                                                                                      \
+        break
+#else
+#define DUELSCRIPT_VM_CASE(name) case OpCode::name:
+#define DUELSCRIPT_VM_NEXT() break
+#endif
+
+// --- VM ---
+// ينفذ الـ BytecodeProgram: register machine بدون أي recursion في C++.
+// كل frame = نافذة داخل stack واحد من الـ Values؛ الاستدعاء لا ينسخ البارامترات
+// (هي أصلاً أول registers الـ frame الجديد)، ولا يحجز أي ذاكرة.
+// نفس قواعد القيم والأخطاء مثل الـ Interpreter (Runtime.h)، فالناتج متطابق.
+class VM {
+public:
+    enum class Dispatch : uint8_t { SWITCH, THREADED };
+#ifdef DUELSCRIPT_COMPUTED_GOTO
+    static constexpr bool THREADED_AVAILABLE = true;
+#else
+    static constexpr bool THREADED_AVAILABLE = false; // (THREADED يعمل كـ SWITCH)
+#endif
+    static constexpr Dispatch DEFAULT_DISPATCH = THREADED_AVAILABLE ? Dispatch::THREADED : Dispatch::SWITCH;
+
+    static constexpr size_t MAX_DEPTH = 1000;
+    // (كل frame لا يتجاوز MAX_REGISTERS، فالعمق وحده يحدد الـ stack overflow)
+    static constexpr size_t STACK_SLOTS = (MAX_DEPTH + 2) * bytecode::MAX_REGISTERS;
+    static constexpr size_t OUTPUT_FLUSH = 64 * 1024;
+
+    VM(const BytecodeProgram& program, Diagnostics& diagnostics, std::ostream& out = std::cout)
+            : program(program), layouts(program.resolved->layouts), diagnostics(diagnostics), out(out),
+              stack(STACK_SLOTS), frames(MAX_DEPTH + 1) {}
+
+    // (يمكن استدعاؤه أكثر من مرة: كل تشغيل يبدأ من globals و objects جديدة)
+    bool run(Dispatch dispatch = DEFAULT_DISPATCH) {
+        heap.clear();
+        strings.clear();
+        globals.assign(program.resolved->globals.size(), Value());
+        bool ok = dispatch == Dispatch::THREADED ? execute<true>() : execute<false>();
+        flush();
+        return ok;
+    }
+
+    const std::vector<Value>& getGlobals() const { return globals; }
+
+private:
+    struct Frame {
+        const Chunk* chunk;
+        const Instruction* ip;
+        Value* base;
+        Instance* self;
+        Value* result; // (أين تذهب قيمة الـ Tribute؛ nullptr للـ constructor والـ script)
+    };
+
+    // (nullptr = stack overflow؛ دالة عضو وليست lambda داخل execute: GCC لا يدمج الـ lambda في
+    //  نسخة الـ computed goto، فتخرج frame و ip و R من الـ registers وتصبح الاستدعاءات أبطأ من الـ switch)
+    Frame* push(Frame* frame, const Instruction* ip, const Chunk& callee, Value* base, Instance* receiver, Value* result) {
+        if (frame == &frames.back()) return nullptr;
+        frame->ip = ip;
+        frame[1] = {&callee, callee.code.data(), base, receiver, result};
+        return frame + 1;
+    }
+
+    template <bool Threaded>
+    bool execute() {
+        using namespace bytecode;
+        Frame* frame = frames.data();
+        *frame = {&program.script, program.script.code.data(), stack.data(), nullptr, nullptr};
+
+        const Value* K = program.constants.data();
+        const Chunk* chunk = frame->chunk;
+        const Instruction* ip = frame->ip;
+        Value* R = frame->base;
+        Instance* self = frame->self;
+
+        // (بعد CALL / RETURN: الحالة المحلية من الـ frame الجديد)
+        auto enter = [&](Frame* next) {
+            frame = next;
+            chunk = frame->chunk;
+            ip = frame->ip;
+            R = frame->base;
+            self = frame->self;
+        };
+        auto siteOf = [&](const Instruction* at) -> const Token& { return chunk->sites[at - chunk->code.data()]; };
+        auto fail = [&](DiagCode code, const Token* token = nullptr, std::string_view arg = {}) {
+            const Token& site = token ? *token : siteOf(ip - 1);
+            diagnostics.report({code, 0, site.line, false, site.lexeme, arg});
+            return false;
+        };
+        // (الأرقام في الـ opcode نفسه، والباقي والأخطاء عبر Runtime)
+        auto slow = [&](TokenType op, Instruction i) {
+            Value left = R[b(i)], right = R[c(i)];
+            DiagCode code;
+            return runtime::binary(op, left, right, R[a(i)], code, &strings) || fail(code);
+        };
+        auto object = [&](const Value& value, const MemberRef& ref) -> Instance* {
+            if (value.type == Value::Type::OBJECT) return value.asObject;
+            fail(DiagCode::NOT_AN_OBJECT, &ref.name);
+            return nullptr;
+        };
+        auto field = [&](const Instance& instance, const MemberRef& ref) {
+            if (ref.layout == instance.layout) return ref.index;
+            uint32_t index = layouts[instance.layout].fieldIndex(ref.name.symbol);
+            if (index == MemberSlot::NONE) fail(DiagCode::UNDEFINED_MEMBER, &ref.name, layouts[instance.layout].name.lexeme);
+            return index;
+        };
+
+#ifdef DUELSCRIPT_COMPUTED_GOTO
+        // (بنفس ترتيب OpCode)
+        static void* const labels[] = {
+            &&op_MOVE, &&op_LOADK, &&op_GETGLOBAL, &&op_SETGLOBAL, &&op_GETSELF, &&op_SETSELF,
+            &&op_GETFIELD, &&op_SETFIELD, &&op_NEWOBJ,
+            &&op_ADD, &&op_SUB, &&op_MUL, &&op_DIV, &&op_EQ, &&op_NE, &&op_LT, &&op_LE, &&op_GT, &&op_GE,
+            &&op_NEG, &&op_NOT, &&op_JMP, &&op_JMPF,
+            &&op_CALL, &&op_CALLSELF, &&op_CALLM, &&op_RETURN, &&op_RETURN0,
+            &&op_SUMMON, &&op_DRAW, &&op_TODOUBLE,
+            &&op_JMPCMP, &&op_JMPCMPK, &&op_JMPFIELDK, &&op_SUMMONS,
+            &&op_ADDI, &&op_SUBI, &&op_MULI, &&op_DIVI, &&op_ADDF, &&op_SUBF, &&op_MULF, &&op_DIVF,
+            &&op_JMPCMPI, &&op_JMPCMPKI, &&op_JMPFB,
+        };
+        static_assert(sizeof(labels) / sizeof(labels[0]) == bytecode::OPCODE_COUNT, "one label per OpCode");
+#endif
+
+        Instruction i;
+        while (true) {
+            i = *ip++;
+            switch (op(i)) {
+                DUELSCRIPT_VM_CASE(MOVE) R[a(i)] = R[b(i)]; DUELSCRIPT_VM_NEXT();
+                DUELSCRIPT_VM_CASE(LOADK) R[a(i)] = K[bx(i)]; DUELSCRIPT_VM_NEXT();
+                DUELSCRIPT_VM_CASE(GETGLOBAL) R[a(i)] = globals[bx(i)]; DUELSCRIPT_VM_NEXT();
+                DUELSCRIPT_VM_CASE(SETGLOBAL) globals[bx(i)] = R[a(i)]; DUELSCRIPT_VM_NEXT();
+                DUELSCRIPT_VM_CASE(GETSELF) R[a(i)] = self->fields[bx(i)]; DUELSCRIPT_VM_NEXT();
+                DUELSCRIPT_VM_CASE(SETSELF) self->fields[bx(i)] = R[a(i)]; DUELSCRIPT_VM_NEXT();
+
+                DUELSCRIPT_VM_CASE(GETFIELD) {
+                    const MemberRef& ref = chunk->members[c(i)];
+                    Instance* instance = object(R[b(i)], ref);
+                    if (!instance) return false;
+                    uint32_t index = field(*instance, ref);
+                    if (index == MemberSlot::NONE) return false;
+                    R[a(i)] = instance->fields[index];
+                }
+                DUELSCRIPT_VM_NEXT();
+                DUELSCRIPT_VM_CASE(SETFIELD) {
+                    const MemberRef& ref = chunk->members[c(i)];
+                    Instance* instance = object(R[a(i)], ref);
+                    if (!instance) return false;
+                    uint32_t index = field(*instance, ref);
+                    if (index == MemberSlot::NONE) return false;
+                    // (الـ layout يُعرف وقت التنفيذ فقط، فالتحويل هنا وليس TODOUBLE)
+                    Value value = R[b(i)];
+                    if (value.type == Value::Type::INT && layouts[instance->layout].fields[index]->slot.toDouble) {
+                        runtime::widen(value);
+                    }
+                    instance->fields[index] = value;
+                }
+                DUELSCRIPT_VM_NEXT();
+                DUELSCRIPT_VM_CASE(NEWOBJ) {
+                    uint32_t layout = bx(i);
+                    // (الـ deque لا ينقل عناصره، فالـ pointer يبقى صالحاً مهما أُنشئ بعده)
+                    Instance* instance = &heap.emplace_back(Instance{layout, std::vector<Value>(layouts[layout].fields.size())});
+                    R[a(i)] = Value::object(instance);
+                    Frame* next = push(frame, ip, program.constructors[layout], R + chunk->registers, instance, nullptr);
+                    if (!next) return fail(DiagCode::STACK_OVERFLOW);
+                    enter(next);
+                }
+                DUELSCRIPT_VM_NEXT();
+
+                DUELSCRIPT_VM_CASE(ADD) {
+                    const Value& x = R[b(i)];
+                    const Value& y = R[c(i)];
+                    if (x.type == Value::Type::INT && y.type == Value::Type::INT) {
+                        R[a(i)] = Value::integer(runtime::wrap(uint64_t(x.asInt) + uint64_t(y.asInt)));
+                    } else if (x.isNumber() && y.isNumber()) {
+                        R[a(i)] = Value::number(x.toDouble() + y.toDouble());
+                    } else if (!slow(TokenType::PLUS, i)) {
+                        return false;
+                    }
+                }
+                DUELSCRIPT_VM_NEXT();
+                DUELSCRIPT_VM_CASE(SUB) {
+                    const Value& x = R[b(i)];
+                    const Value& y = R[c(i)];
+                    if (x.type == Value::Type::INT && y.type == Value::Type::INT) {
+                        R[a(i)] = Value::integer(runtime::wrap(uint64_t(x.asInt) - uint64_t(y.asInt)));
+                    } else if (x.isNumber() && y.isNumber()) {
+                        R[a(i)] = Value::number(x.toDouble() - y.toDouble());
+                    } else if (!slow(TokenType::MINUS, i)) {
+                        return false;
+                    }
+                }
+                DUELSCRIPT_VM_NEXT();
+                DUELSCRIPT_VM_CASE(MUL) {
+                    const Value& x = R[b(i)];
+                    const Value& y = R[c(i)];
+                    if (x.type == Value::Type::INT && y.type == Value::Type::INT) {
+                        R[a(i)] = Value::integer(runtime::wrap(uint64_t(x.asInt) * uint64_t(y.asInt)));
+                    } else if (x.isNumber() && y.isNumber()) {
+                        R[a(i)] = Value::number(x.toDouble() * y.toDouble());
+                    } else if (!slow(TokenType::STAR, i)) {
+                        return false;
+                    }
+                }
+                DUELSCRIPT_VM_NEXT();
+                DUELSCRIPT_VM_CASE(DIV) {
+                    const Value& x = R[b(i)];
+                    const Value& y = R[c(i)];
+                    bool integers = x.type == Value::Type::INT && y.type == Value::Type::INT;
+                    if (integers && y.asInt != 0 && y.asInt != -1) {
+                        R[a(i)] = Value::integer(x.asInt / y.asInt);
+                    } else if (!integers && x.isNumber() && y.isNumber()) {
+                        R[a(i)] = Value::number(x.toDouble() / y.toDouble());
+                    } else if (!slow(TokenType::SLASH, i)) {
+                        return false;
+                    }
+                }
+                DUELSCRIPT_VM_NEXT();
+                DUELSCRIPT_VM_CASE(EQ)
+                DUELSCRIPT_VM_CASE(NE)
+                DUELSCRIPT_VM_CASE(LT)
+                DUELSCRIPT_VM_CASE(LE)
+                DUELSCRIPT_VM_CASE(GT)
+                DUELSCRIPT_VM_CASE(GE) {
+                    bool result;
+                    DiagCode code;
+                    if (!compare(op(i), R[b(i)], R[c(i)], result, code)) return fail(code);
+                    R[a(i)] = Value::boolean(result);
+                }
+                DUELSCRIPT_VM_NEXT();
+                DUELSCRIPT_VM_CASE(NEG) {
+                    Value value = R[b(i)];
+                    DiagCode code;
+                    if (!runtime::negate(value, R[a(i)], code)) return fail(code);
+                }
+                DUELSCRIPT_VM_NEXT();
+                DUELSCRIPT_VM_CASE(NOT) R[a(i)] = Value::boolean(!runtime::isTruthy(R[b(i)])); DUELSCRIPT_VM_NEXT();
+
+                DUELSCRIPT_VM_CASE(JMP) ip += sbx(i); DUELSCRIPT_VM_NEXT();
+                DUELSCRIPT_VM_CASE(JMPF) {
+                    const Value& condition = R[a(i)];
+                    bool truthy = condition.type == Value::Type::BOOL ? condition.asBool : runtime::isTruthy(condition);
+                    if (!truthy) ip += sbx(i);
+                }
+                DUELSCRIPT_VM_NEXT();
+
+                DUELSCRIPT_VM_CASE(CALL) {
+                    Value* base = R + a(i);
+                    Frame* next = push(frame, ip, program.rituals[bx(i)], base, nullptr, base);
+                    if (!next) return fail(DiagCode::STACK_OVERFLOW);
+                    enter(next);
+                }
+                DUELSCRIPT_VM_NEXT();
+                DUELSCRIPT_VM_CASE(CALLSELF) {
+                    Value* base = R + a(i);
+                    Frame* next = push(frame, ip, program.rituals[bx(i)], base, self, base);
+                    if (!next) return fail(DiagCode::STACK_OVERFLOW);
+                    enter(next);
+                }
+                DUELSCRIPT_VM_NEXT();
+                DUELSCRIPT_VM_CASE(CALLM) {
+                    const MemberRef& ref = chunk->members[bx(i)];
+                    Instance* instance = object(R[a(i)], ref);
+                    if (!instance) return false;
+                    const ClassLayout& layout = layouts[instance->layout];
+                    uint32_t method = ref.layout == instance->layout ? ref.index : layout.methodIndex(ref.name.symbol);
+                    if (method == MemberSlot::NONE) return fail(DiagCode::UNDEFINED_MEMBER, &ref.name, layout.name.lexeme);
+                    uint32_t ritual = layout.methods[method];
+                    if (program.resolved->rituals[ritual].decl->params.size() != ref.argc) {
+                        return fail(DiagCode::WRONG_ARGUMENT_COUNT);
+                    }
+                    Value* base = R + a(i);
+                    Frame* next = push(frame, ip, program.rituals[ritual], base + 1, instance, base);
+                    if (!next) return fail(DiagCode::STACK_OVERFLOW);
+                    enter(next);
+                }
+                DUELSCRIPT_VM_NEXT();
+                DUELSCRIPT_VM_CASE(RETURN)
+                DUELSCRIPT_VM_CASE(RETURN0) {
+                    Value result = op(i) == OpCode::RETURN ? R[a(i)] : Value();
+                    if (frame->result) *frame->result = result;
+                    if (frame == frames.data()) return true;
+                    enter(frame - 1);
+                }
+                DUELSCRIPT_VM_NEXT();
+
+                DUELSCRIPT_VM_CASE(SUMMON)
+                    runtime::append(output, R[a(i)]);
+                    if (output.size() >= OUTPUT_FLUSH) flush();
+                    DUELSCRIPT_VM_NEXT();
+                DUELSCRIPT_VM_CASE(DRAW) {
+                    flush();
+                    std::string word;
+                    std::cin >> word;
+                    R[a(i)] = runtime::drawValue(word, R[a(i)], strings);
+                }
+                DUELSCRIPT_VM_NEXT();
+                DUELSCRIPT_VM_CASE(TODOUBLE) runtime::widen(R[a(i)]); DUELSCRIPT_VM_NEXT();
+
+                // --- superinstructions ---
+
+                DUELSCRIPT_VM_CASE(JMPCMP) {
+                    Instruction extra = *ip++;
+                    bool result;
+                    DiagCode code;
+                    if (!compare(OpCode(c(i)), R[a(i)], R[b(i)], result, code)) return fail(code, &siteOf(ip - 2));
+                    if (!result) ip += sbx(extra);
+                }
+                DUELSCRIPT_VM_NEXT();
+                DUELSCRIPT_VM_CASE(JMPCMPK) {
+                    Instruction extra = *ip++;
+                    bool result;
+                    DiagCode code;
+                    if (!compare(OpCode(c(i)), R[a(i)], K[low(extra)], result, code)) return fail(code, &siteOf(ip - 2));
+                    if (!result) ip += sbx(extra);
+                }
+                DUELSCRIPT_VM_NEXT();
+                DUELSCRIPT_VM_CASE(JMPFIELDK) {
+                    Instruction extra = *ip++;
+                    const MemberRef& ref = chunk->members[b(i)];
+                    Instance* instance = object(R[a(i)], ref);
+                    if (!instance) return false;
+                    uint32_t index = field(*instance, ref);
+                    if (index == MemberSlot::NONE) return false;
+                    bool result;
+                    DiagCode code;
+                    if (!compare(OpCode(c(i)), instance->fields[index], K[low(extra)], result, code)) {
+                        return fail(code, &siteOf(ip - 2));
+                    }
+                    if (!result) ip += sbx(extra);
+                }
+                DUELSCRIPT_VM_NEXT();
+                DUELSCRIPT_VM_CASE(SUMMONS) {
+                    // (operand 16 bit: register، أو constant إذا كان SUMMON_CONSTANT فيه)
+                    auto value = [&](uint32_t operand) -> const Value& {
+                        return operand & SUMMON_CONSTANT ? K[operand & ~SUMMON_CONSTANT] : R[operand];
+                    };
+                    for (uint32_t n = a(i); n > 0; n -= n > 1 ? 2 : 1) {
+                        Instruction operands = *ip++;
+                        runtime::append(output, value(low(operands)));
+                        if (n > 1) runtime::append(output, value(operands >> 16));
+                    }
+                    if (output.size() >= OUTPUT_FLUSH) flush();
+                }
+                DUELSCRIPT_VM_NEXT();
+
+                // --- typed (بعد الـ TypeChecker): القيمة مباشرة بدون فحص الـ type ---
+
+                DUELSCRIPT_VM_CASE(ADDI)
+                    R[a(i)] = Value::integer(runtime::wrap(uint64_t(R[b(i)].asInt) + uint64_t(R[c(i)].asInt)));
+                    DUELSCRIPT_VM_NEXT();
+                DUELSCRIPT_VM_CASE(SUBI)
+                    R[a(i)] = Value::integer(runtime::wrap(uint64_t(R[b(i)].asInt) - uint64_t(R[c(i)].asInt)));
+                    DUELSCRIPT_VM_NEXT();
+                DUELSCRIPT_VM_CASE(MULI)
+                    R[a(i)] = Value::integer(runtime::wrap(uint64_t(R[b(i)].asInt) * uint64_t(R[c(i)].asInt)));
+                    DUELSCRIPT_VM_NEXT();
+                DUELSCRIPT_VM_CASE(DIVI) {
+                    // (القسمة على 0 و -1 فقط تحتاج Runtime: خطأ، أو INT64_MIN / -1)
+                    int64_t y = R[c(i)].asInt;
+                    if (y != 0 && y != -1) {
+                        R[a(i)] = Value::integer(R[b(i)].asInt / y);
+                    } else if (!slow(TokenType::SLASH, i)) {
+                        return false;
+                    }
+                }
+                DUELSCRIPT_VM_NEXT();
+                DUELSCRIPT_VM_CASE(ADDF) R[a(i)] = Value::number(R[b(i)].asDouble + R[c(i)].asDouble); DUELSCRIPT_VM_NEXT();
+                DUELSCRIPT_VM_CASE(SUBF) R[a(i)] = Value::number(R[b(i)].asDouble - R[c(i)].asDouble); DUELSCRIPT_VM_NEXT();
+                DUELSCRIPT_VM_CASE(MULF) R[a(i)] = Value::number(R[b(i)].asDouble * R[c(i)].asDouble); DUELSCRIPT_VM_NEXT();
+                DUELSCRIPT_VM_CASE(DIVF) R[a(i)] = Value::number(R[b(i)].asDouble / R[c(i)].asDouble); DUELSCRIPT_VM_NEXT();
+                DUELSCRIPT_VM_CASE(JMPCMPI) {
+                    Instruction extra = *ip++;
+                    if (!compareInt(OpCode(c(i)), R[a(i)].asInt, R[b(i)].asInt)) ip += sbx(extra);
+                }
+                DUELSCRIPT_VM_NEXT();
+                DUELSCRIPT_VM_CASE(JMPCMPKI) {
+                    Instruction extra = *ip++;
+                    if (!compareInt(OpCode(c(i)), R[a(i)].asInt, K[low(extra)].asInt)) ip += sbx(extra);
+                }
+                DUELSCRIPT_VM_NEXT();
+                DUELSCRIPT_VM_CASE(JMPFB) if (!R[a(i)].asBool) ip += sbx(i); DUELSCRIPT_VM_NEXT();
+            }
+        }
+    }
+
+    static bool compareInt(OpCode kind, int64_t x, int64_t y) {
+        switch (kind) {
+            case OpCode::EQ: return x == y;
+            case OpCode::NE: return x != y;
+            case OpCode::LT: return x < y;
+            case OpCode::LE: return x <= y;
+            case OpCode::GT: return x > y;
+            default: return x >= y;
+        }
+    }
+
+    // مقارنة كما في Runtime: INT مع INT هنا، والباقي عبر runtime::binary
+    // (kind = OpCode::EQ .. GE؛ false = خطأ runtime)
+    static bool compare(OpCode kind, const Value& x, const Value& y, bool& result, DiagCode& error) {
+        if (x.type == Value::Type::INT && y.type == Value::Type::INT) {
+            result = compareInt(kind, x.asInt, y.asInt);
+            return true;
+        }
+        if (kind == OpCode::EQ || kind == OpCode::NE) {
+            result = runtime::equals(x, y) == (kind == OpCode::EQ);
+            return true;
+        }
+        TokenType op = kind == OpCode::LT ? TokenType::LESS
+                     : kind == OpCode::LE ? TokenType::LESS_EQUAL
+                     : kind == OpCode::GT ? TokenType::GREATER : TokenType::GREATER_EQUAL;
+        Value value;
+        if (!runtime::binary(op, x, y, value, error)) return false;
+        result = value.asBool;
+        return true;
+    }
+
+    void flush() {
+        out << output;
+        out.flush();
+        output.clear();
+    }
+
+    const BytecodeProgram& program;
+    const std::vector<ClassLayout>& layouts;
+    Diagnostics& diagnostics;
+    std::ostream& out;
+    std::string output; // (SUMMON يكتب هنا، ويُفرغ كل OUTPUT_FLUSH وعند النهاية)
+
+    std::vector<Value> stack;
+    std::vector<Frame> frames;
+    std::vector<Value> globals;
+    std::deque<Instance> heap;
+    StringHeap strings; // (نصوص وقت التنفيذ، تعيش مثل الـ objects حتى الـ run التالي)
+};
+
+#undef DUELSCRIPT_VM_CASE
+#undef DUELSCRIPT_VM_NEXT
+
+#endif // DUELSCRIPT_VM_H
@@ -0,0 +1,79 @@
+#ifndef DUELSCRIPT_VALUE_H
+#define DUELSCRIPT_VALUE_H
+
+#include "SymbolTable.h"
+#include <charconv>
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+struct Instance;
+
+// --- Value ---
+// قيمة DuelScript واحدة بحجم 16 byte: tag + union، بدون heap وبدون RTTI.
+// (النص = pointer + طول لا يتغيران: الـ literals في الـ SymbolTable، ونصوص وقت التنفيذ في
+// الـ StringHeap الخاص بالـ engine، لذلك النسخ مجاني؛ الطول في الـ bytes الفارغة بعد الـ tag)
+struct Value {
+    enum class Type : uint8_t { NIL, INT, DOUBLE, BOOL, STRING, OBJECT };
+
+    Type type = Type::NIL;
+    uint32_t length = 0; // (STRING فقط)
+    union {
+        int64_t asInt;
+        double asDouble;
+        bool asBool;
+        const char* asChars;
+        Instance* asObject; // (LordOfD / ToonWorld، يملكه الـ Interpreter)
+    };
+
+    Value() : asInt(0) {}
+
+    static Value integer(int64_t value) { Value v; v.type = Type::INT; v.asInt = value; return v; }
+    static Value number(double value) { Value v; v.type = Type::DOUBLE; v.asDouble = value; return v; }
+    static Value boolean(bool value) { Value v; v.type = Type::BOOL; v.asBool = value; return v; }
+    // (text يجب أن يعيش أطول من القيمة: SymbolTable أو StringHeap، وطوله لا يتجاوز UINT32_MAX)
+    static Value string(std::string_view text) {
+        Value v;
+        v.type = Type::STRING;
+        v.length = static_cast<uint32_t>(text.size());
+        v.asChars = text.data();
+        return v;
+    }
+    // literal: النص من الـ SymbolTable (يعيش حتى نهاية الـ process)
+    static Value interned(Symbol symbol) { return string(SymbolTable::global().name(symbol)); }
+    static Value object(Instance* value) { Value v; v.type = Type::OBJECT; v.asObject = value; return v; }
+
+    bool isNil() const { return type == Type::NIL; }
+    bool isNumber() const { return type == Type::INT || type == Type::DOUBLE; }
+
+    // (INT أو DOUBLE كـ double)
+    double toDouble() const { return type == Type::INT ? static_cast<double>(asInt) : asDouble; }
+
+    std::string_view stringValue() const { return {asChars, length}; }
+};
+
+// قيمة NUMBER literal: بدون '.' = عدد صحيح، إلا إذا كان أكبر من int64
+// (from_chars يقرأ مباشرة من الـ view بدون std::string مؤقت)
+inline Value numberValue(std::string_view lexeme) {
+    const char* first = lexeme.data();
+    const char* last = first + lexeme.size();
+    if (lexeme.find('.') == std::string_view::npos) {
+        int64_t integer = 0;
+        auto [end, error] = std::from_chars(first, last, integer);
+        if (error == std::errc() && end == last) return Value::integer(integer);
+    }
+    double number = 0;
+    std::from_chars(first, last, number);
+    return Value::number(number);
+}
+
+// --- Instance ---
+// object من LordOfD / ToonWorld: رقم الـ layout (انظر Resolver.h) والحقول بترتيب تعريفها.
+struct Instance {
+    uint32_t layout;
+    std::vector<Value> fields;
+};
+
+static_assert(sizeof(Value) == 16, "Value should stay a 16-byte tag + payload");
+
+#endif // DUELSCRIPT_VALUE_H
@@ -1,47 +1,200 @@
 #include <iostream>
-#include <fstream>
-#include <sstream>
+#define DUELSCRIPT_ALLOCATION_HOOKS
+#include "AllocationStats.h"
+#include "CompilationUnit.h"
 #include "DuelScriptScanner.h"
 #include "Parser.h"
 #include "AstNodes.h"
 #include "AstPrinter.h" // <-- إضافة جديدة
+#include "Benchmarks.h"
+#include "ThreadPool.h"
+#include "AstCache.h"
+#include "ModuleLoader.h"
+#include "Resolver.h"
+#include "TypeChecker.h"
+#include "Optimizer.h"
+#include "CppEmitter.h"
+#include "Interpreter.h"
+#include "BytecodeCompiler.h"
+#include "VM.h"
+#include <chrono>
+#include <fstream>
 
-// Helper function to read a file into a string
-std::string readFile(const std::string& path) {
-    std::ifstream file(path);
-    if (!file.is_open()) {
+// Helper function to load a source file ("-" = stdin)
+SourceBuffer readFile(const std::string& path) {
+    std::optional<SourceBuffer> source = SourceBuffer::fromFile(path);
+    if (!source) {
         std::cerr << "Could not open file: " << path << std::endl;
         exit(74); // Exit code for I/O error
     }
+    return std::move(*source);
+}
 
-    std::stringstream buffer;
-    buffer << file.rdbuf();
-    file.close();
-    return buffer.str();
+// (--cache) الزمن بالـ ms منذ start
+double millisecondsSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+// (--stats) طباعة عدد الـ allocations لكل مرحلة
+void printAllocations(const char* phase, const alloc_stats::Snapshot& delta) {
+    std::cout << "    [" << phase << ": " << delta.count << " allocations, "
+              << delta.bytes << " bytes]" << std::endl;
 }
 
 int main(int argc, char* argv[]) {
     std::string sourceFile = "test.duelscript";
+    bool showStats = false;
+    bool streaming = false;
+    bool parallel = false;
+    bool flatAst = false;
+    std::optional<std::string> cacheDir; // (--cache / --cache-dir DIR)
+    size_t maxErrors = Diagnostics::DEFAULT_LIMIT;
+    bool loadModules = false; // (--modules / --module-path DIR)
+    bool showModules = false;
+    std::vector<std::string> modulePaths;
+    bool useVm = false; // (--vm / --bytecode)
+    bool showBytecode = false;
+    bool optimize = false; // (--optimize)
+    bool typecheck = false; // (--typecheck)
+    std::optional<std::string> emitCpp; // (--emit-cpp FILE.cpp / --native FILE / --shared FILE.so)
+    std::optional<std::string> nativeOutput;
+    bool nativeShared = false;
 
-    if (argc == 2) {
-        sourceFile = argv[1];
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--stats") {
+            showStats = true;
+        } else if (arg == "--stream") {
+            streaming = true;
+        } else if (arg == "--parallel") {
+            parallel = true;
+        } else if (arg == "--flat") {
+            flatAst = true;
+        } else if (arg == "--cache") {
+            if (!cacheDir) cacheDir = ".duelscript-cache";
+        } else if (arg == "--cache-dir" && i + 1 < argc) {
+            cacheDir = argv[++i];
+        } else if (arg == "--modules") {
+            loadModules = showModules = true;
+        } else if (arg == "--module-path" && i + 1 < argc) {
+            loadModules = true;
+            modulePaths.push_back(argv[++i]);
+        } else if (arg == "--vm") {
+            useVm = true;
+        } else if (arg == "--bytecode") {
+            useVm = showBytecode = true;
+        } else if (arg == "--optimize") {
+            optimize = true;
+        } else if (arg == "--typecheck") {
+            typecheck = true;
+        } else if (arg == "--emit-cpp" && i + 1 < argc) {
+            emitCpp = argv[++i];
+            typecheck = true;
+        } else if ((arg == "--native" || arg == "--shared") && i + 1 < argc) {
+            nativeOutput = argv[++i];
+            nativeShared = arg == "--shared";
+            if (!emitCpp) emitCpp = *nativeOutput + ".cpp";
+            typecheck = true;
+        } else if (arg == "--max-errors" && i + 1 < argc) {
+            maxErrors = std::stoul(argv[++i]);
+        } else if (arg == "--bench" && i + 1 < argc) {
+            return bench::run(argv[++i]);
+        } else {
+            sourceFile = arg;
+        }
     }
 
-    std::string sourceCode = readFile(sourceFile);
+    CompilationUnit unit(sourceFile, readFile(sourceFile));
+
+    std::vector<NodePtr<Stmt>> statements;
+    std::optional<TokenBuffer> tokens; // (Batch فقط)
+    std::optional<flat::FlatAst> flatTree; // (من الـ cache، أو لكتابته فيه)
+    bool hadError = false;
+    // (أخطاء الـ Scanner والـ Parser تُجمع هنا وتُطبع بعد كل مرحلة)
+    Diagnostics diagnostics(maxErrors);
+    // (الـ Scanner يرفض الملف كله ويسجل SOURCE_TOO_LARGE؛ الباقي سيكون برنامجاً فارغاً)
+    bool tooLarge = unit.text().size() > Scanner::MAX_SOURCE_BYTES;
+
+    if (streaming) {
+        // --- 1+2. الـ Scanner والـ Parser معاً (الـ Parser يسحب الـ Tokens عند الحاجة) ---
+        std::cout << "--- 1+2. Streaming DuelScript file into the Parser: " << sourceFile << " ---" << std::endl;
+        alloc_stats::Snapshot before = alloc_stats::snapshot();
+        Scanner scanner(unit.text(), &diagnostics);
+        Parser parser(scanner, unit.getArena(), &diagnostics);
+        statements = parser.parse();
+        diagnostics.emit(std::cerr);
+        hadError = parser.hadError || diagnostics.full() || tooLarge;
+        if (showStats) printAllocations("scanner+parser", alloc_stats::snapshot() - before);
+    } else {
+        // --- 0. الـ AST Cache: نفس الـ source = نفس الشجرة بدون Scanner و Parser ---
+        std::optional<AstCache> cache;
+        uint64_t cacheKey = 0;
+        auto start = std::chrono::steady_clock::now();
+        if (cacheDir) {
+            cache.emplace(*cacheDir);
+            cacheKey = AstCache::hash(unit.text());
+            flat::FlatAst cached;
+            AstCache::Status status = cache->load(cacheKey, unit.text(), tokens, cached);
+            if (status == AstCache::Status::HIT) {
+                std::cout << "--- 1+2. Loading cached AST: " << cache->pathFor(cacheKey) << " ---" << std::endl;
+                flatTree.emplace(std::move(cached));
+                statements = flat::expand(*flatTree, unit.getArena());
+                std::cout << "    [cache hit (warm): " << millisecondsSince(start) << " ms, "
+                          << flatTree->nodeCount() << " nodes]" << std::endl;
+            } else {
+                std::cout << "    [cache " << AstCache::statusName(status) << ": " << cache->pathFor(cacheKey) << "]"
+                          << std::endl;
+            }
+        }
 
-    // --- 1. مرحلة الـ Scanner ---
-    std::cout << "--- 1. Scanning DuelScript file: " << sourceFile << " ---" << std::endl;
-    Scanner scanner(sourceCode);
-    std::vector<Token> tokens = scanner.scanTokens();
-    std::cout << "--- Scanning Complete (" << tokens.size() << " tokens) ---" << std::endl;
+        if (!flatTree) {
+            // --- 1. مرحلة الـ Scanner ---
+            std::cout << "--- 1. Scanning DuelScript file: " << sourceFile << " ---" << std::endl;
+            alloc_stats::Snapshot before = alloc_stats::snapshot();
+            tokens.emplace(scanPacked(unit.text(), &diagnostics));
+            diagnostics.emit(std::cerr);
+            std::cout << "--- Scanning Complete (" << tokens->size() << " tokens) ---" << std::endl;
+            if (showStats) {
+                printAllocations("scanner", alloc_stats::snapshot() - before);
+                std::cout << "    [symbols: " << SymbolTable::global().size() << " unique names]" << std::endl;
+            }
 
 
-    // --- 2. مرحلة الـ Parser ---
-    std::cout << "\n--- 2. Parsing Tokens into AST ---" << std::endl;
-    Parser parser(tokens);
-    std::vector<std::unique_ptr<Stmt>> statements = parser.parse();
+            // --- 2. مرحلة الـ Parser ---
+            std::cout << "\n--- 2. Parsing Tokens into AST ---" << std::endl;
+            before = alloc_stats::snapshot();
+            Parser parser(*tokens, unit.getArena(), &diagnostics);
+            statements = parallel ? parser.parseParallel(ThreadPool::shared()) : parser.parse();
+            diagnostics.emit(std::cerr);
+            hadError = parser.hadError || diagnostics.full() || tooLarge;
+            if (showStats) printAllocations("parser", alloc_stats::snapshot() - before);
 
-    if (parser.hadError) {
+            // (فقط برنامج بدون أي خطأ يُحفظ: التحميل لاحقاً لا يعيد طباعة الأخطاء)
+            if (cache && !hadError && diagnostics.empty()) {
+                flatTree.emplace(flat::flatten(statements, *tokens));
+                size_t bytes = cache->store(cacheKey, unit.text(), *tokens, *flatTree);
+                std::cout << "    [cache stored (cold): " << millisecondsSince(start) << " ms, " << bytes
+                          << " bytes]" << std::endl;
+            }
+        }
+    }
+
+    // --- 2b. مرحلة الـ Modules: كل #SetField يُحمل ويُحلل (مرة واحدة لكل ملف) ---
+    std::optional<ModuleLoader> loader;
+    if (loadModules && !hadError) {
+        std::cout << "--- 2b. Loading #SetField modules ---" << std::endl;
+        loader.emplace(modulePaths, ThreadPool::shared(), maxErrors);
+        hadError = !loader->load(sourceFile, statements, diagnostics);
+        diagnostics.emit(std::cerr);
+        for (const auto& module : loader->getModules()) {
+            if (module->diagnostics.empty()) continue;
+            std::cerr << "In module " << module->path << ":" << std::endl;
+            module->diagnostics.emit(std::cerr);
+        }
+        if (showModules) loader->print(std::cout);
+    }
+
+    if (hadError) {
         std::cout << "--- Parsing Failed (see errors above) ---" << std::endl;
         return 65; // Exit code for data error
     }
@@ -52,11 +205,128 @@ int main(int argc, char* argv[]) {
     // --- 3. مرحلة طباعة الـ AST (الجديدة) ---
     std::cout << "\n--- 3. Abstract Syntax Tree (AST) ---" << std::endl;
     AstPrinter printer;
-    printer.print(statements);
+    if (flatAst && tokens) {
+        // (--flat) نفس الطباعة لكن من الـ Flat AST
+        if (!flatTree) flatTree.emplace(flat::flatten(statements, *tokens));
+        if (showStats) {
+            std::cout << "    [flat AST: " << flatTree->nodeCount() << " nodes, " << flatTree->bytes() << " bytes]" << std::endl;
+        }
+        printer.print(*flatTree);
+    } else {
+        printer.print(statements);
+    }
 
 
-    // --- 4. مرحلة الـ Interpreter (قادماً) ---
-    // (هنا سنقوم بتنفيذ الـ "statements" قريباً)
+    // --- 4. مرحلة الـ Interpreter ---
+    // (الـ modules أولاً، كل module بعد ما يطلبه، ثم البرنامج نفسه)
+    std::vector<Resolver::Unit> units;
+    std::vector<size_t> moduleOrder;
+    if (loader) {
+        const auto& modules = loader->getModules();
+        moduleOrder = loader->initializationOrder();
+        for (size_t id : moduleOrder) units.push_back({&modules[id]->statements, &modules[id]->diagnostics});
+    }
+    units.push_back({&statements, &diagnostics});
+    auto emitAll = [&] {
+        for (size_t i = 0; i + 1 < units.size(); ++i) {
+            if (units[i].diagnostics->empty()) continue;
+            std::cerr << "In module " << loader->getModules()[moduleOrder[i]]->path << ":" << std::endl;
+            units[i].diagnostics->emit(std::cerr);
+        }
+        diagnostics.emit(std::cerr);
+    };
+
+    ResolvedProgram program;
+    Resolver resolver;
+    if (!resolver.resolve(units, program)) {
+        emitAll();
+        std::cout << "--- Resolving Failed (see errors above) ---" << std::endl;
+        return 65;
+    }
+
+    TypeChecker checker;
+    if (typecheck) {
+        // --- 3a. الـ TypeChecker: أخطاء الأنواع قبل التنفيذ، وكل Expr يعرف نوعه ---
+        if (!checker.check(units, program)) {
+            emitAll();
+            std::cout << "--- Type Checking Failed (see errors above) ---" << std::endl;
+            return 65;
+        }
+        std::cout << "\n--- 3a. Type Check Passed ---" << std::endl;
+    }
+
+    if (optimize) {
+        // --- 3b. الـ Optimizer: constant folding وحذف الفروع الميتة قبل التنفيذ ---
+        Optimizer optimizer;
+        if (loader) {
+            const auto& modules = loader->getModules();
+            for (size_t id = 1; id < modules.size(); ++id) {
+                optimizer.optimize(modules[id]->statements, modules[id]->unit->getArena());
+            }
+        }
+        optimizer.optimize(statements, unit.getArena());
+        const Optimizer::Stats& stats = optimizer.getStats();
+        std::cout << "\n--- 3b. Optimized AST (" << stats.removed << " nodes removed: " << stats.folded
+                  << " constants folded, " << stats.branches << " constant branches, " << stats.unreachable
+                  << " unreachable statements) ---" << std::endl;
+    }
+
+    if (emitCpp) {
+        // --- 4c. C++ بدلاً من التنفيذ (AOT)، ثم الـ compiler إن طُلب executable / shared object ---
+        std::string code;
+        CppEmitter emitter;
+        if (!emitter.emit(program, checker, diagnostics, sourceFile, code)) {
+            emitAll();
+            std::cout << "--- C++ Emission Failed (see errors above) ---" << std::endl;
+            return 65;
+        }
+        std::ofstream file(*emitCpp, std::ios::binary);
+        if (!(file << code) || !file.flush()) {
+            std::cerr << "Could not write file: " << *emitCpp << std::endl;
+            return 74;
+        }
+        file.close();
+        std::cout << "\n--- 4c. Emitted C++ (" << code.size() << " bytes) to " << *emitCpp << " ---" << std::endl;
+        if (!nativeOutput) return 0;
+        int status = buildNative(*emitCpp, *nativeOutput, nativeShared);
+        if (status != 0) {
+            std::cout << "--- Native Build Failed (compiler exit " << status << ") ---" << std::endl;
+            return 70;
+        }
+        std::cout << "--- Built " << (nativeShared ? "shared object " : "executable ") << *nativeOutput << " ---" << std::endl;
+        return 0;
+    }
+
+    bool ok;
+    if (useVm) {
+        // --- 4b. الـ Bytecode Compiler ثم الـ VM بدلاً من المشي على الـ AST ---
+        BytecodeProgram bytecode;
+        BytecodeCompiler compiler(diagnostics);
+        if (!compiler.compile(program, bytecode)) {
+            emitAll();
+            std::cout << "--- Bytecode Compilation Failed (see errors above) ---" << std::endl;
+            return 65;
+        }
+        if (showBytecode) {
+            std::cout << std::endl;
+            Disassembler(bytecode).print(std::cout);
+        }
+
+        std::cout << "\n--- 4. Running DuelScript (bytecode VM) ---" << std::endl;
+        VM vm(bytecode, diagnostics);
+        ok = vm.run();
+    } else {
+        std::cout << "\n--- 4. Running DuelScript ---" << std::endl;
+        Interpreter interpreter(program, diagnostics);
+        ok = interpreter.run();
+    }
+    std::cout << std::endl;
+    emitAll();
+    if (!ok) {
+        std::cout << "--- Runtime Error (see errors above) ---" << std::endl;
+        return 70; // Exit code for internal software error
+    }
+    std::cout << "--- Run Complete ---" << std::endl;
 
     return 0;
 }